@@ -6,6 +6,30 @@
 
 /* file load/save operations */
 #include <Vector/BLF/File.h>
+#include <Vector/BLF/FileRecovery.h>
+#include <Vector/BLF/MultiProducerWriter.h>
+#include <Vector/BLF/RotatingFile.h>
+#include <Vector/BLF/SharedMemoryPublisher.h>
+#include <Vector/BLF/SharedMemoryReader.h>
+#include <Vector/BLF/TriggerRecorder.h>
+
+/* analysis */
+#include <Vector/BLF/CanBusLoad.h>
+#include <Vector/BLF/Dbc.h>
+#include <Vector/BLF/IsoTpReassembler.h>
+#include <Vector/BLF/J1939.h>
+#include <Vector/BLF/SignalDecoder.h>
+
+/* export */
+#include <Vector/BLF/ArrowWriter.h>
+#include <Vector/BLF/AscWriter.h>
+#include <Vector/BLF/Mdf4Writer.h>
+#include <Vector/BLF/PcapngWriter.h>
+
+/* import */
+#include <Vector/BLF/AscReader.h>
+#include <Vector/BLF/CandumpReader.h>
+#include <Vector/BLF/PcapReader.h>
 
 /* exceptions */
 #include <Vector/BLF/Exceptions.h>
@@ -0,0 +1,962 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/ArrowWriter.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#include <Vector/BLF/CanFdMessage.h>
+#include <Vector/BLF/CanFdMessage64.h>
+#include <Vector/BLF/CanMessage.h>
+#include <Vector/BLF/CanMessage2.h>
+#include <Vector/BLF/EthernetFrame.h>
+#include <Vector/BLF/EthernetFrameEx.h>
+#include <Vector/BLF/Exceptions.h>
+#include <Vector/BLF/FlexRayVFrReceiveMsg.h>
+#include <Vector/BLF/FlexRayVFrReceiveMsgEx.h>
+#include <Vector/BLF/LinMessage.h>
+#include <Vector/BLF/LinMessage2.h>
+#include <Vector/BLF/SystemVariable.h>
+
+namespace Vector {
+namespace BLF {
+
+namespace {
+
+/**
+ * Minimal flatbuffer builder.
+ *
+ * Like the reference implementation, the buffer is built back to front:
+ * children are created first and referenced by their distance to the end
+ * of the buffer. Messages are small, so prepending is cheap enough.
+ */
+class FlatBufferBuilder final {
+  public:
+    /** current size, which is also the offset of the last created object */
+    uint32_t size() const {
+        return static_cast<uint32_t>(m_data.size());
+    }
+
+    /** finished buffer */
+    const std::vector<uint8_t> & data() const {
+        return m_data;
+    }
+
+    /** create string */
+    uint32_t createString(const std::string & string) {
+        align(string.size() + 1, 4);
+        pad(1);
+        pushBytes(string.data(), string.size());
+        push<uint32_t>(static_cast<uint32_t>(string.size()));
+        return size();
+    }
+
+    /** create vector of scalars or structs */
+    uint32_t createVector(const void * elements, const std::size_t count, const std::size_t elementSize, const std::size_t alignment) {
+        align(count * elementSize, std::max<std::size_t>(alignment, 4));
+        pushBytes(elements, count * elementSize);
+        push<uint32_t>(static_cast<uint32_t>(count));
+        return size();
+    }
+
+    /** create vector of tables */
+    uint32_t createOffsetVector(const std::vector<uint32_t> & offsets) {
+        align(offsets.size() * 4, 4);
+        for (auto it = offsets.rbegin(); it != offsets.rend(); ++it)
+            pushOffset(*it);
+        push<uint32_t>(static_cast<uint32_t>(offsets.size()));
+        return size();
+    }
+
+    /** start table */
+    void startTable() {
+        m_fields.clear();
+        m_tableStart = size();
+    }
+
+    /** add scalar field */
+    template<typename T>
+    void addField(const uint16_t id, const T value) {
+        push<T>(value);
+        m_fields.push_back(std::make_pair(id, size()));
+    }
+
+    /** add offset field */
+    void addOffset(const uint16_t id, const uint32_t offset) {
+        pushOffset(offset);
+        m_fields.push_back(std::make_pair(id, size()));
+    }
+
+    /** end table and write its vtable in front of it */
+    uint32_t endTable() {
+        push<int32_t>(0);
+        const uint32_t table = size();
+
+        uint16_t fieldCount = 0;
+        for (const auto & field : m_fields)
+            fieldCount = std::max<uint16_t>(fieldCount, field.first + 1);
+        std::vector<uint16_t> vtable(fieldCount);
+        for (const auto & field : m_fields)
+            vtable[field.first] = static_cast<uint16_t>(table - field.second);
+        for (auto it = vtable.rbegin(); it != vtable.rend(); ++it)
+            push<uint16_t>(*it);
+        push<uint16_t>(static_cast<uint16_t>(table - m_tableStart));
+        push<uint16_t>(static_cast<uint16_t>(4 + 2 * fieldCount));
+
+        /* vtable is located before the table */
+        const int32_t vtableOffset = static_cast<int32_t>(size() - table);
+        std::memcpy(m_data.data() + m_data.size() - table, &vtableOffset, sizeof(vtableOffset));
+        return table;
+    }
+
+    /** finish buffer with root table */
+    void finish(const uint32_t root) {
+        align(4, 8);
+        pushOffset(root);
+    }
+
+  private:
+    /** buffer */
+    std::vector<uint8_t> m_data {};
+
+    /** fields of current table (id, offset) */
+    std::vector<std::pair<uint16_t, uint32_t>> m_fields {};
+
+    /** size at start of current table */
+    uint32_t m_tableStart {};
+
+    /** prepend zero bytes */
+    void pad(const std::size_t count) {
+        m_data.insert(m_data.begin(), count, 0);
+    }
+
+    /** pad, so that an element of given size ends aligned */
+    void align(const std::size_t elementSize, const std::size_t alignment) {
+        pad((alignment - (m_data.size() + elementSize) % alignment) % alignment);
+    }
+
+    /** prepend bytes */
+    void pushBytes(const void * data, const std::size_t count) {
+        const uint8_t * bytes = static_cast<const uint8_t *>(data);
+        m_data.insert(m_data.begin(), bytes, bytes + count);
+    }
+
+    /** prepend scalar */
+    template<typename T>
+    void push(const T value) {
+        align(sizeof(T), sizeof(T));
+        pushBytes(&value, sizeof(T));
+    }
+
+    /** prepend offset, which is relative to its own location */
+    void pushOffset(const uint32_t offset) {
+        align(4, 4);
+        const uint32_t value = size() + 4 - offset;
+        pushBytes(&value, sizeof(value));
+    }
+};
+
+/** Arrow metadata version V5 */
+const int16_t MetadataVersionV5 = 4;
+
+/** Arrow message header types */
+enum MessageHeader : uint8_t {
+    SchemaHeader = 1,
+    DictionaryBatchHeader = 2,
+    RecordBatchHeader = 3
+};
+
+/** Arrow types */
+enum Type : uint8_t {
+    IntType = 2,
+    FloatingPointType = 3,
+    BinaryType = 4,
+    Utf8Type = 5,
+    TimestampType = 10
+};
+
+/** Arrow file block */
+struct Block {
+    /** file offset of message */
+    int64_t offset;
+
+    /** metadata length including prefix and padding */
+    int32_t metaDataLength;
+
+    /** padding */
+    int32_t reserved;
+
+    /** body length */
+    int64_t bodyLength;
+};
+
+/** Arrow field node and buffer (both are two int64) */
+struct Int64Pair {
+    /** length or offset */
+    int64_t first;
+
+    /** null count or length */
+    int64_t second;
+};
+
+/** buffer of a record batch body */
+struct BodyBuffer {
+    /** data */
+    const void * data;
+
+    /** size */
+    std::size_t size;
+};
+
+/** padding to 8 bytes */
+std::size_t padding8(const std::size_t size) {
+    return (8 - size % 8) % 8;
+}
+
+/** create Int type */
+uint32_t createIntType(FlatBufferBuilder & fb, const int32_t bitWidth, const bool isSigned) {
+    fb.startTable();
+    fb.addField<int32_t>(0, bitWidth);
+    fb.addField<uint8_t>(1, isSigned);
+    return fb.endTable();
+}
+
+/** dictionary with values in insertion order */
+struct Dictionary {
+    /** dictionary id */
+    int64_t id {};
+
+    /** string (true) or uint16 (false) values */
+    bool utf8 {};
+
+    /** indices of string values */
+    std::map<std::string, int32_t> strings {};
+
+    /** indices of numeric values */
+    std::map<uint16_t, int32_t> numbers {};
+
+    /** values not written yet */
+    std::vector<uint8_t> values {};
+
+    /** offsets of string values not written yet */
+    std::vector<int32_t> offsets { 0 };
+
+    /** number of values not written yet */
+    int32_t count {};
+
+    /** first dictionary batch was written */
+    bool written {};
+
+    /** get index of string value */
+    int32_t index(const std::string & value) {
+        auto it = strings.find(value);
+        if (it != strings.end())
+            return it->second;
+        int32_t index = static_cast<int32_t>(strings.size());
+        strings[value] = index;
+        values.insert(values.end(), value.begin(), value.end());
+        offsets.push_back(static_cast<int32_t>(values.size()));
+        count++;
+        return index;
+    }
+
+    /** get index of numeric value */
+    int32_t index(const uint16_t value) {
+        auto it = numbers.find(value);
+        if (it != numbers.end())
+            return it->second;
+        int32_t index = static_cast<int32_t>(numbers.size());
+        numbers[value] = index;
+        values.resize(values.size() + sizeof(value));
+        std::memcpy(values.data() + values.size() - sizeof(value), &value, sizeof(value));
+        count++;
+        return index;
+    }
+};
+
+/** column */
+struct Column {
+    /** column types */
+    enum class Kind : uint8_t {
+        UInt8,
+        UInt16,
+        UInt32,
+        UInt64,
+        Double,
+        Timestamp,
+        Binary,
+        Dictionary
+    };
+
+    /** name */
+    std::string name {};
+
+    /** type */
+    Kind kind {};
+
+    /** dictionary index (if dictionary encoded) */
+    std::size_t dictionary {};
+
+    /** values or dictionary indices */
+    std::vector<uint8_t> values {};
+
+    /** offsets (if binary) */
+    std::vector<int32_t> offsets { 0 };
+
+    /** append fixed width value */
+    template<typename T>
+    void append(const T value) {
+        values.resize(values.size() + sizeof(T));
+        std::memcpy(values.data() + values.size() - sizeof(T), &value, sizeof(T));
+    }
+
+    /** append binary value */
+    void appendBinary(const uint8_t * data, const std::size_t size) {
+        values.insert(values.end(), data, data + size);
+        offsets.push_back(static_cast<int32_t>(values.size()));
+    }
+
+    /** clear values, but keep capacity */
+    void clear() {
+        values.clear();
+        offsets.resize(1);
+    }
+};
+
+}
+
+/** table with columns and file */
+struct ArrowWriter::Table {
+    /** file */
+    std::ofstream file {};
+
+    /** columns */
+    std::vector<Column> columns {};
+
+    /** dictionaries */
+    std::vector<Dictionary> dictionaries {};
+
+    /** rows in current batch */
+    uint32_t rows {};
+
+    /** dictionary batch blocks */
+    std::vector<Block> dictionaryBlocks {};
+
+    /** record batch blocks */
+    std::vector<Block> recordBatchBlocks {};
+
+    /** add column */
+    void addColumn(const char * name, const Column::Kind kind) {
+        Column column;
+        column.name = name;
+        column.kind = kind;
+        columns.push_back(column);
+    }
+
+    /** add dictionary encoded column */
+    void addDictionaryColumn(const char * name, const bool utf8) {
+        Dictionary dictionary;
+        dictionary.id = static_cast<int64_t>(dictionaries.size());
+        dictionary.utf8 = utf8;
+        dictionaries.push_back(dictionary);
+
+        Column column;
+        column.name = name;
+        column.kind = Column::Kind::Dictionary;
+        column.dictionary = dictionaries.size() - 1;
+        columns.push_back(column);
+    }
+
+    /** append dictionary index of a string value */
+    void appendDictionary(const std::size_t column, const std::string & value) {
+        columns[column].append<int32_t>(dictionaries[columns[column].dictionary].index(value));
+    }
+
+    /** append dictionary index of a numeric value */
+    void appendDictionary(const std::size_t column, const uint16_t value) {
+        columns[column].append<int32_t>(dictionaries[columns[column].dictionary].index(value));
+    }
+
+    /** open file and write schema */
+    void open(const std::string & filename) {
+        file.open(filename, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        if (!file.is_open())
+            throw Exception("ArrowWriter::open(): Unable to open file.");
+        file.write("ARROW1\0\0", 8);
+
+        FlatBufferBuilder fb;
+        uint32_t schema = createSchema(fb);
+        writeMessage(fb, SchemaHeader, schema, nullptr, 0);
+    }
+
+    /** end row and write record batch if full */
+    void endRow(const uint32_t batchSize) {
+        if (++rows >= batchSize)
+            writeRecordBatch();
+    }
+
+    /** write dictionary deltas and record batch */
+    void writeRecordBatch() {
+        /* dictionaries must be defined before the first record batch, later only new values are written */
+        for (Dictionary & dictionary : dictionaries) {
+            if (dictionary.written && (dictionary.count == 0))
+                continue;
+            writeDictionaryBatch(dictionary);
+        }
+        if (rows == 0)
+            return;
+
+        std::vector<Int64Pair> nodes;
+        std::vector<BodyBuffer> buffers;
+        for (const Column & column : columns) {
+            nodes.push_back(Int64Pair { rows, 0 });
+            buffers.push_back(BodyBuffer { nullptr, 0 }); // validity
+            if (column.kind == Column::Kind::Binary)
+                buffers.push_back(BodyBuffer { column.offsets.data(), column.offsets.size() * sizeof(int32_t) });
+            buffers.push_back(BodyBuffer { column.values.data(), column.values.size() });
+        }
+
+        FlatBufferBuilder fb;
+        uint32_t recordBatch = createRecordBatch(fb, rows, nodes, buffers);
+        recordBatchBlocks.push_back(writeMessage(fb, RecordBatchHeader, recordBatch, buffers.data(), buffers.size()));
+
+        for (Column & column : columns)
+            column.clear();
+        rows = 0;
+    }
+
+    /** write remaining rows, end of stream marker and footer */
+    void close() {
+        writeRecordBatch();
+
+        /* end of stream */
+        const uint32_t endOfStream[2] = { 0xffffffff, 0 };
+        file.write(reinterpret_cast<const char *>(endOfStream), sizeof(endOfStream));
+
+        /* footer */
+        FlatBufferBuilder fb;
+        uint32_t recordBatches = fb.createVector(recordBatchBlocks.data(), recordBatchBlocks.size(), sizeof(Block), 8);
+        uint32_t dictionaryBatches = fb.createVector(dictionaryBlocks.data(), dictionaryBlocks.size(), sizeof(Block), 8);
+        uint32_t schema = createSchema(fb);
+        fb.startTable();
+        fb.addOffset(3, recordBatches);
+        fb.addOffset(2, dictionaryBatches);
+        fb.addOffset(1, schema);
+        fb.addField<int16_t>(0, MetadataVersionV5);
+        fb.finish(fb.endTable());
+        const int32_t footerSize = static_cast<int32_t>(fb.size());
+        file.write(reinterpret_cast<const char *>(fb.data().data()), footerSize);
+        file.write(reinterpret_cast<const char *>(&footerSize), sizeof(footerSize));
+        file.write("ARROW1", 6);
+        file.close();
+    }
+
+  private:
+    /** create schema */
+    uint32_t createSchema(FlatBufferBuilder & fb) const {
+        std::vector<uint32_t> fields;
+        for (const Column & column : columns) {
+            uint32_t name = fb.createString(column.name);
+            uint32_t children = fb.createOffsetVector(std::vector<uint32_t>());
+
+            /* type */
+            uint8_t typeType;
+            uint32_t type;
+            uint32_t dictionaryEncoding = 0;
+            switch (column.kind) {
+            case Column::Kind::UInt8:
+                typeType = IntType;
+                type = createIntType(fb, 8, false);
+                break;
+            case Column::Kind::UInt16:
+                typeType = IntType;
+                type = createIntType(fb, 16, false);
+                break;
+            case Column::Kind::UInt32:
+                typeType = IntType;
+                type = createIntType(fb, 32, false);
+                break;
+            case Column::Kind::UInt64:
+                typeType = IntType;
+                type = createIntType(fb, 64, false);
+                break;
+            case Column::Kind::Double:
+                typeType = FloatingPointType;
+                fb.startTable();
+                fb.addField<int16_t>(0, 2); // DOUBLE
+                type = fb.endTable();
+                break;
+            case Column::Kind::Timestamp:
+                typeType = TimestampType;
+                fb.startTable();
+                fb.addField<int16_t>(0, 3); // NANOSECOND
+                type = fb.endTable();
+                break;
+            case Column::Kind::Binary:
+                typeType = BinaryType;
+                fb.startTable();
+                type = fb.endTable();
+                break;
+            case Column::Kind::Dictionary:
+            default: {
+                const Dictionary & dictionary = dictionaries[column.dictionary];
+                if (dictionary.utf8) {
+                    typeType = Utf8Type;
+                    fb.startTable();
+                    type = fb.endTable();
+                } else {
+                    typeType = IntType;
+                    type = createIntType(fb, 16, false);
+                }
+                uint32_t indexType = createIntType(fb, 32, true);
+                fb.startTable();
+                fb.addField<int64_t>(0, dictionary.id);
+                fb.addOffset(1, indexType);
+                dictionaryEncoding = fb.endTable();
+            }
+            break;
+            }
+
+            fb.startTable();
+            fb.addOffset(0, name);
+            fb.addOffset(3, type);
+            if (dictionaryEncoding != 0)
+                fb.addOffset(4, dictionaryEncoding);
+            fb.addOffset(5, children);
+            fb.addField<uint8_t>(1, false); // nullable
+            fb.addField<uint8_t>(2, typeType);
+            fields.push_back(fb.endTable());
+        }
+        uint32_t fieldVector = fb.createOffsetVector(fields);
+
+        fb.startTable();
+        fb.addOffset(1, fieldVector);
+        fb.addField<int16_t>(0, 0); // little endian
+        return fb.endTable();
+    }
+
+    /** create record batch */
+    static uint32_t createRecordBatch(FlatBufferBuilder & fb, const int64_t length, const std::vector<Int64Pair> & nodes, const std::vector<BodyBuffer> & buffers) {
+        std::vector<Int64Pair> bufferVector;
+        int64_t offset = 0;
+        for (const BodyBuffer & buffer : buffers) {
+            bufferVector.push_back(Int64Pair { offset, static_cast<int64_t>(buffer.size) });
+            offset += buffer.size + padding8(buffer.size);
+        }
+        uint32_t bufferOffset = fb.createVector(bufferVector.data(), bufferVector.size(), sizeof(Int64Pair), 8);
+        uint32_t nodeOffset = fb.createVector(nodes.data(), nodes.size(), sizeof(Int64Pair), 8);
+
+        fb.startTable();
+        fb.addField<int64_t>(0, length);
+        fb.addOffset(1, nodeOffset);
+        fb.addOffset(2, bufferOffset);
+        return fb.endTable();
+    }
+
+    /** write dictionary batch with values not written yet */
+    void writeDictionaryBatch(Dictionary & dictionary) {
+        std::vector<Int64Pair> nodes { Int64Pair { dictionary.count, 0 } };
+        std::vector<BodyBuffer> buffers;
+        buffers.push_back(BodyBuffer { nullptr, 0 }); // validity
+        if (dictionary.utf8)
+            buffers.push_back(BodyBuffer { dictionary.offsets.data(), dictionary.offsets.size() * sizeof(int32_t) });
+        buffers.push_back(BodyBuffer { dictionary.values.data(), dictionary.values.size() });
+
+        FlatBufferBuilder fb;
+        uint32_t recordBatch = createRecordBatch(fb, dictionary.count, nodes, buffers);
+        fb.startTable();
+        fb.addField<int64_t>(0, dictionary.id);
+        fb.addOffset(1, recordBatch);
+        fb.addField<uint8_t>(2, dictionary.written); // isDelta
+        uint32_t dictionaryBatch = fb.endTable();
+        dictionaryBlocks.push_back(writeMessage(fb, DictionaryBatchHeader, dictionaryBatch, buffers.data(), buffers.size()));
+
+        /* string offsets of the next delta start at zero again */
+        dictionary.values.clear();
+        dictionary.offsets.resize(1);
+        dictionary.count = 0;
+        dictionary.written = true;
+    }
+
+    /** write encapsulated message with body */
+    Block writeMessage(FlatBufferBuilder & fb, const MessageHeader headerType, const uint32_t header, const BodyBuffer * buffers, const std::size_t bufferCount) {
+        int64_t bodyLength = 0;
+        for (std::size_t i = 0; i < bufferCount; ++i)
+            bodyLength += buffers[i].size + padding8(buffers[i].size);
+
+        fb.startTable();
+        fb.addField<int64_t>(3, bodyLength);
+        fb.addOffset(2, header);
+        fb.addField<int16_t>(0, MetadataVersionV5);
+        fb.addField<uint8_t>(1, headerType);
+        fb.finish(fb.endTable());
+
+        /* continuation marker and metadata size, flatbuffer size is a multiple of 8 */
+        Block block;
+        block.offset = static_cast<int64_t>(file.tellp());
+        block.metaDataLength = static_cast<int32_t>(8 + fb.size());
+        block.reserved = 0;
+        block.bodyLength = bodyLength;
+        const int32_t prefix[2] = { -1, static_cast<int32_t>(fb.size()) };
+        file.write(reinterpret_cast<const char *>(prefix), sizeof(prefix));
+        file.write(reinterpret_cast<const char *>(fb.data().data()), fb.size());
+
+        /* body */
+        static const char zeros[8] = {};
+        for (std::size_t i = 0; i < bufferCount; ++i) {
+            file.write(static_cast<const char *>(buffers[i].data), static_cast<std::streamsize>(buffers[i].size));
+            file.write(zeros, static_cast<std::streamsize>(padding8(buffers[i].size)));
+        }
+        return block;
+    }
+};
+
+ArrowWriter::ArrowWriter(const std::string & prefix, const uint32_t batchSize) :
+    m_prefix(prefix),
+    m_batchSize(std::max<uint32_t>(batchSize, 1)),
+    m_tables() {
+}
+
+ArrowWriter::~ArrowWriter() {
+    close();
+}
+
+void ArrowWriter::addDbc(const Dbc & dbc) {
+    for (const Dbc::Message & message : dbc.messages()) {
+        m_signalDecoders.erase(message.id);
+        m_signalDecoders.insert(std::make_pair(message.id, SignalDecoder(message)));
+        m_signalNames[message.id] = std::vector<int32_t>(message.signals.size(), -1);
+    }
+}
+
+void ArrowWriter::write(const ObjectHeaderBase * ohb) {
+    if (ohb == nullptr)
+        return;
+
+    switch (ohb->objectType) {
+    case ObjectType::CAN_MESSAGE: {
+        auto * obj = static_cast<const CanMessage *>(ohb);
+        const uint8_t size = std::min<uint8_t>(obj->dlc, 8);
+        Table & t = table(Can);
+        t.columns[0].append<uint64_t>(obj->objectTimeStampNs());
+        t.appendDictionary(1, obj->channel);
+        t.columns[2].append<uint32_t>(obj->id);
+        t.columns[3].append<uint8_t>(obj->flags & 0x01);
+        t.columns[4].append<uint8_t>((obj->flags >> 7) & 0x01);
+        t.columns[5].append<uint8_t>(obj->dlc);
+        t.columns[6].appendBinary(obj->data.data(), size);
+        t.endRow(m_batchSize);
+        writeSignals(obj->objectTimeStampNs(), obj->channel, obj->id, obj->data.data(), size);
+    }
+    break;
+
+    case ObjectType::CAN_MESSAGE2: {
+        auto * obj = static_cast<const CanMessage2 *>(ohb);
+        const uint8_t size = static_cast<uint8_t>(std::min<std::size_t>(std::min<uint8_t>(obj->dlc, 8), obj->data.size()));
+        Table & t = table(Can);
+        t.columns[0].append<uint64_t>(obj->objectTimeStampNs());
+        t.appendDictionary(1, obj->channel);
+        t.columns[2].append<uint32_t>(obj->id);
+        t.columns[3].append<uint8_t>(obj->flags & 0x01);
+        t.columns[4].append<uint8_t>((obj->flags >> 7) & 0x01);
+        t.columns[5].append<uint8_t>(obj->dlc);
+        t.columns[6].appendBinary(obj->data.data(), size);
+        t.endRow(m_batchSize);
+        writeSignals(obj->objectTimeStampNs(), obj->channel, obj->id, obj->data.data(), size);
+    }
+    break;
+
+    case ObjectType::CAN_FD_MESSAGE: {
+        auto * obj = static_cast<const CanFdMessage *>(ohb);
+        const uint8_t size = std::min<uint8_t>(obj->validDataBytes, 64);
+        Table & t = table(CanFd);
+        t.columns[0].append<uint64_t>(obj->objectTimeStampNs());
+        t.appendDictionary(1, obj->channel);
+        t.columns[2].append<uint32_t>(obj->id);
+        t.columns[3].append<uint8_t>(obj->flags & CanFdMessage::Flags::TX);
+        t.columns[4].append<uint8_t>((obj->canFdFlags & CanFdMessage::CanFdFlags::EDL) ? 1 : 0);
+        t.columns[5].append<uint8_t>((obj->canFdFlags & CanFdMessage::CanFdFlags::BRS) ? 1 : 0);
+        t.columns[6].append<uint8_t>(obj->dlc);
+        t.columns[7].appendBinary(obj->data.data(), size);
+        t.endRow(m_batchSize);
+        writeSignals(obj->objectTimeStampNs(), obj->channel, obj->id, obj->data.data(), size);
+    }
+    break;
+
+    case ObjectType::CAN_FD_MESSAGE_64: {
+        auto * obj = static_cast<const CanFdMessage64 *>(ohb);
+        const uint8_t size = static_cast<uint8_t>(std::min<std::size_t>(obj->validDataBytes, obj->data.size()));
+        Table & t = table(CanFd);
+        t.columns[0].append<uint64_t>(obj->objectTimeStampNs());
+        t.appendDictionary(1, static_cast<uint16_t>(obj->channel));
+        t.columns[2].append<uint32_t>(obj->id);
+        t.columns[3].append<uint8_t>(obj->dir);
+        t.columns[4].append<uint8_t>((obj->flags & 0x1000) ? 1 : 0); // EDL
+        t.columns[5].append<uint8_t>((obj->flags & 0x2000) ? 1 : 0); // BRS
+        t.columns[6].append<uint8_t>(obj->dlc);
+        t.columns[7].appendBinary(obj->data.data(), size);
+        t.endRow(m_batchSize);
+        writeSignals(obj->objectTimeStampNs(), obj->channel, obj->id, obj->data.data(), size);
+    }
+    break;
+
+    case ObjectType::LIN_MESSAGE: {
+        auto * obj = static_cast<const LinMessage *>(ohb);
+        Table & t = table(Lin);
+        t.columns[0].append<uint64_t>(obj->objectTimeStampNs());
+        t.appendDictionary(1, obj->channel);
+        t.columns[2].append<uint8_t>(obj->id);
+        t.columns[3].append<uint8_t>(obj->dir);
+        t.columns[4].append<uint8_t>(obj->dlc);
+        t.columns[5].appendBinary(obj->data.data(), std::min<uint8_t>(obj->dlc, 8));
+        t.columns[6].append<uint16_t>(obj->crc);
+        t.endRow(m_batchSize);
+    }
+    break;
+
+    case ObjectType::LIN_MESSAGE2: {
+        auto * obj = static_cast<const LinMessage2 *>(ohb);
+        Table & t = table(Lin);
+        t.columns[0].append<uint64_t>(obj->objectTimeStampNs());
+        t.appendDictionary(1, obj->channel);
+        t.columns[2].append<uint8_t>(obj->id);
+        t.columns[3].append<uint8_t>(obj->dir);
+        t.columns[4].append<uint8_t>(obj->dlc);
+        t.columns[5].appendBinary(obj->data.data(), std::min<uint8_t>(obj->dlc, 8));
+        t.columns[6].append<uint16_t>(obj->crc);
+        t.endRow(m_batchSize);
+    }
+    break;
+
+    case ObjectType::FR_RCVMESSAGE: {
+        auto * obj = static_cast<const FlexRayVFrReceiveMsg *>(ohb);
+        Table & t = table(FlexRay);
+        t.columns[0].append<uint64_t>(obj->objectTimeStampNs());
+        t.appendDictionary(1, obj->channel);
+        t.columns[2].append<uint16_t>(obj->channelMask);
+        t.columns[3].append<uint16_t>(obj->frameId);
+        t.columns[4].append<uint8_t>(obj->cycle);
+        t.columns[5].append<uint8_t>(obj->dir);
+        t.columns[6].appendBinary(obj->dataBytes.data(), std::min<std::size_t>(obj->dataCount, obj->dataBytes.size()));
+        t.endRow(m_batchSize);
+    }
+    break;
+
+    case ObjectType::FR_RCVMESSAGE_EX: {
+        auto * obj = static_cast<const FlexRayVFrReceiveMsgEx *>(ohb);
+        Table & t = table(FlexRay);
+        t.columns[0].append<uint64_t>(obj->objectTimeStampNs());
+        t.appendDictionary(1, obj->channel);
+        t.columns[2].append<uint16_t>(obj->channelMask);
+        t.columns[3].append<uint16_t>(obj->frameId);
+        t.columns[4].append<uint8_t>(static_cast<uint8_t>(obj->cycle));
+        t.columns[5].append<uint8_t>(static_cast<uint8_t>(obj->dir));
+        t.columns[6].appendBinary(obj->dataBytes.data(), std::min<std::size_t>(obj->dataCount, obj->dataBytes.size()));
+        t.endRow(m_batchSize);
+    }
+    break;
+
+    case ObjectType::ETHERNET_FRAME: {
+        auto * obj = static_cast<const EthernetFrame *>(ohb);
+
+        /* reconstruct frame: destination, source, optional VLAN tag, type, payload */
+        m_frame.clear();
+        m_frame.insert(m_frame.end(), obj->destinationAddress.begin(), obj->destinationAddress.end());
+        m_frame.insert(m_frame.end(), obj->sourceAddress.begin(), obj->sourceAddress.end());
+        if (obj->tpid != 0) {
+            m_frame.push_back(static_cast<uint8_t>(obj->tpid >> 8));
+            m_frame.push_back(static_cast<uint8_t>(obj->tpid));
+            m_frame.push_back(static_cast<uint8_t>(obj->tci >> 8));
+            m_frame.push_back(static_cast<uint8_t>(obj->tci));
+        }
+        m_frame.push_back(static_cast<uint8_t>(obj->type >> 8));
+        m_frame.push_back(static_cast<uint8_t>(obj->type));
+        m_frame.insert(m_frame.end(), obj->payLoad.begin(), obj->payLoad.end());
+
+        Table & t = table(Ethernet);
+        t.columns[0].append<uint64_t>(obj->objectTimeStampNs());
+        t.appendDictionary(1, obj->channel);
+        t.columns[2].append<uint8_t>(static_cast<uint8_t>(obj->dir));
+        t.columns[3].appendBinary(m_frame.data(), m_frame.size());
+        t.endRow(m_batchSize);
+    }
+    break;
+
+    case ObjectType::ETHERNET_FRAME_EX: {
+        auto * obj = static_cast<const EthernetFrameEx *>(ohb);
+        Table & t = table(Ethernet);
+        t.columns[0].append<uint64_t>(obj->objectTimeStampNs());
+        t.appendDictionary(1, obj->channel);
+        t.columns[2].append<uint8_t>(static_cast<uint8_t>(obj->dir));
+        t.columns[3].appendBinary(obj->frameData.data(), obj->frameData.size());
+        t.endRow(m_batchSize);
+    }
+    break;
+
+    case ObjectType::SYS_VARIABLE: {
+        auto * obj = static_cast<const SystemVariable *>(ohb);
+
+        /* numeric value */
+        double value = std::numeric_limits<double>::quiet_NaN();
+        switch (obj->type) {
+        case SystemVariable::Type::Double:
+            if (obj->data.size() >= sizeof(double))
+                std::memcpy(&value, obj->data.data(), sizeof(double));
+            break;
+        case SystemVariable::Type::Long:
+            if (obj->data.size() >= sizeof(int32_t)) {
+                int32_t longValue;
+                std::memcpy(&longValue, obj->data.data(), sizeof(longValue));
+                value = longValue;
+            }
+            break;
+        case SystemVariable::Type::LongLong:
+            if (obj->data.size() >= sizeof(int64_t)) {
+                int64_t longLongValue;
+                std::memcpy(&longLongValue, obj->data.data(), sizeof(longLongValue));
+                value = static_cast<double>(longLongValue);
+            }
+            break;
+        default:
+            break;
+        }
+
+        Table & t = table(SysVar);
+        t.columns[0].append<uint64_t>(obj->objectTimeStampNs());
+        t.appendDictionary(1, obj->name);
+        t.columns[2].append<uint32_t>(obj->type);
+        t.columns[3].append<double>(value);
+        t.columns[4].appendBinary(obj->data.data(), obj->data.size());
+        t.endRow(m_batchSize);
+    }
+    break;
+
+    default:
+        break;
+    }
+}
+
+void ArrowWriter::close() {
+    for (std::unique_ptr<Table> & t : m_tables) {
+        if (t) {
+            t->close();
+            t.reset();
+        }
+    }
+
+    /* dictionaries start from scratch in new files */
+    for (auto & signalNames : m_signalNames)
+        std::fill(signalNames.second.begin(), signalNames.second.end(), -1);
+}
+
+ArrowWriter::Table & ArrowWriter::table(const TableType tableType) {
+    std::unique_ptr<Table> & t = m_tables[tableType];
+    if (t)
+        return *t;
+
+    t.reset(new Table);
+    const char * suffix = "";
+    switch (tableType) {
+    case Can:
+        suffix = "_can.arrow";
+        t->addColumn("timestamp", Column::Kind::Timestamp);
+        t->addDictionaryColumn("channel", false);
+        t->addColumn("id", Column::Kind::UInt32);
+        t->addColumn("dir", Column::Kind::UInt8);
+        t->addColumn("rtr", Column::Kind::UInt8);
+        t->addColumn("dlc", Column::Kind::UInt8);
+        t->addColumn("data", Column::Kind::Binary);
+        break;
+    case CanFd:
+        suffix = "_canfd.arrow";
+        t->addColumn("timestamp", Column::Kind::Timestamp);
+        t->addDictionaryColumn("channel", false);
+        t->addColumn("id", Column::Kind::UInt32);
+        t->addColumn("dir", Column::Kind::UInt8);
+        t->addColumn("edl", Column::Kind::UInt8);
+        t->addColumn("brs", Column::Kind::UInt8);
+        t->addColumn("dlc", Column::Kind::UInt8);
+        t->addColumn("data", Column::Kind::Binary);
+        break;
+    case Lin:
+        suffix = "_lin.arrow";
+        t->addColumn("timestamp", Column::Kind::Timestamp);
+        t->addDictionaryColumn("channel", false);
+        t->addColumn("id", Column::Kind::UInt8);
+        t->addColumn("dir", Column::Kind::UInt8);
+        t->addColumn("dlc", Column::Kind::UInt8);
+        t->addColumn("data", Column::Kind::Binary);
+        t->addColumn("checksum", Column::Kind::UInt16);
+        break;
+    case FlexRay:
+        suffix = "_flexray.arrow";
+        t->addColumn("timestamp", Column::Kind::Timestamp);
+        t->addDictionaryColumn("channel", false);
+        t->addColumn("channel_mask", Column::Kind::UInt16);
+        t->addColumn("frame_id", Column::Kind::UInt16);
+        t->addColumn("cycle", Column::Kind::UInt8);
+        t->addColumn("dir", Column::Kind::UInt8);
+        t->addColumn("data", Column::Kind::Binary);
+        break;
+    case Ethernet:
+        suffix = "_ethernet.arrow";
+        t->addColumn("timestamp", Column::Kind::Timestamp);
+        t->addDictionaryColumn("channel", false);
+        t->addColumn("dir", Column::Kind::UInt8);
+        t->addColumn("frame", Column::Kind::Binary);
+        break;
+    case SysVar:
+        suffix = "_sysvar.arrow";
+        t->addColumn("timestamp", Column::Kind::Timestamp);
+        t->addDictionaryColumn("name", true);
+        t->addColumn("type", Column::Kind::UInt32);
+        t->addColumn("value", Column::Kind::Double);
+        t->addColumn("data", Column::Kind::Binary);
+        break;
+    case Signals:
+    default:
+        suffix = "_signals.arrow";
+        t->addColumn("timestamp", Column::Kind::Timestamp);
+        t->addDictionaryColumn("channel", false);
+        t->addColumn("id", Column::Kind::UInt32);
+        t->addDictionaryColumn("name", true);
+        t->addColumn("value", Column::Kind::Double);
+        break;
+    }
+    t->open(m_prefix + suffix);
+    return *t;
+}
+
+void ArrowWriter::writeSignals(const uint64_t timeStamp, const uint16_t channel, const uint32_t id, const uint8_t * data, const uint8_t size) {
+    auto it = m_signalDecoders.find(id);
+    if (it == m_signalDecoders.end())
+        return;
+    const SignalDecoder & signalDecoder = it->second;
+    std::vector<int32_t> & names = m_signalNames[id];
+
+    m_signalValues.resize(signalDecoder.signalCount());
+    signalDecoder.decode(data, size, m_signalValues.data());
+
+    Table & t = table(Signals);
+    Dictionary & nameDictionary = t.dictionaries[t.columns[3].dictionary];
+    for (std::size_t signal = 0; signal < m_signalValues.size(); ++signal) {
+        if (std::isnan(m_signalValues[signal]))
+            continue;
+        if (names[signal] < 0)
+            names[signal] = nameDictionary.index(signalDecoder.signalName(signal));
+        t.columns[0].append<uint64_t>(timeStamp);
+        t.appendDictionary(1, channel);
+        t.columns[2].append<uint32_t>(id);
+        t.columns[3].append<int32_t>(names[signal]);
+        t.columns[4].append<double>(m_signalValues[signal]);
+        t.endRow(m_batchSize);
+    }
+}
+
+}
+}
@@ -0,0 +1,140 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <array>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Vector/BLF/Dbc.h>
+#include <Vector/BLF/ObjectHeaderBase.h>
+#include <Vector/BLF/SignalDecoder.h>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * Apache Arrow IPC file writer
+ *
+ * Writes bus objects into Arrow IPC files (format version V5), one file per
+ * object type:
+ *
+ * - prefix_can.arrow: CanMessage, CanMessage2
+ * - prefix_canfd.arrow: CanFdMessage, CanFdMessage64
+ * - prefix_lin.arrow: LinMessage, LinMessage2
+ * - prefix_flexray.arrow: FlexRayVFrReceiveMsg, FlexRayVFrReceiveMsgEx
+ * - prefix_ethernet.arrow: EthernetFrame, EthernetFrameEx
+ * - prefix_sysvar.arrow: SystemVariable
+ * - prefix_signals.arrow: signals decoded with a DBC
+ *
+ * Files are created with the first object of their type. Columns are
+ * appended directly from the objects and written as a record batch every
+ * batchSize rows, so memory usage only depends on the batch size and the
+ * number of distinct channels and names. Channel and name columns are
+ * dictionary encoded; new dictionary entries are written as delta
+ * dictionary batches in front of the record batch that uses them.
+ */
+class VECTOR_BLF_EXPORT ArrowWriter final {
+  public:
+    /**
+     * constructor
+     *
+     * @param[in] prefix file name prefix
+     * @param[in] batchSize number of rows per record batch
+     */
+    explicit ArrowWriter(const std::string & prefix, const uint32_t batchSize = 65536);
+    virtual ~ArrowWriter();
+    ArrowWriter(const ArrowWriter &) = delete;
+    ArrowWriter & operator=(const ArrowWriter &) = delete;
+
+    /**
+     * Add DBC for signal decoding.
+     *
+     * Signals of CAN and CAN FD messages with IDs in the DBC are written
+     * to the signals file, in addition to the frames.
+     *
+     * @param[in] dbc DBC
+     */
+    virtual void addDbc(const Dbc & dbc);
+
+    /**
+     * Write an object.
+     *
+     * Objects of other types are ignored.
+     *
+     * @param[in] ohb object
+     */
+    virtual void write(const ObjectHeaderBase * ohb);
+
+    /**
+     * Write remaining rows and footers and close all files.
+     */
+    virtual void close();
+
+  private:
+    /** table with columns and file */
+    struct Table;
+
+    /** table types */
+    enum TableType : uint8_t {
+        Can,
+        CanFd,
+        Lin,
+        FlexRay,
+        Ethernet,
+        SysVar,
+        Signals,
+        TableTypeCount
+    };
+
+    /** file name prefix */
+    std::string m_prefix;
+
+    /** rows per record batch */
+    uint32_t m_batchSize;
+
+    /** tables */
+    std::array<std::unique_ptr<Table>, TableTypeCount> m_tables;
+
+    /** signal decoders by CAN ID */
+    std::map<uint32_t, SignalDecoder> m_signalDecoders {};
+
+    /** dictionary indices of signal names by CAN ID (-1 if not yet in dictionary) */
+    std::map<uint32_t, std::vector<int32_t>> m_signalNames {};
+
+    /** decoded signal values */
+    std::vector<double> m_signalValues {};
+
+    /** frame buffer for reconstructed ethernet frames */
+    std::vector<uint8_t> m_frame {};
+
+    /**
+     * Get table, create it if it doesn't exist.
+     *
+     * @param[in] tableType table type
+     * @return table
+     */
+    Table & table(const TableType tableType);
+
+    /**
+     * Decode signals of a CAN frame.
+     *
+     * @param[in] timeStamp timestamp in ns
+     * @param[in] channel application channel
+     * @param[in] id CAN ID
+     * @param[in] data data bytes
+     * @param[in] size number of data bytes
+     */
+    void writeSignals(const uint64_t timeStamp, const uint16_t channel, const uint32_t id, const uint8_t * data, const uint8_t size);
+};
+
+}
+}
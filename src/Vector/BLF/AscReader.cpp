@@ -0,0 +1,689 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/AscReader.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <locale>
+#include <memory>
+#include <sstream>
+
+#include <Vector/BLF/CanErrorFrame.h>
+#include <Vector/BLF/CanFdMessage64.h>
+#include <Vector/BLF/CanMessage2.h>
+#include <Vector/BLF/EnvironmentVariable.h>
+#include <Vector/BLF/Exceptions.h>
+#include <Vector/BLF/Helpers.h>
+#include <Vector/BLF/LinMessage.h>
+#include <Vector/BLF/SystemVariable.h>
+
+namespace Vector {
+namespace BLF {
+
+namespace {
+
+/** CAN message flags */
+const uint8_t CanFlagTx = 0x01;
+const uint8_t CanFlagRtr = 0x80;
+
+/** CAN FD message flags */
+const uint32_t CanFdFlagEdl = 0x1000;
+const uint32_t CanFdFlagBrs = 0x2000;
+const uint32_t CanFdFlagEsi = 0x4000;
+
+/** extended identifier flag */
+const uint32_t ExtendedId = 0x80000000;
+
+/** token in read buffer */
+struct Token {
+    /** begin */
+    const char * data {};
+
+    /** size */
+    std::size_t size {};
+
+    /** compare with literal */
+    bool operator==(const char * literal) const {
+        return (std::strlen(literal) == size) && (std::memcmp(data, literal, size) == 0);
+    }
+};
+
+/** parse unsigned number of the whole token */
+bool parseUnsigned(const Token & token, const bool hex, uint64_t & value) {
+    if (token.size == 0)
+        return false;
+    value = 0;
+    for (std::size_t i = 0; i < token.size; ++i) {
+        const int digit = detail::hexDigit(token.data[i]);
+        if ((digit < 0) || (!hex && (digit > 9)))
+            return false;
+        value = value * (hex ? 16 : 10) + static_cast<uint64_t>(digit);
+    }
+    return true;
+}
+
+/** parse signed decimal number of the whole token */
+bool parseSigned(Token token, int64_t & value) {
+    const bool negative = (token.size > 0) && (token.data[0] == '-');
+    if (negative) {
+        token.data++;
+        token.size--;
+    }
+    uint64_t magnitude;
+    if (!parseUnsigned(token, false, magnitude))
+        return false;
+    value = negative ? -static_cast<int64_t>(magnitude) : static_cast<int64_t>(magnitude);
+    return true;
+}
+
+/** parse floating point number of the whole token */
+bool parseDouble(const Token & token, double & value) {
+    if (token.size == 0)
+        return false;
+
+    /* streams don't parse infinity and NaN */
+    if ((token == "inf") || (token == "-inf")) {
+        value = (token.data[0] == '-') ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+        return true;
+    }
+    if ((token == "nan") || (token == "-nan")) {
+        value = std::numeric_limits<double>::quiet_NaN();
+        return true;
+    }
+
+    /* independent of the global locale, which might use ',' as decimal point */
+    std::istringstream stream(std::string(token.data, token.size));
+    stream.imbue(std::locale::classic());
+    stream >> value;
+    return !stream.fail() && stream.eof();
+}
+
+/** parse identifier with optional 'x' suffix for extended identifiers */
+bool parseId(Token token, const bool hex, uint32_t & id) {
+    bool extended = false;
+    if ((token.size > 1) && ((token.data[token.size - 1] == 'x') || (token.data[token.size - 1] == 'X'))) {
+        extended = true;
+        token.size--;
+    }
+    uint64_t value;
+    if (!parseUnsigned(token, hex, value) || (value > 0x1FFFFFFF))
+        return false;
+    id = static_cast<uint32_t>(value) | (extended ? ExtendedId : 0);
+    return true;
+}
+
+/** parse timestamp "<s>.<fraction>" into ns */
+bool parseTime(const Token & token, uint64_t & ns) {
+    uint64_t seconds = 0;
+    std::size_t i = 0;
+    for (; (i < token.size) && (token.data[i] >= '0') && (token.data[i] <= '9'); ++i)
+        seconds = seconds * 10 + static_cast<uint64_t>(token.data[i] - '0');
+    if ((i == 0) || (i >= token.size) || (token.data[i] != '.'))
+        return false;
+    uint64_t fraction = 0;
+    uint64_t scale = 1000000000;
+    for (++i; i < token.size; ++i) {
+        if ((token.data[i] < '0') || (token.data[i] > '9'))
+            return false;
+        if (scale > 1) {
+            scale /= 10;
+            fraction += scale * static_cast<uint64_t>(token.data[i] - '0');
+        }
+    }
+    ns = seconds * 1000000000 + fraction;
+    return true;
+}
+
+/** parse direction */
+bool parseDir(const Token & token, uint8_t & dir) {
+    if (token == "Rx")
+        dir = 0;
+    else if (token == "Tx")
+        dir = 1;
+    else if (token == "TxRq")
+        dir = 2;
+    else
+        return false;
+    return true;
+}
+
+/** scanner on one line */
+class Scanner {
+  public:
+    Scanner(const char * begin, const char * end) :
+        m_pos(begin),
+        m_end(end) {
+    }
+
+    /** next token, separated by spaces, tabs or commas */
+    Token token() {
+        skipSeparators();
+        Token token;
+        token.data = m_pos;
+        while ((m_pos < m_end) && !isSeparator(*m_pos))
+            ++m_pos;
+        token.size = static_cast<std::size_t>(m_pos - token.data);
+        return token;
+    }
+
+    /** next token without consuming it */
+    Token peek() {
+        const char * pos = m_pos;
+        Token result = token();
+        m_pos = pos;
+        return result;
+    }
+
+    /** consume next token if it equals literal */
+    bool expect(const char * literal) {
+        const char * pos = m_pos;
+        if (token() == literal)
+            return true;
+        m_pos = pos;
+        return false;
+    }
+
+    /** check if only separators are left */
+    bool atEnd() {
+        skipSeparators();
+        return m_pos >= m_end;
+    }
+
+    /** rest of line without leading and trailing spaces */
+    Token rest() {
+        while ((m_pos < m_end) && ((*m_pos == ' ') || (*m_pos == '\t')))
+            ++m_pos;
+        const char * end = m_end;
+        while ((end > m_pos) && ((end[-1] == ' ') || (end[-1] == '\t')))
+            --end;
+        Token token;
+        token.data = m_pos;
+        token.size = static_cast<std::size_t>(end - m_pos);
+        m_pos = m_end;
+        return token;
+    }
+
+  private:
+    /** current position */
+    const char * m_pos;
+
+    /** end of line */
+    const char * m_end;
+
+    /** check for token separator */
+    static bool isSeparator(const char c) {
+        return (c == ' ') || (c == '\t') || (c == ',');
+    }
+
+    /** skip token separators */
+    void skipSeparators() {
+        while ((m_pos < m_end) && isSeparator(*m_pos))
+            ++m_pos;
+    }
+};
+
+/** parse data bytes */
+bool parseBytes(Scanner & scanner, const bool hex, const std::size_t count, uint8_t * data) {
+    for (std::size_t i = 0; i < count; ++i) {
+        uint64_t value;
+        if (!parseUnsigned(scanner.token(), hex, value) || (value > 0xFF))
+            return false;
+        data[i] = static_cast<uint8_t>(value);
+    }
+    return true;
+}
+
+/** append value to data bytes */
+template<typename T>
+void appendValue(std::vector<uint8_t> & data, const T value) {
+    const uint8_t * bytes = reinterpret_cast<const uint8_t *>(&value);
+    data.insert(data.end(), bytes, bytes + sizeof(value));
+}
+
+/** parse "<channel> <id> <dir> d <dlc> <data> [Length = <ns>] [BitCount = <n>]" */
+ObjectHeaderBase * parseCan(Scanner & scanner, const bool hex, const uint16_t channel, const Token & idToken) {
+    std::unique_ptr<CanMessage2> obj(new CanMessage2);
+    uint8_t dir;
+    if (!parseId(idToken, hex, obj->id) || !parseDir(scanner.token(), dir))
+        return nullptr;
+    obj->channel = channel;
+    obj->flags = (dir != 0) ? CanFlagTx : 0;
+
+    const Token kind = scanner.token();
+    uint64_t dlc = 0;
+    if (kind == "r") {
+        obj->flags |= CanFlagRtr;
+        if (parseUnsigned(scanner.peek(), hex, dlc))
+            scanner.token();
+        obj->dlc = static_cast<uint8_t>(dlc);
+    } else if (kind == "d") {
+        if (!parseUnsigned(scanner.token(), hex, dlc) || (dlc > 15))
+            return nullptr;
+        obj->dlc = static_cast<uint8_t>(dlc);
+        obj->data.resize(std::min<uint64_t>(dlc, 8));
+        if (!parseBytes(scanner, hex, obj->data.size(), obj->data.data()))
+            return nullptr;
+    } else
+        return nullptr;
+
+    while (!scanner.atEnd()) {
+        const Token key = scanner.token();
+        uint64_t value;
+        if ((key == "Length") && scanner.expect("=") && parseUnsigned(scanner.token(), false, value))
+            obj->frameLength = static_cast<uint32_t>(value);
+        else if ((key == "BitCount") && scanner.expect("=") && parseUnsigned(scanner.token(), false, value))
+            obj->bitCount = static_cast<uint8_t>(value);
+    }
+    return obj.release();
+}
+
+/**
+ * parse "CANFD <channel> <dir> <id> [<name>] <brs> <esi> <dlc> <length> <data>
+ * [<duration> <bitCount> <flags> <crc> <btrArb> <btrData> ...]"
+ */
+ObjectHeaderBase * parseCanFd(Scanner & scanner, const bool hex) {
+    std::unique_ptr<CanFdMessage64> obj(new CanFdMessage64);
+    uint64_t channel;
+    if (!parseUnsigned(scanner.token(), false, channel) || !parseDir(scanner.token(), obj->dir) || !parseId(scanner.token(), hex, obj->id))
+        return nullptr;
+    obj->channel = static_cast<uint8_t>(channel);
+
+    /* symbolic name is optional */
+    Token brs = scanner.token();
+    if (!(brs == "0") && !(brs == "1"))
+        brs = scanner.token();
+    const Token esi = scanner.token();
+    uint64_t dlc;
+    uint64_t dataLength;
+    if (!parseUnsigned(scanner.token(), true, dlc) || (dlc > 15) ||
+            !parseUnsigned(scanner.token(), false, dataLength) || (dataLength > 64))
+        return nullptr;
+    obj->dlc = static_cast<uint8_t>(dlc);
+    obj->validDataBytes = static_cast<uint8_t>(dataLength);
+    obj->data.resize(dataLength);
+    if (!parseBytes(scanner, hex, obj->data.size(), obj->data.data()))
+        return nullptr;
+
+    uint64_t value;
+    obj->flags = CanFdFlagEdl;
+    if (parseUnsigned(scanner.token(), false, value))
+        obj->frameLength = static_cast<uint32_t>(value);
+    if (parseUnsigned(scanner.token(), false, value))
+        obj->bitCount = static_cast<uint16_t>(value);
+    if (parseUnsigned(scanner.token(), true, value))
+        obj->flags = static_cast<uint32_t>(value);
+    if (parseUnsigned(scanner.token(), true, value))
+        obj->crc = static_cast<uint32_t>(value);
+    if (parseUnsigned(scanner.token(), true, value))
+        obj->btrCfgArb = static_cast<uint32_t>(value);
+    if (parseUnsigned(scanner.token(), true, value))
+        obj->btrCfgData = static_cast<uint32_t>(value);
+    if (brs == "1")
+        obj->flags |= CanFdFlagBrs;
+    if (esi == "1")
+        obj->flags |= CanFdFlagEsi;
+    return obj.release();
+}
+
+/** parse "Li<channel> <id> <dir> <dlc> <data> [checksum = <crc>] [header time = <n>, full time = <n>]" */
+ObjectHeaderBase * parseLin(Scanner & scanner, const bool hex, const Token & channelToken) {
+    std::unique_ptr<LinMessage> obj(new LinMessage);
+    Token channel = channelToken;
+    channel.data += 2;
+    channel.size -= 2;
+    uint64_t value;
+    if (!parseUnsigned(channel, false, value))
+        return nullptr;
+    obj->channel = static_cast<uint16_t>(value);
+    if (!parseUnsigned(scanner.token(), hex, value) || (value > 0x3F))
+        return nullptr;
+    obj->id = static_cast<uint8_t>(value);
+    if (!parseDir(scanner.token(), obj->dir))
+        return nullptr;
+    if (!parseUnsigned(scanner.token(), false, value) || (value > 8))
+        return nullptr;
+    obj->dlc = static_cast<uint8_t>(value);
+    if (!parseBytes(scanner, hex, obj->dlc, obj->data.data()))
+        return nullptr;
+
+    while (!scanner.atEnd()) {
+        const Token key = scanner.token();
+        if ((key == "checksum") && scanner.expect("=") && parseUnsigned(scanner.token(), true, value))
+            obj->crc = static_cast<uint16_t>(value);
+        else if ((key == "header") && scanner.expect("time") && scanner.expect("=") && parseUnsigned(scanner.token(), false, value))
+            obj->headerTime = static_cast<uint8_t>(value);
+        else if ((key == "full") && scanner.expect("time") && scanner.expect("=") && parseUnsigned(scanner.token(), false, value))
+            obj->fullTime = static_cast<uint8_t>(value);
+    }
+    return obj.release();
+}
+
+/** parse "SV: <type> <representation> ... <name> = <value>" */
+ObjectHeaderBase * parseSystemVariable(Scanner & scanner) {
+    std::unique_ptr<SystemVariable> obj(new SystemVariable);
+    uint64_t value;
+    if (!parseUnsigned(scanner.token(), false, value))
+        return nullptr;
+    obj->type = static_cast<uint32_t>(value);
+    if (!parseUnsigned(scanner.token(), false, value))
+        return nullptr;
+    obj->representation = static_cast<uint32_t>(value);
+
+    /* further numeric fields, then the name */
+    Token name = scanner.token();
+    while (parseUnsigned(name, false, value))
+        name = scanner.token();
+    if ((name.size >= 2) && (name.data[0] == ':') && (name.data[1] == ':')) {
+        name.data += 2;
+        name.size -= 2;
+    }
+    if ((name.size == 0) || !scanner.expect("="))
+        return nullptr;
+    obj->name.assign(name.data, name.size);
+
+    double doubleValue;
+    int64_t longValue;
+    switch (obj->type) {
+    case SystemVariable::Type::Double:
+        if (!parseDouble(scanner.token(), doubleValue))
+            return nullptr;
+        appendValue(obj->data, doubleValue);
+        break;
+    case SystemVariable::Type::Long:
+        if (!parseSigned(scanner.token(), longValue))
+            return nullptr;
+        appendValue(obj->data, static_cast<int32_t>(longValue));
+        break;
+    case SystemVariable::Type::LongLong:
+        if (!parseSigned(scanner.token(), longValue))
+            return nullptr;
+        appendValue(obj->data, longValue);
+        break;
+    case SystemVariable::Type::String: {
+        const Token text = scanner.rest();
+        obj->data.assign(text.data, text.data + text.size);
+    }
+    break;
+    case SystemVariable::Type::DoubleArray:
+        while (!scanner.atEnd()) {
+            if (!parseDouble(scanner.token(), doubleValue))
+                return nullptr;
+            appendValue(obj->data, doubleValue);
+        }
+        break;
+    case SystemVariable::Type::LongArray:
+        while (!scanner.atEnd()) {
+            if (!parseSigned(scanner.token(), longValue))
+                return nullptr;
+            appendValue(obj->data, static_cast<int32_t>(longValue));
+        }
+        break;
+    case SystemVariable::Type::ByteArray:
+        while (!scanner.atEnd()) {
+            if (!parseUnsigned(scanner.token(), true, value) || (value > 0xFF))
+                return nullptr;
+            obj->data.push_back(static_cast<uint8_t>(value));
+        }
+        break;
+    default:
+        return nullptr;
+    }
+    return obj.release();
+}
+
+/**
+ * parse "<name> := <value>"
+ *
+ * The type is derived from the value: integer, floating point, hex bytes
+ * (at least two) or otherwise string.
+ */
+ObjectHeaderBase * parseEnvironmentVariable(Scanner & scanner, const Token & name) {
+    if (!scanner.expect(":="))
+        return nullptr;
+    std::unique_ptr<EnvironmentVariable> obj(new EnvironmentVariable);
+    obj->name.assign(name.data, name.size);
+    const Token text = scanner.rest();
+
+    Scanner valueScanner(text.data, text.data + text.size);
+    const Token first = valueScanner.token();
+    int64_t longValue;
+    double doubleValue;
+    if (valueScanner.atEnd() && parseSigned(first, longValue)) {
+        obj->objectType = ObjectType::ENV_INTEGER;
+        appendValue(obj->data, static_cast<int32_t>(longValue));
+        return obj.release();
+    }
+    if (valueScanner.atEnd() && parseDouble(first, doubleValue)) {
+        obj->objectType = ObjectType::ENV_DOUBLE;
+        appendValue(obj->data, doubleValue);
+        return obj.release();
+    }
+
+    /* hex bytes */
+    Scanner dataScanner(text.data, text.data + text.size);
+    uint64_t value;
+    while (!dataScanner.atEnd()) {
+        const Token byte = dataScanner.token();
+        if ((byte.size != 2) || !parseUnsigned(byte, true, value))
+            break;
+        obj->data.push_back(static_cast<uint8_t>(value));
+    }
+    if (dataScanner.atEnd() && (obj->data.size() >= 2)) {
+        obj->objectType = ObjectType::ENV_DATA;
+        return obj.release();
+    }
+
+    obj->objectType = ObjectType::ENV_STRING;
+    obj->data.assign(text.data, text.data + text.size);
+    return obj.release();
+}
+
+/** index of token in list, or -1 */
+int indexOf(const Token & token, const char * const * list, const int size) {
+    for (int i = 0; i < size; ++i)
+        if (token == list[i])
+            return i;
+    return -1;
+}
+
+/** parse "<weekday> <month> <day> <hh:mm:ss.mmm> [am|pm] <year>" */
+void parseDate(Scanner & scanner, SYSTEMTIME & systemTime) {
+    static const char * const weekdays[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+    static const char * const months[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+    SYSTEMTIME result {};
+
+    const int weekday = indexOf(scanner.token(), weekdays, 7);
+    const int month = indexOf(scanner.token(), months, 12);
+    uint64_t day;
+    if ((month < 0) || !parseUnsigned(scanner.token(), false, day))
+        return;
+
+    /* time of day */
+    const Token time = scanner.token();
+    uint64_t fields[4] = {};
+    std::size_t field = 0;
+    for (std::size_t i = 0; (i < time.size) && (field < 4); ++i) {
+        const char c = time.data[i];
+        if ((c >= '0') && (c <= '9'))
+            fields[field] = fields[field] * 10 + static_cast<uint64_t>(c - '0');
+        else
+            field++;
+    }
+
+    Token token = scanner.token();
+    if (token == "am") {
+        if (fields[0] == 12)
+            fields[0] = 0;
+        token = scanner.token();
+    } else if (token == "pm") {
+        if (fields[0] < 12)
+            fields[0] += 12;
+        token = scanner.token();
+    }
+    uint64_t year;
+    if (!parseUnsigned(token, false, year))
+        return;
+
+    result.year = static_cast<uint16_t>(year);
+    result.month = static_cast<uint16_t>(month + 1);
+    result.dayOfWeek = static_cast<uint16_t>(std::max(weekday, 0));
+    result.day = static_cast<uint16_t>(day);
+    result.hour = static_cast<uint16_t>(fields[0]);
+    result.minute = static_cast<uint16_t>(fields[1]);
+    result.second = static_cast<uint16_t>(fields[2]);
+    result.milliseconds = static_cast<uint16_t>(fields[3]);
+    systemTime = result;
+}
+
+}
+
+AscReader::AscReader(const std::string & filename, const std::size_t bufferSize) :
+    m_file(filename, std::ios_base::in | std::ios_base::binary),
+    m_buffer(std::max<std::size_t>(bufferSize, 256)) {
+    if (!m_file.is_open())
+        throw Exception("AscReader::AscReader(): Unable to open file.");
+
+    /* header up to the first event line */
+    while (nextLine()) {
+        if (!parseHeader()) {
+            m_pending = true;
+            break;
+        }
+    }
+}
+
+SYSTEMTIME AscReader::startTime() const {
+    return m_startTime;
+}
+
+ObjectHeaderBase * AscReader::read() {
+    while (nextLine()) {
+        if (parseHeader())
+            continue;
+        ObjectHeaderBase * ohb = parseEvent();
+        if (ohb != nullptr)
+            return ohb;
+        m_skippedLineCount++;
+    }
+    return nullptr;
+}
+
+uint64_t AscReader::copyTo(File & file, const uint64_t count) {
+    if (file.fileStatistics.measurementStartTime.year == 0)
+        file.fileStatistics.measurementStartTime = m_startTime;
+    uint64_t written = 0;
+    while ((count == 0) || (written < count)) {
+        ObjectHeaderBase * ohb = read();
+        if (ohb == nullptr)
+            break;
+        file.write(ohb);
+        written++;
+    }
+    return written;
+}
+
+uint64_t AscReader::skippedLineCount() const {
+    return m_skippedLineCount;
+}
+
+bool AscReader::nextLine() {
+    if (m_pending) {
+        m_pending = false;
+        return true;
+    }
+
+    for (;;) {
+        const char * begin = m_buffer.data() + m_begin;
+        const char * end = m_buffer.data() + m_end;
+        const char * newline = static_cast<const char *>(std::memchr(begin, '\n', static_cast<std::size_t>(end - begin)));
+        if ((newline != nullptr) || (m_eof && (begin < end))) {
+            m_line = begin;
+            m_lineEnd = (newline != nullptr) ? newline : end;
+            m_begin = static_cast<std::size_t>(m_lineEnd - m_buffer.data()) + ((newline != nullptr) ? 1 : 0);
+            if ((m_lineEnd > m_line) && (m_lineEnd[-1] == '\r'))
+                m_lineEnd--;
+            return true;
+        }
+        if (m_eof)
+            return false;
+
+        /* move incomplete line to front, grow buffer if the line doesn't fit */
+        std::memmove(m_buffer.data(), begin, static_cast<std::size_t>(end - begin));
+        m_end -= m_begin;
+        m_begin = 0;
+        if (m_end == m_buffer.size())
+            m_buffer.resize(m_buffer.size() * 2);
+        m_file.read(m_buffer.data() + m_end, static_cast<std::streamsize>(m_buffer.size() - m_end));
+        m_end += static_cast<std::size_t>(m_file.gcount());
+        if (!m_file)
+            m_eof = true;
+    }
+}
+
+bool AscReader::parseHeader() {
+    Scanner scanner(m_line, m_lineEnd);
+    const Token keyword = scanner.token();
+    if (keyword.size == 0)
+        return true;
+    if (keyword == "date") {
+        parseDate(scanner, m_startTime);
+        return true;
+    }
+    if (keyword == "base") {
+        /* "base <hex|dec> timestamps <absolute|relative>" */
+        m_hex = !scanner.expect("dec");
+        if (m_hex)
+            scanner.expect("hex");
+        if (scanner.expect("timestamps"))
+            m_relative = scanner.expect("relative");
+        return true;
+    }
+    if ((keyword == "internal") || (keyword == "no") || (keyword == "Begin") || (keyword == "End"))
+        return true;
+    if ((keyword.size >= 2) && (keyword.data[0] == '/') && (keyword.data[1] == '/'))
+        return true;
+    return false;
+}
+
+ObjectHeaderBase * AscReader::parseEvent() {
+    Scanner scanner(m_line, m_lineEnd);
+    uint64_t timeStamp;
+    if (!parseTime(scanner.token(), timeStamp))
+        return nullptr;
+    if (m_relative)
+        timeStamp += m_lastTimeStamp;
+    m_lastTimeStamp = timeStamp;
+
+    ObjectHeaderBase * ohb = nullptr;
+    const Token type = scanner.token();
+    uint64_t channel;
+    if (type == "CANFD")
+        ohb = parseCanFd(scanner, m_hex);
+    else if (type == "SV:")
+        ohb = parseSystemVariable(scanner);
+    else if ((type.size > 2) && (type.data[0] == 'L') && (type.data[1] == 'i') && (type.data[2] >= '0') && (type.data[2] <= '9'))
+        ohb = parseLin(scanner, m_hex, type);
+    else if (parseUnsigned(type, false, channel)) {
+        const Token id = scanner.token();
+        if (id == "ErrorFrame") {
+            auto * obj = new CanErrorFrame;
+            obj->channel = static_cast<uint16_t>(channel);
+            ohb = obj;
+        } else
+            ohb = parseCan(scanner, m_hex, static_cast<uint16_t>(channel), id);
+    } else if (type.size > 0)
+        ohb = parseEnvironmentVariable(scanner, type);
+
+    if (ohb == nullptr)
+        return nullptr;
+    auto * oh = static_cast<ObjectHeader *>(ohb);
+    oh->objectFlags = ObjectHeader::ObjectFlags::TimeOneNans;
+    oh->objectTimeStamp = timeStamp;
+    return ohb;
+}
+
+}
+}
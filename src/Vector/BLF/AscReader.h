@@ -0,0 +1,151 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <Vector/BLF/File.h>
+#include <Vector/BLF/FileStatistics.h>
+#include <Vector/BLF/ObjectHeaderBase.h>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * ASC reader
+ *
+ * Reads Vector ASCII log files and converts the event lines into objects:
+ *   - CAN frames and remote frames into CanMessage2
+ *   - CAN FD frames into CanFdMessage64
+ *   - CAN error frames into CanErrorFrame
+ *   - LIN frames into LinMessage
+ *   - system variables into SystemVariable
+ *   - environment variables into EnvironmentVariable
+ *
+ * Timestamps are converted into ns (ObjectHeader::TimeOneNans). The header
+ * lines (date, base, timestamps absolute/relative) are evaluated, other
+ * lines are skipped.
+ *
+ * Lines are scanned in place in a large read buffer and numbers are parsed
+ * directly from it, so there is no allocation per line besides the objects.
+ */
+class VECTOR_BLF_EXPORT AscReader final {
+  public:
+    /**
+     * constructor
+     *
+     * Reads the header lines.
+     *
+     * @param[in] filename file name
+     * @param[in] bufferSize size of read buffer
+     */
+    explicit AscReader(const std::string & filename, const std::size_t bufferSize = 4 * 1024 * 1024);
+    virtual ~AscReader() = default;
+    AscReader(const AscReader &) = delete;
+    AscReader & operator=(const AscReader &) = delete;
+
+    /**
+     * Get start time from date line.
+     *
+     * @return start time, or all zero if not known
+     */
+    virtual SYSTEMTIME startTime() const;
+
+    /**
+     * Read next object.
+     *
+     * @return object, which has to be deleted by the caller, or nullptr at end of file
+     */
+    virtual ObjectHeaderBase * read();
+
+    /**
+     * Read objects and write them into a BLF file.
+     *
+     * The measurement start time of the file is set from the date line, if
+     * it's not set yet.
+     *
+     * @param[in] file BLF file opened for writing
+     * @param[in] count maximum number of objects, or 0 for all
+     * @return number of objects written
+     */
+    virtual uint64_t copyTo(File & file, const uint64_t count = 0);
+
+    /**
+     * Get number of lines, which were skipped as unknown or malformed.
+     *
+     * @return line count
+     */
+    virtual uint64_t skippedLineCount() const;
+
+  private:
+    /** file */
+    std::ifstream m_file;
+
+    /** read buffer */
+    std::vector<char> m_buffer;
+
+    /** begin of unprocessed data in read buffer */
+    std::size_t m_begin {};
+
+    /** end of valid data in read buffer */
+    std::size_t m_end {};
+
+    /** end of file reached */
+    bool m_eof {false};
+
+    /** current line */
+    const char * m_line {};
+
+    /** end of current line */
+    const char * m_lineEnd {};
+
+    /** current line was not processed yet */
+    bool m_pending {false};
+
+    /** numbers are hexadecimal */
+    bool m_hex {true};
+
+    /** timestamps are relative to previous event */
+    bool m_relative {false};
+
+    /** timestamp of previous event in ns */
+    uint64_t m_lastTimeStamp {};
+
+    /** start time */
+    SYSTEMTIME m_startTime {};
+
+    /** number of skipped lines */
+    uint64_t m_skippedLineCount {};
+
+    /**
+     * Get next line from read buffer, refill if required.
+     *
+     * @return false at end of file
+     */
+    bool nextLine();
+
+    /**
+     * Evaluate header line.
+     *
+     * @return false if it's not a header line
+     */
+    bool parseHeader();
+
+    /**
+     * Parse event line.
+     *
+     * @return object or nullptr if line is unknown
+     */
+    ObjectHeaderBase * parseEvent();
+};
+
+}
+}
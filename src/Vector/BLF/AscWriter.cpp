@@ -0,0 +1,499 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/AscWriter.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <locale>
+#include <sstream>
+
+#include <Vector/BLF/CanErrorFrame.h>
+#include <Vector/BLF/CanErrorFrameExt.h>
+#include <Vector/BLF/CanFdMessage.h>
+#include <Vector/BLF/CanFdMessage64.h>
+#include <Vector/BLF/CanMessage.h>
+#include <Vector/BLF/CanMessage2.h>
+#include <Vector/BLF/EnvironmentVariable.h>
+#include <Vector/BLF/Exceptions.h>
+#include <Vector/BLF/LinMessage.h>
+#include <Vector/BLF/SystemVariable.h>
+
+namespace Vector {
+namespace BLF {
+
+namespace {
+
+/** CAN message flags */
+const uint8_t CanFlagTx = 0x01;
+const uint8_t CanFlagRtr = 0x80;
+
+/** CAN FD message flags */
+const uint32_t CanFdFlagBrs = 0x2000;
+const uint32_t CanFdFlagEsi = 0x4000;
+
+/** extended identifier flag */
+const uint32_t ExtendedId = 0x80000000;
+
+/** hex digits */
+const char HexDigits[] = "0123456789ABCDEF";
+
+/** maximum length of a line without variable length data */
+const std::size_t MaxLineSize = 512;
+
+/** read value from data bytes */
+template<typename T>
+T valueAt(const std::vector<uint8_t> & data, const std::size_t offset) {
+    T value {};
+    if (offset + sizeof(value) <= data.size())
+        std::memcpy(&value, data.data() + offset, sizeof(value));
+    return value;
+}
+
+}
+
+AscWriter::AscWriter(const std::string & filename, const std::size_t bufferSize) :
+    m_file(filename, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc),
+    m_bufferSize(std::max(bufferSize, MaxLineSize)) {
+    if (!m_file.is_open())
+        throw Exception("AscWriter::AscWriter(): Unable to open file.");
+    m_buffer.reserve(m_bufferSize);
+}
+
+AscWriter::~AscWriter() {
+    close();
+}
+
+void AscWriter::setStartTime(const SYSTEMTIME & startTime) {
+    m_startTime = startTime;
+}
+
+void AscWriter::write(const ObjectHeaderBase * ohb) {
+    if (ohb == nullptr)
+        return;
+    if (!m_headerWritten)
+        writeHeader();
+
+    switch (ohb->objectType) {
+    case ObjectType::CAN_MESSAGE: {
+        auto * obj = static_cast<const CanMessage *>(ohb);
+        appendTime(obj->objectTimeStampNs());
+        append(" ");
+        appendDec(obj->channel);
+        append("  ");
+        appendId(obj->id, 15);
+        append(" ");
+        appendDir((obj->flags & CanFlagTx) ? 1 : 0);
+        if (obj->flags & CanFlagRtr) {
+            append("   r");
+            if (obj->dlc) {
+                append(" ");
+                appendHex(obj->dlc);
+            }
+        } else {
+            append("   d ");
+            appendHex(obj->dlc);
+            appendBytes(obj->data.data(), std::min<std::size_t>(obj->dlc, obj->data.size()));
+        }
+        endLine();
+    }
+    break;
+
+    case ObjectType::CAN_MESSAGE2: {
+        auto * obj = static_cast<const CanMessage2 *>(ohb);
+        appendTime(obj->objectTimeStampNs());
+        append(" ");
+        appendDec(obj->channel);
+        append("  ");
+        appendId(obj->id, 15);
+        append(" ");
+        appendDir((obj->flags & CanFlagTx) ? 1 : 0);
+        if (obj->flags & CanFlagRtr) {
+            append("   r");
+            if (obj->dlc) {
+                append(" ");
+                appendHex(obj->dlc);
+            }
+        } else {
+            append("   d ");
+            appendHex(obj->dlc);
+            appendBytes(obj->data.data(), std::min<std::size_t>(obj->dlc, obj->data.size()));
+        }
+        append("  Length = ");
+        appendDec(obj->frameLength);
+        append(" BitCount = ");
+        appendDec(obj->bitCount);
+        append(" ID = ");
+        appendDec(obj->id & ~ExtendedId);
+        if (obj->id & ExtendedId)
+            append("x");
+        endLine();
+    }
+    break;
+
+    case ObjectType::CAN_FD_MESSAGE: {
+        auto * obj = static_cast<const CanFdMessage *>(ohb);
+        const uint8_t length = std::min<uint8_t>(obj->validDataBytes, 64);
+        appendTime(obj->objectTimeStampNs());
+        append(" CANFD ");
+        appendDec(obj->channel, 3);
+        append(" ");
+        appendDir((obj->flags & CanFdMessage::TX) ? 1 : 0);
+        append(" ");
+        appendId(obj->id, 8);
+        append(" ");
+        appendDec((obj->canFdFlags & CanFdMessage::BRS) ? 1 : 0);
+        append(" ");
+        appendDec((obj->canFdFlags & CanFdMessage::ESI) ? 1 : 0);
+        append(" ");
+        appendHex(obj->dlc);
+        append(" ");
+        appendDec(length, 2);
+        appendBytes(obj->data.data(), length);
+        append(" ");
+        appendDec(obj->frameLength, 8);
+        append(" ");
+        appendDec(obj->arbBitCount, 4);
+        append(" ");
+        appendHex(((obj->canFdFlags & CanFdMessage::EDL) ? 0x1000 : 0) |
+                  ((obj->canFdFlags & CanFdMessage::BRS) ? CanFdFlagBrs : 0) |
+                  ((obj->canFdFlags & CanFdMessage::ESI) ? CanFdFlagEsi : 0), 8);
+        append("        0        0        0        0        0        0");
+        endLine();
+    }
+    break;
+
+    case ObjectType::CAN_FD_MESSAGE_64: {
+        auto * obj = static_cast<const CanFdMessage64 *>(ohb);
+        const std::size_t length = std::min<std::size_t>(obj->validDataBytes, obj->data.size());
+        appendTime(obj->objectTimeStampNs());
+        append(" CANFD ");
+        appendDec(obj->channel, 3);
+        append(" ");
+        appendDir(obj->dir);
+        append(" ");
+        appendId(obj->id, 8);
+        append(" ");
+        appendDec((obj->flags & CanFdFlagBrs) ? 1 : 0);
+        append(" ");
+        appendDec((obj->flags & CanFdFlagEsi) ? 1 : 0);
+        append(" ");
+        appendHex(obj->dlc);
+        append(" ");
+        appendDec(length, 2);
+        appendBytes(obj->data.data(), length);
+        append(" ");
+        appendDec(obj->frameLength, 8);
+        append(" ");
+        appendDec(obj->bitCount, 4);
+        append(" ");
+        appendHex(obj->flags, 8);
+        append(" ");
+        appendHex(obj->crc, 8);
+        append(" ");
+        appendHex(obj->btrCfgArb, 8);
+        append(" ");
+        appendHex(obj->btrCfgData, 8);
+        append("        0        0");
+        endLine();
+    }
+    break;
+
+    case ObjectType::CAN_ERROR: {
+        auto * obj = static_cast<const CanErrorFrame *>(ohb);
+        appendTime(obj->objectTimeStampNs());
+        append(" ");
+        appendDec(obj->channel);
+        append("  ErrorFrame");
+        endLine();
+    }
+    break;
+
+    case ObjectType::CAN_ERROR_EXT: {
+        auto * obj = static_cast<const CanErrorFrameExt *>(ohb);
+        appendTime(obj->objectTimeStampNs());
+        append(" ");
+        appendDec(obj->channel);
+        append("  ErrorFrame");
+        endLine();
+    }
+    break;
+
+    case ObjectType::LIN_MESSAGE: {
+        auto * obj = static_cast<const LinMessage *>(ohb);
+        const uint8_t dlc = std::min<uint8_t>(obj->dlc, 8);
+        appendTime(obj->objectTimeStampNs());
+        append(" Li");
+        appendDec(obj->channel);
+        append(" ");
+        appendHex(obj->id);
+        append(" ");
+        appendDir(obj->dir);
+        append(" ");
+        appendDec(dlc);
+        appendBytes(obj->data.data(), dlc);
+        append(" checksum = ");
+        appendHex(obj->crc);
+        append(" header time = ");
+        appendDec(obj->headerTime);
+        append(", full time = ");
+        appendDec(obj->fullTime);
+        endLine();
+    }
+    break;
+
+    case ObjectType::SYS_VARIABLE: {
+        auto * obj = static_cast<const SystemVariable *>(ohb);
+        appendTime(obj->objectTimeStampNs());
+        append(" SV: ");
+        appendDec(obj->type);
+        append(" ");
+        appendDec(obj->representation);
+        append(" 1 ::");
+        append(obj->name.data(), obj->name.size());
+        append(" =");
+        switch (obj->type) {
+        case SystemVariable::Type::Double:
+            append(" ");
+            appendDouble(valueAt<double>(obj->data, 0));
+            break;
+        case SystemVariable::Type::Long:
+            append(" ");
+            appendSigned(valueAt<int32_t>(obj->data, 0));
+            break;
+        case SystemVariable::Type::LongLong:
+            append(" ");
+            appendSigned(valueAt<int64_t>(obj->data, 0));
+            break;
+        case SystemVariable::Type::String:
+            append(" ");
+            appendText(obj->data);
+            break;
+        case SystemVariable::Type::DoubleArray:
+            for (std::size_t offset = 0; offset + sizeof(double) <= obj->data.size(); offset += sizeof(double)) {
+                append(" ");
+                appendDouble(valueAt<double>(obj->data, offset));
+            }
+            break;
+        case SystemVariable::Type::LongArray:
+            for (std::size_t offset = 0; offset + sizeof(int32_t) <= obj->data.size(); offset += sizeof(int32_t)) {
+                append(" ");
+                appendSigned(valueAt<int32_t>(obj->data, offset));
+            }
+            break;
+        default:
+            appendBytes(obj->data.data(), obj->data.size());
+            break;
+        }
+        endLine();
+    }
+    break;
+
+    case ObjectType::ENV_INTEGER:
+    case ObjectType::ENV_DOUBLE:
+    case ObjectType::ENV_STRING:
+    case ObjectType::ENV_DATA: {
+        auto * obj = static_cast<const EnvironmentVariable *>(ohb);
+        appendTime(obj->objectTimeStampNs());
+        append(" ");
+        append(obj->name.data(), obj->name.size());
+        append(" :=");
+        if (obj->objectType == ObjectType::ENV_INTEGER) {
+            append(" ");
+            appendSigned(valueAt<int32_t>(obj->data, 0));
+        } else if (obj->objectType == ObjectType::ENV_DOUBLE) {
+            append(" ");
+            appendDouble(valueAt<double>(obj->data, 0));
+        } else if (obj->objectType == ObjectType::ENV_STRING) {
+            append(" ");
+            appendText(obj->data);
+        } else
+            appendBytes(obj->data.data(), obj->data.size());
+        endLine();
+    }
+    break;
+
+    default:
+        break;
+    }
+}
+
+void AscWriter::close() {
+    if (!m_file.is_open())
+        return;
+    if (!m_headerWritten)
+        writeHeader();
+    append("End TriggerBlock");
+    endLine();
+    flush();
+    m_file.close();
+}
+
+void AscWriter::writeHeader() {
+    m_headerWritten = true;
+    append("date ");
+    appendDate(m_startTime);
+    endLine();
+    append("base hex  timestamps absolute");
+    endLine();
+    append("internal events logged");
+    endLine();
+    append("// version 9.0.0");
+    endLine();
+    append("Begin Triggerblock ");
+    appendDate(m_startTime);
+    endLine();
+    append("   0.000000 Start of measurement");
+    endLine();
+}
+
+void AscWriter::appendDate(const SYSTEMTIME & systemTime) {
+    static const char * const weekdays[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+    static const char * const months[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+    /* unknown start time is written as 1970-01-01 */
+    SYSTEMTIME date = systemTime;
+    if ((date.year == 0) || (date.month < 1) || (date.month > 12)) {
+        date = SYSTEMTIME();
+        date.year = 1970;
+        date.month = 1;
+        date.dayOfWeek = 4;
+        date.day = 1;
+    }
+
+    append(weekdays[date.dayOfWeek % 7]);
+    append(" ");
+    append(months[date.month - 1]);
+    append(" ");
+    appendDec(date.day);
+    append(" ");
+    const uint16_t hour = (date.hour % 12 == 0) ? 12 : (date.hour % 12);
+    if (hour < 10)
+        append("0");
+    appendDec(hour);
+    append(":");
+    if (date.minute < 10)
+        append("0");
+    appendDec(date.minute);
+    append(":");
+    if (date.second < 10)
+        append("0");
+    appendDec(date.second);
+    append(".");
+    if (date.milliseconds < 100)
+        append("0");
+    if (date.milliseconds < 10)
+        append("0");
+    appendDec(date.milliseconds);
+    append((date.hour < 12) ? " am " : " pm ");
+    appendDec(date.year);
+}
+
+void AscWriter::append(const char * text, const std::size_t size) {
+    m_buffer.insert(m_buffer.end(), text, text + size);
+}
+
+void AscWriter::append(const char * text) {
+    append(text, std::strlen(text));
+}
+
+void AscWriter::appendText(const std::vector<uint8_t> & data) {
+    /* up to terminating 0, if any */
+    auto end = std::find(data.begin(), data.end(), 0);
+    m_buffer.insert(m_buffer.end(), data.begin(), end);
+}
+
+void AscWriter::appendDec(uint64_t value, const std::size_t width) {
+    char digits[20];
+    std::size_t size = 0;
+    do {
+        digits[size++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    for (std::size_t i = size; i < width; ++i)
+        m_buffer.push_back(' ');
+    while (size > 0)
+        m_buffer.push_back(digits[--size]);
+}
+
+void AscWriter::appendSigned(const int64_t value) {
+    if (value < 0) {
+        append("-");
+        appendDec(0 - static_cast<uint64_t>(value));
+    } else
+        appendDec(static_cast<uint64_t>(value));
+}
+
+void AscWriter::appendDouble(const double value) {
+    /* independent of the global locale, which might use ',' as decimal point */
+    std::ostringstream stream;
+    stream.imbue(std::locale::classic());
+    stream << std::setprecision(17) << value;
+    const std::string text = stream.str();
+    append(text.data(), text.size());
+}
+
+void AscWriter::appendHex(uint64_t value, const std::size_t width) {
+    char digits[16];
+    std::size_t size = 0;
+    do {
+        digits[size++] = HexDigits[value & 0x0F];
+        value >>= 4;
+    } while (value != 0);
+    for (std::size_t i = size; i < width; ++i)
+        m_buffer.push_back(' ');
+    while (size > 0)
+        m_buffer.push_back(digits[--size]);
+}
+
+void AscWriter::appendBytes(const uint8_t * data, const std::size_t size) {
+    const std::size_t offset = m_buffer.size();
+    m_buffer.resize(offset + 3 * size);
+    char * out = m_buffer.data() + offset;
+    for (std::size_t i = 0; i < size; ++i) {
+        *out++ = ' ';
+        *out++ = HexDigits[data[i] >> 4];
+        *out++ = HexDigits[data[i] & 0x0F];
+    }
+}
+
+void AscWriter::appendId(const uint32_t id, const std::size_t width) {
+    const std::size_t offset = m_buffer.size();
+    appendHex(id & ~ExtendedId);
+    if (id & ExtendedId)
+        append("x");
+    for (std::size_t i = m_buffer.size() - offset; i < width; ++i)
+        m_buffer.push_back(' ');
+}
+
+void AscWriter::appendTime(const uint64_t timeStamp) {
+    const uint64_t microseconds = timeStamp / 1000;
+    appendDec(microseconds / 1000000, 4);
+    append(".");
+    const uint64_t fraction = microseconds % 1000000;
+    for (uint64_t scale = 100000; scale > 1 && fraction < scale; scale /= 10)
+        append("0");
+    appendDec(fraction);
+}
+
+void AscWriter::appendDir(const uint8_t dir) {
+    append((dir == 0) ? "Rx  " : (dir == 1) ? "Tx  " : "TxRq");
+}
+
+void AscWriter::endLine() {
+    m_buffer.push_back('\n');
+    if (m_buffer.size() + MaxLineSize > m_bufferSize)
+        flush();
+}
+
+void AscWriter::flush() {
+    if (m_buffer.empty())
+        return;
+    m_file.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    m_buffer.clear();
+}
+
+}
+}
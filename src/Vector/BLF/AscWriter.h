@@ -0,0 +1,186 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <Vector/BLF/FileStatistics.h>
+#include <Vector/BLF/ObjectHeaderBase.h>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * ASC writer
+ *
+ * Writes CanMessage, CanMessage2, CanFdMessage, CanFdMessage64,
+ * CanErrorFrame, CanErrorFrameExt, LinMessage, SystemVariable and
+ * EnvironmentVariable objects as lines of a Vector ASCII log file with hex
+ * numbers and absolute timestamps. Other objects are ignored.
+ *
+ * Lines are formatted directly into a write buffer, which is flushed to the
+ * file in large chunks.
+ */
+class VECTOR_BLF_EXPORT AscWriter final {
+  public:
+    /**
+     * constructor
+     *
+     * @param[in] filename file name
+     * @param[in] bufferSize size of write buffer
+     */
+    explicit AscWriter(const std::string & filename, const std::size_t bufferSize = 4 * 1024 * 1024);
+    virtual ~AscWriter();
+    AscWriter(const AscWriter &) = delete;
+    AscWriter & operator=(const AscWriter &) = delete;
+
+    /**
+     * Set start time for the date line.
+     *
+     * This has to be called before the first object is written.
+     *
+     * @param[in] startTime start time, e.g. FileStatistics::measurementStartTime
+     */
+    virtual void setStartTime(const SYSTEMTIME & startTime);
+
+    /**
+     * Write an object.
+     *
+     * @param[in] ohb object
+     */
+    virtual void write(const ObjectHeaderBase * ohb);
+
+    /**
+     * Write end of trigger block, flush write buffer and close file.
+     */
+    virtual void close();
+
+  private:
+    /** file */
+    std::ofstream m_file;
+
+    /** write buffer */
+    std::vector<char> m_buffer {};
+
+    /** flush threshold of write buffer */
+    std::size_t m_bufferSize;
+
+    /** start time */
+    SYSTEMTIME m_startTime {};
+
+    /** header was written */
+    bool m_headerWritten {false};
+
+    /** write header lines */
+    void writeHeader();
+
+    /**
+     * Append date in ASC format.
+     *
+     * @param[in] systemTime date
+     */
+    void appendDate(const SYSTEMTIME & systemTime);
+
+    /**
+     * Append string.
+     *
+     * @param[in] text text
+     * @param[in] size size
+     */
+    void append(const char * text, const std::size_t size);
+
+    /**
+     * Append null-terminated string.
+     *
+     * @param[in] text text
+     */
+    void append(const char * text);
+
+    /**
+     * Append string data up to the terminating 0.
+     *
+     * @param[in] data data
+     */
+    void appendText(const std::vector<uint8_t> & data);
+
+    /**
+     * Append unsigned decimal number, right-aligned.
+     *
+     * @param[in] value value
+     * @param[in] width minimum width, padded with spaces
+     */
+    void appendDec(const uint64_t value, const std::size_t width = 0);
+
+    /**
+     * Append signed decimal number.
+     *
+     * @param[in] value value
+     */
+    void appendSigned(const int64_t value);
+
+    /**
+     * Append floating point number.
+     *
+     * @param[in] value value
+     */
+    void appendDouble(const double value);
+
+    /**
+     * Append unsigned hex number, right-aligned.
+     *
+     * @param[in] value value
+     * @param[in] width minimum width, padded with spaces
+     */
+    void appendHex(const uint64_t value, const std::size_t width = 0);
+
+    /**
+     * Append bytes as two-digit hex numbers, each preceded by a space.
+     *
+     * @param[in] data data
+     * @param[in] size size
+     */
+    void appendBytes(const uint8_t * data, const std::size_t size);
+
+    /**
+     * Append identifier with 'x' suffix for extended identifiers, left-aligned.
+     *
+     * @param[in] id identifier
+     * @param[in] width minimum width, padded with spaces
+     */
+    void appendId(const uint32_t id, const std::size_t width);
+
+    /**
+     * Append timestamp in s with 6 decimals, right-aligned in 11 columns.
+     *
+     * @param[in] timeStamp timestamp in ns
+     */
+    void appendTime(const uint64_t timeStamp);
+
+    /**
+     * Append direction.
+     *
+     * @param[in] dir direction (0=Rx, 1=Tx, 2=TxRq)
+     */
+    void appendDir(const uint8_t dir);
+
+    /**
+     * Append end of line and flush write buffer if it's full.
+     */
+    void endLine();
+
+    /**
+     * Write buffer to file.
+     */
+    void flush();
+};
+
+}
+}
@@ -0,0 +1,404 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/CanBusLoad.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <Vector/BLF/CanFdMessage.h>
+#include <Vector/BLF/CanFdMessage64.h>
+#include <Vector/BLF/CanMessage.h>
+#include <Vector/BLF/CanMessage2.h>
+#include <Vector/BLF/Exceptions.h>
+
+namespace Vector {
+namespace BLF {
+
+namespace {
+
+/**
+ * Bit sequence of a CAN frame, used to count stuff bits and calculate the CRC.
+ */
+struct BitSequence {
+    /** bits (one bit per element) */
+    uint8_t bits[640];
+
+    /** number of bits */
+    uint16_t size {};
+
+    /** append value with given number of bits, msb first */
+    void push(const uint32_t value, const uint8_t count) {
+        for (int8_t i = count - 1; i >= 0; --i)
+            bits[size++] = (value >> i) & 1;
+    }
+
+    /** append data bytes, msb first */
+    void pushBytes(const uint8_t * data, const uint8_t count) {
+        for (uint8_t i = 0; i < count; ++i)
+            push(data[i], 8);
+    }
+};
+
+/**
+ * Count dynamic stuff bits.
+ *
+ * After five consecutive bits of equal value, a complementary bit is inserted,
+ * which itself starts the next run.
+ */
+struct StuffBitCounter {
+    /** value of current run */
+    uint8_t level {2};
+
+    /** length of current run */
+    uint8_t run {};
+
+    /**
+     * count stuff bits of a bit range
+     *
+     * @return number of inserted stuff bits
+     */
+    uint16_t count(const uint8_t * bits, const uint16_t size) {
+        uint16_t stuffBits = 0;
+        for (uint16_t i = 0; i < size; ++i) {
+            if (bits[i] == level)
+                run++;
+            else {
+                level = bits[i];
+                run = 1;
+            }
+            if (run == 5) {
+                stuffBits++;
+                level = !level;
+                run = 1;
+            }
+        }
+        return stuffBits;
+    }
+};
+
+/** CRC-15 of classic CAN frames */
+uint16_t crc15(const uint8_t * bits, const uint16_t size) {
+    uint16_t crc = 0;
+    for (uint16_t i = 0; i < size; ++i) {
+        bool crcNext = bits[i] ^ ((crc >> 14) & 1);
+        crc = (crc << 1) & 0x7fff;
+        if (crcNext)
+            crc ^= 0x4599;
+    }
+    return crc;
+}
+
+/** CAN FD data length to DLC */
+uint8_t canFdDlc(const uint8_t dataLength) {
+    if (dataLength <= 8)
+        return dataLength;
+    if (dataLength <= 12)
+        return 9;
+    if (dataLength <= 16)
+        return 10;
+    if (dataLength <= 20)
+        return 11;
+    if (dataLength <= 24)
+        return 12;
+    if (dataLength <= 32)
+        return 13;
+    if (dataLength <= 48)
+        return 14;
+    return 15;
+}
+
+/**
+ * Bit rate from Vector bit timing configuration.
+ *
+ * - Bit 0-7: Quartz Frequency in MHz
+ * - Bit 8-15: Prescaler
+ * - Bit 16-23: BTL Cycles
+ */
+uint32_t bitRate(const uint32_t btrCfg, const uint32_t defaultBitRate) {
+    uint32_t quartzFrequency = btrCfg & 0xff;
+    uint32_t prescaler = (btrCfg >> 8) & 0xff;
+    uint32_t btlCycles = (btrCfg >> 16) & 0xff;
+    if ((quartzFrequency == 0) || (prescaler == 0) || (btlCycles == 0))
+        return defaultBitRate;
+    return quartzFrequency * 1000000 / (prescaler * btlCycles);
+}
+
+/** duration of bits in ns */
+uint64_t bitsToNs(const uint64_t bits, const uint32_t bitRate) {
+    if (bitRate == 0)
+        return 0;
+    return bits * 1000000000 / bitRate;
+}
+
+/** bits that are not stuffed: CRC delimiter, ACK slot, ACK delimiter, EOF, interframe space */
+const uint16_t trailerBitCount = 1 + 2 + 7 + 3;
+
+/** interframe space, which is not included in frameLength */
+const uint16_t interframeSpaceBitCount = 3;
+
+}
+
+CanBusLoad::CanBusLoad(const uint64_t resolution) :
+    m_resolution(resolution) {
+    if (resolution == 0)
+        throw Exception("CanBusLoad::CanBusLoad(): resolution must not be zero");
+}
+
+uint64_t CanBusLoad::resolution() const {
+    return m_resolution;
+}
+
+void CanBusLoad::setBitRate(const uint16_t channel, const uint32_t arbitrationBitRate, const uint32_t dataBitRate) {
+    Channel & ch = m_channels[channel];
+    ch.arbitrationBitRate = arbitrationBitRate;
+    ch.dataBitRate = (dataBitRate != 0) ? dataBitRate : arbitrationBitRate;
+}
+
+void CanBusLoad::process(const ObjectHeaderBase * ohb) {
+    if (ohb == nullptr)
+        return;
+
+    switch (ohb->objectType) {
+    case ObjectType::CAN_MESSAGE: {
+        auto * obj = static_cast<const CanMessage *>(ohb);
+        Channel & ch = m_channels[obj->channel];
+        uint16_t bits = canFrameBitCount(obj->id, obj->flags & (1 << 7), obj->data.data(), std::min<uint8_t>(obj->dlc, 8));
+        addFrame(ch, obj->objectTimeStampNs(), bitsToNs(bits, ch.arbitrationBitRate));
+    }
+    break;
+
+    case ObjectType::CAN_MESSAGE2: {
+        auto * obj = static_cast<const CanMessage2 *>(ohb);
+        Channel & ch = m_channels[obj->channel];
+        uint64_t duration;
+        if (obj->frameLength != 0)
+            duration = obj->frameLength + bitsToNs(interframeSpaceBitCount, ch.arbitrationBitRate);
+        else if (obj->bitCount != 0)
+            duration = bitsToNs(obj->bitCount, ch.arbitrationBitRate);
+        else {
+            uint8_t dlc = std::min<uint8_t>(obj->dlc, std::min<uint8_t>(8, static_cast<uint8_t>(obj->data.size())));
+            duration = bitsToNs(canFrameBitCount(obj->id, obj->flags & (1 << 7), obj->data.data(), dlc), ch.arbitrationBitRate);
+        }
+        addFrame(ch, obj->objectTimeStampNs(), duration);
+    }
+    break;
+
+    case ObjectType::CAN_FD_MESSAGE: {
+        auto * obj = static_cast<const CanFdMessage *>(ohb);
+        Channel & ch = m_channels[obj->channel];
+        uint64_t duration;
+        if (obj->frameLength != 0)
+            duration = obj->frameLength + bitsToNs(interframeSpaceBitCount, ch.arbitrationBitRate);
+        else if (obj->canFdFlags & CanFdMessage::CanFdFlags::EDL) {
+            uint16_t arbitrationBitCount;
+            uint16_t dataBitCount;
+            canFdFrameBitCount(obj->id, obj->data.data(), std::min<uint8_t>(obj->validDataBytes, 64), arbitrationBitCount, dataBitCount);
+            uint32_t dataBitRate = (obj->canFdFlags & CanFdMessage::CanFdFlags::BRS) ? ch.dataBitRate : ch.arbitrationBitRate;
+            duration =
+                bitsToNs(arbitrationBitCount, ch.arbitrationBitRate) +
+                bitsToNs(dataBitCount, dataBitRate);
+        } else {
+            uint16_t bits = canFrameBitCount(obj->id, obj->flags & CanFdMessage::Flags::RTR, obj->data.data(), std::min<uint8_t>(obj->dlc, 8));
+            duration = bitsToNs(bits, ch.arbitrationBitRate);
+        }
+        addFrame(ch, obj->objectTimeStampNs(), duration);
+    }
+    break;
+
+    case ObjectType::CAN_FD_MESSAGE_64: {
+        auto * obj = static_cast<const CanFdMessage64 *>(ohb);
+        Channel & ch = m_channels[obj->channel];
+        uint32_t arbitrationBitRate = bitRate(obj->btrCfgArb, ch.arbitrationBitRate);
+        uint32_t dataBitRate = (obj->flags & 0x2000) ? bitRate(obj->btrCfgData, ch.dataBitRate) : arbitrationBitRate; // BRS
+        uint8_t dataLength = std::min<uint8_t>(static_cast<uint8_t>(std::min<std::size_t>(obj->data.size(), 64)), obj->validDataBytes);
+        uint64_t duration;
+        if (obj->frameLength != 0)
+            duration = obj->frameLength + bitsToNs(interframeSpaceBitCount, arbitrationBitRate);
+        else if ((obj->bitCount != 0) && (arbitrationBitRate == dataBitRate))
+            duration = bitsToNs(obj->bitCount, arbitrationBitRate);
+        else if (obj->flags & 0x1000) { // EDL
+            uint16_t arbitrationBitCount;
+            uint16_t dataBitCount;
+            canFdFrameBitCount(obj->id, obj->data.data(), dataLength, arbitrationBitCount, dataBitCount);
+            duration =
+                bitsToNs(arbitrationBitCount, arbitrationBitRate) +
+                bitsToNs(dataBitCount, dataBitRate);
+        } else {
+            uint16_t bits = canFrameBitCount(obj->id, obj->flags & 0x0010, obj->data.data(), std::min<uint8_t>(std::min<uint8_t>(obj->dlc, 8), dataLength));
+            duration = bitsToNs(bits, arbitrationBitRate);
+        }
+        addFrame(ch, obj->objectTimeStampNs(), duration);
+    }
+    break;
+
+    default:
+        break;
+    }
+}
+
+void CanBusLoad::process(const uint16_t channel, const uint64_t * timeStamps, const uint32_t * durations, const std::size_t count) {
+    if (count == 0)
+        return;
+    Channel & ch = m_channels[channel];
+
+    /* determine window range of the batch, to resize the window vector only once */
+    uint64_t firstWindow = std::numeric_limits<uint64_t>::max();
+    uint64_t lastWindow = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        uint64_t start = timeStamps[i] - std::min<uint64_t>(durations[i], timeStamps[i]);
+        uint64_t end = std::max(start + 1, timeStamps[i]);
+        firstWindow = std::min(firstWindow, start / m_resolution);
+        lastWindow = std::max(lastWindow, (end - 1) / m_resolution);
+    }
+    addBusyTime(ch, firstWindow, 0);
+    addBusyTime(ch, lastWindow, 0);
+
+    /* accumulate */
+    uint64_t * busyTime = ch.busyTime.data();
+    const uint64_t offset = ch.firstWindow;
+    for (std::size_t i = 0; i < count; ++i) {
+        uint64_t end = timeStamps[i];
+        uint64_t start = end - std::min<uint64_t>(durations[i], end);
+        uint64_t startWindow = start / m_resolution;
+        uint64_t endWindow = (end > start) ? (end - 1) / m_resolution : startWindow;
+        if (startWindow == endWindow) {
+            /* fast path: frame is completely within one window */
+            busyTime[startWindow - offset] += end - start;
+        } else if (endWindow - startWindow == 1) {
+            /* frame crosses one window boundary */
+            uint64_t boundary = endWindow * m_resolution;
+            busyTime[startWindow - offset] += boundary - start;
+            busyTime[endWindow - offset] += end - boundary;
+        } else {
+            /* frame is longer than a window. All windows exist already, so busyTime stays valid. */
+            addFrame(ch, end, end - start);
+        }
+    }
+}
+
+std::vector<uint16_t> CanBusLoad::channels() const {
+    std::vector<uint16_t> result;
+    for (const auto & channel : m_channels)
+        if (!channel.second.busyTime.empty())
+            result.push_back(channel.first);
+    return result;
+}
+
+uint64_t CanBusLoad::startTime(const uint16_t channel) const {
+    auto it = m_channels.find(channel);
+    if (it == m_channels.end())
+        return 0;
+    return it->second.firstWindow * m_resolution;
+}
+
+std::vector<uint64_t> CanBusLoad::busyTime(const uint16_t channel) const {
+    auto it = m_channels.find(channel);
+    if (it == m_channels.end())
+        return std::vector<uint64_t>();
+    return it->second.busyTime;
+}
+
+std::vector<double> CanBusLoad::utilization(const uint16_t channel) const {
+    std::vector<double> result;
+    auto it = m_channels.find(channel);
+    if (it == m_channels.end())
+        return result;
+    const std::vector<uint64_t> & busyTime = it->second.busyTime;
+    result.resize(busyTime.size());
+    const double resolution = static_cast<double>(m_resolution);
+    for (std::size_t i = 0; i < busyTime.size(); ++i)
+        result[i] = std::min(1.0, static_cast<double>(busyTime[i]) / resolution);
+    return result;
+}
+
+uint16_t CanBusLoad::canFrameBitCount(const uint32_t id, const bool remote, const uint8_t * data, const uint8_t dlc) {
+    BitSequence seq;
+    seq.push(0, 1); // SOF
+    if (id & 0x80000000) {
+        seq.push((id >> 18) & 0x7ff, 11); // base id
+        seq.push(1, 1); // SRR
+        seq.push(1, 1); // IDE
+        seq.push(id & 0x3ffff, 18); // id extension
+        seq.push(remote, 1); // RTR
+        seq.push(0, 2); // r1, r0
+    } else {
+        seq.push(id & 0x7ff, 11); // id
+        seq.push(remote, 1); // RTR
+        seq.push(0, 2); // IDE, r0
+    }
+    seq.push(dlc, 4); // DLC
+    if (!remote)
+        seq.pushBytes(data, std::min<uint8_t>(dlc, 8)); // data
+    seq.push(crc15(seq.bits, seq.size), 15); // CRC
+
+    StuffBitCounter stuffBitCounter;
+    return seq.size + stuffBitCounter.count(seq.bits, seq.size) + trailerBitCount;
+}
+
+void CanBusLoad::canFdFrameBitCount(const uint32_t id, const uint8_t * data, const uint8_t dataLength, uint16_t & arbitrationBitCount, uint16_t & dataBitCount) {
+    /* arbitration phase */
+    BitSequence seq;
+    seq.push(0, 1); // SOF
+    if (id & 0x80000000) {
+        seq.push((id >> 18) & 0x7ff, 11); // base id
+        seq.push(1, 1); // SRR
+        seq.push(1, 1); // IDE
+        seq.push(id & 0x3ffff, 18); // id extension
+    } else {
+        seq.push(id & 0x7ff, 11); // id
+    }
+    seq.push(0, 1); // RRS
+    if (!(id & 0x80000000))
+        seq.push(0, 1); // IDE
+    seq.push(1, 1); // FDF
+    seq.push(0, 1); // res
+    seq.push(1, 1); // BRS
+    const uint16_t arbitrationSize = seq.size;
+
+    /* data phase */
+    seq.push(0, 1); // ESI
+    seq.push(canFdDlc(dataLength), 4); // DLC
+    seq.pushBytes(data, dataLength); // data
+
+    /* dynamic stuff bits up to the end of data field */
+    StuffBitCounter stuffBitCounter;
+    uint16_t arbitrationStuffBits = stuffBitCounter.count(seq.bits, arbitrationSize);
+    uint16_t dataStuffBits = stuffBitCounter.count(seq.bits + arbitrationSize, seq.size - arbitrationSize);
+
+    /* stuff count and CRC with fixed stuff bits (before stuff count and after every 4th bit) */
+    uint16_t crcBitCount = (dataLength <= 16) ? 4 + 17 : 4 + 21;
+    uint16_t fixedStuffBits = 1 + crcBitCount / 4;
+
+    arbitrationBitCount = arbitrationSize + arbitrationStuffBits + trailerBitCount;
+    dataBitCount = (seq.size - arbitrationSize) + dataStuffBits + crcBitCount + fixedStuffBits;
+}
+
+void CanBusLoad::addBusyTime(Channel & channel, const uint64_t window, const uint64_t busyTime) {
+    if (channel.busyTime.empty())
+        channel.firstWindow = window;
+    if (window < channel.firstWindow) {
+        channel.busyTime.insert(channel.busyTime.begin(), channel.firstWindow - window, 0);
+        channel.firstWindow = window;
+    }
+    const std::size_t index = window - channel.firstWindow;
+    if (index >= channel.busyTime.size())
+        channel.busyTime.resize(index + 1);
+    channel.busyTime[index] += busyTime;
+}
+
+void CanBusLoad::addFrame(Channel & channel, const uint64_t timeStamp, const uint64_t duration) {
+    const uint64_t start = timeStamp - std::min(duration, timeStamp);
+    uint64_t window = start / m_resolution;
+    uint64_t position = start;
+    while (position < timeStamp) {
+        uint64_t windowEnd = std::min((window + 1) * m_resolution, timeStamp);
+        addBusyTime(channel, window, windowEnd - position);
+        position = windowEnd;
+        window++;
+    }
+}
+
+}
+}
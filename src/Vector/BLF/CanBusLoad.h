@@ -0,0 +1,183 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+#include <Vector/BLF/ObjectHeaderBase.h>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * CAN / CAN FD bus load calculation
+ *
+ * The bus occupancy of each frame is accumulated per channel into time
+ * windows of fixed resolution. The duration of a frame is taken from
+ * frameLength, if logged. Otherwise it is derived from bitCount or, if that
+ * is missing too, the exact bit count is reconstructed from id and data,
+ * including dynamic and fixed stuff bits.
+ *
+ * The object timestamp marks the end of the frame, so a frame occupies the
+ * bus during [timestamp - duration, timestamp). Frames crossing a window
+ * boundary are split between both windows.
+ */
+class VECTOR_BLF_EXPORT CanBusLoad final {
+  public:
+    /**
+     * constructor
+     *
+     * @param[in] resolution window size in ns (1 ms to 1 s)
+     */
+    explicit CanBusLoad(const uint64_t resolution = 10000000);
+    virtual ~CanBusLoad() = default;
+
+    /**
+     * Get window size.
+     *
+     * @return window size in ns
+     */
+    virtual uint64_t resolution() const;
+
+    /**
+     * Set bit rates of a channel.
+     *
+     * These are used if the frame itself doesn't provide the bit timing
+     * (btrCfgArb/btrCfgData). Default is 500 kbit/s and 2 Mbit/s.
+     *
+     * @param[in] channel application channel
+     * @param[in] arbitrationBitRate bit rate in arbitration phase in bit/s
+     * @param[in] dataBitRate bit rate in data phase in bit/s (0 = arbitration bit rate)
+     */
+    virtual void setBitRate(const uint16_t channel, const uint32_t arbitrationBitRate, const uint32_t dataBitRate = 0);
+
+    /**
+     * Process an object.
+     *
+     * CanMessage, CanMessage2, CanFdMessage and CanFdMessage64 are
+     * evaluated, all other objects are ignored.
+     *
+     * @param[in] ohb object
+     */
+    virtual void process(const ObjectHeaderBase * ohb);
+
+    /**
+     * Process a batch of frames of one channel.
+     *
+     * @param[in] channel application channel
+     * @param[in] timeStamps frame end times in ns
+     * @param[in] durations frame durations in ns
+     * @param[in] count number of frames
+     */
+    virtual void process(const uint16_t channel, const uint64_t * timeStamps, const uint32_t * durations, const std::size_t count);
+
+    /**
+     * Get channels that carried frames.
+     *
+     * @return channels
+     */
+    virtual std::vector<uint16_t> channels() const;
+
+    /**
+     * Get start time of the first window of a channel.
+     *
+     * @param[in] channel application channel
+     * @return start time in ns
+     */
+    virtual uint64_t startTime(const uint16_t channel) const;
+
+    /**
+     * Get busy time per window of a channel.
+     *
+     * @param[in] channel application channel
+     * @return busy time in ns per window, beginning at startTime
+     */
+    virtual std::vector<uint64_t> busyTime(const uint16_t channel) const;
+
+    /**
+     * Get bus load per window of a channel.
+     *
+     * @param[in] channel application channel
+     * @return bus load (0.0 - 1.0) per window, beginning at startTime
+     */
+    virtual std::vector<double> utilization(const uint16_t channel) const;
+
+    /**
+     * Calculate the number of bits of a classic CAN frame on the wire.
+     *
+     * This includes stuff bits, CRC, ACK, EOF and 3 bit interframe space.
+     *
+     * @param[in] id CAN ID (bit 31 set for extended id)
+     * @param[in] remote remote frame
+     * @param[in] data data bytes
+     * @param[in] dlc data length code (0-8)
+     * @return number of bits
+     */
+    static uint16_t canFrameBitCount(const uint32_t id, const bool remote, const uint8_t * data, const uint8_t dlc);
+
+    /**
+     * Calculate the number of bits of a CAN FD frame on the wire.
+     *
+     * This includes dynamic and fixed stuff bits, CRC, ACK, EOF and
+     * 3 bit interframe space. The data phase ranges from BRS to the
+     * CRC delimiter.
+     *
+     * @param[in] id CAN ID (bit 31 set for extended id)
+     * @param[in] data data bytes
+     * @param[in] dataLength number of data bytes (0-64)
+     * @param[out] arbitrationBitCount number of bits in arbitration phase
+     * @param[out] dataBitCount number of bits in data phase
+     */
+    static void canFdFrameBitCount(const uint32_t id, const uint8_t * data, const uint8_t dataLength, uint16_t & arbitrationBitCount, uint16_t & dataBitCount);
+
+  private:
+    /** per channel state */
+    struct Channel {
+        /** bit rate in arbitration phase */
+        uint32_t arbitrationBitRate {500000};
+
+        /** bit rate in data phase */
+        uint32_t dataBitRate {2000000};
+
+        /** index of first window */
+        uint64_t firstWindow {};
+
+        /** busy time per window */
+        std::vector<uint64_t> busyTime {};
+    };
+
+    /** window size in ns */
+    uint64_t m_resolution;
+
+    /** channels */
+    std::map<uint16_t, Channel> m_channels {};
+
+    /**
+     * Add busy time to a window.
+     *
+     * @param[in] channel channel
+     * @param[in] window window index
+     * @param[in] busyTime busy time in ns
+     */
+    void addBusyTime(Channel & channel, const uint64_t window, const uint64_t busyTime);
+
+    /**
+     * Add a frame.
+     *
+     * @param[in] channel channel
+     * @param[in] timeStamp frame end time in ns
+     * @param[in] duration frame duration in ns
+     */
+    void addFrame(Channel & channel, const uint64_t timeStamp, const uint64_t duration);
+};
+
+}
+}
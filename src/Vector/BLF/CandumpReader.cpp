@@ -0,0 +1,368 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/CandumpReader.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include <Vector/BLF/CanErrorFrameExt.h>
+#include <Vector/BLF/CanFdMessage64.h>
+#include <Vector/BLF/CanMessage2.h>
+#include <Vector/BLF/Exceptions.h>
+#include <Vector/BLF/Helpers.h>
+
+namespace Vector {
+namespace BLF {
+
+namespace {
+
+/** objects enqueued at once by copyTo */
+const std::size_t copyBatchSize = 256;
+
+/** CAN message flags */
+const uint8_t CanFlagTx = 0x01;
+const uint8_t CanFlagRtr = 0x80;
+
+/** CAN FD message flags */
+const uint32_t CanFdFlagEdl = 0x1000;
+const uint32_t CanFdFlagBrs = 0x2000;
+const uint32_t CanFdFlagEsi = 0x4000;
+
+/** extended identifier flag in BLF */
+const uint32_t ExtendedId = 0x80000000;
+
+/** SocketCAN error frame flag */
+const uint32_t CanErrFlag = 0x20000000;
+
+/** SocketCAN error class: protocol violation */
+const uint32_t CanErrProt = 0x00000008;
+
+/** SocketCAN protocol violation types in data[2] */
+const uint8_t CanErrProtBit = 0x01;
+const uint8_t CanErrProtForm = 0x02;
+const uint8_t CanErrProtStuff = 0x04;
+const uint8_t CanErrProtTx = 0x80;
+
+/** dlc of CAN FD data length */
+uint8_t lengthToDlc(const std::size_t length) {
+    if (length <= 8)
+        return static_cast<uint8_t>(length);
+    if (length <= 24)
+        return static_cast<uint8_t>(9 + (length - 9) / 4);
+    if (length <= 32)
+        return 13;
+    if (length <= 48)
+        return 14;
+    return 15;
+}
+
+/** parse hex bytes up to end or a space, '.' separators are skipped */
+const char * parseHexBytes(const char * p, const char * end, const std::size_t maxSize, uint8_t * data, std::size_t & size) {
+    size = 0;
+    while ((p < end) && (*p != ' ') && (*p != '_')) {
+        if (*p == '.') {
+            ++p;
+            continue;
+        }
+        const int high = detail::hexDigit(*p);
+        const int low = (p + 1 < end) ? detail::hexDigit(p[1]) : -1;
+        if ((high < 0) || (low < 0) || (size >= maxSize))
+            return nullptr;
+        data[size++] = static_cast<uint8_t>((high << 4) | low);
+        p += 2;
+    }
+    return p;
+}
+
+}
+
+CandumpReader::CandumpReader(const std::string & filename, const std::size_t bufferSize) :
+    m_file(filename, std::ios_base::in | std::ios_base::binary),
+    m_buffer(std::max<std::size_t>(bufferSize, 256)) {
+    if (!m_file.is_open())
+        throw Exception("CandumpReader::CandumpReader(): Unable to open file.");
+}
+
+void CandumpReader::setChannel(const std::string & interface, const uint16_t channel) {
+    m_channels[interface] = channel;
+    m_lastInterface.clear();
+}
+
+const std::map<std::string, uint16_t> & CandumpReader::channels() const {
+    return m_channels;
+}
+
+void CandumpReader::setStartTime(const uint64_t startTime) {
+    m_startTime = startTime;
+    m_startTimeValid = true;
+}
+
+uint64_t CandumpReader::startTime() const {
+    return m_startTime;
+}
+
+SYSTEMTIME CandumpReader::startSystemTime() const {
+    SYSTEMTIME systemTime {};
+    const int64_t seconds = static_cast<int64_t>(m_startTime / 1000000000);
+    const int64_t days = seconds / 86400;
+    const int64_t secondOfDay = seconds % 86400;
+    detail::civilFromDays(days, systemTime);
+    systemTime.dayOfWeek = static_cast<uint16_t>((days + 4) % 7); // 1970-01-01 was a Thursday
+    systemTime.hour = static_cast<uint16_t>(secondOfDay / 3600);
+    systemTime.minute = static_cast<uint16_t>(secondOfDay / 60 % 60);
+    systemTime.second = static_cast<uint16_t>(secondOfDay % 60);
+    systemTime.milliseconds = static_cast<uint16_t>(m_startTime % 1000000000 / 1000000);
+    return systemTime;
+}
+
+ObjectHeaderBase * CandumpReader::read() {
+    while (nextLine()) {
+        ObjectHeaderBase * ohb = parseLine();
+        if (ohb == nullptr) {
+            m_skippedLineCount++;
+            continue;
+        }
+
+        /* absolute to relative timestamp */
+        auto * oh = static_cast<ObjectHeader *>(ohb);
+        if (!m_startTimeValid)
+            setStartTime(oh->objectTimeStamp);
+        oh->objectTimeStamp = (oh->objectTimeStamp > m_startTime) ? oh->objectTimeStamp - m_startTime : 0;
+        return ohb;
+    }
+    return nullptr;
+}
+
+uint64_t CandumpReader::copyTo(File & file, const uint64_t count) {
+    /* batches are enqueued at once, but not beyond the queue size */
+    const std::size_t batchSize = std::max<std::size_t>(std::min<std::size_t>(copyBatchSize, file.readWriteQueueSize()), 1);
+    std::vector<ObjectHeaderBase *> batch;
+    batch.reserve(batchSize);
+
+    uint64_t written = 0;
+    try {
+        while ((count == 0) || (written < count)) {
+            ObjectHeaderBase * ohb = read();
+            if (ohb == nullptr)
+                break;
+            if (file.fileStatistics.measurementStartTime.year == 0)
+                file.fileStatistics.measurementStartTime = startSystemTime();
+            batch.push_back(ohb);
+            written++;
+            if (batch.size() == batchSize) {
+                file.write(batch.data(), static_cast<uint32_t>(batch.size()));
+                batch.clear();
+            }
+        }
+    } catch (...) {
+        for (ObjectHeaderBase * ohb : batch)
+            delete ohb;
+        throw;
+    }
+    if (!batch.empty())
+        file.write(batch.data(), static_cast<uint32_t>(batch.size()));
+    return written;
+}
+
+uint64_t CandumpReader::skippedLineCount() const {
+    return m_skippedLineCount;
+}
+
+bool CandumpReader::nextLine() {
+    for (;;) {
+        const char * begin = m_buffer.data() + m_begin;
+        const char * end = m_buffer.data() + m_end;
+        const char * newline = static_cast<const char *>(std::memchr(begin, '\n', static_cast<std::size_t>(end - begin)));
+        if ((newline != nullptr) || (m_eof && (begin < end))) {
+            m_line = begin;
+            m_lineEnd = (newline != nullptr) ? newline : end;
+            m_begin = static_cast<std::size_t>(m_lineEnd - m_buffer.data()) + ((newline != nullptr) ? 1 : 0);
+            if ((m_lineEnd > m_line) && (m_lineEnd[-1] == '\r'))
+                m_lineEnd--;
+            return true;
+        }
+        if (m_eof)
+            return false;
+
+        /* move incomplete line to front, grow buffer if the line doesn't fit */
+        std::memmove(m_buffer.data(), begin, static_cast<std::size_t>(end - begin));
+        m_end -= m_begin;
+        m_begin = 0;
+        if (m_end == m_buffer.size())
+            m_buffer.resize(m_buffer.size() * 2);
+        m_file.read(m_buffer.data() + m_end, static_cast<std::streamsize>(m_buffer.size() - m_end));
+        m_end += static_cast<std::size_t>(m_file.gcount());
+        if (!m_file)
+            m_eof = true;
+    }
+}
+
+ObjectHeaderBase * CandumpReader::parseLine() {
+    const char * p = m_line;
+    const char * end = m_lineEnd;
+    while ((p < end) && (*p == ' '))
+        ++p;
+
+    /* (<s>.<fraction>) */
+    if ((p >= end) || (*p++ != '('))
+        return nullptr;
+    uint64_t seconds = 0;
+    const char * digits = p;
+    while ((p < end) && (*p >= '0') && (*p <= '9'))
+        seconds = seconds * 10 + static_cast<uint64_t>(*p++ - '0');
+    if ((p == digits) || (p >= end) || (*p++ != '.'))
+        return nullptr;
+    uint64_t fraction = 0;
+    uint64_t scale = 1000000000;
+    while ((p < end) && (*p >= '0') && (*p <= '9')) {
+        if (scale > 1) {
+            scale /= 10;
+            fraction += scale * static_cast<uint64_t>(*p - '0');
+        }
+        ++p;
+    }
+    if ((p >= end) || (*p++ != ')'))
+        return nullptr;
+    const uint64_t timeStamp = seconds * 1000000000 + fraction;
+
+    /* interface */
+    while ((p < end) && (*p == ' '))
+        ++p;
+    const char * interface = p;
+    while ((p < end) && (*p != ' '))
+        ++p;
+    if (p == interface)
+        return nullptr;
+    const uint16_t channel = this->channel(interface, static_cast<std::size_t>(p - interface));
+    while ((p < end) && (*p == ' '))
+        ++p;
+
+    /* <id>#... */
+    uint32_t id = 0;
+    const char * idBegin = p;
+    int digit;
+    while ((p < end) && ((digit = detail::hexDigit(*p)) >= 0)) {
+        id = (id << 4) | static_cast<uint32_t>(digit);
+        ++p;
+    }
+    const std::size_t idSize = static_cast<std::size_t>(p - idBegin);
+    if (((idSize != 3) && (idSize != 8)) || (p >= end) || (*p++ != '#'))
+        return nullptr;
+    const bool extended = (idSize == 8);
+
+    /* direction of candump -x at the end of the line */
+    const char * lineEnd = end;
+    while ((lineEnd > p) && (lineEnd[-1] == ' '))
+        --lineEnd;
+    bool tx = false;
+    if ((lineEnd - p >= 2) && (lineEnd[-2] == ' ') && ((lineEnd[-1] == 'T') || (lineEnd[-1] == 'R'))) {
+        tx = (lineEnd[-1] == 'T');
+        lineEnd -= 2;
+    }
+
+    /* CAN FD: ##<flags><data> */
+    if ((p < lineEnd) && (*p == '#')) {
+        ++p;
+        const int flags = (p < lineEnd) ? detail::hexDigit(*p++) : -1;
+        if (flags < 0)
+            return nullptr;
+        std::unique_ptr<CanFdMessage64> obj(new CanFdMessage64);
+        uint8_t data[64];
+        std::size_t size;
+        p = parseHexBytes(p, lineEnd, sizeof(data), data, size);
+        if ((p == nullptr) || (p != lineEnd))
+            return nullptr;
+        obj->channel = static_cast<uint8_t>(channel);
+        obj->dir = tx ? 1 : 0;
+        obj->id = id | (extended ? ExtendedId : 0);
+        obj->flags = CanFdFlagEdl | ((flags & 0x01) ? CanFdFlagBrs : 0) | ((flags & 0x02) ? CanFdFlagEsi : 0);
+        obj->dlc = lengthToDlc(size);
+        obj->validDataBytes = static_cast<uint8_t>(size);
+        obj->data.assign(data, data + size);
+        obj->objectTimeStamp = timeStamp;
+        return obj.release();
+    }
+
+    /* error frame: <class>#<data> */
+    if (extended && (id & CanErrFlag)) {
+        std::unique_ptr<CanErrorFrameExt> obj(new CanErrorFrameExt);
+        uint8_t data[8];
+        std::size_t size;
+        p = parseHexBytes(p, lineEnd, sizeof(data), data, size);
+        if ((p == nullptr) || (p != lineEnd))
+            return nullptr;
+        obj->channel = channel;
+        obj->dlc = static_cast<uint8_t>(size);
+        obj->data.assign(data, data + size);
+
+        /* protocol violation type as CAN-Core error code and direction */
+        if ((id & CanErrProt) && (size > 2)) {
+            const uint16_t errorCode =
+                (data[2] & CanErrProtBit) ? 0 :
+                (data[2] & CanErrProtForm) ? 1 :
+                (data[2] & CanErrProtStuff) ? 2 : 3;
+            obj->flags = 2;
+            obj->flagsExt = static_cast<uint16_t>((errorCode << 6) | (((data[2] & CanErrProtTx) ? 3 : 2) << 12));
+        }
+        obj->objectTimeStamp = timeStamp;
+        return obj.release();
+    }
+
+    /* CAN: #<data>[_<dlc>] or #R[<len>][_<dlc>] */
+    std::unique_ptr<CanMessage2> obj(new CanMessage2);
+    obj->channel = channel;
+    obj->flags = tx ? CanFlagTx : 0;
+    obj->id = id | (extended ? ExtendedId : 0);
+    if ((p < lineEnd) && (*p == 'R')) {
+        ++p;
+        obj->flags |= CanFlagRtr;
+        if ((p < lineEnd) && (*p >= '0') && (*p <= '8'))
+            obj->dlc = static_cast<uint8_t>(*p++ - '0');
+    } else {
+        uint8_t data[8];
+        std::size_t size;
+        p = parseHexBytes(p, lineEnd, sizeof(data), data, size);
+        if (p == nullptr)
+            return nullptr;
+        obj->dlc = static_cast<uint8_t>(size);
+        obj->data.assign(data, data + size);
+    }
+    if ((p + 1 < lineEnd) && (*p == '_')) {
+        /* dlc 9..15 of classic frames with 8 bytes */
+        const int dlc = detail::hexDigit(p[1]);
+        if (dlc < 0)
+            return nullptr;
+        obj->dlc = static_cast<uint8_t>(dlc);
+        p += 2;
+    }
+    if (p != lineEnd)
+        return nullptr;
+    obj->objectTimeStamp = timeStamp;
+    return obj.release();
+}
+
+uint16_t CandumpReader::channel(const char * interface, const std::size_t size) {
+    if ((m_lastInterface.size() == size) && (std::memcmp(m_lastInterface.data(), interface, size) == 0))
+        return m_lastChannel;
+
+    m_lastInterface.assign(interface, size);
+    auto it = m_channels.find(m_lastInterface);
+    if (it != m_channels.end()) {
+        m_lastChannel = it->second;
+        return m_lastChannel;
+    }
+
+    /* next free channel */
+    uint16_t channel = 1;
+    for (const auto & entry : m_channels)
+        channel = std::max<uint16_t>(channel, static_cast<uint16_t>(entry.second + 1));
+    m_channels[m_lastInterface] = channel;
+    m_lastChannel = channel;
+    return channel;
+}
+
+}
+}
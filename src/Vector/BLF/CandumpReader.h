@@ -0,0 +1,184 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <Vector/BLF/File.h>
+#include <Vector/BLF/FileStatistics.h>
+#include <Vector/BLF/ObjectHeaderBase.h>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * candump log reader
+ *
+ * Reads SocketCAN log files as written by "candump -l" and converts the
+ * frames into objects:
+ *   - "(<s>.<us>) <interface> <id>#<data>" and "<id>#R[<len>]" into CanMessage2
+ *   - "(<s>.<us>) <interface> <id>##<flags><data>" into CanFdMessage64
+ *   - frames with CAN_ERR_FLAG in the id into CanErrorFrameExt
+ *
+ * An optional trailing "T" or "R" (candump -x) sets the direction.
+ * Interfaces are mapped to BLF channels in order of appearance, starting
+ * with 1, unless they were assigned explicitly. Timestamps are converted
+ * into ns relative to the start time.
+ *
+ * Lines are scanned in place in a large read buffer, so there is no
+ * allocation per line besides the objects.
+ */
+class VECTOR_BLF_EXPORT CandumpReader final {
+  public:
+    /**
+     * constructor
+     *
+     * @param[in] filename file name
+     * @param[in] bufferSize size of read buffer
+     */
+    explicit CandumpReader(const std::string & filename, const std::size_t bufferSize = 4 * 1024 * 1024);
+    virtual ~CandumpReader() = default;
+    CandumpReader(const CandumpReader &) = delete;
+    CandumpReader & operator=(const CandumpReader &) = delete;
+
+    /**
+     * Assign BLF channel to an interface.
+     *
+     * @param[in] interface interface name, e.g. "can0"
+     * @param[in] channel application channel
+     */
+    virtual void setChannel(const std::string & interface, const uint16_t channel);
+
+    /**
+     * Get BLF channels of interfaces.
+     *
+     * @return channels by interface name
+     */
+    virtual const std::map<std::string, uint16_t> & channels() const;
+
+    /**
+     * Set start time, which is subtracted from frame timestamps.
+     *
+     * If not set, the timestamp of the first frame is used.
+     *
+     * @param[in] startTime start time in ns since 1970-01-01
+     */
+    virtual void setStartTime(const uint64_t startTime);
+
+    /**
+     * Get start time.
+     *
+     * @return start time in ns since 1970-01-01, or 0 if not known yet
+     */
+    virtual uint64_t startTime() const;
+
+    /**
+     * Get start time, e.g. for FileStatistics::measurementStartTime.
+     *
+     * @return start time in UTC
+     */
+    virtual SYSTEMTIME startSystemTime() const;
+
+    /**
+     * Read next frame.
+     *
+     * @return object, which has to be deleted by the caller, or nullptr at end of file
+     */
+    virtual ObjectHeaderBase * read();
+
+    /**
+     * Read frames and write them into a BLF file.
+     *
+     * Frames are written in batches of up to 256 objects, which are
+     * enqueued at once. File::write blocks while its queue is full, so
+     * objects don't pile up in memory. The measurement start time of the
+     * file is set from the first frame, if it's not set yet.
+     *
+     * @param[in] file BLF file opened for writing
+     * @param[in] count maximum number of frames, or 0 for all
+     * @return number of frames written
+     */
+    virtual uint64_t copyTo(File & file, const uint64_t count = 0);
+
+    /**
+     * Get number of lines, which were skipped as empty or malformed.
+     *
+     * @return line count
+     */
+    virtual uint64_t skippedLineCount() const;
+
+  private:
+    /** file */
+    std::ifstream m_file;
+
+    /** read buffer */
+    std::vector<char> m_buffer;
+
+    /** begin of unprocessed data in read buffer */
+    std::size_t m_begin {};
+
+    /** end of valid data in read buffer */
+    std::size_t m_end {};
+
+    /** end of file reached */
+    bool m_eof {false};
+
+    /** current line */
+    const char * m_line {};
+
+    /** end of current line */
+    const char * m_lineEnd {};
+
+    /** channels by interface name */
+    std::map<std::string, uint16_t> m_channels {};
+
+    /** interface name of last line, to skip the map lookup */
+    std::string m_lastInterface {};
+
+    /** channel of last line */
+    uint16_t m_lastChannel {};
+
+    /** start time in ns */
+    uint64_t m_startTime {};
+
+    /** start time is set */
+    bool m_startTimeValid {false};
+
+    /** number of skipped lines */
+    uint64_t m_skippedLineCount {};
+
+    /**
+     * Get next line from read buffer, refill if required.
+     *
+     * @return false at end of file
+     */
+    bool nextLine();
+
+    /**
+     * Parse current line.
+     *
+     * @return object or nullptr if line is malformed
+     */
+    ObjectHeaderBase * parseLine();
+
+    /**
+     * Get channel of interface, assign next free channel if it's new.
+     *
+     * @param[in] interface interface name
+     * @param[in] size length of interface name
+     * @return channel
+     */
+    uint16_t channel(const char * interface, const std::size_t size);
+};
+
+}
+}
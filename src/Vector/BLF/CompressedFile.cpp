@@ -4,9 +4,31 @@
 
 #include <Vector/BLF/CompressedFile.h>
 
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace Vector {
 namespace BLF {
 
+namespace {
+
+/** data read is dropped from page cache in chunks of this size */
+const uint64_t dropChunkSize = 0x100000;
+
+/** page size for alignment of the dropped ranges */
+const uint64_t pageSize = 0x1000;
+
+/** bytes kept to seek back in non-seekable input, covering object headers */
+const size_t lookbackSize = 0x100;
+
+}
+
 CompressedFile::~CompressedFile() {
     close();
 }
@@ -15,6 +37,10 @@ std::streamsize CompressedFile::gcount() const {
     /* mutex lock */
     std::lock_guard<std::mutex> lock(m_mutex);
 
+    if (m_ioUringFile)
+        return m_ioUringFile->gcount();
+    if (!m_seekable)
+        return m_gcount;
     return m_file.gcount();
 }
 
@@ -22,13 +48,35 @@ void CompressedFile::read(char * s, std::streamsize n) {
     /* mutex lock */
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    m_file.read(s, n);
+    std::streamsize count;
+    if (m_ioUringFile) {
+        m_ioUringFile->read(s, n);
+        count = m_ioUringFile->gcount();
+    } else if (!m_seekable) {
+        readForward(s, n);
+        count = m_gcount;
+    } else {
+        m_file.read(s, n);
+        count = m_file.gcount();
+    }
+
+    /* read policy */
+    m_readPosition += static_cast<uint64_t>(count);
+    adviseRead();
+
+    /* metrics */
+    if (m_metrics)
+        FileMetrics::add(m_metrics->compressedBytesRead, static_cast<uint64_t>(count));
 }
 
 std::streampos CompressedFile::tellg() {
     /* mutex lock */
     std::lock_guard<std::mutex> lock(m_mutex);
 
+    if (m_ioUringFile)
+        return m_ioUringFile->tellg();
+    if (!m_seekable)
+        return m_file.fail() ? std::streampos(-1) : std::streampos(static_cast<std::streamoff>(m_readPosition));
     return m_file.tellg();
 }
 
@@ -36,20 +84,49 @@ void CompressedFile::seekg(std::streamoff off, const std::ios_base::seekdir way)
     /* mutex lock */
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    m_file.seekg(off, way);
+    if (m_ioUringFile)
+        m_ioUringFile->seekg(off, way);
+    else if (!m_seekable)
+        seekForward(off, way);
+    else
+        m_file.seekg(off, way);
+
+    /* read policy, restart read ahead on large backward seeks */
+    if (m_reading && m_seekable && (m_readAheadSize || m_dropBehind)) {
+        const std::streamoff position = m_ioUringFile ? m_ioUringFile->tellg() : m_file.tellg();
+        if (position >= 0) {
+            m_readPosition = static_cast<uint64_t>(position);
+            if (m_readPosition + m_readAheadSize < m_adviseEnd)
+                m_adviseEnd = m_readPosition;
+            m_dropEnd = std::min(m_dropEnd, m_readPosition & ~(pageSize - 1));
+        }
+    }
 }
 
 void CompressedFile::write(const char * s, std::streamsize n) {
     /* mutex lock */
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    m_file.write(s, n);
+    bool good;
+    if (m_ioUringFile) {
+        m_ioUringFile->write(s, n);
+        good = m_ioUringFile->good();
+    } else {
+        m_file.write(s, n);
+        good = m_file.good();
+    }
+
+    /* metrics */
+    if (m_metrics && good)
+        FileMetrics::add(m_metrics->compressedBytesWritten, static_cast<uint64_t>(n));
 }
 
 std::streampos CompressedFile::tellp() {
     /* mutex lock */
     std::lock_guard<std::mutex> lock(m_mutex);
 
+    if (m_ioUringFile)
+        return m_ioUringFile->tellp();
     return m_file.tellp();
 }
 
@@ -57,6 +134,8 @@ bool CompressedFile::good() const {
     /* mutex lock */
     std::lock_guard<std::mutex> lock(m_mutex);
 
+    if (m_ioUringFile)
+        return m_ioUringFile->good();
     return m_file.good();
 }
 
@@ -64,35 +143,300 @@ bool CompressedFile::eof() const {
     /* mutex lock */
     std::lock_guard<std::mutex> lock(m_mutex);
 
+    if (m_ioUringFile)
+        return m_ioUringFile->eof();
     return m_file.eof();
 }
 
-void CompressedFile::open(const char * filename, std::ios_base::openmode openMode) {
+void CompressedFile::open(const char * filename, std::ios_base::openmode openMode, bool ioUring) {
     /* mutex lock */
     std::lock_guard<std::mutex> lock(m_mutex);
 
+    /* read policy */
+    m_reading = openMode & std::ios_base::in;
+    m_readPosition = 0;
+    m_adviseEnd = 0;
+    m_dropEnd = 0;
+
+    /* forward only reading */
+    m_seekable = true;
+    m_lookback.clear();
+    m_lookahead.clear();
+    m_lookaheadPosition = 0;
+    m_gcount = 0;
+
+    /* try io_uring first */
+    if (ioUring) {
+        m_ioUringFile.reset(new IoUringFile);
+        if (m_ioUringFile->open(filename, openMode)) {
+            m_filename = filename;
+            return;
+        }
+        m_ioUringFile.reset();
+    }
+
     m_file.open(filename, openMode);
+    m_filename = filename;
+
+    /* pipes etc. can't tell their position, so they are read forward only */
+    m_seekable = !m_reading || !m_file.is_open() || (m_file.tellg() != std::streampos(-1));
 }
 
 bool CompressedFile::is_open() const {
     /* mutex lock */
     std::lock_guard<std::mutex> lock(m_mutex);
 
+    if (m_ioUringFile)
+        return m_ioUringFile->is_open();
     return m_file.is_open();
 }
 
+bool CompressedFile::ioUring() const {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_ioUringFile != nullptr;
+}
+
 void CompressedFile::close() {
     /* mutex lock */
     std::lock_guard<std::mutex> lock(m_mutex);
 
+    /* drop the rest of the file from page cache */
+#if defined(POSIX_FADV_DONTNEED)
+    if (m_reading && m_dropBehind && (m_syncFd >= 0))
+        ::posix_fadvise(m_syncFd, static_cast<off_t>(m_dropEnd), 0, POSIX_FADV_DONTNEED);
+#endif
+    m_reading = false;
+
+    if (m_ioUringFile) {
+        m_ioUringFile->close();
+        m_ioUringFile.reset();
+    }
     m_file.close();
+
+    /* close sync handle */
+#if defined(_WIN32)
+    if (m_syncHandle) {
+        CloseHandle(m_syncHandle);
+        m_syncHandle = nullptr;
+    }
+#else
+    if (m_syncFd >= 0) {
+        ::close(m_syncFd);
+        m_syncFd = -1;
+    }
+#endif
 }
 
 void CompressedFile::seekp(std::streampos pos) {
     /* mutex lock */
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    m_file.seekp(pos);
+    if (m_ioUringFile)
+        m_ioUringFile->seekp(pos);
+    else
+        m_file.seekp(pos);
+}
+
+void CompressedFile::clear() {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_ioUringFile)
+        m_ioUringFile->clear();
+    else
+        m_file.clear();
+}
+
+void CompressedFile::setMetrics(FileMetrics * metrics) {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_metrics = metrics;
+}
+
+void CompressedFile::setReadPolicy(uint64_t readAheadSize, bool dropBehind) {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_readAheadSize = readAheadSize;
+    m_dropBehind = dropBehind;
+
+    /* position isn't tracked across seeks without read policy */
+    if (m_reading) {
+        const std::streamoff position = m_ioUringFile ? m_ioUringFile->tellg() : m_file.tellg();
+        if (position >= 0) {
+            m_readPosition = static_cast<uint64_t>(position);
+            m_adviseEnd = m_readPosition;
+            m_dropEnd = m_readPosition & ~(pageSize - 1);
+        }
+    }
+}
+
+void CompressedFile::flush() {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_ioUringFile)
+        m_ioUringFile->flush();
+    else
+        m_file.flush();
+}
+
+bool CompressedFile::sync() {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    /* io_uring file has its own descriptor */
+    if (m_ioUringFile) {
+        const uint64_t syncBegin = FileMetrics::now();
+        const bool synced = m_ioUringFile->sync();
+        if (m_metrics)
+            FileMetrics::add(m_metrics->syncTime, FileMetrics::now() - syncBegin);
+        return synced;
+    }
+
+    /* flush stream buffer to the operating system */
+    m_file.flush();
+    if (!m_file.good())
+        return false;
+
+    /*
+     * std::fstream doesn't expose its descriptor, so a second handle is opened.
+     * Syncing it writes back the dirty pages of the file, regardless of the handle.
+     */
+    const uint64_t syncBegin = FileMetrics::now();
+    if (!openSyncHandle())
+        return false;
+#if defined(_WIN32)
+    const bool synced = FlushFileBuffers(m_syncHandle) != 0;
+#else
+#if defined(__APPLE__)
+    const bool synced = (::fsync(m_syncFd) == 0);
+#else
+    const bool synced = (::fdatasync(m_syncFd) == 0);
+#endif
+#endif
+
+    /* metrics */
+    if (m_metrics)
+        FileMetrics::add(m_metrics->syncTime, FileMetrics::now() - syncBegin);
+
+    return synced;
+}
+
+bool CompressedFile::openSyncHandle() {
+#if defined(_WIN32)
+    if (!m_syncHandle) {
+        HANDLE handle = CreateFileA(m_filename.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE)
+            return false;
+        m_syncHandle = handle;
+    }
+#else
+    if (m_syncFd < 0) {
+        m_syncFd = ::open(m_filename.c_str(), O_RDONLY);
+        if (m_syncFd < 0)
+            return false;
+    }
+#endif
+    return true;
+}
+
+void CompressedFile::adviseRead() {
+#if defined(POSIX_FADV_WILLNEED)
+    if (!m_reading || !m_seekable || (!m_readAheadSize && !m_dropBehind))
+        return;
+    if (!openSyncHandle())
+        return;
+
+    /* read ahead, once half of the window is consumed */
+    if (m_readAheadSize && (m_readPosition + m_readAheadSize / 2 >= m_adviseEnd)) {
+        const uint64_t begin = std::max(m_readPosition, m_adviseEnd);
+        const uint64_t end = m_readPosition + m_readAheadSize;
+        ::posix_fadvise(m_syncFd, static_cast<off_t>(begin), static_cast<off_t>(end - begin), POSIX_FADV_WILLNEED);
+        m_adviseEnd = end;
+    }
+
+    /* drop data already read, in chunks */
+    if (m_dropBehind && (m_readPosition >= m_dropEnd + dropChunkSize)) {
+        const uint64_t end = m_readPosition & ~(pageSize - 1);
+        ::posix_fadvise(m_syncFd, static_cast<off_t>(m_dropEnd), static_cast<off_t>(end - m_dropEnd), POSIX_FADV_DONTNEED);
+        m_dropEnd = end;
+    }
+#endif
+}
+
+void CompressedFile::readForward(char * s, std::streamsize n) {
+    /* bytes seeked back first */
+    const std::streamsize pushedBack = std::min(n, static_cast<std::streamsize>(m_lookahead.size() - m_lookaheadPosition));
+    std::copy(m_lookahead.cbegin() + static_cast<std::ptrdiff_t>(m_lookaheadPosition), m_lookahead.cbegin() + static_cast<std::ptrdiff_t>(m_lookaheadPosition) + pushedBack, s);
+    m_lookaheadPosition += static_cast<size_t>(pushedBack);
+    if (m_lookaheadPosition == m_lookahead.size()) {
+        m_lookahead.clear();
+        m_lookaheadPosition = 0;
+    }
+
+    /* then from the stream */
+    m_gcount = pushedBack;
+    if (n > pushedBack) {
+        m_file.read(s + pushedBack, n - pushedBack);
+        m_gcount += m_file.gcount();
+    }
+
+    /* keep the last bytes */
+    const size_t count = static_cast<size_t>(m_gcount);
+    if (count >= lookbackSize)
+        m_lookback.assign(s + count - lookbackSize, s + count);
+    else {
+        m_lookback.insert(m_lookback.end(), s, s + count);
+        if (m_lookback.size() > 2 * lookbackSize)
+            m_lookback.erase(m_lookback.begin(), m_lookback.end() - lookbackSize);
+    }
+}
+
+void CompressedFile::seekForward(std::streamoff off, const std::ios_base::seekdir way) {
+    /* like std::istream::seekg */
+    m_file.clear(m_file.rdstate() & ~std::ios_base::eofbit);
+    if (m_file.fail())
+        return;
+
+    /* relative offset */
+    std::streamoff relative;
+    if (way == std::ios_base::cur)
+        relative = off;
+    else if (way == std::ios_base::beg)
+        relative = off - static_cast<std::streamoff>(m_readPosition);
+    else {
+        m_file.setstate(std::ios_base::failbit);
+        return;
+    }
+
+    if (relative < 0) {
+        /* seek back within the lookback buffer */
+        const size_t count = static_cast<size_t>(-relative);
+        if (count > m_lookback.size()) {
+            m_file.setstate(std::ios_base::failbit);
+            return;
+        }
+        std::vector<char> lookahead(m_lookback.end() - static_cast<std::ptrdiff_t>(count), m_lookback.end());
+        lookahead.insert(lookahead.end(), m_lookahead.begin() + static_cast<std::ptrdiff_t>(m_lookaheadPosition), m_lookahead.end());
+        m_lookahead.swap(lookahead);
+        m_lookaheadPosition = 0;
+        m_lookback.resize(m_lookback.size() - count);
+        m_readPosition -= count;
+    } else {
+        /* seek forward by skipping bytes */
+        std::vector<char> skipped(static_cast<size_t>(std::min<std::streamoff>(relative, 0x1000)));
+        while ((relative > 0) && m_file.good()) {
+            readForward(skipped.data(), std::min<std::streamoff>(relative, static_cast<std::streamoff>(skipped.size())));
+            if (m_gcount == 0)
+                break;
+            relative -= m_gcount;
+            m_readPosition += static_cast<uint64_t>(m_gcount);
+        }
+    }
 }
 
 }
@@ -7,9 +7,14 @@
 #include <Vector/BLF/platform.h>
 
 #include <fstream>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <vector>
 
 #include <Vector/BLF/AbstractFile.h>
+#include <Vector/BLF/FileMetrics.h>
+#include <Vector/BLF/IoUringFile.h>
 
 #include <Vector/BLF/vector_blf_export.h>
 
@@ -19,6 +24,10 @@ namespace BLF {
 /**
  * CompressedFile (Input/output file stream)
  *
+ * Non-seekable input, like pipes, is read forward only. Seeking back over
+ * the last bytes read is served from a lookback buffer, and seeking forward
+ * skips the bytes.
+ *
  * This class is thread-safe.
  */
 class VECTOR_BLF_EXPORT CompressedFile final : public AbstractFile {
@@ -44,8 +53,9 @@ class VECTOR_BLF_EXPORT CompressedFile final : public AbstractFile {
      *
      * @param filename file name
      * @param openMode open in read or write mode
+     * @param ioUring try IoUringFile first, and fall back to std::fstream
      */
-    virtual void open(const char * filename, std::ios_base::openmode openMode);
+    virtual void open(const char * filename, std::ios_base::openmode openMode, bool ioUring = false);
 
     /**
      * is file open?
@@ -54,6 +64,13 @@ class VECTOR_BLF_EXPORT CompressedFile final : public AbstractFile {
      */
     virtual bool is_open() const;
 
+    /**
+     * Is the file opened with io_uring?
+     *
+     * @return true if IoUringFile is used
+     */
+    virtual bool ioUring() const;
+
     /**
      * Close file.
      */
@@ -66,14 +83,134 @@ class VECTOR_BLF_EXPORT CompressedFile final : public AbstractFile {
      */
     virtual void seekp(std::streampos pos);
 
+    /**
+     * Clear the error state, e.g. to read again after the file has grown.
+     */
+    virtual void clear();
+
+    /**
+     * Set metrics, which receive the bytes read and written.
+     *
+     * @param[in] metrics metrics or nullptr
+     */
+    virtual void setMetrics(FileMetrics * metrics);
+
+    /**
+     * Set read policy for sequential scans.
+     *
+     * The operating system is advised to read the next window ahead
+     * (POSIX_FADV_WILLNEED). With dropBehind, data already read is dropped
+     * from the page cache (POSIX_FADV_DONTNEED), so that scans of large
+     * files don't evict the cached data of other processes.
+     * This has no effect on systems without posix_fadvise.
+     *
+     * @param[in] readAheadSize read ahead window in bytes, 0 disables
+     * @param[in] dropBehind drop data already read from the page cache
+     */
+    virtual void setReadPolicy(uint64_t readAheadSize, bool dropBehind);
+
+    /**
+     * Flush the stream buffer to the operating system.
+     *
+     * Other processes can read the data then, but it's not necessarily on disk.
+     */
+    virtual void flush();
+
+    /**
+     * Flush the stream buffer and sync the file data to disk.
+     *
+     * This uses fdatasync (POSIX) or FlushFileBuffers (Windows).
+     *
+     * @return true if the data is on disk
+     */
+    virtual bool sync();
+
   private:
     /**
      * file stream
      */
     std::fstream m_file {};
 
+    /** io_uring file, used instead of m_file if set */
+    std::unique_ptr<IoUringFile> m_ioUringFile {};
+
+    /** file name, to open a handle for sync */
+    std::string m_filename {};
+
+#if defined(_WIN32)
+    /** handle for sync */
+    void * m_syncHandle {};
+#else
+    /** file descriptor for sync and fadvise */
+    int m_syncFd {-1};
+#endif
+
+    /** opened for reading */
+    bool m_reading {};
+
+    /** input can seek, otherwise it's read forward only */
+    bool m_seekable {true};
+
+    /** last bytes read from non-seekable input, to seek back */
+    std::vector<char> m_lookback {};
+
+    /** bytes seeked back, to be read again */
+    std::vector<char> m_lookahead {};
+
+    /** position in m_lookahead */
+    size_t m_lookaheadPosition {};
+
+    /** last read size from non-seekable input */
+    std::streamsize m_gcount {};
+
+    /** read ahead window */
+    uint64_t m_readAheadSize {};
+
+    /** drop data already read from page cache */
+    bool m_dropBehind {};
+
+    /** read position, tracked to avoid tellg calls */
+    uint64_t m_readPosition {};
+
+    /** end of the range advised to be read ahead */
+    uint64_t m_adviseEnd {};
+
+    /** begin of the range not dropped from page cache yet */
+    uint64_t m_dropEnd {};
+
     /** mutex */
     mutable std::mutex m_mutex {};
+
+    /** metrics */
+    FileMetrics * m_metrics {};
+
+    /**
+     * Open the descriptor for sync and fadvise.
+     *
+     * @return true if the descriptor is open
+     */
+    bool openSyncHandle();
+
+    /**
+     * Apply the read policy at the current read position.
+     */
+    void adviseRead();
+
+    /**
+     * Read from non-seekable input, after the bytes seeked back.
+     *
+     * @param[out] s data
+     * @param[in] n size
+     */
+    void readForward(char * s, std::streamsize n);
+
+    /**
+     * Seek in non-seekable input, within the lookback buffer or forward.
+     *
+     * @param[in] off offset
+     * @param[in] way direction
+     */
+    void seekForward(std::streamoff off, const std::ios_base::seekdir way);
 };
 
 }
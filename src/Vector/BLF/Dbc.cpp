@@ -0,0 +1,144 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/Dbc.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include <Vector/BLF/Exceptions.h>
+
+namespace Vector {
+namespace BLF {
+
+namespace {
+
+/** returns true if line starts with keyword followed by whitespace */
+bool startsWith(const std::string & line, const char * keyword) {
+    std::size_t pos = line.find_first_not_of(" \t");
+    if (pos == std::string::npos)
+        return false;
+    std::size_t length = std::char_traits<char>::length(keyword);
+    if (line.compare(pos, length, keyword) != 0)
+        return false;
+    return (pos + length < line.size()) && ((line[pos + length] == ' ') || (line[pos + length] == '\t'));
+}
+
+/** parse signal line */
+Dbc::Signal parseSignal(const std::string & line) {
+    Dbc::Signal signal;
+
+    /* name and multiplexing */
+    std::size_t colon = line.find(':');
+    if (colon == std::string::npos)
+        throw Exception(("Dbc::parse(): Invalid signal: " + line).c_str());
+    std::istringstream head(line.substr(0, colon));
+    std::string keyword;
+    std::string multiplex;
+    head >> keyword >> signal.name >> multiplex;
+    if (multiplex == "M") {
+        signal.multiplex = Dbc::Signal::Multiplex::Multiplexor;
+    } else if ((multiplex.size() > 1) && (multiplex[0] == 'm')) {
+        /* extended multiplexing (mNM) is treated as multiplexed */
+        signal.multiplex = Dbc::Signal::Multiplex::Multiplexed;
+        signal.multiplexValue = static_cast<uint32_t>(std::strtoul(multiplex.c_str() + 1, nullptr, 10));
+    }
+
+    /* layout, scaling and range */
+    unsigned int startBit;
+    unsigned int length;
+    char byteOrder;
+    char valueType;
+    if (std::sscanf(line.c_str() + colon + 1, " %u | %u @ %c %c ( %lf , %lf ) [ %lf | %lf ]",
+                    &startBit, &length, &byteOrder, &valueType,
+                    &signal.factor, &signal.offset, &signal.minimum, &signal.maximum) != 8)
+        throw Exception(("Dbc::parse(): Invalid signal: " + line).c_str());
+    if ((length < 1) || (length > 64) || (startBit > 511))
+        throw Exception(("Dbc::parse(): Invalid signal layout: " + line).c_str());
+    signal.startBit = static_cast<uint16_t>(startBit);
+    signal.length = static_cast<uint8_t>(length);
+    signal.bigEndian = (byteOrder == '0');
+    signal.isSigned = (valueType == '-');
+
+    /* unit */
+    std::size_t unitBegin = line.find('"', colon);
+    if (unitBegin != std::string::npos) {
+        std::size_t unitEnd = line.find('"', unitBegin + 1);
+        if (unitEnd != std::string::npos)
+            signal.unit = line.substr(unitBegin + 1, unitEnd - unitBegin - 1);
+    }
+
+    return signal;
+}
+
+}
+
+void Dbc::load(const char * filename) {
+    std::ifstream is(filename);
+    if (!is.is_open())
+        throw Exception("Dbc::load(): Unable to open file.");
+    parse(is);
+}
+
+void Dbc::parse(std::istream & is) {
+    std::string line;
+    Message * message = nullptr;
+    bool inString = false;
+    while (std::getline(is, line)) {
+        if (!line.empty() && (line.back() == '\r'))
+            line.pop_back();
+
+        /* skip continuation lines of multi-line strings (e.g. comments) */
+        bool lineInString = inString;
+        if (std::count(line.begin(), line.end(), '"') % 2)
+            inString = !inString;
+        if (lineInString)
+            continue;
+
+        if (startsWith(line, "BO_")) {
+            std::istringstream iss(line);
+            std::string keyword;
+            unsigned long id;
+            std::string name;
+            unsigned int size;
+            iss >> keyword >> id >> name >> size >> std::ws;
+            if (iss.fail() || name.empty() || (name.back() != ':'))
+                throw Exception(("Dbc::parse(): Invalid message: " + line).c_str());
+            name.pop_back();
+
+            Message newMessage;
+            newMessage.id = static_cast<uint32_t>(id);
+            newMessage.name = name;
+            newMessage.size = static_cast<uint8_t>(size);
+            std::getline(iss, newMessage.transmitter);
+            m_messageIndex[newMessage.id] = m_messages.size();
+            m_messages.push_back(newMessage);
+            message = &m_messages.back();
+        } else if (startsWith(line, "SG_")) {
+            if (message == nullptr)
+                throw Exception(("Dbc::parse(): Signal without message: " + line).c_str());
+            message->signals.push_back(parseSignal(line));
+        } else if (line.find_first_not_of(" \t") == std::string::npos) {
+            /* an empty line ends the signal list */
+            message = nullptr;
+        }
+    }
+}
+
+const std::vector<Dbc::Message> & Dbc::messages() const {
+    return m_messages;
+}
+
+const Dbc::Message * Dbc::message(const uint32_t id) const {
+    auto it = m_messageIndex.find(id);
+    if (it == m_messageIndex.end())
+        return nullptr;
+    return &m_messages[it->second];
+}
+
+}
+}
@@ -0,0 +1,138 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * DBC database
+ *
+ * Loads messages (BO_) and signals (SG_) from a DBC file. Other sections
+ * are skipped. Message IDs are used as in the objects, i.e. bit 31 set for
+ * extended ids.
+ */
+class VECTOR_BLF_EXPORT Dbc final {
+  public:
+    /** signal */
+    struct Signal {
+        /** multiplexing */
+        enum class Multiplex : uint8_t {
+            /** plain signal */
+            None,
+
+            /** multiplexor switch (M) */
+            Multiplexor,
+
+            /** multiplexed signal (mN) */
+            Multiplexed
+        };
+
+        /** name */
+        std::string name {};
+
+        /** start bit (LSB for Intel, MSB for Motorola) */
+        uint16_t startBit {};
+
+        /** length in bits */
+        uint8_t length {};
+
+        /** byte order (false: Intel/little endian, true: Motorola/big endian) */
+        bool bigEndian {};
+
+        /** value is signed */
+        bool isSigned {};
+
+        /** factor */
+        double factor {1.0};
+
+        /** offset */
+        double offset {};
+
+        /** minimum */
+        double minimum {};
+
+        /** maximum */
+        double maximum {};
+
+        /** unit */
+        std::string unit {};
+
+        /** multiplexing */
+        Multiplex multiplex {Multiplex::None};
+
+        /** multiplexor value (if multiplexed) */
+        uint32_t multiplexValue {};
+    };
+
+    /** message */
+    struct Message {
+        /** CAN ID */
+        uint32_t id {};
+
+        /** name */
+        std::string name {};
+
+        /** size in bytes */
+        uint8_t size {};
+
+        /** transmitter */
+        std::string transmitter {};
+
+        /** signals */
+        std::vector<Signal> signals {};
+    };
+
+    Dbc() = default;
+    virtual ~Dbc() = default;
+
+    /**
+     * Load a DBC file.
+     *
+     * @param[in] filename file name
+     */
+    virtual void load(const char * filename);
+
+    /**
+     * Parse a DBC stream.
+     *
+     * @param[in] is input stream
+     */
+    virtual void parse(std::istream & is);
+
+    /**
+     * Get messages.
+     *
+     * @return messages in file order
+     */
+    virtual const std::vector<Message> & messages() const;
+
+    /**
+     * Get message by CAN ID.
+     *
+     * @param[in] id CAN ID
+     * @return message or nullptr if not found
+     */
+    virtual const Message * message(const uint32_t id) const;
+
+  private:
+    /** messages */
+    std::vector<Message> m_messages {};
+
+    /** message indices by CAN ID */
+    std::map<uint32_t, std::size_t> m_messageIndex {};
+};
+
+}
+}
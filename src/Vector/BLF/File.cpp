@@ -4,6 +4,8 @@
 
 #include <Vector/BLF/File.h>
 
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <iostream>
 
@@ -12,10 +14,37 @@
 namespace Vector {
 namespace BLF {
 
+namespace {
+
+/** objects processed per iteration of the uncompressedFileThread, so one trace span covers a batch */
+const uint32_t objectsPerBatch = 256;
+
+/** interval in which flush checks, that the pipeline threads are still running */
+const std::chrono::milliseconds flushCheckInterval(100);
+
+/** marks the position of a flush request in the readWriteQueue */
+class FlushRequest final : public ObjectHeaderBase {
+  public:
+    FlushRequest() :
+        ObjectHeaderBase(0, ObjectType::UNKNOWN) {
+    }
+};
+
+}
+
 File::File() {
     /* set performance/memory values */
     m_readWriteQueue.setBufferSize(10);
     m_uncompressedFile.setBufferSize(m_uncompressedFile.defaultLogContainerSize());
+
+    /* metrics */
+    m_readWriteQueue.setMetrics(&metrics);
+    m_uncompressedFile.setMetrics(&metrics);
+    m_compressedFile.setMetrics(&metrics);
+#ifdef OPTION_USE_TRACING
+    m_readWriteQueue.setTracer(&m_tracer);
+    m_uncompressedFile.setTracer(&m_tracer);
+#endif
 }
 
 File::~File() {
@@ -28,10 +57,15 @@ void File::open(const char * filename, const std::ios_base::openmode mode) {
         return;
 
     /* try to open file */
-    m_compressedFile.open(filename, mode | std::ios_base::binary);
+    m_compressedFile.setReadPolicy(static_cast<uint64_t>(readAheadContainers) * m_uncompressedFile.defaultLogContainerSize(), dropPageCache);
+    m_compressedFile.open(filename, mode | std::ios_base::binary, useIoUring);
     if (!m_compressedFile.is_open())
         return;
     m_openMode = mode;
+    VECTOR_BLF_TRACE_THREAD_NAME(&m_tracer, "application");
+
+    /* watermarks */
+    m_readWriteQueue.setWatermarks(lowWatermark, highWatermark, watermarkCallback);
 
     /* read */
     if (mode & std::ios_base::in) {
@@ -61,6 +95,35 @@ void File::open(const char * filename, const std::ios_base::openmode mode) {
             /* fileStatistics done */
             currentUncompressedFileSize += fileStatistics.statisticsSize;
 
+            /* checkpoints */
+            m_lastCheckpointTime = FileMetrics::now();
+            m_lastCheckpointFileSize = static_cast<uint64_t>(m_compressedFile.tellp());
+            m_writtenObjectCount = 0;
+            m_writtenObjectPosition = 0;
+            m_objectPositions.clear();
+            m_lastObjectPosition = std::make_pair(std::streampos(0), 0U);
+            m_logContainerEnd = m_uncompressedFile.defaultLogContainerSize();
+
+            /* flush */
+            {
+                /* mutex lock */
+                std::lock_guard<std::mutex> lock(m_flushMutex);
+
+                m_flushRequests = 0;
+                m_flushesPending = 0;
+                m_flushesCompleted = 0;
+                m_flushPosition = 0;
+                m_writtenPosition = 0;
+            }
+
+            /* dropped objects */
+            {
+                /* mutex lock */
+                std::lock_guard<std::mutex> lock(m_objectsLostMutex);
+
+                m_objectsLost = 0;
+            }
+
             /* prepare threads */
             m_uncompressedFileThreadRunning = true;
             m_compressedFileThreadRunning = true;
@@ -89,16 +152,140 @@ bool File::eof() const {
 
 ObjectHeaderBase * File::read() {
     /* read object */
+    VECTOR_BLF_TRACE_SPAN(&m_tracer, "read", currentObjectCount);
     ObjectHeaderBase * ohb = m_readWriteQueue.read();
 
     return ohb;
 }
 
+ObjectHeaderBase * File::tryRead() {
+    return read(0);
+}
+
+ObjectHeaderBase * File::read(uint32_t timeout) {
+    /* read object */
+    VECTOR_BLF_TRACE_SPAN(&m_tracer, "read", currentObjectCount);
+    ObjectHeaderBase * ohb = m_readWriteQueue.read(std::chrono::milliseconds(timeout));
+
+    return ohb;
+}
+
 void File::write(ObjectHeaderBase * ohb) {
+    if (ohb == nullptr)
+        return;
+
     /* push to queue */
+    VECTOR_BLF_TRACE_SPAN(&m_tracer, "write", currentObjectCount);
     m_readWriteQueue.write(ohb);
 }
 
+void File::write(ObjectHeaderBase * const * ohbs, uint32_t count) {
+    VECTOR_BLF_TRACE_SPAN(&m_tracer, "write", currentObjectCount);
+
+    /* nullptr is ignored */
+    if (std::find(ohbs, ohbs + count, nullptr) != ohbs + count) {
+        std::vector<ObjectHeaderBase *> objs;
+        std::remove_copy(ohbs, ohbs + count, std::back_inserter(objs), nullptr);
+        m_readWriteQueue.write(objs.data(), static_cast<uint32_t>(objs.size()));
+        return;
+    }
+
+    /* push to queue */
+    m_readWriteQueue.write(ohbs, count);
+}
+
+bool File::tryWrite(ObjectHeaderBase * ohb) {
+    return write(ohb, 0);
+}
+
+bool File::write(ObjectHeaderBase * ohb, uint32_t timeout) {
+    if (ohb == nullptr)
+        return false;
+    VECTOR_BLF_TRACE_SPAN(&m_tracer, "write", currentObjectCount);
+
+    /* the first object, which fits in again, ends the dropped span */
+    ObjectHeaderBase * objs[3];
+    uint32_t count = 0;
+    ObjectHeaderBase * dataLostBegin = nullptr;
+    ObjectHeaderBase * dataLostEnd = nullptr;
+    uint32_t objectsLost;
+    uint64_t firstObjectLostTimeStamp;
+    uint64_t lastObjectLostTimeStamp;
+    {
+        /* mutex lock */
+        std::lock_guard<std::mutex> lock(m_objectsLostMutex);
+
+        /* take over the dropped span, so that it's reported once */
+        objectsLost = m_objectsLost;
+        firstObjectLostTimeStamp = m_firstObjectLostTimeStamp;
+        lastObjectLostTimeStamp = m_lastObjectLostTimeStamp;
+        if ((m_objectsLost > 0) && writeDataLostObjects) {
+            createDataLostObjects(dataLostBegin, dataLostEnd);
+            objs[count++] = dataLostBegin;
+            objs[count++] = dataLostEnd;
+        }
+        m_objectsLost = 0;
+    }
+    objs[count++] = ohb;
+
+    /* push to queue, unlocked, so that concurrent producers don't wait for each other */
+    if (m_readWriteQueue.write(objs, count, std::chrono::milliseconds(timeout)))
+        return true;
+
+    /* drop object */
+    delete dataLostBegin;
+    delete dataLostEnd;
+    const uint64_t timeStamp = objectTimeStampNs(*ohb);
+    delete ohb;
+    FileMetrics::add(metrics.objectsDropped, 1);
+
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_objectsLostMutex);
+
+    /* give back the dropped span, merged with objects dropped meanwhile */
+    if (objectsLost > 0) {
+        if (m_objectsLost == 0) {
+            m_firstObjectLostTimeStamp = firstObjectLostTimeStamp;
+            m_lastObjectLostTimeStamp = lastObjectLostTimeStamp;
+        } else {
+            m_firstObjectLostTimeStamp = std::min(m_firstObjectLostTimeStamp, firstObjectLostTimeStamp);
+            m_lastObjectLostTimeStamp = std::max(m_lastObjectLostTimeStamp, lastObjectLostTimeStamp);
+        }
+        m_objectsLost += objectsLost;
+    }
+    if (m_objectsLost == 0) {
+        m_firstObjectLostTimeStamp = timeStamp;
+        m_lastObjectLostTimeStamp = timeStamp;
+    } else
+        m_lastObjectLostTimeStamp = std::max(m_lastObjectLostTimeStamp, timeStamp);
+    m_objectsLost++;
+    return false;
+}
+
+void File::flush() {
+    /* check if file is open for writing */
+    if (!is_open() || !(m_openMode & std::ios_base::out))
+        return;
+    VECTOR_BLF_TRACE_SPAN(&m_tracer, "flush", currentObjectCount);
+
+    /* request */
+    uint32_t flushRequest;
+    {
+        /* mutex lock */
+        std::lock_guard<std::mutex> lock(m_flushMutex);
+
+        flushRequest = ++m_flushRequests;
+    }
+
+    /* mark the position in the readWriteQueue */
+    m_readWriteQueue.write(new FlushRequest);
+
+    /* wait until written */
+    std::unique_lock<std::mutex> lock(m_flushMutex);
+    while ((m_flushesCompleted < flushRequest) && m_uncompressedFileThreadRunning && m_compressedFileThreadRunning)
+        m_flushCondition.wait_for(lock, flushCheckInterval);
+}
+
 void File::close() {
     /* check if file is open */
     if (!is_open())
@@ -108,6 +295,11 @@ void File::close() {
     if (m_openMode & std::ios_base::in) {
         /* finalize compressedFileThread */
         m_compressedFileThreadRunning = false;
+        {
+            /* mutex lock */
+            std::lock_guard<std::mutex> lock(m_followMutex);
+        }
+        m_followCondition.notify_all();
         m_compressedFile.close();
 
         /* finalize uncompressedFileThread */
@@ -128,6 +320,21 @@ void File::close() {
 
     /* write */
     if (m_openMode & std::ios_base::out) {
+        /* mark objects dropped at the end */
+        {
+            /* mutex lock */
+            std::lock_guard<std::mutex> lock(m_objectsLostMutex);
+
+            if ((m_objectsLost > 0) && writeDataLostObjects) {
+                ObjectHeaderBase * dataLostBegin;
+                ObjectHeaderBase * dataLostEnd;
+                createDataLostObjects(dataLostBegin, dataLostEnd);
+                m_readWriteQueue.write(dataLostBegin);
+                m_readWriteQueue.write(dataLostEnd);
+            }
+            m_objectsLost = 0;
+        }
+
         /* set eof */
         m_readWriteQueue.setFileSize(m_readWriteQueue.tellp()); // set eof
 
@@ -181,6 +388,13 @@ void File::close() {
         fileStatistics.write(m_compressedFile);
         m_compressedFile.close();
     }
+
+#ifdef OPTION_USE_TRACING
+    /* write timeline, all pipeline threads are finished */
+    if (!traceFilename.empty())
+        m_tracer.write(traceFilename);
+    m_tracer.clear();
+#endif
 }
 
 uint32_t File::defaultLogContainerSize() const {
@@ -191,6 +405,22 @@ void File::setDefaultLogContainerSize(uint32_t defaultLogContainerSize) {
     m_uncompressedFile.setDefaultLogContainerSize(defaultLogContainerSize);
 }
 
+uint32_t File::readWriteQueueSize() const {
+    return m_readWriteQueue.bufferSize();
+}
+
+void File::setReadWriteQueueSize(uint32_t readWriteQueueSize) {
+    m_readWriteQueue.setBufferSize(readWriteQueueSize);
+}
+
+uint32_t File::maxLatency() const {
+    return m_uncompressedFile.maxLatency();
+}
+
+void File::setMaxLatency(uint32_t maxLatency) {
+    m_uncompressedFile.setMaxLatency(maxLatency);
+}
+
 ObjectHeaderBase * File::createObject(ObjectType type) {
     ObjectHeaderBase * obj = nullptr;
 
@@ -698,6 +928,60 @@ ObjectHeaderBase * File::createObject(ObjectType type) {
     return obj;
 }
 
+bool File::probe(const std::string & filename, FileStatistics & fileStatistics, std::vector<AppText> * appTexts) {
+    /* open file */
+    CompressedFile compressedFile;
+    compressedFile.open(filename.c_str(), std::ios_base::in | std::ios_base::binary);
+    if (!compressedFile.is_open())
+        return false;
+
+    /* read file statistics */
+    try {
+        fileStatistics.read(compressedFile);
+    } catch (Vector::BLF::Exception &) {
+        return false;
+    }
+    if (!compressedFile.good())
+        return false;
+    if (appTexts == nullptr)
+        return true;
+
+    try {
+        /* read first log container */
+        compressedFile.seekg(fileStatistics.statisticsSize, std::ios_base::beg);
+        ObjectHeaderBase ohb(0, ObjectType::UNKNOWN);
+        ohb.read(compressedFile);
+        if (!compressedFile.good() || (ohb.objectType != ObjectType::LOG_CONTAINER))
+            return true;
+        compressedFile.seekg(-ohb.calculateHeaderSize(), std::ios_base::cur);
+        std::shared_ptr<LogContainer> logContainer(new LogContainer);
+        logContainer->read(compressedFile);
+        if (!compressedFile.good())
+            return true;
+        logContainer->uncompress();
+
+        /* read leading AppText objects */
+        UncompressedFile uncompressedFile;
+        uncompressedFile.write(logContainer);
+        uncompressedFile.setFileSize(uncompressedFile.tellp());
+        for (;;) {
+            ohb.read(uncompressedFile);
+            if (!uncompressedFile.good() || (ohb.objectType != ObjectType::APP_TEXT))
+                break;
+            uncompressedFile.seekg(-ohb.calculateHeaderSize(), std::ios_base::cur);
+            AppText appText;
+            appText.read(uncompressedFile);
+            if (!uncompressedFile.good())
+                break;
+            appTexts->push_back(appText);
+        }
+    } catch (Vector::BLF::Exception &) {
+        /* metadata is optional */
+    }
+
+    return true;
+}
+
 void File::uncompressedFile2ReadWriteQueue() {
     /* identify type */
     ObjectHeaderBase ohb(0, ObjectType::UNKNOWN);
@@ -733,13 +1017,14 @@ void File::uncompressedFile2ReadWriteQueue() {
         m_uncompressedFile.seekg(tmp);
     }
 
-    /* push data into readWriteQueue */
-    m_readWriteQueue.write(obj);
-
-    /* statistics */
+    /* statistics, before the object is handed over */
+    metrics.addObject(obj->objectType);
     if (obj->objectType != ObjectType::Unknown115)
         currentObjectCount++;
 
+    /* push data into readWriteQueue */
+    m_readWriteQueue.write(obj);
+
     /* drop old data */
     m_uncompressedFile.dropOldData();
 }
@@ -754,13 +1039,62 @@ void File::readWriteQueue2UncompressedFile() {
         return;
     }
 
+    /* flush request, so close the log container here */
+    if ((ohb->objectType == ObjectType::UNKNOWN) && dynamic_cast<FlushRequest *>(ohb)) {
+        delete ohb;
+        m_uncompressedFile.nextLogContainer();
+        const std::streampos position = m_uncompressedFile.tellp();
+        {
+            /* mutex lock */
+            std::lock_guard<std::mutex> lock(m_flushMutex);
+
+            m_flushesPending++;
+            m_flushPosition = position;
+        }
+        completeFlush();
+
+        /* the log container ends after the last object */
+        if (checkpointsEnabled()) {
+            {
+                /* mutex lock */
+                std::lock_guard<std::mutex> lock(m_objectPositionsMutex);
+
+                m_objectPositions.push_back(m_lastObjectPosition);
+            }
+            m_logContainerEnd = position + static_cast<std::streamoff>(m_uncompressedFile.defaultLogContainerSize());
+        }
+        return;
+    }
+
     /* write into uncompressedFile */
     ohb->write(m_uncompressedFile);
 
     /* statistics */
+    metrics.addObject(ohb->objectType);
     if (ohb->objectType != ObjectType::Unknown115)
         currentObjectCount++;
 
+    /* remember the last object end in each log container for checkpoints */
+    if (checkpointsEnabled()) {
+        const std::streampos position = m_uncompressedFile.tellp();
+        if (position >= m_logContainerEnd) {
+            {
+                /* mutex lock */
+                std::lock_guard<std::mutex> lock(m_objectPositionsMutex);
+
+                if (position == m_logContainerEnd)
+                    m_objectPositions.emplace_back(position, currentObjectCount);
+                else
+                    m_objectPositions.push_back(m_lastObjectPosition);
+            }
+
+            /* objects can span several log containers */
+            const std::streamoff logContainerSize = m_uncompressedFile.defaultLogContainerSize();
+            m_logContainerEnd += ((position - m_logContainerEnd) / logContainerSize + 1) * logContainerSize;
+        }
+        m_lastObjectPosition = std::make_pair(position, static_cast<uint32_t>(currentObjectCount));
+    }
+
     /* delete object */
     delete ohb;
 }
@@ -777,17 +1111,27 @@ void File::compressedFile2UncompressedFile() {
 
     /* read LogContainer */
     std::shared_ptr<LogContainer> logContainer(new LogContainer);
-    logContainer->read(m_compressedFile);
+    {
+        VECTOR_BLF_TRACE_SPAN(&m_tracer, "read log container", metrics.logContainersInflated);
+        logContainer->read(m_compressedFile);
+    }
     if (!m_compressedFile.good())
         throw Exception("File::compressedFile2UncompressedFile(): Read beyond end of file.");
 
-    /* statistics */
+    /* uncompress */
+    const uint64_t inflateBegin = FileMetrics::now();
+    logContainer->uncompress();
+    const uint64_t inflateEnd = FileMetrics::now();
+
+    /* statistics, after uncompress, as it's tried again in follow mode */
     currentUncompressedFileSize +=
         logContainer->internalHeaderSize() +
         logContainer->uncompressedFileSize;
-
-    /* uncompress */
-    logContainer->uncompress();
+#ifdef OPTION_USE_TRACING
+    m_tracer.record("inflate log container", metrics.logContainersInflated, inflateBegin, inflateEnd);
+#endif
+    FileMetrics::add(metrics.inflateTime, inflateEnd - inflateBegin);
+    FileMetrics::add(metrics.logContainersInflated, 1);
 
     /* copy into uncompressedFile */
     m_uncompressedFile.write(logContainer);
@@ -797,15 +1141,18 @@ void File::uncompressedFile2CompressedFile() {
     /* setup new log container */
     LogContainer logContainer;
 
-    /* copy data into LogContainer */
-    logContainer.uncompressedFile.resize(m_uncompressedFile.defaultLogContainerSize());
+    /* copy data into LogContainer, up to its end */
+    const std::streamsize size = m_uncompressedFile.waitLogContainer();
+    logContainer.uncompressedFile.resize(size);
     m_uncompressedFile.read(
         reinterpret_cast<char *>(logContainer.uncompressedFile.data()),
-        m_uncompressedFile.defaultLogContainerSize());
+        size);
+    const std::streampos position = m_uncompressedFile.tellg();
     logContainer.uncompressedFileSize = static_cast<uint32_t>(m_uncompressedFile.gcount());
     logContainer.uncompressedFile.resize(logContainer.uncompressedFileSize);
 
     /* compress */
+    const uint64_t deflateBegin = FileMetrics::now();
     if (compressionLevel == 0) {
         /* no compression */
         logContainer.compress(0, 0);
@@ -813,32 +1160,149 @@ void File::uncompressedFile2CompressedFile() {
         /* zlib compression */
         logContainer.compress(2, compressionLevel);
     }
+    const uint64_t deflateEnd = FileMetrics::now();
+#ifdef OPTION_USE_TRACING
+    m_tracer.record("deflate log container", metrics.logContainersDeflated, deflateBegin, deflateEnd);
+#endif
+    FileMetrics::add(metrics.deflateTime, deflateEnd - deflateBegin);
+    FileMetrics::add(metrics.logContainersDeflated, 1);
 
     /* write log container */
-    logContainer.write(m_compressedFile);
+    {
+        VECTOR_BLF_TRACE_SPAN(&m_tracer, "write log container", metrics.logContainersDeflated - 1);
+        logContainer.write(m_compressedFile);
+    }
 
     /* statistics */
     currentUncompressedFileSize +=
         logContainer.internalHeaderSize() +
         logContainer.uncompressedFileSize;
 
+    /* a closed log container is meant to be seen by readers, so pass it on */
+    if (m_uncompressedFile.good()) {
+        if (logContainer.uncompressedFileSize < m_uncompressedFile.defaultLogContainerSize())
+            m_compressedFile.flush();
+        {
+            /* mutex lock */
+            std::lock_guard<std::mutex> lock(m_flushMutex);
+
+            m_writtenPosition = position;
+        }
+        completeFlush();
+    }
+
     /* drop old data */
     m_uncompressedFile.dropOldData();
 }
 
+void File::waitForGrowth(std::streampos position) {
+    /* read again from the begin of the log container */
+    m_compressedFile.clear();
+    m_compressedFile.seekg(position, std::ios_base::beg);
+
+    /* wait for close, or poll again */
+    VECTOR_BLF_TRACE_SPAN(&m_tracer, "wait growth", static_cast<uint64_t>(position));
+    std::unique_lock<std::mutex> lock(m_followMutex);
+    m_followCondition.wait_for(lock, std::chrono::milliseconds(followInterval), [this] {
+        return !m_compressedFileThreadRunning;
+    });
+}
+
+void File::completeFlush() {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_flushMutex);
+
+    if ((m_flushesCompleted < m_flushesPending) && (m_writtenPosition >= m_flushPosition)) {
+        m_compressedFile.flush();
+        m_flushesCompleted = m_flushesPending;
+        m_flushCondition.notify_all();
+    }
+}
+
+void File::createDataLostObjects(ObjectHeaderBase * & dataLostBegin, ObjectHeaderBase * & dataLostEnd) const {
+    auto * begin = new DataLostBegin;
+    begin->objectTimeStamp = m_firstObjectLostTimeStamp;
+    dataLostBegin = begin;
+
+    auto * end = new DataLostEnd;
+    end->objectTimeStamp = m_lastObjectLostTimeStamp;
+    end->firstObjectLostTimeStamp = m_firstObjectLostTimeStamp;
+    end->numberOfLostEvents = m_objectsLost;
+    dataLostEnd = end;
+}
+
+bool File::checkpointsEnabled() const {
+    return (checkpointInterval > 0) || (checkpointSize > 0);
+}
+
+void File::checkpoint() {
+    /* check if due */
+    if (!checkpointsEnabled())
+        return;
+    const uint64_t now = FileMetrics::now();
+    const uint64_t fileSize = static_cast<uint64_t>(m_compressedFile.tellp());
+    const bool timeDue = (checkpointInterval > 0) && (now - m_lastCheckpointTime >= checkpointInterval * UINT64_C(1000000));
+    const bool sizeDue = (checkpointSize > 0) && (fileSize - m_lastCheckpointFileSize >= checkpointSize);
+    if (!timeDue && !sizeDue)
+        return;
+    VECTOR_BLF_TRACE_SPAN(&m_tracer, "checkpoint", metrics.checkpoints);
+
+    /* objects completely contained in the written log containers */
+    const std::streampos position = m_uncompressedFile.tellg();
+    {
+        /* mutex lock */
+        std::lock_guard<std::mutex> lock(m_objectPositionsMutex);
+
+        while (!m_objectPositions.empty() && (m_objectPositions.front().first <= position)) {
+            m_writtenObjectPosition = m_objectPositions.front().first;
+            m_writtenObjectCount = m_objectPositions.front().second;
+            m_objectPositions.pop_front();
+        }
+    }
+
+    /* written data behind these objects belongs to the next ones */
+    const uint64_t pendingSize = static_cast<uint64_t>(position - m_writtenObjectPosition);
+
+    /* log containers must be on disk, before the statistics refer to them */
+    if (!m_compressedFile.sync())
+        return;
+
+    /* rewrite file statistics */
+    FileStatistics checkpointStatistics = fileStatistics;
+    checkpointStatistics.fileSize = fileSize;
+    checkpointStatistics.uncompressedFileSize = currentUncompressedFileSize - pendingSize;
+    checkpointStatistics.objectCount = m_writtenObjectCount;
+    checkpointStatistics.restorePointsOffset = 0;
+    m_compressedFile.seekp(0);
+    checkpointStatistics.write(m_compressedFile);
+    m_compressedFile.seekp(static_cast<std::streampos>(fileSize));
+    if (!m_compressedFile.sync())
+        return;
+
+    /* next checkpoint */
+    m_lastCheckpointTime = now;
+    m_lastCheckpointFileSize = fileSize;
+    FileMetrics::add(metrics.checkpoints, 1);
+}
+
 void File::uncompressedFileReadThread(File * file) {
+    VECTOR_BLF_TRACE_THREAD_NAME(&file->m_tracer, "uncompressedFileReadThread");
     try {
         while (file->m_uncompressedFileThreadRunning) {
-            /* process */
-            try {
-                file->uncompressedFile2ReadWriteQueue();
-            } catch (Vector::BLF::Exception &) {
-                file->m_uncompressedFileThreadRunning = false;
+            /* process a batch of objects */
+            VECTOR_BLF_TRACE_SPAN(&file->m_tracer, "parse objects", file->currentObjectCount);
+            for (uint32_t i = 0; (i < objectsPerBatch) && file->m_uncompressedFileThreadRunning; ++i) {
+                /* process */
+                try {
+                    file->uncompressedFile2ReadWriteQueue();
+                } catch (Vector::BLF::Exception &) {
+                    file->m_uncompressedFileThreadRunning = false;
+                }
+
+                /* check for eof */
+                if (!file->m_uncompressedFile.good())
+                    file->m_uncompressedFileThreadRunning = false;
             }
-
-            /* check for eof */
-            if (!file->m_uncompressedFile.good())
-                file->m_uncompressedFileThreadRunning = false;
         }
 
         /* set end of file */
@@ -849,14 +1313,19 @@ void File::uncompressedFileReadThread(File * file) {
 }
 
 void File::uncompressedFileWriteThread(File * file) {
+    VECTOR_BLF_TRACE_THREAD_NAME(&file->m_tracer, "uncompressedFileWriteThread");
     try {
         while (file->m_uncompressedFileThreadRunning) {
-            /* process */
-            file->readWriteQueue2UncompressedFile();
-
-            /* check for eof */
-            if (!file->m_readWriteQueue.good())
-                file->m_uncompressedFileThreadRunning = false;
+            /* process a batch of objects */
+            VECTOR_BLF_TRACE_SPAN(&file->m_tracer, "serialize objects", file->currentObjectCount);
+            for (uint32_t i = 0; (i < objectsPerBatch) && file->m_uncompressedFileThreadRunning; ++i) {
+                /* process */
+                file->readWriteQueue2UncompressedFile();
+
+                /* check for eof */
+                if (!file->m_readWriteQueue.good())
+                    file->m_uncompressedFileThreadRunning = false;
+            }
         }
 
         /* set end of file */
@@ -867,12 +1336,23 @@ void File::uncompressedFileWriteThread(File * file) {
 }
 
 void File::compressedFileReadThread(File * file) {
+    VECTOR_BLF_TRACE_THREAD_NAME(&file->m_tracer, "compressedFileReadThread");
     try {
         while (file->m_compressedFileThreadRunning) {
+            /* begin of log container, to read it again in follow mode */
+            const std::streampos position = file->follow ? file->m_compressedFile.tellg() : std::streampos(-1);
+
             /* process */
             try {
                 file->compressedFile2UncompressedFile();
             } catch (Vector::BLF::Exception &) {
+                if (file->follow && (position >= 0) && file->m_compressedFile.eof()) {
+                    /* short read, so the log container is not written completely yet */
+                    file->waitForGrowth(position);
+                    continue;
+                }
+
+                /* data errors end reading, like without follow */
                 file->m_compressedFileThreadRunning = false;
             }
 
@@ -889,11 +1369,15 @@ void File::compressedFileReadThread(File * file) {
 }
 
 void File::compressedFileWriteThread(File * file) {
+    VECTOR_BLF_TRACE_THREAD_NAME(&file->m_tracer, "compressedFileWriteThread");
     try {
         while (file->m_compressedFileThreadRunning) {
             /* process */
             file->uncompressedFile2CompressedFile();
 
+            /* durable writes */
+            file->checkpoint();
+
             /* check for eof */
             if (!file->m_uncompressedFile.good())
                 file->m_compressedFileThreadRunning = false;
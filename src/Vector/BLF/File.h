@@ -7,14 +7,21 @@
 #include <Vector/BLF/platform.h>
 
 #include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <functional>
+#include <mutex>
 #include <thread>
+#include <utility>
 
 #include <Vector/BLF/CompressedFile.h>
+#include <Vector/BLF/FileMetrics.h>
 #include <Vector/BLF/FileStatistics.h>
 #include <Vector/BLF/ObjectHeaderBase.h>
 #include <Vector/BLF/ObjectQueue.h>
 #include <Vector/BLF/RestorePoints.h>
+#include <Vector/BLF/Tracer.h>
 #include <Vector/BLF/UncompressedFile.h>
 
 // UNKNOWN = 0
@@ -184,6 +191,23 @@ class VECTOR_BLF_EXPORT File final {
      */
     std::atomic<uint32_t> currentObjectCount {};
 
+    /**
+     * Pipeline metrics
+     *
+     * Can be read at any time, also while the file is being read or written.
+     */
+    FileMetrics metrics {};
+
+    /**
+     * Write timeline of the pipeline at file close
+     *
+     * If set, the spans of the pipeline threads and of the read/write calls
+     * are written into this file in Chrome trace event format.
+     * Spans are only recorded, if the library was built with
+     * OPTION_USE_TRACING, otherwise no file is written.
+     */
+    std::string traceFilename {};
+
     /**
      * compression level
      *
@@ -204,9 +228,111 @@ class VECTOR_BLF_EXPORT File final {
      */
     bool writeRestorePoints {true};
 
+    /**
+     * Checkpoint interval in ms for durable writes
+     *
+     * If set, the compressedFileThread rewrites the FileStatistics with the
+     * totals of the log containers written so far, once this time has passed
+     * since the last checkpoint. Data and statistics are synced to disk, so
+     * after a power loss the file is readable up to the last checkpoint.
+     * Only complete log containers are covered.
+     *
+     * 0 disables time based checkpoints.
+     */
+    uint32_t checkpointInterval {};
+
+    /**
+     * Checkpoint size in bytes for durable writes
+     *
+     * Like checkpointInterval, but a checkpoint is done once this many bytes
+     * were written to the compressedFile since the last checkpoint.
+     *
+     * 0 disables size based checkpoints.
+     */
+    uint64_t checkpointSize {};
+
+    /**
+     * High watermark of the readWriteQueue in objects
+     *
+     * If set, watermarkCallback is called with true, once this many objects
+     * are queued. 0 disables the watermarks.
+     */
+    uint32_t highWatermark {};
+
+    /**
+     * Low watermark of the readWriteQueue in objects
+     *
+     * After the high watermark, watermarkCallback is called with false, once
+     * the readWriteQueue drained down to this many objects.
+     */
+    uint32_t lowWatermark {};
+
+    /**
+     * Watermark callback
+     *
+     * Lets the application apply its own shedding policy. It's called by the
+     * writing resp. reading thread, without holding internal locks.
+     */
+    std::function<void(bool)> watermarkCallback {};
+
+    /**
+     * Write DataLostBegin/DataLostEnd around objects dropped by tryWrite.
+     *
+     * DataLostBegin has the timestamp of the first, DataLostEnd the one of
+     * the last dropped object. They are written, once an object fits into
+     * the readWriteQueue again, or at close.
+     */
+    bool writeDataLostObjects {true};
+
+    /**
+     * Use io_uring for the compressedFile on Linux.
+     *
+     * Several buffers are read ahead of the inflater resp. written behind
+     * the deflater, asynchronously. Falls back to std::fstream, if io_uring
+     * is not available. Has to be set before open.
+     */
+    bool useIoUring {false};
+
+    /**
+     * Read ahead window in log containers for sequential scans
+     *
+     * If set, the operating system is advised to read this many log
+     * containers of the defaultLogContainerSize ahead. 0 disables this.
+     * Has to be set before open.
+     */
+    uint32_t readAheadContainers {};
+
+    /**
+     * Drop data already read from the page cache.
+     *
+     * Scans of large files then don't evict the cached data of other
+     * processes. Has to be set before open.
+     */
+    bool dropPageCache {false};
+
+    /**
+     * Follow a file, which is still being written, like tail -f.
+     *
+     * At the end of the last complete log container, reading waits for the
+     * file to grow, instead of ending. Partially written log containers are
+     * read again, once they are complete. The FileStatistics don't need to
+     * be finalized. Reading only ends with close, so read with timeout
+     * resp. tryRead should be used. The writer should use flush or
+     * maxLatency to bound the latency. Has to be set before open.
+     */
+    bool follow {false};
+
+    /**
+     * Interval in ms, in which a followed file is checked for growth
+     */
+    uint32_t followInterval {10};
+
     /**
      * open file
      *
+     * For reading, this can also be a pipe, e.g. /dev/stdin, which is read
+     * forward only.
+     *
      * @param[in] filename file name
      * @param[in] mode open mode, either in (read) or out (write)
      */
@@ -253,11 +379,32 @@ class VECTOR_BLF_EXPORT File final {
      */
     virtual ObjectHeaderBase * read();
 
+    /**
+     * Read object from file, if one is available.
+     *
+     * @see read(uint32_t)
+     *
+     * @return read object or nullptr
+     */
+    virtual ObjectHeaderBase * tryRead();
+
+    /**
+     * Read object from file, waiting at most timeout.
+     *
+     * If no object is available, nullptr is returned. Then eof() tells if
+     * the end of file was reached.
+     *
+     * @param[in] timeout max wait time in ms
+     * @return read object or nullptr
+     */
+    virtual ObjectHeaderBase * read(uint32_t timeout);
+
     /**
      * Write object to file.
      *
      * Ownership is taken over from the user to the library.
      * The object should not be further accessed any more.
+     * nullptr is ignored.
      *
      * @todo Use std::unique_ptr in future versions.
      *
@@ -265,6 +412,51 @@ class VECTOR_BLF_EXPORT File final {
      */
     virtual void write(ObjectHeaderBase * ohb);
 
+    /**
+     * Write objects to file at once.
+     *
+     * The objects are enqueued together, so that the queue is locked and
+     * the pipeline threads are woken up once per batch instead of per
+     * object. Ownership is taken over like with write(ObjectHeaderBase *).
+     *
+     * @param[in] ohbs write objects
+     * @param[in] count number of objects
+     */
+    virtual void write(ObjectHeaderBase * const * ohbs, uint32_t count);
+
+    /**
+     * Write object to file, if the readWriteQueue is not full.
+     *
+     * @see write(ObjectHeaderBase *, uint32_t)
+     *
+     * @param[in] ohb write object
+     * @return true if written, false if dropped
+     */
+    virtual bool tryWrite(ObjectHeaderBase * ohb);
+
+    /**
+     * Write object to file, waiting at most timeout for free space.
+     *
+     * Ownership is taken over from the user to the library, also if the
+     * object is dropped. Dropped objects are counted in
+     * metrics.objectsDropped and marked with DataLostBegin/DataLostEnd.
+     *
+     * @param[in] ohb write object
+     * @param[in] timeout max wait time in ms
+     * @return true if written, false if dropped
+     */
+    virtual bool write(ObjectHeaderBase * ohb, uint32_t timeout);
+
+    /**
+     * Flush objects written so far to the operating system.
+     *
+     * The current log container is closed after the objects written before,
+     * compressed and written into the file. This returns, when the data was
+     * passed to the operating system, so that other processes can read it.
+     * Use checkpoints to get it on disk.
+     */
+    virtual void flush();
+
     /**
      * close file
      */
@@ -284,6 +476,38 @@ class VECTOR_BLF_EXPORT File final {
      */
     virtual void setDefaultLogContainerSize(uint32_t defaultLogContainerSize);
 
+    /**
+     * Get readWriteQueue size.
+     *
+     * @return max number of objects queued
+     */
+    virtual uint32_t readWriteQueueSize() const;
+
+    /**
+     * Set readWriteQueue size.
+     *
+     * @param[in] readWriteQueueSize max number of objects queued
+     */
+    virtual void setReadWriteQueueSize(uint32_t readWriteQueueSize);
+
+    /**
+     * Get max latency.
+     *
+     * @return max latency in ms
+     */
+    virtual uint32_t maxLatency() const;
+
+    /**
+     * Set max latency for live logging.
+     *
+     * A log container is written once it's full, which can take long at low
+     * bus load. With a max latency, a partially filled log container is
+     * closed, compressed and written, once it holds data for this time.
+     *
+     * @param[in] maxLatency max latency in ms, 0 to disable
+     */
+    virtual void setMaxLatency(uint32_t maxLatency);
+
     /**
      * create object of given type
      *
@@ -292,6 +516,21 @@ class VECTOR_BLF_EXPORT File final {
      */
     static ObjectHeaderBase * createObject(ObjectType type);
 
+    /**
+     * Read file metadata without opening the file.
+     *
+     * Only the FileStatistics are read, and optionally the AppText objects
+     * (e.g. DbChannelInfo, MetaData) at the start of the first log container.
+     * No threads are started and no further log containers are inflated,
+     * so this is suitable to catalog many files.
+     *
+     * @param[in] filename file name
+     * @param[out] fileStatistics file statistics
+     * @param[out] appTexts leading AppText objects, or nullptr to skip the first log container
+     * @return true if the file could be opened and has a valid signature
+     */
+    static bool probe(const std::string & filename, FileStatistics & fileStatistics, std::vector<AppText> * appTexts = nullptr);
+
   private:
     /**
      * Open mode
@@ -364,6 +603,87 @@ class VECTOR_BLF_EXPORT File final {
      */
     std::atomic<bool> m_compressedFileThreadRunning {};
 
+    /**
+     * timeline of the pipeline
+     */
+    Tracer m_tracer {};
+
+    /* checkpoints */
+
+    /** time of last checkpoint in ns */
+    uint64_t m_lastCheckpointTime {};
+
+    /** compressedFile size at last checkpoint */
+    uint64_t m_lastCheckpointFileSize {};
+
+    /** mutex for m_objectPositions */
+    std::mutex m_objectPositionsMutex {};
+
+    /**
+     * uncompressedFile position after the last object of each log container, with the object count up to it
+     *
+     * Filled by the uncompressedFileThread if checkpoints are enabled, consumed by
+     * the compressedFileThread to know the objects contained in written log containers.
+     */
+    std::deque<std::pair<std::streampos, uint32_t>> m_objectPositions {};
+
+    /** uncompressedFile position after the last object, with the object count up to it */
+    std::pair<std::streampos, uint32_t> m_lastObjectPosition {};
+
+    /** expected end of the current log container in the uncompressedFile */
+    std::streampos m_logContainerEnd {};
+
+    /** uncompressedFile position up to the objects in written log containers */
+    std::streampos m_writtenObjectPosition {};
+
+    /** number of objects in written log containers */
+    uint32_t m_writtenObjectCount {};
+
+    /* flush */
+
+    /** mutex for the flush data below */
+    std::mutex m_flushMutex {};
+
+    /** flush completed */
+    std::condition_variable m_flushCondition {};
+
+    /** number of flush requests */
+    uint32_t m_flushRequests {};
+
+    /** number of flush requests, which reached the uncompressedFile */
+    uint32_t m_flushesPending {};
+
+    /** number of flush requests, which reached the compressedFile */
+    uint32_t m_flushesCompleted {};
+
+    /** uncompressedFile position of the last flush request */
+    std::streampos m_flushPosition {};
+
+    /** uncompressedFile position written into the compressedFile */
+    std::streampos m_writtenPosition {};
+
+    /* dropped objects */
+
+    /** mutex for the dropped objects data below */
+    std::mutex m_objectsLostMutex {};
+
+    /** number of objects dropped since the last written object */
+    uint32_t m_objectsLost {};
+
+    /** timestamp of the first dropped object */
+    uint64_t m_firstObjectLostTimeStamp {};
+
+    /** timestamp of the last dropped object */
+    uint64_t m_lastObjectLostTimeStamp {};
+
+    /* follow */
+
+    /** mutex for m_followCondition */
+    std::mutex m_followMutex {};
+
+    /** close was called, while waiting for growth */
+    std::condition_variable m_followCondition {};
+
     /* internal functions */
 
     /**
@@ -386,6 +706,40 @@ class VECTOR_BLF_EXPORT File final {
      */
     void uncompressedFile2CompressedFile();
 
+    /**
+     * Wait for a followed file to grow.
+     *
+     * @param[in] position position to read again from
+     */
+    void waitForGrowth(std::streampos position);
+
+    /**
+     * Complete pending flush requests, if their data was written.
+     */
+    void completeFlush();
+
+    /**
+     * Create DataLostBegin/DataLostEnd for the dropped objects.
+     *
+     * Mutex for dropped objects must be locked.
+     *
+     * @param[out] dataLostBegin data lost begin
+     * @param[out] dataLostEnd data lost end
+     */
+    void createDataLostObjects(ObjectHeaderBase * & dataLostBegin, ObjectHeaderBase * & dataLostEnd) const;
+
+    /**
+     * Check if checkpoints are enabled.
+     *
+     * @return true if checkpointInterval or checkpointSize is set
+     */
+    bool checkpointsEnabled() const;
+
+    /**
+     * Rewrite FileStatistics and sync to disk, if a checkpoint is due.
+     */
+    void checkpoint();
+
     /**
      * transfer data from uncompressedFile to readWriteQueue
      */
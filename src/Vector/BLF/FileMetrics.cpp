@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/FileMetrics.h>
+
+#include <chrono>
+
+namespace Vector {
+namespace BLF {
+
+constexpr std::size_t FileMetrics::objectTypeCount;
+
+uint64_t FileMetrics::objects(const ObjectType objectType) const {
+    const std::size_t index = static_cast<std::size_t>(objectType);
+    if (index >= objectTypeCount)
+        return 0;
+    return objectCount[index].load(std::memory_order_relaxed);
+}
+
+void FileMetrics::reset() {
+    compressedBytesRead.store(0, std::memory_order_relaxed);
+    compressedBytesWritten.store(0, std::memory_order_relaxed);
+    logContainersInflated.store(0, std::memory_order_relaxed);
+    inflateTime.store(0, std::memory_order_relaxed);
+    logContainersDeflated.store(0, std::memory_order_relaxed);
+    deflateTime.store(0, std::memory_order_relaxed);
+    for (auto & count : objectCount)
+        count.store(0, std::memory_order_relaxed);
+    readWriteQueueReadWaitTime.store(0, std::memory_order_relaxed);
+    readWriteQueueWriteWaitTime.store(0, std::memory_order_relaxed);
+    uncompressedFileReadWaitTime.store(0, std::memory_order_relaxed);
+    uncompressedFileWriteWaitTime.store(0, std::memory_order_relaxed);
+    peakLogContainerCount.store(0, std::memory_order_relaxed);
+    checkpoints.store(0, std::memory_order_relaxed);
+    syncTime.store(0, std::memory_order_relaxed);
+    objectsDropped.store(0, std::memory_order_relaxed);
+}
+
+uint64_t FileMetrics::now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void FileMetrics::add(std::atomic<uint64_t> & counter, const uint64_t value) {
+    counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+void FileMetrics::max(std::atomic<uint64_t> & counter, const uint64_t value) {
+    uint64_t current = counter.load(std::memory_order_relaxed);
+    while ((value > current) && !counter.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void FileMetrics::addObject(const ObjectType objectType) {
+    const std::size_t index = static_cast<std::size_t>(objectType);
+    if (index < objectTypeCount)
+        objectCount[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+}
+}
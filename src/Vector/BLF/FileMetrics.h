@@ -0,0 +1,152 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <array>
+#include <atomic>
+
+#include <Vector/BLF/ObjectHeaderBase.h>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * Pipeline metrics of File
+ *
+ * File reads and writes in three stages: the application thread exchanges
+ * objects with the readWriteQueue, the uncompressedFileThread (de)serializes
+ * them from/to the uncompressedFile, and the compressedFileThread
+ * inflates/deflates log containers from/to the compressedFile.
+ *
+ * The counters are updated with relaxed atomic operations and can be read
+ * at any time, also while the threads are running. Wait times are only
+ * measured when a thread actually blocks, so the metrics don't add clock
+ * reads to the fast path and can be left on.
+ *
+ * Times are in ns.
+ */
+struct VECTOR_BLF_EXPORT FileMetrics final {
+    FileMetrics() = default;
+    FileMetrics(const FileMetrics &) = delete;
+    FileMetrics & operator=(const FileMetrics &) = delete;
+
+    /** number of object types */
+    static constexpr std::size_t objectTypeCount = static_cast<std::size_t>(ObjectType::ATTRIBUTE_EVENT) + 1;
+
+    /** bytes read from compressedFile */
+    std::atomic<uint64_t> compressedBytesRead {};
+
+    /** bytes written to compressedFile */
+    std::atomic<uint64_t> compressedBytesWritten {};
+
+    /** number of log containers inflated */
+    std::atomic<uint64_t> logContainersInflated {};
+
+    /** time spent inflating log containers */
+    std::atomic<uint64_t> inflateTime {};
+
+    /** number of log containers deflated */
+    std::atomic<uint64_t> logContainersDeflated {};
+
+    /** time spent deflating log containers */
+    std::atomic<uint64_t> deflateTime {};
+
+    /** number of objects parsed (read) or serialized (write) per object type */
+    std::array<std::atomic<uint64_t>, objectTypeCount> objectCount {};
+
+    /**
+     * time blocked in readWriteQueue read
+     *
+     * Application thread waiting for objects (read), or
+     * uncompressedFileThread waiting for objects to serialize (write).
+     */
+    std::atomic<uint64_t> readWriteQueueReadWaitTime {};
+
+    /**
+     * time blocked in readWriteQueue write
+     *
+     * uncompressedFileThread waiting for the application (read), or
+     * application thread waiting for free space (write).
+     */
+    std::atomic<uint64_t> readWriteQueueWriteWaitTime {};
+
+    /**
+     * time blocked in uncompressedFile read
+     *
+     * uncompressedFileThread waiting for inflated data (read), or
+     * compressedFileThread waiting for data to deflate (write).
+     */
+    std::atomic<uint64_t> uncompressedFileReadWaitTime {};
+
+    /**
+     * time blocked in uncompressedFile write
+     *
+     * compressedFileThread waiting for free space (read), or
+     * uncompressedFileThread waiting for free space (write).
+     */
+    std::atomic<uint64_t> uncompressedFileWriteWaitTime {};
+
+    /** peak number of log containers resident in uncompressedFile */
+    std::atomic<uint64_t> peakLogContainerCount {};
+
+    /** number of checkpoints, see File::checkpointInterval */
+    std::atomic<uint64_t> checkpoints {};
+
+    /** time spent syncing the compressedFile to disk */
+    std::atomic<uint64_t> syncTime {};
+
+    /** number of objects dropped, see File::tryWrite */
+    std::atomic<uint64_t> objectsDropped {};
+
+    /**
+     * Get number of objects of a type.
+     *
+     * @param[in] objectType object type
+     * @return object count
+     */
+    virtual uint64_t objects(const ObjectType objectType) const;
+
+    /**
+     * Reset all counters.
+     */
+    virtual void reset();
+
+    /**
+     * Get current time of a monotonic clock.
+     *
+     * @return time in ns
+     */
+    static uint64_t now();
+
+    /**
+     * Add to counter.
+     *
+     * @param[in] counter counter
+     * @param[in] value value to add
+     */
+    static void add(std::atomic<uint64_t> & counter, const uint64_t value);
+
+    /**
+     * Raise counter to value, if it's larger.
+     *
+     * @param[in] counter counter
+     * @param[in] value value
+     */
+    static void max(std::atomic<uint64_t> & counter, const uint64_t value);
+
+    /**
+     * Count an object.
+     *
+     * @param[in] objectType object type
+     */
+    virtual void addObject(const ObjectType objectType);
+};
+
+}
+}
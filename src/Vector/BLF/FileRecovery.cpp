@@ -0,0 +1,443 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/FileRecovery.h>
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+
+#include <zlib.h>
+
+namespace Vector {
+namespace BLF {
+
+namespace {
+
+/** size of reads from the damaged file */
+const std::size_t inputBufferSize = 4 * 1024 * 1024;
+
+/** size of ObjectHeaderBase */
+const std::size_t objectHeaderBaseSize = 16;
+
+/** size of LogContainer header */
+const std::size_t logContainerHeaderSize = 32;
+
+/** larger objects and log containers are considered damaged */
+const uint32_t maxObjectSize = 64 * 1024 * 1024;
+
+/** ObjectHeaderBase fields */
+struct ObjectHeaderFields {
+    /** signature */
+    uint32_t signature;
+
+    /** header size */
+    uint16_t headerSize;
+
+    /** object size */
+    uint32_t objectSize;
+
+    /** object type */
+    ObjectType objectType;
+};
+
+/** read ObjectHeaderBase fields, data must have at least objectHeaderBaseSize bytes */
+ObjectHeaderFields readHeader(const char * data) {
+    ObjectHeaderFields fields;
+    std::memcpy(&fields.signature, data, sizeof(fields.signature));
+    std::memcpy(&fields.headerSize, data + 4, sizeof(fields.headerSize));
+    std::memcpy(&fields.objectSize, data + 8, sizeof(fields.objectSize));
+    std::memcpy(&fields.objectType, data + 12, sizeof(fields.objectType));
+    return fields;
+}
+
+/** check if header can belong to an object */
+bool plausibleHeader(const ObjectHeaderFields & fields) {
+    return
+        (fields.signature == ObjectSignature) &&
+        (fields.headerSize >= objectHeaderBaseSize) &&
+        (fields.objectSize >= fields.headerSize) &&
+        (fields.objectSize <= maxObjectSize);
+}
+
+/**
+ * Find next object signature.
+ *
+ * memchr is vectorized in common C libraries, so this runs at memory speed.
+ *
+ * @return position of signature, or end - 3 if there is none
+ */
+const char * findSignature(const char * begin, const char * end) {
+    const char signature[4] = { 'L', 'O', 'B', 'J' };
+    if (end - begin < 4)
+        return begin;
+    const char * last = end - 3;
+    while (begin < last) {
+        const char * candidate = static_cast<const char *>(std::memchr(begin, signature[0], static_cast<std::size_t>(last - begin)));
+        if (candidate == nullptr)
+            return last;
+        if (std::memcmp(candidate, signature, sizeof(signature)) == 0)
+            return candidate;
+        begin = candidate + 1;
+    }
+    return last;
+}
+
+/** read-only AbstractFile on a memory area, to parse objects */
+class MemoryFile final : public AbstractFile {
+  public:
+    MemoryFile(const char * data, const std::size_t size) :
+        m_data(data),
+        m_size(static_cast<std::streamoff>(size)) {
+    }
+
+    std::streamsize gcount() const override {
+        return m_gcount;
+    }
+
+    void read(char * s, std::streamsize n) override {
+        if (n > m_size - m_position) {
+            n = m_size - m_position;
+            m_rdstate = std::ios_base::eofbit | std::ios_base::failbit;
+        }
+        std::memcpy(s, m_data + m_position, static_cast<std::size_t>(n));
+        m_position += n;
+        m_gcount = n;
+    }
+
+    std::streampos tellg() override {
+        return m_position;
+    }
+
+    void seekg(std::streamoff off, const std::ios_base::seekdir way) override {
+        switch (way) {
+        case std::ios_base::beg:
+            m_position = off;
+            break;
+        case std::ios_base::cur:
+            m_position += off;
+            break;
+        case std::ios_base::end:
+            m_position = m_size + off;
+            break;
+        default:
+            break;
+        }
+        m_position = std::max<std::streamoff>(0, std::min(m_position, m_size));
+    }
+
+    void write(const char * /*s*/, std::streamsize /*n*/) override {
+        m_rdstate |= std::ios_base::badbit;
+    }
+
+    std::streampos tellp() override {
+        return 0;
+    }
+
+    bool good() const override {
+        return m_rdstate == std::ios_base::goodbit;
+    }
+
+    bool eof() const override {
+        return (m_rdstate & std::ios_base::eofbit) != 0;
+    }
+
+  private:
+    /** data */
+    const char * m_data;
+
+    /** size */
+    std::streamoff m_size;
+
+    /** read position */
+    std::streamoff m_position {};
+
+    /** characters returned by last read */
+    std::streamsize m_gcount {};
+
+    /** error state */
+    std::ios_base::iostate m_rdstate {std::ios_base::goodbit};
+};
+
+}
+
+bool FileRecovery::recover(const std::string & inputFilename, const std::string & outputFilename) {
+    /* reset */
+    logContainers = 0;
+    damagedLogContainers = 0;
+    objects = 0;
+    damagedObjects = 0;
+    unknownObjects = 0;
+    skippedBytes = 0;
+    skippedUncompressedBytes = 0;
+    m_inputBegin = 0;
+    m_inputEnd = 0;
+    m_uncompressedData.clear();
+
+    /* open damaged file */
+    m_inputFile.open(inputFilename, std::ios_base::in | std::ios_base::binary);
+    if (!m_inputFile.is_open())
+        return false;
+    m_inputBuffer.resize(inputBufferSize);
+
+    /* open recovered file, with application and times of the damaged file */
+    File outputFile;
+    FileStatistics inputStatistics;
+    const bool inputStatisticsValid = File::probe(inputFilename, inputStatistics) && (inputStatistics.statisticsSize <= inputBufferSize);
+    if (inputStatisticsValid) {
+        outputFile.fileStatistics.applicationId = inputStatistics.applicationId;
+        outputFile.fileStatistics.applicationMajor = inputStatistics.applicationMajor;
+        outputFile.fileStatistics.applicationMinor = inputStatistics.applicationMinor;
+        outputFile.fileStatistics.applicationBuild = inputStatistics.applicationBuild;
+        outputFile.fileStatistics.measurementStartTime = inputStatistics.measurementStartTime;
+        outputFile.fileStatistics.lastObjectTime = inputStatistics.lastObjectTime;
+    }
+    outputFile.compressionLevel = compressionLevel;
+    outputFile.open(outputFilename, std::ios_base::out);
+    if (!outputFile.is_open()) {
+        m_inputFile.close();
+        return false;
+    }
+    m_outputFile = &outputFile;
+
+    /* skip file statistics */
+    if (inputStatisticsValid)
+        m_inputBegin = fill(inputStatistics.statisticsSize);
+
+    /* process objects and log containers */
+    while (fill(objectHeaderBaseSize) >= objectHeaderBaseSize) {
+        if (!processObject())
+            resynchronize();
+    }
+    skippedBytes += m_inputEnd - m_inputBegin;
+    m_inputBegin = m_inputEnd;
+
+    /* remaining uncompressed data */
+    parseUncompressedData(true);
+
+    /* close files */
+    outputFile.close();
+    m_outputFile = nullptr;
+    m_inputFile.close();
+    m_inputBuffer.clear();
+    m_inputBuffer.shrink_to_fit();
+    return true;
+}
+
+std::size_t FileRecovery::fill(const std::size_t size) {
+    /* already available */
+    if (m_inputEnd - m_inputBegin >= size)
+        return size;
+
+    /* move unprocessed data to the start of the buffer */
+    if (m_inputBegin > 0) {
+        std::memmove(m_inputBuffer.data(), m_inputBuffer.data() + m_inputBegin, m_inputEnd - m_inputBegin);
+        m_inputEnd -= m_inputBegin;
+        m_inputBegin = 0;
+    }
+    if (size > m_inputBuffer.size())
+        m_inputBuffer.resize(size);
+
+    /* read */
+    while ((m_inputEnd < size) && m_inputFile.good()) {
+        m_inputFile.read(m_inputBuffer.data() + m_inputEnd, static_cast<std::streamsize>(m_inputBuffer.size() - m_inputEnd));
+        m_inputEnd += static_cast<std::size_t>(m_inputFile.gcount());
+    }
+
+    return std::min(size, m_inputEnd);
+}
+
+void FileRecovery::resynchronize() {
+    /* skip current position */
+    m_inputBegin++;
+    skippedBytes++;
+
+    /* search signature */
+    while (fill(4) >= 4) {
+        const char * begin = m_inputBuffer.data() + m_inputBegin;
+        const char * signature = findSignature(begin, m_inputBuffer.data() + m_inputEnd);
+        skippedBytes += static_cast<uint64_t>(signature - begin);
+        m_inputBegin += static_cast<std::size_t>(signature - begin);
+        if ((m_inputEnd - m_inputBegin >= 4) && (std::memcmp(m_inputBuffer.data() + m_inputBegin, "LOBJ", 4) == 0))
+            return;
+    }
+}
+
+bool FileRecovery::processObject() {
+    const ObjectHeaderFields header = readHeader(m_inputBuffer.data() + m_inputBegin);
+    if (!plausibleHeader(header))
+        return false;
+
+    /* log container */
+    if (header.objectType == ObjectType::LOG_CONTAINER)
+        return processLogContainer(header.objectSize);
+
+    /* object outside of log containers, not contiguous with uncompressed data */
+    parseUncompressedData(true);
+    const std::size_t size = header.objectSize + header.objectSize % 4;
+    const std::size_t available = fill(size);
+    if (available < header.objectSize)
+        return false;
+    ObjectHeaderBase * obj = File::createObject(header.objectType);
+    if (obj == nullptr)
+        return false;
+    if (!recoverObject(obj, m_inputBuffer.data() + m_inputBegin, available))
+        return false;
+    m_inputBegin += available;
+    return true;
+}
+
+bool FileRecovery::processLogContainer(const uint32_t objectSize) {
+    /* log container header */
+    if ((objectSize < logContainerHeaderSize) || (fill(logContainerHeaderSize) < logContainerHeaderSize))
+        return false;
+    uint16_t compressionMethod;
+    uint32_t uncompressedFileSize;
+    std::memcpy(&compressionMethod, m_inputBuffer.data() + m_inputBegin + 16, sizeof(compressionMethod));
+    std::memcpy(&uncompressedFileSize, m_inputBuffer.data() + m_inputBegin + 24, sizeof(uncompressedFileSize));
+    if (((compressionMethod != 0) && (compressionMethod != 2)) || (uncompressedFileSize > maxObjectSize))
+        return false;
+
+    /* compressed data, up to end of file */
+    const std::size_t size = objectSize + objectSize % 4;
+    const std::size_t available = fill(size);
+    const char * compressedFile = m_inputBuffer.data() + m_inputBegin + logContainerHeaderSize;
+    const std::size_t compressedFileSize = std::min<std::size_t>(available, objectSize) - logContainerHeaderSize;
+
+    /* uncompress into m_uncompressedData, up to a break in the data */
+    const std::size_t offset = m_uncompressedData.size();
+    m_uncompressedData.resize(offset + uncompressedFileSize);
+    std::size_t uncompressedSize = 0;
+    std::size_t consumedSize = 0;
+    bool streamEnd = false;
+    if (compressionMethod == 0) {
+        /* no compression */
+        uncompressedSize = std::min<std::size_t>(compressedFileSize, uncompressedFileSize);
+        std::memcpy(m_uncompressedData.data() + offset, compressedFile, uncompressedSize);
+        consumedSize = uncompressedSize;
+        streamEnd = (uncompressedSize == uncompressedFileSize);
+    } else {
+        /* zlib compression, inflate keeps the output before a truncation or data error */
+        z_stream stream;
+        std::memset(&stream, 0, sizeof(stream));
+        if (inflateInit(&stream) == Z_OK) {
+            stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(compressedFile));
+            stream.avail_in = static_cast<uInt>(compressedFileSize);
+            stream.next_out = reinterpret_cast<Bytef *>(m_uncompressedData.data() + offset);
+            stream.avail_out = static_cast<uInt>(uncompressedFileSize);
+            streamEnd = (inflate(&stream, Z_FINISH) == Z_STREAM_END);
+            uncompressedSize = static_cast<std::size_t>(stream.total_out);
+            consumedSize = static_cast<std::size_t>(stream.total_in);
+            inflateEnd(&stream);
+        }
+    }
+    m_uncompressedData.resize(offset + uncompressedSize);
+
+    /* complete log container */
+    if ((available >= objectSize) && streamEnd && (uncompressedSize == uncompressedFileSize)) {
+        logContainers++;
+        m_inputBegin += available;
+        parseUncompressedData(false);
+        return true;
+    }
+
+    /* nothing salvaged, e.g. the signature is part of other data */
+    if (uncompressedSize == 0)
+        return false;
+
+    /* damaged log container, the next log container doesn't continue its data */
+    damagedLogContainers++;
+    parseUncompressedData(true);
+
+    /* continue after the break, so salvaged objects are not found again */
+    m_inputBegin += logContainerHeaderSize + consumedSize;
+    return true;
+}
+
+void FileRecovery::parseUncompressedData(const bool flush) {
+    const char * data = m_uncompressedData.data();
+    const std::size_t size = m_uncompressedData.size();
+    std::size_t position = 0;
+    while (size - position >= objectHeaderBaseSize) {
+        const ObjectHeaderFields header = readHeader(data + position);
+
+        /* resynchronize */
+        if (!plausibleHeader(header) || (header.objectType == ObjectType::LOG_CONTAINER)) {
+            const char * signature = findSignature(data + position + 1, data + size);
+            skippedUncompressedBytes += static_cast<uint64_t>(signature - (data + position));
+            position = static_cast<std::size_t>(signature - data);
+            continue;
+        }
+
+        /* object continues in next log container */
+        if (size - position < header.objectSize) {
+            if (!flush)
+                break;
+
+            /* truncated object */
+            damagedObjects++;
+            const char * signature = findSignature(data + position + 1, data + size);
+            skippedUncompressedBytes += static_cast<uint64_t>(signature - (data + position));
+            position = static_cast<std::size_t>(signature - data);
+            continue;
+        }
+        const std::size_t objectSize = std::min<std::size_t>(header.objectSize + header.objectSize % 4, size - position);
+
+        /* restore points are written by File itself */
+        if (header.objectType == ObjectType::Unknown115) {
+            position += objectSize;
+            continue;
+        }
+
+        /* unknown object type */
+        ObjectHeaderBase * obj = File::createObject(header.objectType);
+        if (obj == nullptr) {
+            unknownObjects++;
+            position += objectSize;
+            continue;
+        }
+
+        /* parse object */
+        if (recoverObject(obj, data + position, objectSize))
+            position += objectSize;
+        else {
+            const char * signature = findSignature(data + position + 1, data + size);
+            skippedUncompressedBytes += static_cast<uint64_t>(signature - (data + position));
+            position = static_cast<std::size_t>(signature - data);
+        }
+    }
+
+    /* drop parsed data */
+    if (flush) {
+        skippedUncompressedBytes += size - position;
+        m_uncompressedData.clear();
+    } else
+        m_uncompressedData.erase(m_uncompressedData.begin(), m_uncompressedData.begin() + static_cast<std::ptrdiff_t>(position));
+}
+
+bool FileRecovery::recoverObject(ObjectHeaderBase * obj, const char * data, const std::size_t size) {
+    /* parse */
+    MemoryFile memoryFile(data, size);
+    try {
+        obj->read(memoryFile);
+    } catch (const std::exception &) {
+        /* e.g. Exception or bad_alloc from damaged length fields */
+        delete obj;
+        damagedObjects++;
+        return false;
+    }
+    if (!memoryFile.good()) {
+        delete obj;
+        damagedObjects++;
+        return false;
+    }
+
+    /* write into recovered file */
+    m_outputFile->write(obj);
+    objects++;
+    return true;
+}
+
+}
+}
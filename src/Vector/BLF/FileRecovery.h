@@ -0,0 +1,146 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <Vector/BLF/File.h>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * Recovery of truncated and corrupted files
+ *
+ * File stops at the first damaged log container or object. FileRecovery
+ * instead scans the file sequentially and resynchronizes on the object
+ * signature, whenever a log container or object is damaged:
+ * - Log containers with a broken or truncated zlib stream are inflated up
+ *   to the break.
+ * - Objects, which are truncated, damaged or span a damaged part of the
+ *   file, are skipped.
+ * - Objects outside of log containers are taken over as well.
+ *
+ * All recovered objects are written into a new file, which gets correct
+ * FileStatistics. The application and measurement time are taken over
+ * from the damaged file, if its FileStatistics are readable.
+ */
+class VECTOR_BLF_EXPORT FileRecovery final {
+  public:
+    FileRecovery() = default;
+    virtual ~FileRecovery() = default;
+    FileRecovery(const FileRecovery &) = delete;
+    FileRecovery & operator=(const FileRecovery &) = delete;
+
+    /**
+     * compression level of the recovered file
+     *
+     * @see File::compressionLevel
+     */
+    int compressionLevel {1};
+
+    /** number of complete log containers */
+    uint64_t logContainers {};
+
+    /** number of damaged log containers, from which data was salvaged */
+    uint64_t damagedLogContainers {};
+
+    /** number of recovered objects */
+    uint64_t objects {};
+
+    /** number of damaged objects, which were skipped */
+    uint64_t damagedObjects {};
+
+    /** number of objects with unknown object type, which were skipped */
+    uint64_t unknownObjects {};
+
+    /** bytes skipped in the damaged file to find the next object signature */
+    uint64_t skippedBytes {};
+
+    /** bytes skipped in the uncompressed data to find the next object signature */
+    uint64_t skippedUncompressedBytes {};
+
+    /**
+     * Recover objects from damaged file into a new file.
+     *
+     * @param[in] inputFilename damaged file
+     * @param[in] outputFilename recovered file
+     * @return true if files could be opened
+     */
+    virtual bool recover(const std::string & inputFilename, const std::string & outputFilename);
+
+  private:
+    /** damaged file */
+    std::ifstream m_inputFile {};
+
+    /** buffer of damaged file */
+    std::vector<char> m_inputBuffer {};
+
+    /** begin of unprocessed data in m_inputBuffer */
+    std::size_t m_inputBegin {};
+
+    /** end of valid data in m_inputBuffer */
+    std::size_t m_inputEnd {};
+
+    /** uncompressed data of log containers, not yet parsed */
+    std::vector<char> m_uncompressedData {};
+
+    /** recovered file */
+    File * m_outputFile {};
+
+    /**
+     * Make bytes available in m_inputBuffer.
+     *
+     * @param[in] size number of bytes from m_inputBegin
+     * @return number of available bytes, less than size at end of file
+     */
+    std::size_t fill(const std::size_t size);
+
+    /**
+     * Skip to the next object signature in the damaged file.
+     */
+    void resynchronize();
+
+    /**
+     * Process object at m_inputBegin.
+     *
+     * @return false if there is no valid object, so the file must be resynchronized
+     */
+    bool processObject();
+
+    /**
+     * Process log container at m_inputBegin.
+     *
+     * @param[in] objectSize object size from header
+     * @return false if the log container header is not valid
+     */
+    bool processLogContainer(const uint32_t objectSize);
+
+    /**
+     * Parse objects from m_uncompressedData.
+     *
+     * @param[in] flush data ends here, e.g. damaged log container or end of file
+     */
+    void parseUncompressedData(const bool flush);
+
+    /**
+     * Parse object and write it into the recovered file.
+     *
+     * @param[in] obj object, ownership is taken over
+     * @param[in] data object data
+     * @param[in] size object size including padding
+     * @return true if object was recovered
+     */
+    bool recoverObject(ObjectHeaderBase * obj, const char * data, const std::size_t size);
+};
+
+}
+}
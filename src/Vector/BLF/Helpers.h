@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <Vector/BLF/FileStatistics.h>
+
+/*
+ * Internal helpers shared by the readers and writers.
+ * This header is not installed.
+ */
+
+namespace Vector {
+namespace BLF {
+namespace detail {
+
+/** value of a hex digit, or -1 */
+inline int hexDigit(const char c) {
+    if ((c >= '0') && (c <= '9'))
+        return c - '0';
+    if ((c >= 'A') && (c <= 'F'))
+        return c - 'A' + 10;
+    if ((c >= 'a') && (c <= 'f'))
+        return c - 'a' + 10;
+    return -1;
+}
+
+/** days since 1970-01-01 of a date in the proleptic Gregorian calendar */
+inline int64_t daysFromCivil(int64_t year, const unsigned int month, const unsigned int day) {
+    year -= (month <= 2) ? 1 : 0;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned int yearOfEra = static_cast<unsigned int>(year - era * 400);
+    const unsigned int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const unsigned int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+}
+
+/** date in the proleptic Gregorian calendar of days since 1970-01-01 */
+inline void civilFromDays(int64_t days, SYSTEMTIME & systemTime) {
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned int dayOfEra = static_cast<unsigned int>(days - era * 146097);
+    const unsigned int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const unsigned int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const unsigned int mp = (5 * dayOfYear + 2) / 153;
+    systemTime.day = static_cast<uint16_t>(dayOfYear - (153 * mp + 2) / 5 + 1);
+    systemTime.month = static_cast<uint16_t>(mp < 10 ? mp + 3 : mp - 9);
+    systemTime.year = static_cast<uint16_t>(static_cast<int64_t>(yearOfEra) + era * 400 + (systemTime.month <= 2 ? 1 : 0));
+}
+
+}
+}
+}
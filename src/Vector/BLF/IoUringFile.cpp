@@ -0,0 +1,584 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/IoUringFile.h>
+
+#ifdef OPTION_USE_IO_URING
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace Vector {
+namespace BLF {
+
+#ifdef OPTION_USE_IO_URING
+
+namespace {
+
+/** number of buffers, resp. operations in flight */
+const uint32_t slotCount = 4;
+
+/** buffer size, covering a few log containers */
+const uint32_t slotSize = 0x40000;
+
+/* There is no glibc wrapper for the io_uring system calls. */
+
+int ioUringSetup(unsigned entries, io_uring_params * params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int ioUringRegister(int ringFd, unsigned opcode, const void * arg, unsigned nrArgs) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, ringFd, opcode, arg, nrArgs));
+}
+
+}
+
+IoUringFile::~IoUringFile() {
+    close();
+}
+
+std::streamsize IoUringFile::gcount() const {
+    return m_gcount;
+}
+
+void IoUringFile::read(char * s, std::streamsize n) {
+    m_gcount = 0;
+    if (m_rdstate & (std::ios_base::failbit | std::ios_base::badbit)) {
+        m_rdstate |= std::ios_base::failbit;
+        return;
+    }
+
+    while (n > 0) {
+        /* end of file, unless the file has grown meanwhile */
+        if (m_position >= m_fileSize) {
+            struct stat st;
+            if (::fstat(m_fd, &st) == 0)
+                m_fileSize = static_cast<uint64_t>(st.st_size);
+            if (m_position >= m_fileSize) {
+                m_rdstate |= std::ios_base::eofbit | std::ios_base::failbit;
+                break;
+            }
+        }
+
+        /* find buffer containing the position */
+        Slot * slot = nullptr;
+        for (Slot & candidate : m_slots) {
+            if ((candidate.state != SlotState::Free) &&
+                    (m_position >= candidate.offset) &&
+                    (m_position < candidate.offset + candidate.length)) {
+                slot = &candidate;
+                break;
+            }
+        }
+
+        /* restart read ahead at the position */
+        if (!slot) {
+            drain();
+            for (Slot & unused : m_slots)
+                unused.state = SlotState::Free;
+            m_readAheadOffset = m_position;
+            readAhead();
+            if (!good())
+                break;
+            continue;
+        }
+
+        /* wait for data */
+        while (slot->state == SlotState::InFlight)
+            reap(true);
+        if (slot->result < 0) {
+            m_rdstate |= std::ios_base::badbit;
+            break;
+        }
+
+        /* short read, as the file ended there */
+        const uint64_t end = slot->offset + static_cast<uint32_t>(slot->result);
+        if (m_position >= end) {
+            slot->length = static_cast<uint32_t>(slot->result);
+            m_fileSize = end;
+            continue;
+        }
+
+        /* copy data */
+        const std::streamsize count = std::min(n, static_cast<std::streamsize>(end - m_position));
+        std::memcpy(s, slot->data + (m_position - slot->offset), static_cast<size_t>(count));
+        s += count;
+        n -= count;
+        m_position += static_cast<uint64_t>(count);
+        m_gcount += count;
+
+        /* reuse buffers behind the position */
+        for (Slot & used : m_slots) {
+            if ((used.state == SlotState::Done) && (used.offset + used.length <= m_position))
+                used.state = SlotState::Free;
+        }
+        readAhead();
+    }
+}
+
+std::streampos IoUringFile::tellg() {
+    /* in case of failure return -1 */
+    if (m_rdstate & (std::ios_base::failbit | std::ios_base::badbit))
+        return -1;
+    return static_cast<std::streamoff>(m_position);
+}
+
+void IoUringFile::seekg(std::streamoff off, const std::ios_base::seekdir way) {
+    /* like std::istream::seekg */
+    m_rdstate &= ~std::ios_base::eofbit;
+    if (m_rdstate & (std::ios_base::failbit | std::ios_base::badbit)) {
+        m_rdstate |= std::ios_base::failbit;
+        return;
+    }
+
+    /* new position */
+    std::streamoff position = off;
+    if (way == std::ios_base::cur)
+        position += static_cast<std::streamoff>(m_position);
+    else if (way == std::ios_base::end)
+        position += static_cast<std::streamoff>(m_fileSize);
+    if (position < 0) {
+        m_rdstate |= std::ios_base::failbit;
+        return;
+    }
+    m_position = static_cast<uint64_t>(position);
+}
+
+void IoUringFile::write(const char * s, std::streamsize n) {
+    if (m_rdstate & std::ios_base::badbit)
+        return;
+
+    while (n > 0) {
+        /* get a free buffer */
+        if (!m_fillSlot) {
+            for (;;) {
+                auto slot = std::find_if(m_slots.begin(), m_slots.end(), [](const Slot & candidate) {
+                    return candidate.state == SlotState::Free;
+                });
+                if (slot != m_slots.end()) {
+                    m_fillSlot = &*slot;
+                    break;
+                }
+                reap(true);
+                if (!good())
+                    return;
+            }
+            m_fillSlot->offset = m_position;
+            m_fillSlot->length = 0;
+            m_fillSlot->state = SlotState::Filling;
+        }
+
+        /* copy data */
+        const std::streamsize count = std::min(n, static_cast<std::streamsize>(slotSize - m_fillSlot->length));
+        std::memcpy(m_fillSlot->data + m_fillSlot->length, s, static_cast<size_t>(count));
+        m_fillSlot->length += static_cast<uint32_t>(count);
+        s += count;
+        n -= count;
+        m_position += static_cast<uint64_t>(count);
+
+        /* submit full buffer */
+        if (m_fillSlot->length == slotSize)
+            submitFillSlot();
+    }
+}
+
+std::streampos IoUringFile::tellp() {
+    /* in case of failure return -1 */
+    if (m_rdstate & (std::ios_base::failbit | std::ios_base::badbit))
+        return -1;
+    return static_cast<std::streamoff>(m_position);
+}
+
+bool IoUringFile::good() const {
+    return m_rdstate == std::ios_base::goodbit;
+}
+
+bool IoUringFile::eof() const {
+    return m_rdstate & std::ios_base::eofbit;
+}
+
+bool IoUringFile::open(const char * filename, std::ios_base::openmode openMode) {
+    if (is_open())
+        return false;
+
+    /* either read or write */
+    const bool in = openMode & std::ios_base::in;
+    const bool out = openMode & std::ios_base::out;
+    if (in == out)
+        return false;
+
+    /* only regular files, pipes etc. are read by CompressedFile itself */
+    struct stat st;
+    if (in && ((::stat(filename, &st) != 0) || !S_ISREG(st.st_mode)))
+        return false; // not opened, as opening a pipe lets its writer start
+
+    /* io_uring first, so that the file is not touched, if it's not available */
+    if (!setup()) {
+        teardown();
+        return false;
+    }
+
+    /* open file */
+    m_fd = out ?
+           ::open(filename, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666) :
+           ::open(filename, O_RDONLY | O_CLOEXEC | O_NONBLOCK); // don't wait for the writer of a pipe
+    if (m_fd < 0) {
+        teardown();
+        return false;
+    }
+
+    /* the file might have been replaced since, so check what was opened */
+    if (in && ((::fstat(m_fd, &st) != 0) || !S_ISREG(st.st_mode) ||
+               (::fcntl(m_fd, F_SETFL, ::fcntl(m_fd, F_GETFL) & ~O_NONBLOCK) != 0))) {
+        ::close(m_fd);
+        m_fd = -1;
+        teardown();
+        return false;
+    }
+
+    /* reset */
+    m_openMode = openMode;
+    m_fillSlot = nullptr;
+    m_position = 0;
+    m_fileSize = 0;
+    m_readAheadOffset = 0;
+    m_gcount = 0;
+    m_rdstate = std::ios_base::goodbit;
+    if (in)
+        m_fileSize = static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
+bool IoUringFile::is_open() const {
+    return m_fd >= 0;
+}
+
+void IoUringFile::close() {
+    if (!is_open())
+        return;
+
+    /* complete writes, buffers can't be released with operations in flight */
+    if (m_openMode & std::ios_base::out)
+        submitFillSlot();
+    drain();
+
+    teardown();
+    ::close(m_fd);
+    m_fd = -1;
+}
+
+void IoUringFile::seekp(std::streampos pos) {
+    /* overlapping writes are not ordered, so complete the previous ones */
+    flush();
+    m_position = static_cast<uint64_t>(static_cast<std::streamoff>(pos));
+}
+
+void IoUringFile::clear() {
+    /* read ahead data may be outdated */
+    if (is_open() && (m_openMode & std::ios_base::in)) {
+        drain();
+        for (Slot & slot : m_slots)
+            slot.state = SlotState::Free;
+    }
+    m_rdstate = std::ios_base::goodbit;
+}
+
+void IoUringFile::flush() {
+    if (!is_open() || !(m_openMode & std::ios_base::out))
+        return;
+    submitFillSlot();
+    drain();
+}
+
+bool IoUringFile::sync() {
+    if (!is_open())
+        return false;
+    flush();
+    return good() && (::fdatasync(m_fd) == 0);
+}
+
+bool IoUringFile::setup() {
+    /* ring */
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    m_ringFd = ioUringSetup(slotCount, &params);
+    if (m_ringFd < 0)
+        return false;
+
+    /* map rings */
+    m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap)
+        m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+    void * sqRing = ::mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED)
+        return false;
+    m_sqRing = sqRing;
+    if (singleMmap)
+        m_cqRing = m_sqRing;
+    else {
+        void * cqRing = ::mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED)
+            return false;
+        m_cqRing = cqRing;
+    }
+    m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void * sqes = ::mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+        return false;
+    m_sqes = sqes;
+
+    /* ring fields */
+    char * sq = static_cast<char *>(m_sqRing);
+    m_sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    m_sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    m_sqMask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    m_sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    char * cq = static_cast<char *>(m_cqRing);
+    m_cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    m_cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    m_cqMask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    m_cqes = cq + params.cq_off.cqes;
+
+    /* buffers */
+    void * buffer = nullptr;
+    if (::posix_memalign(&buffer, 4096, slotCount * slotSize) != 0)
+        return false;
+    m_buffer = static_cast<char *>(buffer);
+    std::vector<iovec> iovecs(slotCount);
+    m_slots.resize(slotCount);
+    for (uint32_t i = 0; i < slotCount; ++i) {
+        m_slots[i].data = m_buffer + i * slotSize;
+        m_slots[i].offset = 0;
+        m_slots[i].length = 0;
+        m_slots[i].result = 0;
+        m_slots[i].state = SlotState::Free;
+        iovecs[i].iov_base = m_slots[i].data;
+        iovecs[i].iov_len = slotSize;
+    }
+
+    /* register buffers, this fails if the memlock limit is too low */
+    return ioUringRegister(m_ringFd, IORING_REGISTER_BUFFERS, iovecs.data(), slotCount) == 0;
+}
+
+void IoUringFile::teardown() {
+    /* closing the ring unregisters the buffers */
+    if (m_ringFd >= 0) {
+        ::close(m_ringFd);
+        m_ringFd = -1;
+    }
+    if (m_sqes) {
+        ::munmap(m_sqes, m_sqesSize);
+        m_sqes = nullptr;
+    }
+    if (m_cqRing && (m_cqRing != m_sqRing))
+        ::munmap(m_cqRing, m_cqRingSize);
+    m_cqRing = nullptr;
+    if (m_sqRing) {
+        ::munmap(m_sqRing, m_sqRingSize);
+        m_sqRing = nullptr;
+    }
+    m_slots.clear();
+    m_fillSlot = nullptr;
+    std::free(m_buffer);
+    m_buffer = nullptr;
+}
+
+void IoUringFile::submit(Slot & slot) {
+    const unsigned slotIndex = static_cast<unsigned>(&slot - m_slots.data());
+
+    /* fill submission queue entry */
+    const unsigned tail = *m_sqTail;
+    const unsigned index = tail & *m_sqMask;
+    io_uring_sqe * sqe = static_cast<io_uring_sqe *>(m_sqes) + index;
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = (m_openMode & std::ios_base::out) ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+    sqe->fd = m_fd;
+    sqe->off = slot.offset;
+    sqe->addr = reinterpret_cast<uintptr_t>(slot.data);
+    sqe->len = slot.length;
+    sqe->buf_index = static_cast<uint16_t>(slotIndex);
+    sqe->user_data = slotIndex;
+    m_sqArray[index] = index;
+    __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+    slot.state = SlotState::InFlight;
+
+    /* submit */
+    int result;
+    do {
+        result = ioUringEnter(m_ringFd, 1, 0, 0);
+    } while ((result < 0) && (errno == EINTR));
+    if (result < 0) {
+        __atomic_store_n(m_sqTail, tail, __ATOMIC_RELEASE);
+        slot.state = SlotState::Free;
+        m_rdstate |= std::ios_base::badbit;
+    }
+}
+
+void IoUringFile::reap(bool wait) {
+    for (;;) {
+        /* take over completions */
+        unsigned head = *m_cqHead;
+        const unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+        if (head != tail) {
+            while (head != tail) {
+                const io_uring_cqe & cqe = static_cast<io_uring_cqe *>(m_cqes)[head & *m_cqMask];
+                Slot & slot = m_slots[static_cast<size_t>(cqe.user_data)];
+                slot.result = cqe.res;
+                if (m_openMode & std::ios_base::out)
+                    completeWrite(slot);
+                else
+                    slot.state = SlotState::Done;
+                head++;
+            }
+            __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+            return;
+        }
+        if (!wait)
+            return;
+
+        /* wait for completion */
+        if ((ioUringEnter(m_ringFd, 0, 1, IORING_ENTER_GETEVENTS) < 0) && (errno != EINTR)) {
+            m_rdstate |= std::ios_base::badbit;
+            return;
+        }
+    }
+}
+
+void IoUringFile::completeWrite(Slot & slot) {
+    slot.state = SlotState::Free;
+    if (slot.result < 0) {
+        m_rdstate |= std::ios_base::badbit;
+        return;
+    }
+
+    /* write the rest of short writes directly */
+    uint32_t written = static_cast<uint32_t>(slot.result);
+    while (written < slot.length) {
+        const ssize_t result = ::pwrite(m_fd, slot.data + written, slot.length - written, static_cast<off_t>(slot.offset + written));
+        if (result <= 0) {
+            if ((result < 0) && (errno == EINTR))
+                continue;
+            m_rdstate |= std::ios_base::badbit;
+            return;
+        }
+        written += static_cast<uint32_t>(result);
+    }
+}
+
+void IoUringFile::submitFillSlot() {
+    if (!m_fillSlot)
+        return;
+    if (m_fillSlot->length > 0)
+        submit(*m_fillSlot);
+    else
+        m_fillSlot->state = SlotState::Free;
+    m_fillSlot = nullptr;
+}
+
+void IoUringFile::drain() {
+    for (;;) {
+        const bool inFlight = std::any_of(m_slots.begin(), m_slots.end(), [](const Slot & slot) {
+            return slot.state == SlotState::InFlight;
+        });
+        if (!inFlight || (m_rdstate & std::ios_base::badbit))
+            return;
+        reap(true);
+    }
+}
+
+void IoUringFile::readAhead() {
+    for (Slot & slot : m_slots) {
+        if (m_readAheadOffset >= m_fileSize)
+            break;
+        if (slot.state != SlotState::Free)
+            continue;
+        slot.offset = m_readAheadOffset;
+        slot.length = static_cast<uint32_t>(std::min<uint64_t>(slotSize, m_fileSize - m_readAheadOffset));
+        submit(slot);
+        if (!good())
+            break;
+        m_readAheadOffset += slot.length;
+    }
+}
+
+#else
+
+/* Without io_uring, open fails and the caller falls back to another file. */
+
+IoUringFile::~IoUringFile() {
+}
+
+std::streamsize IoUringFile::gcount() const {
+    return 0;
+}
+
+void IoUringFile::read(char * /*s*/, std::streamsize /*n*/) {
+}
+
+std::streampos IoUringFile::tellg() {
+    return -1;
+}
+
+void IoUringFile::seekg(std::streamoff /*off*/, const std::ios_base::seekdir /*way*/) {
+}
+
+void IoUringFile::write(const char * /*s*/, std::streamsize /*n*/) {
+}
+
+std::streampos IoUringFile::tellp() {
+    return -1;
+}
+
+bool IoUringFile::good() const {
+    return false;
+}
+
+bool IoUringFile::eof() const {
+    return false;
+}
+
+bool IoUringFile::open(const char * /*filename*/, std::ios_base::openmode /*openMode*/) {
+    return false;
+}
+
+bool IoUringFile::is_open() const {
+    return false;
+}
+
+void IoUringFile::close() {
+}
+
+void IoUringFile::seekp(std::streampos /*pos*/) {
+}
+
+void IoUringFile::clear() {
+}
+
+void IoUringFile::flush() {
+}
+
+bool IoUringFile::sync() {
+    return false;
+}
+
+#endif
+
+}
+}
@@ -0,0 +1,250 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <ios>
+#include <vector>
+
+#include <Vector/BLF/AbstractFile.h>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * File using io_uring on Linux
+ *
+ * Reads are done ahead in several buffers, so that the disk works while the
+ * data of the previous buffer is processed. Writes are collected in a
+ * buffer, which is submitted when full, while the next buffer is filled.
+ * The buffers are registered with the kernel, so open fails if the memlock
+ * limit doesn't allow this.
+ *
+ * There is a single position for reading and writing. Seeking during write
+ * waits for the submitted writes to complete, so that overlapping writes
+ * (e.g. FileStatistics) are done in order.
+ *
+ * Only available, if the library was built with OPTION_USE_IO_URING,
+ * otherwise open fails. This class is not thread-safe.
+ */
+class VECTOR_BLF_EXPORT IoUringFile final : public AbstractFile {
+  public:
+    IoUringFile() = default;
+    ~IoUringFile() override;
+    IoUringFile(const IoUringFile &) = delete;
+    IoUringFile & operator=(const IoUringFile &) = delete;
+    IoUringFile(IoUringFile &&) = delete;
+    IoUringFile & operator=(IoUringFile &&) = delete;
+
+    std::streamsize gcount() const override;
+    void read(char * s, std::streamsize n) override;
+    std::streampos tellg() override;
+    void seekg(std::streamoff off, const std::ios_base::seekdir way = std::ios_base::cur) override;
+    void write(const char * s, std::streamsize n) override;
+    std::streampos tellp() override;
+    bool good() const override;
+    bool eof() const override;
+
+    /**
+     * open file
+     *
+     * @param[in] filename file name
+     * @param[in] openMode open in read or write mode
+     * @return false if io_uring is not available or the file can't be opened
+     */
+    virtual bool open(const char * filename, std::ios_base::openmode openMode);
+
+    /**
+     * is file open?
+     *
+     * @return true if file is open
+     */
+    virtual bool is_open() const;
+
+    /**
+     * Close file.
+     */
+    virtual void close();
+
+    /**
+     * Set position in output sequence.
+     *
+     * @param[in] pos Position
+     */
+    virtual void seekp(std::streampos pos);
+
+    /**
+     * Clear the error state, and discard the data read ahead, so that it's
+     * read again after the file has grown.
+     */
+    virtual void clear();
+
+    /**
+     * Submit buffered writes and wait for their completion.
+     */
+    virtual void flush();
+
+    /**
+     * Flush and sync the file data to disk.
+     *
+     * @return true if the data is on disk
+     */
+    virtual bool sync();
+
+  private:
+    /** state of a buffer */
+    enum class SlotState {
+        /** unused */
+        Free,
+
+        /** being filled by write */
+        Filling,
+
+        /** submitted */
+        InFlight,
+
+        /** completed */
+        Done
+    };
+
+    /** buffer for one read or write */
+    struct Slot {
+        /** data */
+        char * data;
+
+        /** file offset */
+        uint64_t offset;
+
+        /** requested length */
+        uint32_t length;
+
+        /** result of the operation, bytes or negative errno */
+        int32_t result;
+
+        /** state */
+        SlotState state;
+    };
+
+    /** file descriptor */
+    int m_fd {-1};
+
+    /** io_uring file descriptor */
+    int m_ringFd {-1};
+
+    /** open mode */
+    std::ios_base::openmode m_openMode {};
+
+    /** buffer memory */
+    char * m_buffer {};
+
+    /** buffers */
+    std::vector<Slot> m_slots {};
+
+    /** buffer being filled by write */
+    Slot * m_fillSlot {};
+
+    /** position */
+    uint64_t m_position {};
+
+    /** file size, for reading */
+    uint64_t m_fileSize {};
+
+    /** next offset to read ahead */
+    uint64_t m_readAheadOffset {};
+
+    /** last read size */
+    std::streamsize m_gcount {};
+
+    /** error state */
+    std::ios_base::iostate m_rdstate {std::ios_base::goodbit};
+
+    /* rings */
+
+    /** submission queue ring */
+    void * m_sqRing {};
+
+    /** submission queue ring size */
+    size_t m_sqRingSize {};
+
+    /** completion queue ring */
+    void * m_cqRing {};
+
+    /** completion queue ring size */
+    size_t m_cqRingSize {};
+
+    /** submission queue entries */
+    void * m_sqes {};
+
+    /** submission queue entries size */
+    size_t m_sqesSize {};
+
+    /** submission queue head, tail, mask and index array */
+    unsigned * m_sqHead {};
+    unsigned * m_sqTail {};
+    unsigned * m_sqMask {};
+    unsigned * m_sqArray {};
+
+    /** completion queue head, tail and mask */
+    unsigned * m_cqHead {};
+    unsigned * m_cqTail {};
+    unsigned * m_cqMask {};
+
+    /** completion queue entries */
+    void * m_cqes {};
+
+    /**
+     * Set up io_uring and buffers.
+     *
+     * @return true on success
+     */
+    bool setup();
+
+    /**
+     * Release io_uring and buffers.
+     */
+    void teardown();
+
+    /**
+     * Submit read or write of a buffer.
+     *
+     * @param[in] slot buffer
+     */
+    void submit(Slot & slot);
+
+    /**
+     * Take over completions.
+     *
+     * @param[in] wait wait for at least one completion
+     */
+    void reap(bool wait);
+
+    /**
+     * Check a completed write, and complete short writes.
+     *
+     * @param[in] slot buffer
+     */
+    void completeWrite(Slot & slot);
+
+    /**
+     * Submit the buffer being filled.
+     */
+    void submitFillSlot();
+
+    /**
+     * Wait for all submitted operations.
+     */
+    void drain();
+
+    /**
+     * Read ahead into free buffers.
+     */
+    void readAhead();
+};
+
+}
+}
@@ -0,0 +1,264 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/IsoTpReassembler.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <Vector/BLF/CanFdMessage.h>
+#include <Vector/BLF/CanFdMessage64.h>
+#include <Vector/BLF/CanMessage.h>
+#include <Vector/BLF/CanMessage2.h>
+
+namespace Vector {
+namespace BLF {
+
+namespace {
+
+/** key for connection lookup */
+uint64_t connectionKey(const uint16_t channel, const uint32_t id) {
+    return (static_cast<uint64_t>(channel) << 32) | id;
+}
+
+}
+
+IsoTpReassembler::IsoTpReassembler(std::function<void(const Pdu &)> callback) :
+    m_callback(callback) {
+}
+
+void IsoTpReassembler::addConnection(
+    const uint16_t channel,
+    const uint32_t txId,
+    const uint32_t rxId,
+    const AddressingMode addressingMode,
+    const uint8_t address,
+    const uint32_t maxPduSize) {
+    Connection connection;
+    connection.pdu.channel = channel;
+    connection.pdu.txId = txId;
+    connection.pdu.rxId = rxId;
+    connection.pdu.address = address;
+    connection.addressingMode = addressingMode;
+    connection.buffer.resize(maxPduSize);
+
+    m_txConnections.insert(std::make_pair(connectionKey(channel, txId), m_connections.size()));
+    m_rxConnections.insert(std::make_pair(connectionKey(channel, rxId), m_connections.size()));
+    m_connections.push_back(std::move(connection));
+}
+
+void IsoTpReassembler::process(const ObjectHeaderBase * ohb) {
+    if (ohb == nullptr)
+        return;
+
+    switch (ohb->objectType) {
+    case ObjectType::CAN_MESSAGE: {
+        auto * obj = static_cast<const CanMessage *>(ohb);
+        if (obj->flags & (1 << 7)) // RTR
+            break;
+        process(obj->channel, obj->id, obj->data.data(), std::min<uint8_t>(obj->dlc, 8), obj->objectTimeStampNs());
+    }
+    break;
+
+    case ObjectType::CAN_MESSAGE2: {
+        auto * obj = static_cast<const CanMessage2 *>(ohb);
+        if (obj->flags & (1 << 7)) // RTR
+            break;
+        uint8_t size = static_cast<uint8_t>(std::min<std::size_t>(std::min<uint8_t>(obj->dlc, 8), obj->data.size()));
+        process(obj->channel, obj->id, obj->data.data(), size, obj->objectTimeStampNs());
+    }
+    break;
+
+    case ObjectType::CAN_FD_MESSAGE: {
+        auto * obj = static_cast<const CanFdMessage *>(ohb);
+        if (obj->flags & CanFdMessage::Flags::RTR)
+            break;
+        process(obj->channel, obj->id, obj->data.data(), std::min<uint8_t>(obj->validDataBytes, 64), obj->objectTimeStampNs());
+    }
+    break;
+
+    case ObjectType::CAN_FD_MESSAGE_64: {
+        auto * obj = static_cast<const CanFdMessage64 *>(ohb);
+        if (obj->flags & 0x0010) // remote frame
+            break;
+        uint8_t size = static_cast<uint8_t>(std::min<std::size_t>(obj->validDataBytes, obj->data.size()));
+        process(obj->channel, obj->id, obj->data.data(), size, obj->objectTimeStampNs());
+    }
+    break;
+
+    default:
+        break;
+    }
+}
+
+void IsoTpReassembler::process(const uint16_t channel, const uint32_t id, const uint8_t * data, const uint8_t size, const uint64_t timeStamp) {
+    const uint64_t key = connectionKey(channel, id);
+
+    /* data frames */
+    auto txRange = m_txConnections.equal_range(key);
+    for (auto it = txRange.first; it != txRange.second; ++it) {
+        Connection & connection = m_connections[it->second];
+        if (connection.addressingMode == AddressingMode::Normal)
+            processDataFrame(connection, data, size, timeStamp);
+        else if ((size > 0) && (data[0] == connection.pdu.address))
+            processDataFrame(connection, data + 1, size - 1, timeStamp);
+    }
+
+    /* flow control frames */
+    auto rxRange = m_rxConnections.equal_range(key);
+    for (auto it = rxRange.first; it != rxRange.second; ++it) {
+        Connection & connection = m_connections[it->second];
+        switch (connection.addressingMode) {
+        case AddressingMode::Normal:
+            processFlowControlFrame(connection, data, size);
+            break;
+        case AddressingMode::Extended:
+            /* target address is the address of the sender of data frames, which is unknown */
+            if (size > 0)
+                processFlowControlFrame(connection, data + 1, size - 1);
+            break;
+        case AddressingMode::Mixed:
+            if ((size > 0) && (data[0] == connection.pdu.address))
+                processFlowControlFrame(connection, data + 1, size - 1);
+            break;
+        }
+    }
+}
+
+uint64_t IsoTpReassembler::errorCount() const {
+    return m_errorCount;
+}
+
+void IsoTpReassembler::processDataFrame(Connection & connection, const uint8_t * data, const uint8_t size, const uint64_t timeStamp) {
+    if (size < 1)
+        return;
+
+    switch (data[0] >> 4) {
+    case 0: { /* single frame */
+        uint32_t length = data[0] & 0x0f;
+        const uint8_t * payload = data + 1;
+        uint8_t available = size - 1;
+        if (length == 0) {
+            /* CAN FD escape sequence */
+            if (size < 2) {
+                m_errorCount++;
+                return;
+            }
+            length = data[1];
+            payload = data + 2;
+            available = size - 2;
+        }
+        if ((length == 0) || (length > available)) {
+            m_errorCount++;
+            return;
+        }
+
+        /* single frame interrupts multi frame reception */
+        if (connection.receiving) {
+            m_errorCount++;
+            connection.receiving = false;
+        }
+
+        /* emit */
+        connection.pdu.startTimeStamp = timeStamp;
+        connection.pdu.endTimeStamp = timeStamp;
+        connection.pdu.data = payload;
+        connection.pdu.size = length;
+        m_callback(connection.pdu);
+    }
+    break;
+
+    case 1: { /* first frame */
+        if (size < 2) {
+            m_errorCount++;
+            return;
+        }
+        uint32_t length = ((data[0] & 0x0f) << 8) | data[1];
+        const uint8_t * payload = data + 2;
+        uint8_t available = size - 2;
+        if (length == 0) {
+            /* escape sequence for PDUs > 4095 bytes */
+            if (size < 6) {
+                m_errorCount++;
+                return;
+            }
+            length =
+                (static_cast<uint32_t>(data[2]) << 24) |
+                (static_cast<uint32_t>(data[3]) << 16) |
+                (static_cast<uint32_t>(data[4]) << 8) |
+                (static_cast<uint32_t>(data[5]));
+            payload = data + 6;
+            available = size - 6;
+        }
+
+        /* first frame interrupts multi frame reception */
+        if (connection.receiving) {
+            m_errorCount++;
+            connection.receiving = false;
+        }
+
+        /* check buffer size */
+        if (length > connection.buffer.size()) {
+            m_errorCount++;
+            return;
+        }
+
+        /* start reception */
+        uint32_t count = std::min<uint32_t>(available, length);
+        std::memcpy(connection.buffer.data(), payload, count);
+        connection.expectedSize = length;
+        connection.receivedSize = count;
+        connection.sequenceNumber = 1;
+        connection.receiving = true;
+        connection.pdu.startTimeStamp = timeStamp;
+    }
+    break;
+
+    case 2: { /* consecutive frame */
+        if (!connection.receiving) {
+            m_errorCount++;
+            return;
+        }
+        if ((data[0] & 0x0f) != connection.sequenceNumber) {
+            m_errorCount++;
+            connection.receiving = false;
+            return;
+        }
+
+        /* copy data */
+        uint32_t count = std::min<uint32_t>(size - 1, connection.expectedSize - connection.receivedSize);
+        std::memcpy(connection.buffer.data() + connection.receivedSize, data + 1, count);
+        connection.receivedSize += count;
+        connection.sequenceNumber = (connection.sequenceNumber + 1) & 0x0f;
+    }
+    break;
+
+    default:
+        /* flow control frames are sent on rx id, other types are reserved */
+        return;
+    }
+
+    /* emit completed multi frame PDU */
+    if (connection.receiving && (connection.receivedSize >= connection.expectedSize)) {
+        connection.pdu.endTimeStamp = timeStamp;
+        connection.pdu.data = connection.buffer.data();
+        connection.pdu.size = connection.expectedSize;
+        connection.receiving = false;
+        m_callback(connection.pdu);
+    }
+}
+
+void IsoTpReassembler::processFlowControlFrame(Connection & connection, const uint8_t * data, const uint8_t size) {
+    if ((size < 1) || ((data[0] >> 4) != 3))
+        return;
+
+    /* flow status overflow aborts the reception */
+    if (((data[0] & 0x0f) == 2) && connection.receiving) {
+        m_errorCount++;
+        connection.receiving = false;
+    }
+}
+
+}
+}
@@ -0,0 +1,191 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <Vector/BLF/ObjectHeaderBase.h>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * ISO-TP (ISO 15765-2) reassembler
+ *
+ * Reassembles single, first and consecutive frames of CAN and CAN FD messages
+ * into PDUs. Connections are defined by channel, tx id (sender of data frames)
+ * and rx id (sender of flow control frames). CAN IDs are used as in the
+ * objects, i.e. bit 31 set for extended ids.
+ *
+ * Each connection owns a receive buffer of maxPduSize, which is allocated when
+ * the connection is added. Processing of frames doesn't allocate memory.
+ */
+class VECTOR_BLF_EXPORT IsoTpReassembler final {
+  public:
+    /** addressing mode */
+    enum class AddressingMode : uint8_t {
+        /** PCI is in first byte */
+        Normal,
+
+        /** first byte is target address (N_TA) */
+        Extended,
+
+        /** first byte is address extension (N_AE) */
+        Mixed
+    };
+
+    /** reassembled PDU */
+    struct Pdu {
+        /** application channel */
+        uint16_t channel {};
+
+        /** CAN ID of data frames */
+        uint32_t txId {};
+
+        /** CAN ID of flow control frames */
+        uint32_t rxId {};
+
+        /** target address or address extension (not used in normal addressing) */
+        uint8_t address {};
+
+        /** timestamp of single frame or first frame in ns */
+        uint64_t startTimeStamp {};
+
+        /** timestamp of single frame or last consecutive frame in ns */
+        uint64_t endTimeStamp {};
+
+        /** data (only valid during callback) */
+        const uint8_t * data {};
+
+        /** data size */
+        uint32_t size {};
+    };
+
+    /**
+     * constructor
+     *
+     * @param[in] callback called for each reassembled PDU
+     */
+    explicit IsoTpReassembler(std::function<void(const Pdu &)> callback);
+    virtual ~IsoTpReassembler() = default;
+
+    /**
+     * Add a connection.
+     *
+     * @param[in] channel application channel
+     * @param[in] txId CAN ID of data frames
+     * @param[in] rxId CAN ID of flow control frames
+     * @param[in] addressingMode addressing mode
+     * @param[in] address target address (extended) or address extension (mixed) in data frames
+     * @param[in] maxPduSize maximum PDU size, larger PDUs are discarded
+     */
+    virtual void addConnection(
+        const uint16_t channel,
+        const uint32_t txId,
+        const uint32_t rxId,
+        const AddressingMode addressingMode = AddressingMode::Normal,
+        const uint8_t address = 0,
+        const uint32_t maxPduSize = 4095);
+
+    /**
+     * Process an object.
+     *
+     * CanMessage, CanMessage2, CanFdMessage and CanFdMessage64 are
+     * evaluated, all other objects are ignored.
+     *
+     * @param[in] ohb object
+     */
+    virtual void process(const ObjectHeaderBase * ohb);
+
+    /**
+     * Process a frame.
+     *
+     * @param[in] channel application channel
+     * @param[in] id CAN ID
+     * @param[in] data data bytes
+     * @param[in] size number of data bytes
+     * @param[in] timeStamp timestamp in ns
+     */
+    virtual void process(const uint16_t channel, const uint32_t id, const uint8_t * data, const uint8_t size, const uint64_t timeStamp);
+
+    /**
+     * Number of protocol errors.
+     *
+     * These are sequence number errors, unexpected consecutive frames,
+     * interrupted receptions, flow control overflows and oversized PDUs.
+     *
+     * @return error count
+     */
+    virtual uint64_t errorCount() const;
+
+  private:
+    /** connection state */
+    struct Connection {
+        /** PDU information */
+        Pdu pdu {};
+
+        /** addressing mode */
+        AddressingMode addressingMode {AddressingMode::Normal};
+
+        /** receive buffer */
+        std::vector<uint8_t> buffer {};
+
+        /** expected PDU size */
+        uint32_t expectedSize {};
+
+        /** received bytes */
+        uint32_t receivedSize {};
+
+        /** expected sequence number */
+        uint8_t sequenceNumber {};
+
+        /** reception in progress */
+        bool receiving {};
+    };
+
+    /** PDU callback */
+    std::function<void(const Pdu &)> m_callback;
+
+    /** connections */
+    std::vector<Connection> m_connections {};
+
+    /** connection indices by channel and tx id */
+    std::multimap<uint64_t, std::size_t> m_txConnections {};
+
+    /** connection indices by channel and rx id */
+    std::multimap<uint64_t, std::size_t> m_rxConnections {};
+
+    /** protocol errors */
+    uint64_t m_errorCount {};
+
+    /**
+     * Process a data frame (SF, FF, CF).
+     *
+     * @param[in] connection connection
+     * @param[in] data data bytes after address byte
+     * @param[in] size number of data bytes after address byte
+     * @param[in] timeStamp timestamp in ns
+     */
+    void processDataFrame(Connection & connection, const uint8_t * data, const uint8_t size, const uint64_t timeStamp);
+
+    /**
+     * Process a flow control frame.
+     *
+     * @param[in] connection connection
+     * @param[in] data data bytes after address byte
+     * @param[in] size number of data bytes after address byte
+     */
+    void processFlowControlFrame(Connection & connection, const uint8_t * data, const uint8_t size);
+};
+
+}
+}
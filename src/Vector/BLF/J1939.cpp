@@ -0,0 +1,287 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/J1939.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <Vector/BLF/CanMessage.h>
+#include <Vector/BLF/CanMessage2.h>
+#include <Vector/BLF/J1708Message.h>
+
+namespace Vector {
+namespace BLF {
+
+constexpr uint32_t J1939::TpCmPgn;
+constexpr uint32_t J1939::TpDtPgn;
+constexpr uint8_t J1939::GlobalAddress;
+constexpr uint16_t J1939::MaxTpSize;
+
+namespace {
+
+/** TP.CM control bytes */
+enum TpCmControl : uint8_t {
+    RequestToSend = 16,
+    ClearToSend = 17,
+    EndOfMessageAcknowledge = 19,
+    BroadcastAnnounceMessage = 32,
+    ConnectionAbort = 255
+};
+
+/** key for session lookup */
+uint32_t sessionKey(const uint16_t channel, const uint8_t sourceAddress, const uint8_t destinationAddress) {
+    return (static_cast<uint32_t>(channel) << 16) | (static_cast<uint32_t>(sourceAddress) << 8) | destinationAddress;
+}
+
+/** update index entry */
+void updateIndexEntry(J1939::IndexEntry & indexEntry, const uint64_t timeStamp) {
+    if (indexEntry.count == 0)
+        indexEntry.firstTimeStamp = timeStamp;
+    indexEntry.lastTimeStamp = timeStamp;
+    indexEntry.count++;
+}
+
+}
+
+J1939::J1939(std::function<void(const Message &)> messageCallback, std::function<void(const J1708Frame &)> j1708Callback) :
+    m_messageCallback(messageCallback),
+    m_j1708Callback(j1708Callback) {
+}
+
+void J1939::parseId(const uint32_t id, uint8_t & priority, uint32_t & pgn, uint8_t & sourceAddress, uint8_t & destinationAddress) {
+    priority = (id >> 26) & 0x07;
+    sourceAddress = id & 0xff;
+    const uint8_t pduFormat = (id >> 16) & 0xff;
+    if (pduFormat < 240) {
+        /* PDU1: PDU specific is destination address */
+        pgn = (id >> 8) & 0x3ff00;
+        destinationAddress = (id >> 8) & 0xff;
+    } else {
+        /* PDU2: PDU specific is group extension */
+        pgn = (id >> 8) & 0x3ffff;
+        destinationAddress = GlobalAddress;
+    }
+}
+
+void J1939::setPgnFilter(const std::vector<uint32_t> & pgns) {
+    m_pgnFilter.clear();
+    if (pgns.empty())
+        return;
+    m_pgnFilter.resize(0x40000);
+    for (const uint32_t pgn : pgns)
+        m_pgnFilter[pgn & 0x3ffff] = true;
+}
+
+void J1939::process(const ObjectHeaderBase * ohb) {
+    if (ohb == nullptr)
+        return;
+
+    switch (ohb->objectType) {
+    case ObjectType::CAN_MESSAGE: {
+        auto * obj = static_cast<const CanMessage *>(ohb);
+        if (obj->flags & (1 << 7)) // RTR
+            break;
+        process(obj->channel, obj->id, obj->data.data(), std::min<uint8_t>(obj->dlc, 8), obj->objectTimeStampNs());
+    }
+    break;
+
+    case ObjectType::CAN_MESSAGE2: {
+        auto * obj = static_cast<const CanMessage2 *>(ohb);
+        if (obj->flags & (1 << 7)) // RTR
+            break;
+        uint8_t size = static_cast<uint8_t>(std::min<std::size_t>(std::min<uint8_t>(obj->dlc, 8), obj->data.size()));
+        process(obj->channel, obj->id, obj->data.data(), size, obj->objectTimeStampNs());
+    }
+    break;
+
+    case ObjectType::J1708_MESSAGE:
+    case ObjectType::J1708_VIRTUAL_MSG: {
+        auto * obj = static_cast<const J1708Message *>(ohb);
+        if (obj->error != 0)
+            break;
+        processJ1708(obj->channel, obj->data.data(), obj->size, obj->objectTimeStampNs());
+    }
+    break;
+
+    default:
+        break;
+    }
+}
+
+void J1939::process(const uint16_t channel, const uint32_t id, const uint8_t * data, const uint8_t size, const uint64_t timeStamp) {
+    /* only extended ids */
+    if ((id & 0x80000000) == 0)
+        return;
+
+    Message message;
+    message.channel = channel;
+    parseId(id, message.priority, message.pgn, message.sourceAddress, message.destinationAddress);
+    message.startTimeStamp = timeStamp;
+    message.endTimeStamp = timeStamp;
+    message.data = data;
+    message.size = size;
+
+    switch (message.pgn) {
+    case TpCmPgn:
+        processTpCm(message);
+        break;
+    case TpDtPgn:
+        processTpDt(message);
+        break;
+    default:
+        emit(message);
+        break;
+    }
+}
+
+void J1939::processJ1708(const uint16_t channel, const uint8_t * data, const uint8_t size, const uint64_t timeStamp) {
+    if (size < 1)
+        return;
+
+    /* sum of all bytes including checksum is zero */
+    uint8_t checksum = 0;
+    for (uint8_t i = 0; i < size; ++i)
+        checksum += data[i];
+
+    J1708Frame frame;
+    frame.channel = channel;
+    frame.mid = data[0];
+    frame.timeStamp = timeStamp;
+    frame.data = data + 1;
+    frame.checksumValid = (size >= 2) && (checksum == 0);
+    frame.size = frame.checksumValid ? size - 2 : size - 1;
+
+    updateIndexEntry(m_midIndex[channel][frame.mid], timeStamp);
+    if (m_j1708Callback)
+        m_j1708Callback(frame);
+}
+
+std::map<uint32_t, J1939::IndexEntry> J1939::pgnIndex(const uint16_t channel) const {
+    auto it = m_pgnIndex.find(channel);
+    if (it == m_pgnIndex.end())
+        return std::map<uint32_t, IndexEntry>();
+    return it->second;
+}
+
+std::map<uint8_t, J1939::IndexEntry> J1939::midIndex(const uint16_t channel) const {
+    auto it = m_midIndex.find(channel);
+    if (it == m_midIndex.end())
+        return std::map<uint8_t, IndexEntry>();
+    return it->second;
+}
+
+uint64_t J1939::errorCount() const {
+    return m_errorCount;
+}
+
+void J1939::processTpCm(const Message & message) {
+    if (message.size < 8)
+        return;
+
+    const uint8_t * data = message.data;
+    switch (data[0]) {
+    case RequestToSend:
+    case BroadcastAnnounceMessage: {
+        const uint16_t size = data[1] | (data[2] << 8);
+        const uint8_t packetCount = data[3];
+        if ((size < 9) || (size > MaxTpSize) || (packetCount != (size + 6) / 7)) {
+            m_errorCount++;
+            return;
+        }
+
+        /* BAM is always global, RTS is never */
+        if ((data[0] == BroadcastAnnounceMessage) != (message.destinationAddress == GlobalAddress))
+            return;
+
+        Session & session = m_sessions[sessionKey(message.channel, message.sourceAddress, message.destinationAddress)];
+
+        /* new transfer interrupts the running one */
+        if (session.receiving)
+            m_errorCount++;
+
+        session.message = message;
+        session.message.pgn = data[5] | (data[6] << 8) | ((data[7] & 0x03) << 16);
+        session.message.data = session.buffer.data();
+        session.message.size = size;
+        session.packetCount = packetCount;
+        session.sequenceNumber = 1;
+        session.receiving = true;
+    }
+    break;
+
+    case ClearToSend: {
+        /* CTS is sent by the receiver, so the session is in reverse direction */
+        auto it = m_sessions.find(sessionKey(message.channel, message.destinationAddress, message.sourceAddress));
+        if ((it == m_sessions.end()) || !it->second.receiving)
+            return;
+
+        /* next packet number, 0 means hold */
+        if (data[2] != 0)
+            it->second.sequenceNumber = data[2];
+    }
+    break;
+
+    case ConnectionAbort: {
+        /* abort can be sent by either side */
+        for (const uint32_t key : {
+                    sessionKey(message.channel, message.sourceAddress, message.destinationAddress),
+                    sessionKey(message.channel, message.destinationAddress, message.sourceAddress)
+                }) {
+            auto it = m_sessions.find(key);
+            if ((it != m_sessions.end()) && it->second.receiving) {
+                it->second.receiving = false;
+                m_errorCount++;
+            }
+        }
+    }
+    break;
+
+    case EndOfMessageAcknowledge:
+    default:
+        break;
+    }
+}
+
+void J1939::processTpDt(const Message & message) {
+    if (message.size < 8)
+        return;
+
+    auto it = m_sessions.find(sessionKey(message.channel, message.sourceAddress, message.destinationAddress));
+    if ((it == m_sessions.end()) || !it->second.receiving) {
+        m_errorCount++;
+        return;
+    }
+    Session & session = it->second;
+
+    const uint8_t sequenceNumber = message.data[0];
+    if ((sequenceNumber != session.sequenceNumber) || (sequenceNumber > session.packetCount)) {
+        m_errorCount++;
+        session.receiving = false;
+        return;
+    }
+
+    /* copy data */
+    const uint16_t offset = (sequenceNumber - 1) * 7;
+    const uint16_t count = std::min<uint16_t>(7, session.message.size - offset);
+    std::memcpy(session.buffer.data() + offset, message.data + 1, count);
+    session.sequenceNumber++;
+
+    /* emit completed transfer */
+    if (sequenceNumber == session.packetCount) {
+        session.receiving = false;
+        session.message.endTimeStamp = message.endTimeStamp;
+        emit(session.message);
+    }
+}
+
+void J1939::emit(const Message & message) {
+    updateIndexEntry(m_pgnIndex[message.channel][message.pgn], message.endTimeStamp);
+    if (!m_pgnFilter.empty() && !m_pgnFilter[message.pgn])
+        return;
+    m_messageCallback(message);
+}
+
+}
+}
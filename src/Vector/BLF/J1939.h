@@ -0,0 +1,265 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <array>
+#include <functional>
+#include <map>
+#include <vector>
+
+#include <Vector/BLF/ObjectHeaderBase.h>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * J1939 demultiplexer
+ *
+ * Parses extended CAN IDs of CanMessage and CanMessage2 objects into
+ * priority, PGN, source and destination address, reassembles transport
+ * protocol transfers (TP.CM/TP.DT, both BAM and RTS/CTS) and keeps a PGN
+ * index per channel. J1708Message objects are handled in the same pass,
+ * so a trucking log only needs to be read once.
+ *
+ * Transport protocol sessions own a buffer of the maximum transfer size
+ * (1785 bytes), which is allocated with the first session between two nodes
+ * and reused afterwards.
+ */
+class VECTOR_BLF_EXPORT J1939 final {
+  public:
+    /** PGN of transport protocol connection management (TP.CM) */
+    static constexpr uint32_t TpCmPgn = 0xEC00;
+
+    /** PGN of transport protocol data transfer (TP.DT) */
+    static constexpr uint32_t TpDtPgn = 0xEB00;
+
+    /** global destination address */
+    static constexpr uint8_t GlobalAddress = 0xFF;
+
+    /** maximum transport protocol message size */
+    static constexpr uint16_t MaxTpSize = 255 * 7;
+
+    /** J1939 message (single frame or reassembled transfer) */
+    struct Message {
+        /** application channel */
+        uint16_t channel {};
+
+        /** parameter group number */
+        uint32_t pgn {};
+
+        /** priority */
+        uint8_t priority {};
+
+        /** source address */
+        uint8_t sourceAddress {};
+
+        /** destination address (GlobalAddress for PDU2 and BAM) */
+        uint8_t destinationAddress {};
+
+        /** timestamp of the frame or TP.CM in ns */
+        uint64_t startTimeStamp {};
+
+        /** timestamp of the frame or last TP.DT in ns */
+        uint64_t endTimeStamp {};
+
+        /** data (only valid during callback) */
+        const uint8_t * data {};
+
+        /** data size */
+        uint16_t size {};
+    };
+
+    /** J1708 message */
+    struct J1708Frame {
+        /** application channel */
+        uint16_t channel {};
+
+        /** message identifier */
+        uint8_t mid {};
+
+        /** timestamp in ns */
+        uint64_t timeStamp {};
+
+        /** data after MID, without checksum if it is valid (only valid during callback) */
+        const uint8_t * data {};
+
+        /** data size */
+        uint8_t size {};
+
+        /** checksum is valid */
+        bool checksumValid {};
+    };
+
+    /** index entry */
+    struct IndexEntry {
+        /** number of messages */
+        uint64_t count {};
+
+        /** timestamp of first message in ns */
+        uint64_t firstTimeStamp {};
+
+        /** timestamp of last message in ns */
+        uint64_t lastTimeStamp {};
+    };
+
+    /**
+     * constructor
+     *
+     * @param[in] messageCallback called for each J1939 message
+     * @param[in] j1708Callback called for each J1708 message (optional)
+     */
+    explicit J1939(std::function<void(const Message &)> messageCallback, std::function<void(const J1708Frame &)> j1708Callback = nullptr);
+    virtual ~J1939() = default;
+
+    /**
+     * Parse a 29-bit CAN ID.
+     *
+     * @param[in] id CAN ID (bit 31 is ignored)
+     * @param[out] priority priority
+     * @param[out] pgn parameter group number
+     * @param[out] sourceAddress source address
+     * @param[out] destinationAddress destination address (GlobalAddress for PDU2)
+     */
+    static void parseId(const uint32_t id, uint8_t & priority, uint32_t & pgn, uint8_t & sourceAddress, uint8_t & destinationAddress);
+
+    /**
+     * Restrict callbacks to some PGNs.
+     *
+     * The index is updated for all PGNs. An empty list disables the filter.
+     *
+     * @param[in] pgns PGNs to pass to the message callback
+     */
+    virtual void setPgnFilter(const std::vector<uint32_t> & pgns);
+
+    /**
+     * Process an object.
+     *
+     * CanMessage, CanMessage2 and J1708Message are evaluated, all other
+     * objects are ignored.
+     *
+     * @param[in] ohb object
+     */
+    virtual void process(const ObjectHeaderBase * ohb);
+
+    /**
+     * Process a CAN frame.
+     *
+     * Frames with standard IDs are ignored.
+     *
+     * @param[in] channel application channel
+     * @param[in] id CAN ID with bit 31 set
+     * @param[in] data data bytes
+     * @param[in] size number of data bytes
+     * @param[in] timeStamp timestamp in ns
+     */
+    virtual void process(const uint16_t channel, const uint32_t id, const uint8_t * data, const uint8_t size, const uint64_t timeStamp);
+
+    /**
+     * Process a J1708 message.
+     *
+     * @param[in] channel application channel
+     * @param[in] data data bytes, starting with MID and ending with checksum
+     * @param[in] size number of data bytes
+     * @param[in] timeStamp timestamp in ns
+     */
+    virtual void processJ1708(const uint16_t channel, const uint8_t * data, const uint8_t size, const uint64_t timeStamp);
+
+    /**
+     * PGN index of a channel.
+     *
+     * Reassembled transfers are counted with their transported PGN.
+     * TP.CM and TP.DT frames are not counted.
+     *
+     * @param[in] channel application channel
+     * @return index entries by PGN
+     */
+    virtual std::map<uint32_t, IndexEntry> pgnIndex(const uint16_t channel) const;
+
+    /**
+     * MID index of a J1708 channel.
+     *
+     * @param[in] channel application channel
+     * @return index entries by MID
+     */
+    virtual std::map<uint8_t, IndexEntry> midIndex(const uint16_t channel) const;
+
+    /**
+     * Number of transport protocol errors.
+     *
+     * These are sequence errors, unexpected TP.DT frames, interrupted and
+     * aborted transfers.
+     *
+     * @return error count
+     */
+    virtual uint64_t errorCount() const;
+
+  private:
+    /** transport protocol session */
+    struct Session {
+        /** reassembled message */
+        Message message {};
+
+        /** receive buffer */
+        std::array<uint8_t, MaxTpSize> buffer {};
+
+        /** number of packets */
+        uint8_t packetCount {};
+
+        /** expected sequence number */
+        uint8_t sequenceNumber {};
+
+        /** transfer in progress */
+        bool receiving {};
+    };
+
+    /** message callback */
+    std::function<void(const Message &)> m_messageCallback;
+
+    /** J1708 callback */
+    std::function<void(const J1708Frame &)> m_j1708Callback;
+
+    /** PGN filter (one bit per 18-bit PGN, empty if disabled) */
+    std::vector<bool> m_pgnFilter {};
+
+    /** sessions by channel, source and destination address */
+    std::map<uint32_t, Session> m_sessions {};
+
+    /** PGN index by channel */
+    std::map<uint16_t, std::map<uint32_t, IndexEntry>> m_pgnIndex {};
+
+    /** MID index by channel */
+    std::map<uint16_t, std::map<uint8_t, IndexEntry>> m_midIndex {};
+
+    /** protocol errors */
+    uint64_t m_errorCount {};
+
+    /**
+     * Process TP.CM frame.
+     *
+     * @param[in] message frame
+     */
+    void processTpCm(const Message & message);
+
+    /**
+     * Process TP.DT frame.
+     *
+     * @param[in] message frame
+     */
+    void processTpDt(const Message & message);
+
+    /**
+     * Update index and call message callback.
+     *
+     * @param[in] message message
+     */
+    void emit(const Message & message);
+};
+
+}
+}
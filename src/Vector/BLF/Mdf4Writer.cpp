@@ -0,0 +1,687 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/Mdf4Writer.h>
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <thread>
+
+#include <zlib.h>
+
+#include <Vector/BLF/CanFdMessage.h>
+#include <Vector/BLF/CanFdMessage64.h>
+#include <Vector/BLF/CanMessage.h>
+#include <Vector/BLF/CanMessage2.h>
+#include <Vector/BLF/config.h>
+#include <Vector/BLF/EthernetFrame.h>
+#include <Vector/BLF/EthernetFrameEx.h>
+#include <Vector/BLF/EthernetFrameForwarded.h>
+#include <Vector/BLF/Exceptions.h>
+#include <Vector/BLF/Helpers.h>
+#include <Vector/BLF/FlexRayVFrReceiveMsg.h>
+#include <Vector/BLF/FlexRayVFrReceiveMsgEx.h>
+#include <Vector/BLF/LinMessage.h>
+#include <Vector/BLF/LinMessage2.h>
+
+namespace Vector {
+namespace BLF {
+
+namespace {
+
+/** CAN message flags */
+const uint8_t CanFlagTx = 0x01;
+const uint8_t CanFlagRtr = 0x80;
+
+/** CAN FD message flags */
+const uint32_t CanFdFlagRemote = 0x0010;
+const uint32_t CanFdFlagEdl = 0x1000;
+const uint32_t CanFdFlagBrs = 0x2000;
+const uint32_t CanFdFlagEsi = 0x4000;
+
+/** extended identifier flag */
+const uint32_t ExtendedId = 0x80000000;
+
+/** file position of HDBLOCK */
+const uint64_t HeaderPosition = 64;
+
+/** channel types */
+enum ChannelType : uint8_t {
+    FixedLength = 0,
+    VariableLength = 1,
+    Master = 2
+};
+
+/** data types */
+enum DataType : uint8_t {
+    UnsignedIntegerLe = 0,
+    FloatLe = 4,
+    ByteArray = 10
+};
+
+/** member of a bus logging structure */
+struct ChannelDescription {
+    /** name without group name */
+    const char * name;
+
+    /** channel type */
+    ChannelType channelType;
+
+    /** data type */
+    DataType dataType;
+
+    /** byte offset in record */
+    uint32_t byteOffset;
+
+    /** bit offset in byte */
+    uint8_t bitOffset;
+
+    /** number of bits */
+    uint32_t bitCount;
+};
+
+/** bus logging group */
+struct GroupDescription {
+    /** group and structure name */
+    const char * name;
+
+    /** acquisition name and source name */
+    const char * acquisitionName;
+
+    /** bus type of source information */
+    uint8_t busType;
+
+    /** record size */
+    uint32_t recordSize;
+
+    /** members */
+    const ChannelDescription * channels;
+
+    /** number of members */
+    std::size_t channelCount;
+};
+
+/*
+ * Record layouts: Timestamp (float64) at offset 0, followed by the
+ * structure from offset 8 to the end of the record.
+ */
+
+const ChannelDescription CanChannels[] = {
+    { "BusChannel", FixedLength, UnsignedIntegerLe, 8, 0, 8 },
+    { "ID", FixedLength, UnsignedIntegerLe, 12, 0, 29 },
+    { "IDE", FixedLength, UnsignedIntegerLe, 9, 0, 1 },
+    { "Dir", FixedLength, UnsignedIntegerLe, 9, 1, 1 },
+    { "EDL", FixedLength, UnsignedIntegerLe, 9, 2, 1 },
+    { "BRS", FixedLength, UnsignedIntegerLe, 9, 3, 1 },
+    { "ESI", FixedLength, UnsignedIntegerLe, 9, 4, 1 },
+    { "DLC", FixedLength, UnsignedIntegerLe, 10, 0, 4 },
+    { "DataLength", FixedLength, UnsignedIntegerLe, 11, 0, 7 },
+    { "DataBytes", FixedLength, ByteArray, 16, 0, 64 * 8 }
+};
+
+const ChannelDescription LinChannels[] = {
+    { "BusChannel", FixedLength, UnsignedIntegerLe, 8, 0, 8 },
+    { "ID", FixedLength, UnsignedIntegerLe, 9, 0, 6 },
+    { "Dir", FixedLength, UnsignedIntegerLe, 10, 0, 1 },
+    { "DataLength", FixedLength, UnsignedIntegerLe, 11, 0, 4 },
+    { "Checksum", FixedLength, UnsignedIntegerLe, 12, 0, 8 },
+    { "DataBytes", FixedLength, ByteArray, 16, 0, 8 * 8 }
+};
+
+const ChannelDescription FlexRayChannels[] = {
+    { "BusChannel", FixedLength, UnsignedIntegerLe, 8, 0, 8 },
+    { "FlexRayChannel", FixedLength, UnsignedIntegerLe, 9, 0, 2 },
+    { "Dir", FixedLength, UnsignedIntegerLe, 9, 2, 1 },
+    { "CycleCount", FixedLength, UnsignedIntegerLe, 10, 0, 6 },
+    { "DataLength", FixedLength, UnsignedIntegerLe, 11, 0, 8 },
+    { "ID", FixedLength, UnsignedIntegerLe, 12, 0, 11 },
+    { "HeaderCRC", FixedLength, UnsignedIntegerLe, 14, 0, 11 },
+    { "DataBytes", FixedLength, ByteArray, 16, 0, 254 * 8 }
+};
+
+const ChannelDescription EthernetChannels[] = {
+    { "BusChannel", FixedLength, UnsignedIntegerLe, 8, 0, 8 },
+    { "Dir", FixedLength, UnsignedIntegerLe, 9, 0, 1 },
+    { "DataLength", FixedLength, UnsignedIntegerLe, 10, 0, 16 },
+    { "DataBytes", VariableLength, ByteArray, 16, 0, 64 }
+};
+
+const GroupDescription Groups[] = {
+    { "CAN_DataFrame", "CAN", 2, 80, CanChannels, sizeof(CanChannels) / sizeof(CanChannels[0]) },
+    { "LIN_Frame", "LIN", 3, 24, LinChannels, sizeof(LinChannels) / sizeof(LinChannels[0]) },
+    { "FlexRay_Frame", "FlexRay", 5, 272, FlexRayChannels, sizeof(FlexRayChannels) / sizeof(FlexRayChannels[0]) },
+    { "ETH_Frame", "Ethernet", 7, 24, EthernetChannels, sizeof(EthernetChannels) / sizeof(EthernetChannels[0]) }
+};
+
+/** block data in little endian byte order */
+struct BlockData {
+    /** bytes */
+    std::vector<uint8_t> bytes {};
+
+    /** append value */
+    template<typename T>
+    BlockData & put(const T value) {
+        const uint8_t * data = reinterpret_cast<const uint8_t *>(&value);
+        bytes.insert(bytes.end(), data, data + sizeof(value));
+        return *this;
+    }
+
+    /** append zero bytes */
+    BlockData & zeros(const std::size_t size) {
+        bytes.insert(bytes.end(), size, 0);
+        return *this;
+    }
+};
+
+/** store value in record */
+template<typename T>
+void store(std::vector<uint8_t> & record, const std::size_t offset, const T value) {
+    std::memcpy(record.data() + offset, &value, sizeof(value));
+}
+
+}
+
+struct Mdf4Writer::Stream {
+    /** constructor */
+    explicit Stream(const char * blockType) :
+        blockType(blockType) {
+    }
+
+    /** block type, "DT" or "SD" */
+    const char * blockType;
+
+    /** current block */
+    std::vector<uint8_t> buffer {};
+
+    /** file positions of written blocks */
+    std::vector<uint64_t> blocks {};
+
+    /** number of bytes appended */
+    uint64_t length {};
+};
+
+struct Mdf4Writer::Group {
+    /** records */
+    Stream records {"DT"};
+
+    /** variable length signal data */
+    Stream signalData {"SD"};
+
+    /** number of records */
+    uint64_t cycleCount {};
+};
+
+struct Mdf4Writer::PendingBlock {
+    /** stream the block belongs to */
+    Stream * stream {};
+
+    /** uncompressed data */
+    std::vector<uint8_t> data {};
+
+    /** compressed data */
+    std::vector<uint8_t> compressedData {};
+
+    /** compression task */
+    std::future<void> done {};
+};
+
+Mdf4Writer::Mdf4Writer(const std::string & filename, const int compressionLevel, const std::size_t blockSize) :
+    m_file(filename, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc),
+    m_compressionLevel(compressionLevel),
+    m_blockSize(std::max<std::size_t>(blockSize, 1024)),
+    m_maxPendingBlocks(std::max(std::thread::hardware_concurrency(), 1U)) {
+    if (!m_file.is_open())
+        throw Exception("Mdf4Writer::Mdf4Writer(): Unable to open file.");
+
+    /* IDBLOCK */
+    BlockData id;
+    const char identification[] = "MDF     4.10    VecBLF  ";
+    id.bytes.assign(identification, identification + 24);
+    id.zeros(4).put<uint16_t>(410).zeros(30).put<uint16_t>(0).put<uint16_t>(0);
+    m_file.write(reinterpret_cast<const char *>(id.bytes.data()), static_cast<std::streamsize>(id.bytes.size()));
+    m_position = id.bytes.size();
+
+    /* HDBLOCK, links and start time are updated on close */
+    BlockData hd;
+    hd.put<uint64_t>(0).put<int16_t>(0).put<int16_t>(0).put<uint8_t>(0).put<uint8_t>(0).put<uint8_t>(0).put<uint8_t>(0).put<double>(0).put<double>(0);
+    writeBlock("HD", std::vector<uint64_t>(6, 0), hd.bytes.data(), hd.bytes.size());
+}
+
+Mdf4Writer::~Mdf4Writer() {
+    /* destructors must not throw, call close() before to get compression errors */
+    try {
+        close();
+    } catch (Vector::BLF::Exception &) {
+    }
+}
+
+void Mdf4Writer::setStartTime(const uint64_t startTime) {
+    m_startTime = startTime;
+}
+
+void Mdf4Writer::setStartTime(const SYSTEMTIME & startTime) {
+    if (startTime.year == 0) {
+        m_startTime = 0;
+        return;
+    }
+    const int64_t days = detail::daysFromCivil(startTime.year, startTime.month, startTime.day);
+    const int64_t seconds = days * 86400 + startTime.hour * 3600 + startTime.minute * 60 + startTime.second;
+    m_startTime = static_cast<uint64_t>(seconds) * 1000000000 + static_cast<uint64_t>(startTime.milliseconds) * 1000000;
+}
+
+void Mdf4Writer::write(const ObjectHeaderBase * ohb) {
+    if (ohb == nullptr)
+        return;
+
+    switch (ohb->objectType) {
+    case ObjectType::CAN_MESSAGE: {
+        auto * obj = static_cast<const CanMessage *>(ohb);
+        if (obj->flags & CanFlagRtr)
+            break;
+        const uint8_t size = std::min<uint8_t>(obj->dlc, 8);
+        Group & g = beginRecord(Can, obj->objectTimeStampNs());
+        store<uint8_t>(m_record, 8, static_cast<uint8_t>(obj->channel));
+        store<uint8_t>(m_record, 9, static_cast<uint8_t>(((obj->id & ExtendedId) ? 0x01 : 0) | ((obj->flags & CanFlagTx) ? 0x02 : 0)));
+        store<uint8_t>(m_record, 10, obj->dlc);
+        store<uint8_t>(m_record, 11, size);
+        store<uint32_t>(m_record, 12, obj->id & ~ExtendedId);
+        std::copy(obj->data.begin(), obj->data.begin() + size, m_record.begin() + 16);
+        endRecord(g);
+    }
+    break;
+
+    case ObjectType::CAN_MESSAGE2: {
+        auto * obj = static_cast<const CanMessage2 *>(ohb);
+        if (obj->flags & CanFlagRtr)
+            break;
+        const uint8_t size = static_cast<uint8_t>(std::min<std::size_t>(std::min<uint8_t>(obj->dlc, 8), obj->data.size()));
+        Group & g = beginRecord(Can, obj->objectTimeStampNs());
+        store<uint8_t>(m_record, 8, static_cast<uint8_t>(obj->channel));
+        store<uint8_t>(m_record, 9, static_cast<uint8_t>(((obj->id & ExtendedId) ? 0x01 : 0) | ((obj->flags & CanFlagTx) ? 0x02 : 0)));
+        store<uint8_t>(m_record, 10, obj->dlc);
+        store<uint8_t>(m_record, 11, size);
+        store<uint32_t>(m_record, 12, obj->id & ~ExtendedId);
+        std::copy(obj->data.begin(), obj->data.begin() + size, m_record.begin() + 16);
+        endRecord(g);
+    }
+    break;
+
+    case ObjectType::CAN_FD_MESSAGE: {
+        auto * obj = static_cast<const CanFdMessage *>(ohb);
+        if (obj->flags & CanFdMessage::Flags::RTR)
+            break;
+        const uint8_t size = std::min<uint8_t>(obj->validDataBytes, 64);
+        Group & g = beginRecord(Can, obj->objectTimeStampNs());
+        store<uint8_t>(m_record, 8, static_cast<uint8_t>(obj->channel));
+        store<uint8_t>(m_record, 9, static_cast<uint8_t>(
+                           ((obj->id & ExtendedId) ? 0x01 : 0) |
+                           ((obj->flags & CanFdMessage::Flags::TX) ? 0x02 : 0) |
+                           ((obj->canFdFlags & CanFdMessage::CanFdFlags::EDL) ? 0x04 : 0) |
+                           ((obj->canFdFlags & CanFdMessage::CanFdFlags::BRS) ? 0x08 : 0) |
+                           ((obj->canFdFlags & CanFdMessage::CanFdFlags::ESI) ? 0x10 : 0)));
+        store<uint8_t>(m_record, 10, obj->dlc);
+        store<uint8_t>(m_record, 11, size);
+        store<uint32_t>(m_record, 12, obj->id & ~ExtendedId);
+        std::copy(obj->data.begin(), obj->data.begin() + size, m_record.begin() + 16);
+        endRecord(g);
+    }
+    break;
+
+    case ObjectType::CAN_FD_MESSAGE_64: {
+        auto * obj = static_cast<const CanFdMessage64 *>(ohb);
+        if (obj->flags & CanFdFlagRemote)
+            break;
+        const uint8_t size = static_cast<uint8_t>(std::min<std::size_t>(std::min<uint8_t>(obj->validDataBytes, 64), obj->data.size()));
+        Group & g = beginRecord(Can, obj->objectTimeStampNs());
+        store<uint8_t>(m_record, 8, obj->channel);
+        store<uint8_t>(m_record, 9, static_cast<uint8_t>(
+                           ((obj->id & ExtendedId) ? 0x01 : 0) |
+                           ((obj->dir != 0) ? 0x02 : 0) |
+                           ((obj->flags & CanFdFlagEdl) ? 0x04 : 0) |
+                           ((obj->flags & CanFdFlagBrs) ? 0x08 : 0) |
+                           ((obj->flags & CanFdFlagEsi) ? 0x10 : 0)));
+        store<uint8_t>(m_record, 10, obj->dlc);
+        store<uint8_t>(m_record, 11, size);
+        store<uint32_t>(m_record, 12, obj->id & ~ExtendedId);
+        std::copy(obj->data.begin(), obj->data.begin() + size, m_record.begin() + 16);
+        endRecord(g);
+    }
+    break;
+
+    case ObjectType::LIN_MESSAGE: {
+        auto * obj = static_cast<const LinMessage *>(ohb);
+        const uint8_t size = std::min<uint8_t>(obj->dlc, 8);
+        Group & g = beginRecord(Lin, obj->objectTimeStampNs());
+        store<uint8_t>(m_record, 8, static_cast<uint8_t>(obj->channel));
+        store<uint8_t>(m_record, 9, obj->id);
+        store<uint8_t>(m_record, 10, (obj->dir != 0) ? 1 : 0);
+        store<uint8_t>(m_record, 11, size);
+        store<uint8_t>(m_record, 12, static_cast<uint8_t>(obj->crc));
+        std::copy(obj->data.begin(), obj->data.begin() + size, m_record.begin() + 16);
+        endRecord(g);
+    }
+    break;
+
+    case ObjectType::LIN_MESSAGE2: {
+        auto * obj = static_cast<const LinMessage2 *>(ohb);
+        const uint8_t size = std::min<uint8_t>(obj->dlc, 8);
+        Group & g = beginRecord(Lin, obj->objectTimeStampNs());
+        store<uint8_t>(m_record, 8, static_cast<uint8_t>(obj->channel));
+        store<uint8_t>(m_record, 9, obj->id);
+        store<uint8_t>(m_record, 10, (obj->dir != 0) ? 1 : 0);
+        store<uint8_t>(m_record, 11, size);
+        store<uint8_t>(m_record, 12, static_cast<uint8_t>(obj->crc));
+        std::copy(obj->data.begin(), obj->data.begin() + size, m_record.begin() + 16);
+        endRecord(g);
+    }
+    break;
+
+    case ObjectType::FR_RCVMESSAGE: {
+        auto * obj = static_cast<const FlexRayVFrReceiveMsg *>(ohb);
+        const uint8_t size = static_cast<uint8_t>(std::min<std::size_t>(obj->dataCount, obj->dataBytes.size()));
+        Group & g = beginRecord(FlexRay, obj->objectTimeStampNs());
+        store<uint8_t>(m_record, 8, static_cast<uint8_t>(obj->channel));
+        store<uint8_t>(m_record, 9, static_cast<uint8_t>((obj->channelMask & 0x03) | ((obj->dir != 0) ? 0x04 : 0)));
+        store<uint8_t>(m_record, 10, obj->cycle);
+        store<uint8_t>(m_record, 11, size);
+        store<uint16_t>(m_record, 12, obj->frameId);
+        store<uint16_t>(m_record, 14, obj->headerCrc1);
+        std::copy(obj->dataBytes.begin(), obj->dataBytes.begin() + size, m_record.begin() + 16);
+        endRecord(g);
+    }
+    break;
+
+    case ObjectType::FR_RCVMESSAGE_EX: {
+        auto * obj = static_cast<const FlexRayVFrReceiveMsgEx *>(ohb);
+        const uint8_t size = static_cast<uint8_t>(std::min<std::size_t>(std::min<std::size_t>(obj->dataCount, obj->dataBytes.size()), 254));
+        Group & g = beginRecord(FlexRay, obj->objectTimeStampNs());
+        store<uint8_t>(m_record, 8, static_cast<uint8_t>(obj->channel));
+        store<uint8_t>(m_record, 9, static_cast<uint8_t>((obj->channelMask & 0x03) | ((obj->dir != 0) ? 0x04 : 0)));
+        store<uint8_t>(m_record, 10, static_cast<uint8_t>(obj->cycle));
+        store<uint8_t>(m_record, 11, size);
+        store<uint16_t>(m_record, 12, obj->frameId);
+        store<uint16_t>(m_record, 14, obj->headerCrc1);
+        std::copy(obj->dataBytes.begin(), obj->dataBytes.begin() + size, m_record.begin() + 16);
+        endRecord(g);
+    }
+    break;
+
+    case ObjectType::ETHERNET_FRAME: {
+        auto * obj = static_cast<const EthernetFrame *>(ohb);
+
+        /* reconstruct frame: destination, source, optional VLAN tag, type, payload */
+        m_frame.clear();
+        m_frame.insert(m_frame.end(), obj->destinationAddress.begin(), obj->destinationAddress.end());
+        m_frame.insert(m_frame.end(), obj->sourceAddress.begin(), obj->sourceAddress.end());
+        if (obj->tpid != 0) {
+            m_frame.push_back(static_cast<uint8_t>(obj->tpid >> 8));
+            m_frame.push_back(static_cast<uint8_t>(obj->tpid));
+            m_frame.push_back(static_cast<uint8_t>(obj->tci >> 8));
+            m_frame.push_back(static_cast<uint8_t>(obj->tci));
+        }
+        m_frame.push_back(static_cast<uint8_t>(obj->type >> 8));
+        m_frame.push_back(static_cast<uint8_t>(obj->type));
+        m_frame.insert(m_frame.end(), obj->payLoad.begin(), obj->payLoad.end());
+
+        Group & g = beginRecord(Ethernet, obj->objectTimeStampNs());
+        store<uint8_t>(m_record, 8, static_cast<uint8_t>(obj->channel));
+        store<uint8_t>(m_record, 9, (obj->dir != 0) ? 1 : 0);
+        store<uint16_t>(m_record, 10, static_cast<uint16_t>(m_frame.size()));
+        store<uint64_t>(m_record, 16, g.signalData.length);
+        const uint32_t length = static_cast<uint32_t>(m_frame.size());
+        append(g.signalData, &length, sizeof(length));
+        append(g.signalData, m_frame.data(), m_frame.size());
+        endRecord(g);
+    }
+    break;
+
+    case ObjectType::ETHERNET_FRAME_EX: {
+        auto * obj = static_cast<const EthernetFrameEx *>(ohb);
+        Group & g = beginRecord(Ethernet, obj->objectTimeStampNs());
+        store<uint8_t>(m_record, 8, static_cast<uint8_t>(obj->channel));
+        store<uint8_t>(m_record, 9, (obj->dir != 0) ? 1 : 0);
+        store<uint16_t>(m_record, 10, static_cast<uint16_t>(obj->frameData.size()));
+        store<uint64_t>(m_record, 16, g.signalData.length);
+        const uint32_t length = static_cast<uint32_t>(obj->frameData.size());
+        append(g.signalData, &length, sizeof(length));
+        append(g.signalData, obj->frameData.data(), obj->frameData.size());
+        endRecord(g);
+    }
+    break;
+
+    case ObjectType::ETHERNET_FRAME_FORWARDED: {
+        auto * obj = static_cast<const EthernetFrameForwarded *>(ohb);
+        Group & g = beginRecord(Ethernet, obj->objectTimeStampNs());
+        store<uint8_t>(m_record, 8, static_cast<uint8_t>(obj->channel));
+        store<uint8_t>(m_record, 9, (obj->dir != 0) ? 1 : 0);
+        store<uint16_t>(m_record, 10, static_cast<uint16_t>(obj->frameData.size()));
+        store<uint64_t>(m_record, 16, g.signalData.length);
+        const uint32_t length = static_cast<uint32_t>(obj->frameData.size());
+        append(g.signalData, &length, sizeof(length));
+        append(g.signalData, obj->frameData.data(), obj->frameData.size());
+        endRecord(g);
+    }
+    break;
+
+    default:
+        break;
+    }
+}
+
+void Mdf4Writer::close() {
+    if (!m_file.is_open())
+        return;
+
+    /* remaining data blocks */
+    for (auto & group : m_groups) {
+        if (!group)
+            continue;
+        submit(group->records);
+        submit(group->signalData);
+    }
+    while (!m_pendingBlocks.empty())
+        writePendingBlock();
+
+    /* FHBLOCK */
+    const uint64_t fileHistoryComment = writeText("MD",
+            "<FHcomment>\n"
+            "<TX>created</TX>\n"
+            "<tool_id>Vector_BLF</tool_id>\n"
+            "<tool_vendor>Vector_BLF</tool_vendor>\n"
+            "<tool_version>" VECTOR_BLF_VERSION "</tool_version>\n"
+            "</FHcomment>\n");
+    BlockData fh;
+    fh.put<uint64_t>(m_startTime).put<int16_t>(0).put<int16_t>(0).put<uint8_t>(0).zeros(3);
+    const uint64_t fileHistory = writeBlock("FH", { 0, fileHistoryComment }, fh.bytes.data(), fh.bytes.size());
+
+    /* data groups in reverse order to link them */
+    uint64_t firstDataGroup = 0;
+    for (int groupType = GroupTypeCount - 1; groupType >= 0; --groupType)
+        if (m_groups[groupType])
+            firstDataGroup = writeDataGroup(static_cast<GroupType>(groupType), firstDataGroup);
+
+    /* update HDBLOCK: hd_dg_first, hd_fh_first and hd_start_time_ns */
+    const uint64_t links[2] = { firstDataGroup, fileHistory };
+    m_file.seekp(static_cast<std::streamoff>(HeaderPosition + 24));
+    m_file.write(reinterpret_cast<const char *>(links), sizeof(links));
+    m_file.seekp(static_cast<std::streamoff>(HeaderPosition + 24 + 6 * 8));
+    m_file.write(reinterpret_cast<const char *>(&m_startTime), sizeof(m_startTime));
+    m_file.close();
+}
+
+Mdf4Writer::Group & Mdf4Writer::group(const GroupType groupType) {
+    if (!m_groups[groupType]) {
+        m_groups[groupType].reset(new Group);
+        m_groups[groupType]->records.buffer.reserve(m_blockSize);
+    }
+    return *m_groups[groupType];
+}
+
+Mdf4Writer::Group & Mdf4Writer::beginRecord(const GroupType groupType, const uint64_t timeStamp) {
+    m_record.assign(Groups[groupType].recordSize, 0);
+    store<double>(m_record, 0, static_cast<double>(timeStamp) * 1e-9);
+    return group(groupType);
+}
+
+void Mdf4Writer::endRecord(Group & group) {
+    append(group.records, m_record.data(), m_record.size());
+    group.cycleCount++;
+}
+
+void Mdf4Writer::append(Stream & stream, const void * data, std::size_t size) {
+    const uint8_t * bytes = static_cast<const uint8_t *>(data);
+    while (size > 0) {
+        const std::size_t count = std::min(size, m_blockSize - stream.buffer.size());
+        stream.buffer.insert(stream.buffer.end(), bytes, bytes + count);
+        stream.length += count;
+        bytes += count;
+        size -= count;
+        if (stream.buffer.size() == m_blockSize)
+            submit(stream);
+    }
+}
+
+void Mdf4Writer::submit(Stream & stream) {
+    if (stream.buffer.empty())
+        return;
+
+    if (m_compressionLevel <= 0) {
+        stream.blocks.push_back(writeBlock(stream.blockType, {}, stream.buffer.data(), stream.buffer.size()));
+        stream.buffer.clear();
+        return;
+    }
+
+    /* compress in a worker thread */
+    std::unique_ptr<PendingBlock> pendingBlock(new PendingBlock);
+    pendingBlock->stream = &stream;
+    pendingBlock->data.swap(stream.buffer);
+    stream.buffer.reserve(m_blockSize);
+    PendingBlock * block = pendingBlock.get();
+    const int level = m_compressionLevel;
+    block->done = std::async(std::launch::async, [block, level]() {
+        uLongf size = compressBound(static_cast<uLong>(block->data.size()));
+        block->compressedData.resize(size);
+        if (::compress2(block->compressedData.data(), &size, block->data.data(), static_cast<uLong>(block->data.size()), level) != Z_OK)
+            throw Exception("Mdf4Writer::submit(): compress2 error");
+        block->compressedData.resize(size);
+    });
+    m_pendingBlocks.push_back(std::move(pendingBlock));
+
+    while (m_pendingBlocks.size() > m_maxPendingBlocks)
+        writePendingBlock();
+}
+
+void Mdf4Writer::writePendingBlock() {
+    std::unique_ptr<PendingBlock> block = std::move(m_pendingBlocks.front());
+    m_pendingBlocks.pop_front();
+    block->done.get();
+
+    /* keep uncompressed block, if compression doesn't pay off */
+    Stream & stream = *block->stream;
+    if (block->compressedData.size() + 24 >= block->data.size()) {
+        stream.blocks.push_back(writeBlock(stream.blockType, {}, block->data.data(), block->data.size()));
+        return;
+    }
+
+    /* DZBLOCK: original block type, zip type deflate, original and compressed length */
+    BlockData dz;
+    dz.bytes.push_back(static_cast<uint8_t>(stream.blockType[0]));
+    dz.bytes.push_back(static_cast<uint8_t>(stream.blockType[1]));
+    dz.put<uint8_t>(0).put<uint8_t>(0).put<uint32_t>(0).put<uint64_t>(block->data.size()).put<uint64_t>(block->compressedData.size());
+    dz.bytes.insert(dz.bytes.end(), block->compressedData.begin(), block->compressedData.end());
+    stream.blocks.push_back(writeBlock("DZ", {}, dz.bytes.data(), dz.bytes.size()));
+}
+
+uint64_t Mdf4Writer::writeBlock(const char * id, const std::vector<uint64_t> & links, const void * data, const std::size_t size) {
+    const uint64_t position = m_position;
+    const uint64_t length = 24 + 8 * links.size() + size;
+
+    BlockData header;
+    header.bytes.assign({ '#', '#', static_cast<uint8_t>(id[0]), static_cast<uint8_t>(id[1]) });
+    header.put<uint32_t>(0).put<uint64_t>(length).put<uint64_t>(links.size());
+    for (const uint64_t link : links)
+        header.put<uint64_t>(link);
+    m_file.write(reinterpret_cast<const char *>(header.bytes.data()), static_cast<std::streamsize>(header.bytes.size()));
+    m_file.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+
+    /* blocks start at 8 byte boundaries */
+    static const char padding[8] = {};
+    const std::size_t paddingSize = (8 - length % 8) % 8;
+    m_file.write(padding, static_cast<std::streamsize>(paddingSize));
+    m_position += length + paddingSize;
+    return position;
+}
+
+uint64_t Mdf4Writer::writeText(const char * id, const std::string & text) {
+    /* zero terminated, padded to 8 bytes */
+    std::vector<char> data(text.begin(), text.end());
+    data.resize((text.size() / 8 + 1) * 8, 0);
+    return writeBlock(id, {}, data.data(), data.size());
+}
+
+uint64_t Mdf4Writer::writeDataList(const Stream & stream) {
+    if (stream.blocks.empty())
+        return 0;
+    if (stream.blocks.size() == 1)
+        return stream.blocks[0];
+
+    /* DLBLOCK with equal length flag, as all blocks but the last have blockSize bytes */
+    std::vector<uint64_t> links;
+    links.push_back(0);
+    links.insert(links.end(), stream.blocks.begin(), stream.blocks.end());
+    BlockData dl;
+    dl.put<uint8_t>(1).zeros(3).put<uint32_t>(static_cast<uint32_t>(stream.blocks.size())).put<uint64_t>(m_blockSize);
+    return writeBlock("DL", links, dl.bytes.data(), dl.bytes.size());
+}
+
+uint64_t Mdf4Writer::writeDataGroup(const GroupType groupType, const uint64_t nextDataGroup) {
+    const GroupDescription & description = Groups[groupType];
+    const Group & g = *m_groups[groupType];
+    const std::string name = description.name;
+
+    /* CNBLOCK */
+    auto writeChannel = [this](const std::string & channelName, const uint64_t next, const uint64_t composition, const uint64_t data, const uint64_t unit,
+    const uint8_t channelType, const uint8_t syncType, const uint8_t dataType, const uint32_t byteOffset, const uint8_t bitOffset, const uint32_t bitCount) {
+        const uint64_t textName = writeText("TX", channelName);
+        BlockData cn;
+        cn.put<uint8_t>(channelType).put<uint8_t>(syncType).put<uint8_t>(dataType).put<uint8_t>(bitOffset);
+        cn.put<uint32_t>(byteOffset).put<uint32_t>(bitCount).put<uint32_t>(0).put<uint32_t>(0);
+        cn.put<uint8_t>(0).put<uint8_t>(0).put<uint16_t>(0).zeros(6 * 8);
+        return writeBlock("CN", { next, composition, textName, 0, 0, data, unit, 0 }, cn.bytes.data(), cn.bytes.size());
+    };
+
+    /* structure members in reverse order to link them */
+    uint64_t firstMember = 0;
+    for (std::size_t i = description.channelCount; i > 0; --i) {
+        const ChannelDescription & channel = description.channels[i - 1];
+        const uint64_t data = (channel.channelType == VariableLength) ? writeDataList(g.signalData) : 0;
+        firstMember = writeChannel(name + "." + channel.name, firstMember, 0, data, 0,
+                                   channel.channelType, 0, channel.dataType, channel.byteOffset, channel.bitOffset, channel.bitCount);
+    }
+    const uint64_t structure = writeChannel(name, 0, firstMember, 0, 0,
+                                            FixedLength, 0, ByteArray, 8, 0, (description.recordSize - 8) * 8);
+    const uint64_t timeStamp = writeChannel("Timestamp", structure, 0, 0, writeText("TX", "s"),
+                                            Master, 1, FloatLe, 0, 0, 64);
+
+    /* SIBLOCK: source type bus */
+    const uint64_t acquisitionName = writeText("TX", description.acquisitionName);
+    BlockData si;
+    si.put<uint8_t>(2).put<uint8_t>(description.busType).put<uint8_t>(0).zeros(5);
+    const uint64_t source = writeBlock("SI", { acquisitionName, 0, 0 }, si.bytes.data(), si.bytes.size());
+
+    /* CGBLOCK: bus event, plain bus event, path separator '.' */
+    BlockData cg;
+    cg.put<uint64_t>(0).put<uint64_t>(g.cycleCount).put<uint16_t>(0x0006).put<uint16_t>('.').zeros(4);
+    cg.put<uint32_t>(description.recordSize).put<uint32_t>(0);
+    const uint64_t channelGroup = writeBlock("CG", { 0, timeStamp, acquisitionName, source, 0, 0 }, cg.bytes.data(), cg.bytes.size());
+
+    /* DGBLOCK without record ids */
+    BlockData dg;
+    dg.put<uint8_t>(0).zeros(7);
+    return writeBlock("DG", { nextDataGroup, channelGroup, writeDataList(g.records), 0 }, dg.bytes.data(), dg.bytes.size());
+}
+
+}
+}
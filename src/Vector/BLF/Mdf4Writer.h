@@ -0,0 +1,229 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <array>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Vector/BLF/FileStatistics.h>
+#include <Vector/BLF/ObjectHeaderBase.h>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * ASAM MDF 4.1 writer
+ *
+ * Writes bus objects into channel groups following the ASAM MDF bus
+ * logging standard, one sorted data group per bus type:
+ *
+ * - CAN_DataFrame: CanMessage, CanMessage2, CanFdMessage, CanFdMessage64
+ *   (remote frames are not written)
+ * - LIN_Frame: LinMessage, LinMessage2
+ * - FlexRay_Frame: FlexRayVFrReceiveMsg, FlexRayVFrReceiveMsgEx
+ * - ETH_Frame: EthernetFrame, EthernetFrameEx, EthernetFrameForwarded
+ *
+ * Each group has a float64 master channel "Timestamp" in s relative to the
+ * start time and a structure channel with the bus logging members. CAN, LIN
+ * and FlexRay data bytes are fixed size byte arrays with a DataLength
+ * channel, Ethernet data bytes are variable length signal data.
+ *
+ * Records are appended to per group buffers, which are written as DT/SD
+ * blocks of blockSize bytes as soon as they are full, so memory usage only
+ * depends on the block size. With a compression level above 0, full blocks
+ * are deflate compressed by worker threads and written as DZ blocks in
+ * order of submission. The metadata blocks are written on close, when the
+ * cycle counts and block lists are known.
+ */
+class VECTOR_BLF_EXPORT Mdf4Writer final {
+  public:
+    /**
+     * constructor
+     *
+     * @param[in] filename file name
+     * @param[in] compressionLevel zlib compression level of DZ blocks, or 0 for DT blocks
+     * @param[in] blockSize uncompressed size of data blocks
+     */
+    explicit Mdf4Writer(const std::string & filename, const int compressionLevel = 0, const std::size_t blockSize = 4 * 1024 * 1024);
+    virtual ~Mdf4Writer();
+    Mdf4Writer(const Mdf4Writer &) = delete;
+    Mdf4Writer & operator=(const Mdf4Writer &) = delete;
+
+    /**
+     * Set start time of the measurement.
+     *
+     * @param[in] startTime start time in ns since 1970-01-01
+     */
+    virtual void setStartTime(const uint64_t startTime);
+
+    /**
+     * Set start time of the measurement.
+     *
+     * BLF files store measurementStartTime without time zone, so it is
+     * interpreted as UTC.
+     *
+     * @param[in] startTime start time, e.g. FileStatistics::measurementStartTime
+     */
+    virtual void setStartTime(const SYSTEMTIME & startTime);
+
+    /**
+     * Write an object.
+     *
+     * Objects of other types are ignored.
+     *
+     * @param[in] ohb object
+     */
+    virtual void write(const ObjectHeaderBase * ohb);
+
+    /**
+     * Write remaining data blocks and metadata and close file.
+     *
+     * Throws, if a data block couldn't be compressed. The destructor
+     * closes the file as well, but ignores this error.
+     */
+    virtual void close();
+
+  private:
+    /** data stream written as sequence of data blocks */
+    struct Stream;
+
+    /** channel group with its streams */
+    struct Group;
+
+    /** data block being compressed */
+    struct PendingBlock;
+
+    /** group types */
+    enum GroupType : uint8_t {
+        Can,
+        Lin,
+        FlexRay,
+        Ethernet,
+        GroupTypeCount
+    };
+
+    /** file */
+    std::ofstream m_file;
+
+    /** current file position */
+    uint64_t m_position {};
+
+    /** compression level */
+    int m_compressionLevel;
+
+    /** uncompressed data block size */
+    std::size_t m_blockSize;
+
+    /** maximum number of blocks being compressed */
+    std::size_t m_maxPendingBlocks;
+
+    /** start time in ns */
+    uint64_t m_startTime {};
+
+    /** groups */
+    std::array<std::unique_ptr<Group>, GroupTypeCount> m_groups;
+
+    /** blocks being compressed, in order of submission */
+    std::deque<std::unique_ptr<PendingBlock>> m_pendingBlocks {};
+
+    /** record buffer */
+    std::vector<uint8_t> m_record {};
+
+    /** frame buffer for reconstructed ethernet frames */
+    std::vector<uint8_t> m_frame {};
+
+    /**
+     * Get group, create it if it doesn't exist.
+     *
+     * @param[in] groupType group type
+     * @return group
+     */
+    Group & group(const GroupType groupType);
+
+    /**
+     * Start a record with its timestamp.
+     *
+     * @param[in] groupType group type
+     * @param[in] timeStamp timestamp in ns
+     * @return group
+     */
+    Group & beginRecord(const GroupType groupType, const uint64_t timeStamp);
+
+    /**
+     * Append record buffer to group.
+     *
+     * @param[in] group group
+     */
+    void endRecord(Group & group);
+
+    /**
+     * Append data to a stream, submit full blocks.
+     *
+     * @param[in] stream stream
+     * @param[in] data data
+     * @param[in] size size
+     */
+    void append(Stream & stream, const void * data, std::size_t size);
+
+    /**
+     * Write stream buffer as data block, or hand it over for compression.
+     *
+     * @param[in] stream stream
+     */
+    void submit(Stream & stream);
+
+    /**
+     * Write oldest compressed block.
+     */
+    void writePendingBlock();
+
+    /**
+     * Write block with header and padding to 8 bytes at end of file.
+     *
+     * @param[in] id block id, e.g. "DT"
+     * @param[in] links links
+     * @param[in] data block data
+     * @param[in] size size of block data
+     * @return file position of block
+     */
+    uint64_t writeBlock(const char * id, const std::vector<uint64_t> & links, const void * data, const std::size_t size);
+
+    /**
+     * Write TX or MD block.
+     *
+     * @param[in] id block id, "TX" or "MD"
+     * @param[in] text text
+     * @return file position of block
+     */
+    uint64_t writeText(const char * id, const std::string & text);
+
+    /**
+     * Write data list of a stream.
+     *
+     * @param[in] stream stream
+     * @return file position of data block or data list, or 0 if stream is empty
+     */
+    uint64_t writeDataList(const Stream & stream);
+
+    /**
+     * Write channel, channel group and data group blocks of a group.
+     *
+     * @param[in] groupType group type
+     * @param[in] nextDataGroup file position of next data group
+     * @return file position of data group
+     */
+    uint64_t writeDataGroup(const GroupType groupType, const uint64_t nextDataGroup);
+};
+
+}
+}
@@ -0,0 +1,171 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/MultiProducerWriter.h>
+
+#include <chrono>
+
+#include <Vector/BLF/FileMetrics.h>
+
+namespace Vector {
+namespace BLF {
+
+namespace {
+
+/** interval in which the merge thread polls the producers, if they are idle */
+const std::chrono::milliseconds pollInterval(1);
+
+}
+
+MultiProducerWriter::Producer::Producer(uint32_t bufferSize) {
+    m_queue.setBufferSize(bufferSize);
+}
+
+void MultiProducerWriter::Producer::write(ObjectHeaderBase * ohb) {
+    if (ohb == nullptr)
+        return;
+    m_queue.write(ohb);
+}
+
+bool MultiProducerWriter::Pending::operator<(const Pending & rhs) const {
+    if (timeStamp != rhs.timeStamp)
+        return timeStamp > rhs.timeStamp;
+    return sequence > rhs.sequence;
+}
+
+MultiProducerWriter::MultiProducerWriter(File & file) :
+    m_file(file) {
+}
+
+MultiProducerWriter::~MultiProducerWriter() {
+    close();
+}
+
+void MultiProducerWriter::open() {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_running)
+        return;
+
+    /* reset */
+    m_lateObjects = 0;
+    m_sequence = 0;
+    m_newestTimeStamp = 0;
+    m_lastTimeStamp = 0;
+
+    /* start thread */
+    m_running = true;
+    m_thread = std::thread(&MultiProducerWriter::mergeThread, this);
+}
+
+bool MultiProducerWriter::is_open() const {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_running;
+}
+
+MultiProducerWriter::Producer * MultiProducerWriter::producer() {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_producers.emplace_back(new Producer(producerBufferSize));
+    return m_producers.back().get();
+}
+
+void MultiProducerWriter::close() {
+    {
+        /* mutex lock */
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (!m_running)
+            return;
+        m_running = false;
+    }
+
+    /* finalize thread */
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+uint64_t MultiProducerWriter::lateObjects() const {
+    return m_lateObjects;
+}
+
+void MultiProducerWriter::mergeThread() {
+    std::vector<Producer *> producers;
+
+    for (;;) {
+        /* take over new producers */
+        bool running;
+        {
+            /* mutex lock */
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            running = m_running;
+            for (size_t i = producers.size(); i < m_producers.size(); ++i)
+                producers.push_back(m_producers[i].get());
+        }
+
+        /* take over objects, which are there already, without waiting for more */
+        const uint64_t now = FileMetrics::now();
+        bool idle = true;
+        for (Producer * producer : producers) {
+            for (uint32_t n = producer->m_queue.tellp() - producer->m_queue.tellg(); n > 0; --n) {
+                ObjectHeaderBase * ohb = producer->m_queue.read();
+                if (ohb == nullptr)
+                    break;
+                Pending pending;
+                pending.timeStamp = objectTimeStampNs(*ohb);
+                pending.arrivalTime = now;
+                pending.sequence = m_sequence++;
+                pending.ohb = ohb;
+                m_pending.push(pending);
+                if (pending.timeStamp > m_newestTimeStamp)
+                    m_newestTimeStamp = pending.timeStamp;
+                idle = false;
+            }
+        }
+
+        /* write objects, all of them after close */
+        if (writePending(now, !running))
+            idle = false;
+
+        /* producers are done, when close is called */
+        if (!running)
+            break;
+
+        if (idle)
+            std::this_thread::sleep_for(pollInterval);
+    }
+}
+
+bool MultiProducerWriter::writePending(uint64_t now, bool all) {
+    const uint64_t window = reorderWindow * UINT64_C(1000000);
+    bool written = false;
+    while (!m_pending.empty()) {
+        const Pending & pending = m_pending.top();
+
+        /* keep objects in the reorder window */
+        if (!all &&
+                (pending.timeStamp + window > m_newestTimeStamp) &&
+                (now - pending.arrivalTime < window))
+            break;
+
+        /* late objects are written anyway */
+        if (pending.timeStamp < m_lastTimeStamp)
+            m_lateObjects++;
+        else
+            m_lastTimeStamp = pending.timeStamp;
+
+        m_file.write(pending.ohb);
+        m_pending.pop();
+        written = true;
+    }
+    return written;
+}
+
+}
+}
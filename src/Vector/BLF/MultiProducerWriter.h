@@ -0,0 +1,198 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include <Vector/BLF/File.h>
+#include <Vector/BLF/ObjectHeaderBase.h>
+#include <Vector/BLF/ObjectQueue.h>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * Write front-end for many producer threads
+ *
+ * Each producer thread gets its own Producer, which buffers its objects in
+ * an own queue. So producers only share a lock with the merge thread, but
+ * not with each other.
+ *
+ * The merge thread collects the objects of all producers and writes them
+ * ordered by timestamp into the file. An object is held back until an
+ * object, which is newer by reorderWindow, arrived, or until it was held
+ * for reorderWindow. So objects, which arrive slightly late, e.g. from
+ * another interface or out of order from the same interface, are still
+ * written in order.
+ */
+class VECTOR_BLF_EXPORT MultiProducerWriter final {
+  public:
+    /**
+     * Producer, to be used by a single thread
+     */
+    class VECTOR_BLF_EXPORT Producer final {
+      public:
+        Producer(const Producer &) = delete;
+        Producer & operator=(const Producer &) = delete;
+
+        /**
+         * Write object.
+         *
+         * Ownership is taken over from the user to the library.
+         * Blocks, if the producer buffer is full.
+         *
+         * @param[in] ohb write object
+         */
+        void write(ObjectHeaderBase * ohb);
+
+      private:
+        friend class MultiProducerWriter;
+
+        /**
+         * Constructor
+         *
+         * @param[in] bufferSize number of objects buffered
+         */
+        explicit Producer(uint32_t bufferSize);
+
+        /** buffered objects */
+        ObjectQueue<ObjectHeaderBase> m_queue {};
+    };
+
+    /**
+     * Constructor
+     *
+     * @param[in] file file to write into, which is opened and closed by the user
+     */
+    explicit MultiProducerWriter(File & file);
+    virtual ~MultiProducerWriter();
+    MultiProducerWriter(const MultiProducerWriter &) = delete;
+    MultiProducerWriter & operator=(const MultiProducerWriter &) = delete;
+
+    /** reorder window in ms */
+    uint32_t reorderWindow {100};
+
+    /** number of objects buffered per producer */
+    uint32_t producerBufferSize {1024};
+
+    /**
+     * Start merge thread.
+     */
+    virtual void open();
+
+    /**
+     * is merge thread running?
+     *
+     * @return true if running
+     */
+    virtual bool is_open() const;
+
+    /**
+     * Create a producer.
+     *
+     * The producer stays valid until the writer is destroyed.
+     *
+     * @return producer
+     */
+    virtual Producer * producer();
+
+    /**
+     * Write all buffered objects into the file and stop merge thread.
+     *
+     * Producers must not write anymore.
+     */
+    virtual void close();
+
+    /**
+     * Get number of objects, which arrived after the reorder window.
+     *
+     * These are written out of order.
+     *
+     * @return late object count
+     */
+    virtual uint64_t lateObjects() const;
+
+  private:
+    /** object held back in the reorder window */
+    struct Pending {
+        /** object timestamp in ns */
+        uint64_t timeStamp;
+
+        /** time the object was taken over in ns */
+        uint64_t arrivalTime;
+
+        /** sequence number, to keep the order of equal timestamps */
+        uint64_t sequence;
+
+        /** object */
+        ObjectHeaderBase * ohb;
+
+        /**
+         * Order for the priority queue, which has the greatest element on top.
+         *
+         * @param[in] rhs other object
+         * @return true if this object is written after the other one
+         */
+        bool operator<(const Pending & rhs) const;
+    };
+
+    /** file */
+    File & m_file;
+
+    /** mutex for the data below */
+    mutable std::mutex m_mutex {};
+
+    /** producers */
+    std::vector<std::unique_ptr<Producer>> m_producers {};
+
+    /** thread still running */
+    bool m_running {};
+
+    /** merge thread */
+    std::thread m_thread {};
+
+    /** number of late objects */
+    std::atomic<uint64_t> m_lateObjects {};
+
+    /* merge thread only */
+
+    /** objects held back */
+    std::priority_queue<Pending> m_pending {};
+
+    /** next sequence number */
+    uint64_t m_sequence {};
+
+    /** newest timestamp taken over */
+    uint64_t m_newestTimeStamp {};
+
+    /** timestamp of the last object written */
+    uint64_t m_lastTimeStamp {};
+
+    /**
+     * Merge objects of all producers into the file.
+     */
+    void mergeThread();
+
+    /**
+     * Write objects, which left the reorder window.
+     *
+     * @param[in] now current time in ns
+     * @param[in] all write all objects
+     * @return true if objects were written
+     */
+    bool writePending(uint64_t now, bool all);
+};
+
+}
+}
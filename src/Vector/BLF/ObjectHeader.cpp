@@ -41,5 +41,11 @@ uint32_t ObjectHeader::calculateObjectSize() const {
     return calculateHeaderSize();
 }
 
+uint64_t ObjectHeader::objectTimeStampNs() const {
+    if (objectFlags == ObjectFlags::TimeTenMics)
+        return objectTimeStamp * 10000;
+    return objectTimeStamp;
+}
+
 }
 }
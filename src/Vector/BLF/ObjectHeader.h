@@ -27,6 +27,13 @@ struct VECTOR_BLF_EXPORT ObjectHeader : ObjectHeaderBase {
     uint16_t calculateHeaderSize() const override;
     uint32_t calculateObjectSize() const override;
 
+    /**
+     * Object timestamp in nanoseconds, independent of the unit in objectFlags.
+     *
+     * @return object timestamp in ns
+     */
+    uint64_t objectTimeStampNs() const;
+
     /** enumeration for objectFlags */
     enum ObjectFlags : uint32_t {
         /**
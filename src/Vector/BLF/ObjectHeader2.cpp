@@ -46,5 +46,11 @@ uint32_t ObjectHeader2::calculateObjectSize() const {
     return calculateHeaderSize();
 }
 
+uint64_t ObjectHeader2::objectTimeStampNs() const {
+    if (objectFlags == ObjectFlags::TimeTenMics)
+        return objectTimeStamp * 10000;
+    return objectTimeStamp;
+}
+
 }
 }
@@ -6,6 +6,8 @@
 
 #include <Vector/BLF/AbstractFile.h>
 #include <Vector/BLF/Exceptions.h>
+#include <Vector/BLF/ObjectHeader.h>
+#include <Vector/BLF/ObjectHeader2.h>
 
 namespace Vector {
 	namespace BLF {
@@ -51,5 +53,15 @@ namespace Vector {
 			return calculateHeaderSize();
 		}
 
+		uint64_t objectTimeStampNs(const ObjectHeaderBase& ohb) {
+			if (const ObjectHeader* oh = dynamic_cast<const ObjectHeader*>(&ohb)) {
+				return oh->objectTimeStampNs();
+			}
+			if (const ObjectHeader2* oh2 = dynamic_cast<const ObjectHeader2*>(&ohb)) {
+				return oh2->objectTimeStampNs();
+			}
+			return 0;
+		}
+
 	}
 }
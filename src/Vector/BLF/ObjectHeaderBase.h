@@ -248,5 +248,16 @@ struct VECTOR_BLF_EXPORT ObjectHeaderBase {
     ObjectType objectType {ObjectType::UNKNOWN};
 };
 
+/**
+ * Object timestamp in nanoseconds, for ObjectHeader and ObjectHeader2
+ *
+ * This is a free function, so that the ObjectHeaderBase interface stays
+ * binary compatible.
+ *
+ * @param[in] ohb object
+ * @return object timestamp in ns, or 0 if the object header has none
+ */
+VECTOR_BLF_EXPORT uint64_t objectTimeStampNs(const ObjectHeaderBase & ohb);
+
 }
 }
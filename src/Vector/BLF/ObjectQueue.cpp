@@ -27,30 +27,69 @@ T * ObjectQueue<T>::read() {
     std::unique_lock<std::mutex> lock(m_mutex);
 
     /* wait for data */
-    tellpChanged.wait(lock, [&] {
+    auto dataAvailable = [&] {
         return
         m_abort ||
         !m_queue.empty() ||
         (m_tellg >= m_fileSize);
-    });
+    };
+    if (!dataAvailable()) {
+        VECTOR_BLF_TRACE_SPAN(m_tracer, "wait queue empty", m_tellg);
+        const uint64_t waitBegin = m_metrics ? FileMetrics::now() : 0;
+        tellpChanged.wait(lock, dataAvailable);
+        if (m_metrics)
+            FileMetrics::add(m_metrics->readWriteQueueReadWaitTime, FileMetrics::now() - waitBegin);
+    }
 
     /* get first entry */
-    T * ohb = nullptr;
-    if (m_queue.empty())
-        m_rdstate = std::ios_base::eofbit | std::ios_base::failbit;
-    else {
-        ohb = m_queue.front();
-        m_queue.pop();
+    bool lowWatermarkReached = false;
+    T * ohb = pop(lowWatermarkReached);
+
+    /* watermark */
+    if (lowWatermarkReached) {
+        const std::function<void(bool)> callback = m_watermarkCallback;
+        lock.unlock();
+        callback(false);
+    }
 
-        /* set state */
-        m_rdstate = std::ios_base::goodbit;
+    return ohb;
+}
 
-        /* increase get count */
-        m_tellg++;
+template<typename T>
+T * ObjectQueue<T>::read(std::chrono::milliseconds timeout) {
+    /* mutex lock */
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    /* wait for data */
+    auto dataAvailable = [&] {
+        return
+        m_abort ||
+        !m_queue.empty() ||
+        (m_tellg >= m_fileSize);
+    };
+    if (!dataAvailable()) {
+        VECTOR_BLF_TRACE_SPAN(m_tracer, "wait queue empty", m_tellg);
+        const uint64_t waitBegin = m_metrics ? FileMetrics::now() : 0;
+        const bool available = tellpChanged.wait_for(lock, timeout, dataAvailable);
+        if (m_metrics)
+            FileMetrics::add(m_metrics->readWriteQueueReadWaitTime, FileMetrics::now() - waitBegin);
+        if (!available) {
+            /* still empty, but not eof */
+            m_rdstate = std::ios_base::goodbit;
+            return nullptr;
+        }
     }
 
-    /* notify */
-    tellgChanged.notify_all();
+    /* get first entry */
+    bool lowWatermarkReached = false;
+    T * ohb = pop(lowWatermarkReached);
+
+    /* watermark */
+    if (lowWatermarkReached) {
+        const std::function<void(bool)> callback = m_watermarkCallback;
+        lock.unlock();
+        callback(false);
+    }
 
     return ohb;
 }
@@ -69,24 +108,41 @@ void ObjectQueue<T>::write(T * obj) {
     std::unique_lock<std::mutex> lock(m_mutex);
 
     /* wait for free space */
-    tellgChanged.wait(lock, [&] {
+    auto spaceAvailable = [&] {
         return
         m_abort ||
         static_cast<uint32_t>(m_queue.size()) < m_bufferSize;
-    });
+    };
+    if (!spaceAvailable()) {
+        VECTOR_BLF_TRACE_SPAN(m_tracer, "wait queue full", m_tellp);
+        const uint64_t waitBegin = m_metrics ? FileMetrics::now() : 0;
+        tellgChanged.wait(lock, spaceAvailable);
+        if (m_metrics)
+            FileMetrics::add(m_metrics->readWriteQueueWriteWaitTime, FileMetrics::now() - waitBegin);
+    }
 
     /* push data */
-    m_queue.push(obj);
-
-    /* increase put count */
-    m_tellp++;
-
-    /* shift eof */
-    if (m_tellp > m_fileSize)
-        m_fileSize = m_tellp;
+    const bool highWatermarkReached = push(obj);
 
     /* notify */
     tellpChanged.notify_all();
+
+    /* watermark */
+    if (highWatermarkReached) {
+        const std::function<void(bool)> callback = m_watermarkCallback;
+        lock.unlock();
+        callback(true);
+    }
+}
+
+template<typename T>
+void ObjectQueue<T>::write(T * const * objs, uint32_t count) {
+    writeObjects(objs, count, nullptr);
+}
+
+template<typename T>
+bool ObjectQueue<T>::write(T * const * objs, uint32_t count, std::chrono::milliseconds timeout) {
+    return writeObjects(objs, count, &timeout);
 }
 
 template<typename T>
@@ -147,6 +203,139 @@ void ObjectQueue<T>::setBufferSize(uint32_t bufferSize) {
     m_bufferSize = bufferSize;
 }
 
+template<typename T>
+uint32_t ObjectQueue<T>::bufferSize() const {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_bufferSize;
+}
+
+template<typename T>
+void ObjectQueue<T>::setWatermarks(uint32_t lowWatermark, uint32_t highWatermark, std::function<void(bool)> callback) {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_lowWatermark = lowWatermark;
+    m_highWatermark = highWatermark;
+    m_watermarkCallback = callback;
+    m_highWatermarkReached = false;
+}
+
+template<typename T>
+void ObjectQueue<T>::setMetrics(FileMetrics * metrics) {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_metrics = metrics;
+}
+
+template<typename T>
+void ObjectQueue<T>::setTracer(Tracer * tracer) {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_tracer = tracer;
+}
+
+template<typename T>
+T * ObjectQueue<T>::pop(bool & lowWatermarkReached) {
+    /* get first entry */
+    T * ohb = nullptr;
+    if (m_queue.empty())
+        m_rdstate = std::ios_base::eofbit | std::ios_base::failbit;
+    else {
+        ohb = m_queue.front();
+        m_queue.pop();
+
+        /* set state */
+        m_rdstate = std::ios_base::goodbit;
+
+        /* increase get count */
+        m_tellg++;
+    }
+
+    /* watermark */
+    lowWatermarkReached =
+        m_highWatermarkReached &&
+        (static_cast<uint32_t>(m_queue.size()) <= m_lowWatermark);
+    if (lowWatermarkReached)
+        m_highWatermarkReached = false;
+
+    /* notify */
+    tellgChanged.notify_all();
+
+    return ohb;
+}
+
+template<typename T>
+bool ObjectQueue<T>::push(T * obj) {
+    /* push data */
+    m_queue.push(obj);
+
+    /* increase put count */
+    m_tellp++;
+
+    /* shift eof */
+    if (m_tellp > m_fileSize)
+        m_fileSize = m_tellp;
+
+    /* watermark */
+    const bool highWatermarkReached =
+        !m_highWatermarkReached &&
+        (m_highWatermark > 0) &&
+        m_watermarkCallback &&
+        (static_cast<uint32_t>(m_queue.size()) >= m_highWatermark);
+    if (highWatermarkReached)
+        m_highWatermarkReached = true;
+
+    return highWatermarkReached;
+}
+
+template<typename T>
+bool ObjectQueue<T>::writeObjects(T * const * objs, uint32_t count, const std::chrono::milliseconds * timeout) {
+    /* mutex lock */
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    /* wait for free space, an empty queue takes any count */
+    auto spaceAvailable = [&] {
+        return
+        m_abort ||
+        m_queue.empty() ||
+        static_cast<uint32_t>(m_queue.size()) + count <= m_bufferSize;
+    };
+    if (!spaceAvailable()) {
+        VECTOR_BLF_TRACE_SPAN(m_tracer, "wait queue full", m_tellp);
+        const uint64_t waitBegin = m_metrics ? FileMetrics::now() : 0;
+        bool available = true;
+        if (timeout)
+            available = tellgChanged.wait_for(lock, *timeout, spaceAvailable);
+        else
+            tellgChanged.wait(lock, spaceAvailable);
+        if (m_metrics)
+            FileMetrics::add(m_metrics->readWriteQueueWriteWaitTime, FileMetrics::now() - waitBegin);
+        if (!available)
+            return false;
+    }
+
+    /* push data */
+    bool highWatermarkReached = false;
+    for (uint32_t i = 0; i < count; ++i)
+        highWatermarkReached |= push(objs[i]);
+
+    /* notify */
+    tellpChanged.notify_all();
+
+    /* watermark */
+    if (highWatermarkReached) {
+        const std::function<void(bool)> callback = m_watermarkCallback;
+        lock.unlock();
+        callback(true);
+    }
+
+    return true;
+}
+
 template class ObjectQueue<ObjectHeaderBase>;
 
 }
@@ -6,13 +6,17 @@
 
 #include <Vector/BLF/platform.h>
 
+#include <chrono>
 #include <condition_variable>
+#include <functional>
 #include <limits>
 #include <mutex>
 #include <queue>
 
+#include <Vector/BLF/FileMetrics.h>
 #include <Vector/BLF/ObjectHeaderBase.h>
 #include <Vector/BLF/LogContainer.h>
+#include <Vector/BLF/Tracer.h>
 
 #include <Vector/BLF/vector_blf_export.h>
 
@@ -35,6 +39,16 @@ class VECTOR_BLF_EXPORT ObjectQueue final {
      */
     T * read();
 
+    /**
+     * Get access to front of queue, waiting at most timeout.
+     *
+     * If the queue stays empty, nullptr is returned without setting eof.
+     *
+     * @param[in] timeout max wait time
+     * @return object (or nullptr if empty)
+     */
+    T * read(std::chrono::milliseconds timeout);
+
     /** @copydoc AbstractFile::tellg */
     uint32_t tellg() const;
 
@@ -47,6 +61,29 @@ class VECTOR_BLF_EXPORT ObjectQueue final {
      */
     void write(T * obj);
 
+    /**
+     * Enqueue objects to end of queue at once.
+     *
+     * Waits until there is space for all of them, an empty queue takes any count.
+     *
+     * @param[in] objs objects
+     * @param[in] count number of objects
+     */
+    void write(T * const * objs, uint32_t count);
+
+    /**
+     * Enqueue objects to end of queue, if there is space for all within timeout.
+     *
+     * Either all or none of the objects are enqueued.
+     * If not, the caller keeps the ownership.
+     *
+     * @param[in] objs objects
+     * @param[in] count number of objects
+     * @param[in] timeout max wait time
+     * @return true if enqueued
+     */
+    bool write(T * const * objs, uint32_t count, std::chrono::milliseconds timeout);
+
     /** @copydoc AbstractFile::tellp */
     uint32_t tellp() const;
 
@@ -65,6 +102,37 @@ class VECTOR_BLF_EXPORT ObjectQueue final {
     /** @copydoc UncompressedFile::setBufferSize */
     void setBufferSize(uint32_t bufferSize);
 
+    /** @return buffer size */
+    uint32_t bufferSize() const;
+
+    /**
+     * Set queue depth watermarks.
+     *
+     * The callback is called with true, when the queue fills up to the high
+     * watermark, and then with false, when it drains down to the low
+     * watermark. It's called by the writing resp. reading thread, without
+     * holding the queue lock.
+     *
+     * @param[in] lowWatermark low watermark
+     * @param[in] highWatermark high watermark, 0 to disable
+     * @param[in] callback callback
+     */
+    void setWatermarks(uint32_t lowWatermark, uint32_t highWatermark, std::function<void(bool)> callback);
+
+    /**
+     * Set metrics, which receive the wait times.
+     *
+     * @param[in] metrics metrics or nullptr
+     */
+    void setMetrics(FileMetrics * metrics);
+
+    /**
+     * Set tracer, which receives the wait spans.
+     *
+     * @param[in] tracer tracer or nullptr
+     */
+    void setTracer(Tracer * tracer);
+
     /** data was dequeued */
     std::condition_variable tellgChanged;
 
@@ -95,6 +163,54 @@ class VECTOR_BLF_EXPORT ObjectQueue final {
 
     /** mutex */
     mutable std::mutex m_mutex {};
+
+    /** metrics */
+    FileMetrics * m_metrics {};
+
+    /** tracer */
+    Tracer * m_tracer {};
+
+    /** low watermark */
+    uint32_t m_lowWatermark {};
+
+    /** high watermark */
+    uint32_t m_highWatermark {};
+
+    /** watermark callback */
+    std::function<void(bool)> m_watermarkCallback {};
+
+    /** high watermark was reached */
+    bool m_highWatermarkReached {};
+
+    /**
+     * Take first entry, after waiting for data.
+     *
+     * Mutex must be locked.
+     *
+     * @param[out] lowWatermarkReached queue drained down to the low watermark
+     * @return object (or nullptr if empty)
+     */
+    T * pop(bool & lowWatermarkReached);
+
+    /**
+     * Append entry, after waiting for space.
+     *
+     * Mutex must be locked.
+     *
+     * @param[in] obj object
+     * @return true if the queue filled up to the high watermark
+     */
+    bool push(T * obj);
+
+    /**
+     * Enqueue objects to end of queue at once, after waiting for space for all.
+     *
+     * @param[in] objs objects
+     * @param[in] count number of objects
+     * @param[in] timeout max wait time, or nullptr to wait without limit
+     * @return true if enqueued
+     */
+    bool writeObjects(T * const * objs, uint32_t count, const std::chrono::milliseconds * timeout);
 };
 
 /* explicit template instantiation */
@@ -0,0 +1,379 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/PcapReader.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <Vector/BLF/Exceptions.h>
+#include <Vector/BLF/Helpers.h>
+
+namespace Vector {
+namespace BLF {
+
+namespace {
+
+/** objects enqueued at once by copyTo */
+const std::size_t copyBatchSize = 256;
+
+/** magic numbers */
+enum Magic : uint32_t {
+    PcapMicroseconds = 0xA1B2C3D4,
+    PcapMicrosecondsSwapped = 0xD4C3B2A1,
+    PcapNanoseconds = 0xA1B23C4D,
+    PcapNanosecondsSwapped = 0x4D3CB2A1,
+    ByteOrderMagic = 0x1A2B3C4D,
+    ByteOrderMagicSwapped = 0x4D3C2B1A
+};
+
+/** block types */
+enum BlockType : uint32_t {
+    InterfaceDescriptionBlock = 0x00000001,
+    PacketBlock = 0x00000002,
+    SimplePacketBlock = 0x00000003,
+    EnhancedPacketBlock = 0x00000006,
+    SectionHeaderBlock = 0x0A0D0D0A
+};
+
+/** option codes */
+enum OptionCode : uint16_t {
+    OptEndOfOpt = 0,
+    IfTsResol = 9,
+    IfTsOffset = 14,
+    EpbFlags = 2
+};
+
+/** link type Ethernet */
+const uint16_t LinkTypeEthernet = 1;
+
+/** maximum size of a PCAP record or PCAPNG block, to reject corrupt lengths */
+const uint32_t MaxBlockSize = 16 * 1024 * 1024;
+
+/** padding to 4 bytes */
+uint32_t padding4(const uint32_t size) {
+    return (4 - size % 4) % 4;
+}
+
+/** swap bytes of 16-bit value */
+uint16_t swap16(const uint16_t value) {
+    return static_cast<uint16_t>((value >> 8) | (value << 8));
+}
+
+/** swap bytes of 32-bit value */
+uint32_t swap32(const uint32_t value) {
+    return
+        ((value & 0x000000FF) << 24) |
+        ((value & 0x0000FF00) << 8) |
+        ((value & 0x00FF0000) >> 8) |
+        ((value & 0xFF000000) >> 24);
+}
+
+}
+
+PcapReader::PcapReader(const std::string & filename, const std::size_t bufferSize) :
+    m_fileBuffer(bufferSize) {
+    m_file.rdbuf()->pubsetbuf(m_fileBuffer.data(), static_cast<std::streamsize>(m_fileBuffer.size()));
+    m_file.open(filename, std::ios_base::in | std::ios_base::binary);
+    if (!m_file.is_open())
+        throw Exception("PcapReader::PcapReader(): Unable to open file.");
+
+    uint32_t magic;
+    if (!readBytes(&magic, sizeof(magic)))
+        throw Exception("PcapReader::PcapReader(): Unknown file format.");
+    switch (magic) {
+    case SectionHeaderBlock:
+        /* the Section Header Block is parsed by readPcapng */
+        m_pcapng = true;
+        m_file.seekg(0);
+        return;
+    case PcapMicroseconds:
+    case PcapNanoseconds:
+        break;
+    case PcapMicrosecondsSwapped:
+    case PcapNanosecondsSwapped:
+        m_swapped = true;
+        break;
+    default:
+        throw Exception("PcapReader::PcapReader(): Unknown file format.");
+    }
+
+    /* rest of PCAP file header: version, thiszone, sigfigs, snaplen, network */
+    m_block.resize(20);
+    if (!readBytes(m_block.data(), m_block.size()))
+        throw Exception("PcapReader::PcapReader(): Unknown file format.");
+    Interface interface;
+    interface.linkType = static_cast<uint16_t>(get32(16));
+    interface.resolution = ((magic == PcapNanoseconds) || (magic == PcapNanosecondsSwapped)) ? 9 : 6;
+    interface.offset = static_cast<int32_t>(get32(4));
+    m_interfaces.push_back(interface);
+}
+
+void PcapReader::setStartTime(const uint64_t startTime) {
+    m_startTime = startTime;
+    m_startTimeValid = true;
+}
+
+uint64_t PcapReader::startTime() const {
+    return m_startTime;
+}
+
+SYSTEMTIME PcapReader::startSystemTime() const {
+    SYSTEMTIME systemTime {};
+    const int64_t seconds = static_cast<int64_t>(m_startTime / 1000000000);
+    const int64_t days = seconds / 86400;
+    const int64_t secondOfDay = seconds % 86400;
+    detail::civilFromDays(days, systemTime);
+    systemTime.dayOfWeek = static_cast<uint16_t>((days + 4) % 7); // 1970-01-01 was a Thursday
+    systemTime.hour = static_cast<uint16_t>(secondOfDay / 3600);
+    systemTime.minute = static_cast<uint16_t>(secondOfDay / 60 % 60);
+    systemTime.second = static_cast<uint16_t>(secondOfDay % 60);
+    systemTime.milliseconds = static_cast<uint16_t>(m_startTime % 1000000000 / 1000000);
+    return systemTime;
+}
+
+EthernetFrameEx * PcapReader::read() {
+    return m_pcapng ? readPcapng() : readPcap();
+}
+
+uint64_t PcapReader::copyTo(File & file, const uint64_t count) {
+    /* batches are enqueued at once, but not beyond the queue size */
+    const std::size_t batchSize = std::max<std::size_t>(std::min<std::size_t>(copyBatchSize, file.readWriteQueueSize()), 1);
+    std::vector<ObjectHeaderBase *> batch;
+    batch.reserve(batchSize);
+
+    uint64_t written = 0;
+    try {
+        while ((count == 0) || (written < count)) {
+            EthernetFrameEx * obj = read();
+            if (obj == nullptr)
+                break;
+            if (file.fileStatistics.measurementStartTime.year == 0)
+                file.fileStatistics.measurementStartTime = startSystemTime();
+            batch.push_back(obj);
+            written++;
+            if (batch.size() == batchSize) {
+                file.write(batch.data(), static_cast<uint32_t>(batch.size()));
+                batch.clear();
+            }
+        }
+    } catch (...) {
+        for (ObjectHeaderBase * ohb : batch)
+            delete ohb;
+        throw;
+    }
+    if (!batch.empty())
+        file.write(batch.data(), static_cast<uint32_t>(batch.size()));
+    return written;
+}
+
+uint64_t PcapReader::packetCount() const {
+    return m_packetCount;
+}
+
+bool PcapReader::readBytes(void * data, const std::size_t size) {
+    m_file.read(static_cast<char *>(data), static_cast<std::streamsize>(size));
+    return m_file.gcount() == static_cast<std::streamsize>(size);
+}
+
+uint16_t PcapReader::get16(const std::size_t offset) const {
+    uint16_t value;
+    std::memcpy(&value, m_block.data() + offset, sizeof(value));
+    return m_swapped ? swap16(value) : value;
+}
+
+uint32_t PcapReader::get32(const std::size_t offset) const {
+    uint32_t value;
+    std::memcpy(&value, m_block.data() + offset, sizeof(value));
+    return convert32(value);
+}
+
+uint32_t PcapReader::convert32(const uint32_t value) const {
+    return m_swapped ? swap32(value) : value;
+}
+
+EthernetFrameEx * PcapReader::readPcap() {
+    for (;;) {
+        /* record header: ts_sec, ts_usec/ts_nsec, incl_len, orig_len */
+        uint32_t header[4];
+        if (!readBytes(header, sizeof(header)))
+            return nullptr;
+        const uint32_t captureLength = convert32(header[2]);
+        if (captureLength > MaxBlockSize)
+            throw Exception("PcapReader::read(): Invalid record length.");
+        m_block.resize(captureLength);
+        if (!readBytes(m_block.data(), captureLength))
+            return nullptr;
+
+        const Interface & interface = m_interfaces[0];
+        if (interface.linkType != LinkTypeEthernet)
+            continue;
+        const uint64_t timeStamp = toNs(interface, static_cast<uint64_t>(convert32(header[0])) * (interface.resolution == 9 ? 1000000000 : 1000000) + convert32(header[1]));
+        return createFrame(0, timeStamp, 0, m_block.data(), captureLength);
+    }
+}
+
+EthernetFrameEx * PcapReader::readPcapng() {
+    for (;;) {
+        /* block header: type, length */
+        uint32_t header[2];
+        if (!readBytes(header, sizeof(header)))
+            return nullptr;
+        std::size_t headerSize = sizeof(header);
+
+        /* new section with its own byte order */
+        if (header[0] == SectionHeaderBlock) {
+            uint32_t byteOrderMagic;
+            if (!readBytes(&byteOrderMagic, sizeof(byteOrderMagic)))
+                return nullptr;
+            if (byteOrderMagic == ByteOrderMagic)
+                m_swapped = false;
+            else if (byteOrderMagic == ByteOrderMagicSwapped)
+                m_swapped = true;
+            else
+                throw Exception("PcapReader::read(): Invalid byte-order magic.");
+            headerSize += sizeof(byteOrderMagic);
+            m_interfaces.clear();
+        }
+
+        const uint32_t blockType = convert32(header[0]);
+        const uint32_t blockLength = convert32(header[1]);
+        if ((blockLength < headerSize + 4) || (blockLength % 4 != 0) || (blockLength > MaxBlockSize))
+            throw Exception("PcapReader::read(): Invalid block length.");
+
+        /* block body and trailing block length */
+        m_block.resize(blockLength - headerSize);
+        if (!readBytes(m_block.data(), m_block.size()))
+            return nullptr;
+        const uint32_t bodyLength = static_cast<uint32_t>(m_block.size() - 4);
+
+        switch (blockType) {
+        case InterfaceDescriptionBlock:
+            parseInterfaceDescriptionBlock(bodyLength);
+            break;
+
+        case PacketBlock:
+        case EnhancedPacketBlock: {
+            /* interface id, timestamp (high), timestamp (low), captured length, original length */
+            if (bodyLength < 20)
+                throw Exception("PcapReader::read(): Invalid packet block.");
+            const uint32_t interfaceId = (blockType == PacketBlock) ? get16(0) : get32(0);
+            const uint32_t captureLength = get32(12);
+            if (captureLength > bodyLength - 20)
+                throw Exception("PcapReader::read(): Invalid packet block.");
+            if ((interfaceId >= m_interfaces.size()) || (m_interfaces[interfaceId].linkType != LinkTypeEthernet))
+                break;
+
+            /* epb_flags/pack_flags: inbound/outbound */
+            uint16_t dir = 0;
+            uint32_t offset = 20 + captureLength + padding4(captureLength);
+            while (offset + 4 <= bodyLength) {
+                const uint16_t optionCode = get16(offset);
+                const uint16_t optionLength = get16(offset + 2);
+                if ((optionCode == OptEndOfOpt) || (offset + 4 + optionLength > bodyLength))
+                    break;
+                if ((optionCode == EpbFlags) && (optionLength == 4) && ((get32(offset + 4) & 0x03) == 2))
+                    dir = 1;
+                offset += 4 + optionLength + padding4(optionLength);
+            }
+
+            const uint64_t timeStamp = toNs(m_interfaces[interfaceId], (static_cast<uint64_t>(get32(4)) << 32) | get32(8));
+            return createFrame(interfaceId, timeStamp, dir, m_block.data() + 20, captureLength);
+        }
+
+        case SimplePacketBlock: {
+            /* original length, packet data without timestamp */
+            if (bodyLength < 4)
+                throw Exception("PcapReader::read(): Invalid packet block.");
+            if (m_interfaces.empty() || (m_interfaces[0].linkType != LinkTypeEthernet))
+                break;
+            const uint32_t captureLength = std::min(get32(0), bodyLength - 4);
+            return createFrame(0, m_lastTimeStamp, 0, m_block.data() + 4, captureLength);
+        }
+
+        default:
+            break;
+        }
+    }
+}
+
+void PcapReader::parseInterfaceDescriptionBlock(const uint32_t bodyLength) {
+    /* link type, reserved, snap length */
+    if (bodyLength < 8)
+        throw Exception("PcapReader::read(): Invalid interface description block.");
+    Interface interface;
+    interface.linkType = get16(0);
+
+    uint32_t offset = 8;
+    while (offset + 4 <= bodyLength) {
+        const uint16_t optionCode = get16(offset);
+        const uint16_t optionLength = get16(offset + 2);
+        if ((optionCode == OptEndOfOpt) || (offset + 4 + optionLength > bodyLength))
+            break;
+        if ((optionCode == IfTsResol) && (optionLength == 1)) {
+            const uint8_t value = m_block[offset + 4];
+            interface.binary = (value & 0x80) != 0;
+            interface.resolution = value & 0x7F;
+        }
+        if ((optionCode == IfTsOffset) && (optionLength == 8)) {
+            uint64_t value;
+            if (m_swapped)
+                value = (static_cast<uint64_t>(get32(offset + 4)) << 32) | get32(offset + 8);
+            else
+                value = (static_cast<uint64_t>(get32(offset + 8)) << 32) | get32(offset + 4);
+            interface.offset = static_cast<int64_t>(value);
+        }
+        offset += 4 + optionLength + padding4(optionLength);
+    }
+
+    m_interfaces.push_back(interface);
+}
+
+uint64_t PcapReader::toNs(const Interface & interface, const uint64_t timeStamp) const {
+    uint64_t ns;
+    if (interface.binary) {
+        /* whole seconds, then fraction with at most 32 bits to not overflow */
+        if (interface.resolution >= 64)
+            ns = 0;
+        else {
+            uint64_t fraction = timeStamp & ((UINT64_C(1) << interface.resolution) - 1);
+            unsigned int shift = interface.resolution;
+            if (shift > 32) {
+                fraction >>= shift - 32;
+                shift = 32;
+            }
+            ns = (timeStamp >> interface.resolution) * 1000000000 + ((fraction * 1000000000) >> shift);
+        }
+    } else {
+        ns = timeStamp;
+        for (unsigned int i = interface.resolution; i < 9; ++i)
+            ns *= 10;
+        for (unsigned int i = 9; i < interface.resolution; ++i)
+            ns /= 10;
+    }
+    return ns + static_cast<uint64_t>(interface.offset * 1000000000);
+}
+
+EthernetFrameEx * PcapReader::createFrame(const uint32_t interfaceId, const uint64_t timeStamp, const uint16_t dir, const uint8_t * data, const uint32_t size) {
+    if (!m_startTimeValid)
+        setStartTime(timeStamp);
+    m_lastTimeStamp = timeStamp;
+    m_packetCount++;
+
+    /* frameLength is 16 bit, so jumbo frames beyond that are truncated */
+    const uint16_t frameLength = static_cast<uint16_t>(std::min<uint32_t>(size, 0xFFFF));
+
+    auto * obj = new EthernetFrameEx;
+    obj->objectFlags = ObjectHeader::ObjectFlags::TimeOneNans;
+    obj->objectTimeStamp = (timeStamp > m_startTime) ? timeStamp - m_startTime : 0;
+    obj->channel = static_cast<uint16_t>(interfaceId + 1);
+    obj->dir = dir;
+    obj->frameLength = frameLength;
+    obj->frameData.assign(data, data + frameLength);
+    obj->structLength = obj->calculateStructLength();
+    return obj;
+}
+
+}
+}
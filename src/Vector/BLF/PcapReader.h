@@ -0,0 +1,225 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <Vector/BLF/EthernetFrameEx.h>
+#include <Vector/BLF/File.h>
+#include <Vector/BLF/FileStatistics.h>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * PCAP/PCAPNG reader
+ *
+ * Reads Ethernet packets from PCAP (microsecond or nanosecond timestamps)
+ * and PCAPNG files (Enhanced, Simple and obsolete Packet Blocks) in either
+ * byte order and converts them into EthernetFrameEx objects:
+ *   - channel is the PCAPNG interface id + 1 (PCAP: 1)
+ *   - frameLength is the number of captured bytes
+ *   - objectTimeStamp is in ns relative to the start time
+ *   - dir is taken from epb_flags (default Rx)
+ *
+ * Packets of other link types and other blocks are skipped.
+ *
+ * The file is read sequentially into one block buffer, which is reused, so
+ * memory usage doesn't depend on the file size.
+ */
+class VECTOR_BLF_EXPORT PcapReader final {
+  public:
+    /**
+     * constructor
+     *
+     * @param[in] filename file name
+     * @param[in] bufferSize size of read buffer
+     */
+    explicit PcapReader(const std::string & filename, const std::size_t bufferSize = 4 * 1024 * 1024);
+    virtual ~PcapReader() = default;
+    PcapReader(const PcapReader &) = delete;
+    PcapReader & operator=(const PcapReader &) = delete;
+
+    /**
+     * Set start time, which is subtracted from packet timestamps.
+     *
+     * If not set, the timestamp of the first packet is used.
+     *
+     * @param[in] startTime start time in ns since 1970-01-01
+     */
+    virtual void setStartTime(const uint64_t startTime);
+
+    /**
+     * Get start time.
+     *
+     * @return start time in ns since 1970-01-01, or 0 if not known yet
+     */
+    virtual uint64_t startTime() const;
+
+    /**
+     * Get start time, e.g. for FileStatistics::measurementStartTime.
+     *
+     * @return start time in UTC
+     */
+    virtual SYSTEMTIME startSystemTime() const;
+
+    /**
+     * Read next packet.
+     *
+     * @return object, which has to be deleted by the caller, or nullptr at end of file
+     */
+    virtual EthernetFrameEx * read();
+
+    /**
+     * Read packets and write them into a BLF file.
+     *
+     * Packets are written in batches of up to 256 objects, which are
+     * enqueued at once. File::write blocks while its queue is full, so
+     * objects don't pile up in memory. The measurement start time of the
+     * file is set from the first packet, if it's not set yet.
+     *
+     * @param[in] file BLF file opened for writing
+     * @param[in] count maximum number of packets, or 0 for all
+     * @return number of packets written
+     */
+    virtual uint64_t copyTo(File & file, const uint64_t count = 0);
+
+    /**
+     * Get number of packets read.
+     *
+     * @return packet count
+     */
+    virtual uint64_t packetCount() const;
+
+  private:
+    /** interface */
+    struct Interface {
+        /** link type */
+        uint16_t linkType {};
+
+        /** timestamp resolution: power of 10 (or 2, if binary) */
+        uint8_t resolution {6};
+
+        /** timestamp resolution is a power of 2 */
+        bool binary {false};
+
+        /** timestamp offset in s */
+        int64_t offset {};
+    };
+
+    /** read buffer */
+    std::vector<char> m_fileBuffer;
+
+    /** file */
+    std::ifstream m_file {};
+
+    /** file is PCAPNG */
+    bool m_pcapng {false};
+
+    /** byte order of current section or file is swapped */
+    bool m_swapped {false};
+
+    /** interfaces of current section (PCAP: one) */
+    std::vector<Interface> m_interfaces {};
+
+    /** block buffer */
+    std::vector<uint8_t> m_block {};
+
+    /** start time in ns */
+    uint64_t m_startTime {};
+
+    /** start time is set */
+    bool m_startTimeValid {false};
+
+    /** last packet timestamp in ns, used for Simple Packet Blocks */
+    uint64_t m_lastTimeStamp {};
+
+    /** number of packets */
+    uint64_t m_packetCount {};
+
+    /**
+     * Read bytes from file.
+     *
+     * @param[out] data data
+     * @param[in] size size
+     * @return true if all bytes were read
+     */
+    bool readBytes(void * data, const std::size_t size);
+
+    /**
+     * Get 16-bit value from block buffer in byte order of section.
+     *
+     * @param[in] offset offset in block buffer
+     * @return value
+     */
+    uint16_t get16(const std::size_t offset) const;
+
+    /**
+     * Get 32-bit value from block buffer in byte order of section.
+     *
+     * @param[in] offset offset in block buffer
+     * @return value
+     */
+    uint32_t get32(const std::size_t offset) const;
+
+    /**
+     * Convert 32-bit value in byte order of section.
+     *
+     * @param[in] value value
+     * @return converted value
+     */
+    uint32_t convert32(const uint32_t value) const;
+
+    /**
+     * Read next PCAP record.
+     *
+     * @return object or nullptr at end of file
+     */
+    EthernetFrameEx * readPcap();
+
+    /**
+     * Read next PCAPNG packet block.
+     *
+     * @return object or nullptr at end of file
+     */
+    EthernetFrameEx * readPcapng();
+
+    /**
+     * Parse Interface Description Block in block buffer.
+     *
+     * @param[in] bodyLength length of block body
+     */
+    void parseInterfaceDescriptionBlock(const uint32_t bodyLength);
+
+    /**
+     * Convert timestamp of interface into ns since 1970-01-01.
+     *
+     * @param[in] interface interface
+     * @param[in] timeStamp timestamp in units of interface resolution
+     * @return timestamp in ns
+     */
+    uint64_t toNs(const Interface & interface, const uint64_t timeStamp) const;
+
+    /**
+     * Create object.
+     *
+     * @param[in] interfaceId interface id
+     * @param[in] timeStamp timestamp in ns since 1970-01-01
+     * @param[in] dir direction
+     * @param[in] data packet data
+     * @param[in] size captured length
+     * @return object
+     */
+    EthernetFrameEx * createFrame(const uint32_t interfaceId, const uint64_t timeStamp, const uint16_t dir, const uint8_t * data, const uint32_t size);
+};
+
+}
+}
@@ -0,0 +1,244 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/PcapngWriter.h>
+
+#include <cstring>
+
+#include <Vector/BLF/EthernetFrame.h>
+#include <Vector/BLF/EthernetFrameEx.h>
+#include <Vector/BLF/EthernetFrameForwarded.h>
+#include <Vector/BLF/Exceptions.h>
+#include <Vector/BLF/Helpers.h>
+#include <Vector/BLF/WlanFrame.h>
+
+namespace Vector {
+namespace BLF {
+
+namespace {
+
+/** block types */
+enum BlockType : uint32_t {
+    InterfaceDescriptionBlock = 0x00000001,
+    EnhancedPacketBlock = 0x00000006,
+    SectionHeaderBlock = 0x0A0D0D0A
+};
+
+/** option codes */
+enum OptionCode : uint16_t {
+    OptEndOfOpt = 0,
+    IfName = 2,
+    IfTsResol = 9,
+    EpbFlags = 2
+};
+
+/** padding to 4 bytes */
+uint32_t padding4(const std::size_t size) {
+    return static_cast<uint32_t>((4 - size % 4) % 4);
+}
+
+/** size of Enhanced Packet Block without packet data and padding */
+const uint32_t EnhancedPacketBlockOverhead =
+    7 * 4 + /* header */
+    8 + /* epb_flags */
+    4 + /* opt_endofopt */
+    4; /* trailer */
+
+}
+
+PcapngWriter::PcapngWriter(const std::string & filename, const std::size_t bufferSize) :
+    m_file(filename, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc),
+    m_bufferSize(bufferSize) {
+    if (!m_file.is_open())
+        throw Exception("PcapngWriter::PcapngWriter(): Unable to open file.");
+    m_buffer.reserve(m_bufferSize);
+
+    /* Section Header Block without options */
+    append32(SectionHeaderBlock);
+    append32(28);
+    append32(0x1A2B3C4D); // byte-order magic
+    const uint16_t version[2] = { 1, 0 };
+    append(version, sizeof(version));
+    const int64_t sectionLength = -1; // unspecified
+    append(&sectionLength, sizeof(sectionLength));
+    append32(28);
+}
+
+PcapngWriter::~PcapngWriter() {
+    close();
+}
+
+void PcapngWriter::setStartTime(const uint64_t startTime) {
+    m_startTime = startTime;
+}
+
+void PcapngWriter::setStartTime(const SYSTEMTIME & startTime) {
+    if (startTime.year == 0) {
+        m_startTime = 0;
+        return;
+    }
+    const int64_t days = detail::daysFromCivil(startTime.year, startTime.month, startTime.day);
+    const int64_t seconds = days * 86400 + startTime.hour * 3600 + startTime.minute * 60 + startTime.second;
+    m_startTime = static_cast<uint64_t>(seconds) * 1000000000 + static_cast<uint64_t>(startTime.milliseconds) * 1000000;
+}
+
+void PcapngWriter::write(const ObjectHeaderBase * ohb) {
+    if (ohb == nullptr)
+        return;
+
+    switch (ohb->objectType) {
+    case ObjectType::ETHERNET_FRAME: {
+        /* reconstruct frame: destination, source, optional VLAN tag, type, payload */
+        auto * obj = static_cast<const EthernetFrame *>(ohb);
+        const uint32_t interface = interfaceId(Ethernet, obj->channel);
+        const uint32_t captureLength = static_cast<uint32_t>(6 + 6 + (obj->tpid ? 4 : 0) + 2 + obj->payLoad.size());
+        reserve(EnhancedPacketBlockOverhead + captureLength + 3);
+        beginEnhancedPacketBlock(interface, obj->objectTimeStampNs(), captureLength);
+        append(obj->destinationAddress.data(), obj->destinationAddress.size());
+        append(obj->sourceAddress.data(), obj->sourceAddress.size());
+        if (obj->tpid) {
+            const uint8_t tag[4] = {
+                static_cast<uint8_t>(obj->tpid >> 8), static_cast<uint8_t>(obj->tpid),
+                static_cast<uint8_t>(obj->tci >> 8), static_cast<uint8_t>(obj->tci)
+            };
+            append(tag, sizeof(tag));
+        }
+        const uint8_t type[2] = { static_cast<uint8_t>(obj->type >> 8), static_cast<uint8_t>(obj->type) };
+        append(type, sizeof(type));
+        append(obj->payLoad.data(), obj->payLoad.size());
+        endEnhancedPacketBlock(obj->dir, captureLength);
+    }
+    break;
+
+    case ObjectType::ETHERNET_FRAME_EX: {
+        auto * obj = static_cast<const EthernetFrameEx *>(ohb);
+        writePacket(Ethernet, obj->channel, obj->objectTimeStampNs(), obj->dir, obj->frameData.data(), static_cast<uint32_t>(obj->frameData.size()));
+    }
+    break;
+
+    case ObjectType::ETHERNET_FRAME_FORWARDED: {
+        auto * obj = static_cast<const EthernetFrameForwarded *>(ohb);
+        writePacket(Ethernet, obj->channel, obj->objectTimeStampNs(), obj->dir, obj->frameData.data(), static_cast<uint32_t>(obj->frameData.size()));
+    }
+    break;
+
+    case ObjectType::WLAN_FRAME: {
+        auto * obj = static_cast<const WlanFrame *>(ohb);
+        writePacket(Ieee80211, obj->channel, obj->objectTimeStampNs(), obj->dir, obj->frameData.data(), static_cast<uint32_t>(obj->frameData.size()));
+    }
+    break;
+
+    default:
+        break;
+    }
+}
+
+void PcapngWriter::writePacket(const LinkType linkType, const uint16_t channel, const uint64_t timeStamp, const uint16_t dir, const uint8_t * data, const uint32_t size) {
+    const uint32_t interface = interfaceId(linkType, channel);
+    reserve(EnhancedPacketBlockOverhead + size + 3);
+    beginEnhancedPacketBlock(interface, timeStamp, size);
+    append(data, size);
+    endEnhancedPacketBlock(dir, size);
+}
+
+uint64_t PcapngWriter::packetCount() const {
+    return m_packetCount;
+}
+
+void PcapngWriter::close() {
+    if (!m_file.is_open())
+        return;
+    flush();
+    m_file.close();
+}
+
+uint32_t PcapngWriter::interfaceId(const LinkType linkType, const uint16_t channel) {
+    const uint32_t key = (static_cast<uint32_t>(linkType) << 16) | channel;
+    auto it = m_interfaces.find(key);
+    if (it != m_interfaces.end())
+        return it->second;
+
+    const uint32_t interface = static_cast<uint32_t>(m_interfaces.size());
+    m_interfaces[key] = interface;
+
+    /* Interface Description Block with if_name and if_tsresol */
+    const std::string name = std::string(linkType == Ieee80211 ? "WLAN " : "ETH ") + std::to_string(channel);
+    const uint32_t nameLength = static_cast<uint32_t>(name.size());
+    const uint32_t blockLength =
+        4 * 4 + /* header */
+        4 + nameLength + padding4(nameLength) + /* if_name */
+        4 + 4 + /* if_tsresol */
+        4 + /* opt_endofopt */
+        4; /* trailer */
+    reserve(blockLength);
+    append32(InterfaceDescriptionBlock);
+    append32(blockLength);
+    const uint16_t linkTypeAndReserved[2] = { linkType, 0 };
+    append(linkTypeAndReserved, sizeof(linkTypeAndReserved));
+    append32(0); // snaplen: no limit
+    const uint16_t ifName[2] = { IfName, static_cast<uint16_t>(nameLength) };
+    append(ifName, sizeof(ifName));
+    append(name.data(), nameLength);
+    appendPadding(nameLength);
+    const uint16_t ifTsResol[2] = { IfTsResol, 1 };
+    append(ifTsResol, sizeof(ifTsResol));
+    append32(9); // 10^-9 s, padded
+    append32(OptEndOfOpt);
+    append32(blockLength);
+
+    return interface;
+}
+
+void PcapngWriter::beginEnhancedPacketBlock(const uint32_t interfaceId, const uint64_t timeStamp, const uint32_t captureLength) {
+    const uint64_t absoluteTimeStamp = m_startTime + timeStamp;
+    append32(EnhancedPacketBlock);
+    append32(EnhancedPacketBlockOverhead + captureLength + padding4(captureLength));
+    append32(interfaceId);
+    append32(static_cast<uint32_t>(absoluteTimeStamp >> 32));
+    append32(static_cast<uint32_t>(absoluteTimeStamp));
+    append32(captureLength);
+    append32(captureLength); // original length
+}
+
+void PcapngWriter::endEnhancedPacketBlock(const uint16_t dir, const uint32_t captureLength) {
+    appendPadding(captureLength);
+
+    /* epb_flags: inbound (Rx) or outbound (Tx, TxRq) */
+    const uint16_t epbFlags[2] = { EpbFlags, 4 };
+    append(epbFlags, sizeof(epbFlags));
+    append32((dir == 0) ? 1 : 2);
+    append32(OptEndOfOpt);
+    append32(EnhancedPacketBlockOverhead + captureLength + padding4(captureLength));
+
+    m_packetCount++;
+}
+
+void PcapngWriter::append(const void * data, const std::size_t size) {
+    const char * bytes = static_cast<const char *>(data);
+    m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+}
+
+void PcapngWriter::appendPadding(const std::size_t size) {
+    static const char zeros[4] = {};
+    append(zeros, padding4(size));
+}
+
+void PcapngWriter::append32(const uint32_t value) {
+    append(&value, sizeof(value));
+}
+
+void PcapngWriter::reserve(const std::size_t blockSize) {
+    if (m_buffer.size() + blockSize > m_bufferSize)
+        flush();
+}
+
+void PcapngWriter::flush() {
+    if (m_buffer.empty())
+        return;
+    m_file.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    m_buffer.clear();
+}
+
+}
+}
@@ -0,0 +1,190 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <Vector/BLF/FileStatistics.h>
+#include <Vector/BLF/ObjectHeaderBase.h>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * PCAPNG writer
+ *
+ * Writes EthernetFrame, EthernetFrameEx, EthernetFrameForwarded and
+ * WlanFrame objects as Enhanced Packet Blocks into a PCAPNG file.
+ * An Interface Description Block with nanosecond timestamp resolution is
+ * written for each link type and BLF channel when it occurs first.
+ *
+ * Blocks are assembled in a write buffer, which is flushed to the file in
+ * large chunks. Packet data is copied from the objects directly into the
+ * write buffer, so there is no allocation per packet.
+ */
+class VECTOR_BLF_EXPORT PcapngWriter final {
+  public:
+    /** link types */
+    enum LinkType : uint16_t {
+        /** Ethernet */
+        Ethernet = 1,
+
+        /** IEEE 802.11 */
+        Ieee80211 = 105
+    };
+
+    /**
+     * constructor
+     *
+     * @param[in] filename file name
+     * @param[in] bufferSize size of write buffer
+     */
+    explicit PcapngWriter(const std::string & filename, const std::size_t bufferSize = 4 * 1024 * 1024);
+    virtual ~PcapngWriter();
+    PcapngWriter(const PcapngWriter &) = delete;
+    PcapngWriter & operator=(const PcapngWriter &) = delete;
+
+    /**
+     * Set start time, which is added to object timestamps.
+     *
+     * @param[in] startTime start time in ns since 1970-01-01
+     */
+    virtual void setStartTime(const uint64_t startTime);
+
+    /**
+     * Set start time, which is added to object timestamps.
+     *
+     * BLF files store measurementStartTime without time zone, so it is
+     * interpreted as UTC.
+     *
+     * @param[in] startTime start time, e.g. FileStatistics::measurementStartTime
+     */
+    virtual void setStartTime(const SYSTEMTIME & startTime);
+
+    /**
+     * Write an object.
+     *
+     * Objects of other types are ignored.
+     *
+     * @param[in] ohb object
+     */
+    virtual void write(const ObjectHeaderBase * ohb);
+
+    /**
+     * Write a packet.
+     *
+     * @param[in] linkType link type
+     * @param[in] channel application channel
+     * @param[in] timeStamp timestamp in ns (start time is added)
+     * @param[in] dir direction (0=Rx, 1=Tx, 2=TxRq)
+     * @param[in] data packet data
+     * @param[in] size packet size
+     */
+    virtual void writePacket(const LinkType linkType, const uint16_t channel, const uint64_t timeStamp, const uint16_t dir, const uint8_t * data, const uint32_t size);
+
+    /**
+     * Get number of packets written.
+     *
+     * @return packet count
+     */
+    virtual uint64_t packetCount() const;
+
+    /**
+     * Flush write buffer and close file.
+     */
+    virtual void close();
+
+  private:
+    /** file */
+    std::ofstream m_file;
+
+    /** write buffer */
+    std::vector<char> m_buffer {};
+
+    /** flush threshold of write buffer */
+    std::size_t m_bufferSize;
+
+    /** interface ids by link type and channel */
+    std::map<uint32_t, uint32_t> m_interfaces {};
+
+    /** start time in ns */
+    uint64_t m_startTime {};
+
+    /** number of packets */
+    uint64_t m_packetCount {};
+
+    /**
+     * Get interface id, write Interface Description Block if it's new.
+     *
+     * @param[in] linkType link type
+     * @param[in] channel application channel
+     * @return interface id
+     */
+    uint32_t interfaceId(const LinkType linkType, const uint16_t channel);
+
+    /**
+     * Write Enhanced Packet Block header.
+     *
+     * The packet data of captureLength bytes has to be appended, followed
+     * by endEnhancedPacketBlock.
+     *
+     * @param[in] interfaceId interface id
+     * @param[in] timeStamp timestamp in ns (start time is added)
+     * @param[in] captureLength packet length
+     */
+    void beginEnhancedPacketBlock(const uint32_t interfaceId, const uint64_t timeStamp, const uint32_t captureLength);
+
+    /**
+     * Write padding, options and trailer of Enhanced Packet Block.
+     *
+     * @param[in] dir direction
+     * @param[in] captureLength packet length
+     */
+    void endEnhancedPacketBlock(const uint16_t dir, const uint32_t captureLength);
+
+    /**
+     * Append bytes to write buffer.
+     *
+     * @param[in] data data
+     * @param[in] size size
+     */
+    void append(const void * data, const std::size_t size);
+
+    /**
+     * Append zero padding to 4 bytes.
+     *
+     * @param[in] size size of padded data
+     */
+    void appendPadding(const std::size_t size);
+
+    /**
+     * Append 32-bit value to write buffer.
+     *
+     * @param[in] value value
+     */
+    void append32(const uint32_t value);
+
+    /**
+     * Flush write buffer, if the next block doesn't fit in.
+     *
+     * @param[in] blockSize size of next block
+     */
+    void reserve(const std::size_t blockSize);
+
+    /**
+     * Write buffer to file.
+     */
+    void flush();
+};
+
+}
+}
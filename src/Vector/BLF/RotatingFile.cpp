@@ -0,0 +1,176 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/RotatingFile.h>
+
+#include <chrono>
+#include <cstdio>
+
+namespace Vector {
+namespace BLF {
+
+namespace {
+
+/** retry interval, if the next file can't be opened */
+const std::chrono::seconds openRetryInterval(1);
+
+}
+
+RotatingFile::~RotatingFile() {
+    close();
+}
+
+void RotatingFile::open() {
+    if (is_open())
+        return;
+
+    /* first file */
+    m_currentFile = openFile(1);
+    if (!m_currentFile->is_open()) {
+        m_currentFile.reset();
+        return;
+    }
+    m_currentFileStart = FileMetrics::now();
+    m_fileCount = 1;
+
+    /* open next file in advance */
+    {
+        /* mutex lock */
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_nextFileNumber = 2;
+        m_running = true;
+    }
+    m_thread = std::thread(&RotatingFile::fileThread, this);
+}
+
+bool RotatingFile::is_open() const {
+    return static_cast<bool>(m_currentFile);
+}
+
+void RotatingFile::write(ObjectHeaderBase * ohb) {
+    if (!m_currentFile) {
+        delete ohb;
+        return;
+    }
+
+    /* switch to next file, if it's open already */
+    if (rolloverDue()) {
+        /* mutex lock */
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_nextFile) {
+            m_closingFiles.push_back(std::move(m_currentFile));
+            m_currentFile = std::move(m_nextFile);
+            m_currentFileStart = FileMetrics::now();
+            m_fileCount++;
+            m_condition.notify_one();
+        }
+    }
+
+    m_currentFile->write(ohb);
+}
+
+void RotatingFile::close() {
+    if (!m_currentFile)
+        return;
+
+    /* finalize thread, it closes pending files */
+    {
+        /* mutex lock */
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_running = false;
+        m_condition.notify_one();
+    }
+    if (m_thread.joinable())
+        m_thread.join();
+
+    /* close current file */
+    m_currentFile->close();
+    m_currentFile.reset();
+
+    /* remove unused next file */
+    if (m_nextFile) {
+        m_nextFile->close();
+        m_nextFile.reset();
+        std::remove(filename(m_nextFileNumber - 1).c_str());
+    }
+}
+
+uint32_t RotatingFile::fileCount() const {
+    return m_fileCount;
+}
+
+std::string RotatingFile::filename(const uint32_t fileNumber) const {
+    char number[16];
+    std::snprintf(number, sizeof(number), "%04u", static_cast<unsigned int>(fileNumber));
+    return filenamePrefix + number + ".blf";
+}
+
+std::unique_ptr<File> RotatingFile::openFile(const uint32_t fileNumber) const {
+    std::unique_ptr<File> file(new File);
+    file->fileStatistics.applicationId = fileStatistics.applicationId;
+    file->fileStatistics.applicationMajor = fileStatistics.applicationMajor;
+    file->fileStatistics.applicationMinor = fileStatistics.applicationMinor;
+    file->fileStatistics.applicationBuild = fileStatistics.applicationBuild;
+    file->fileStatistics.measurementStartTime = fileStatistics.measurementStartTime;
+    file->compressionLevel = compressionLevel;
+    file->writeRestorePoints = writeRestorePoints;
+    file->setDefaultLogContainerSize(defaultLogContainerSize);
+    file->open(filename(fileNumber), std::ios_base::out);
+    return file;
+}
+
+bool RotatingFile::rolloverDue() const {
+    return
+        ((maxFileSize > 0) && (m_currentFile->metrics.compressedBytesWritten >= maxFileSize)) ||
+        ((maxFileTime > 0) && (FileMetrics::now() - m_currentFileStart >= maxFileTime * UINT64_C(1000000)));
+}
+
+void RotatingFile::fileThread() {
+    /* mutex lock */
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    for (;;) {
+        /* close previous files */
+        if (!m_closingFiles.empty()) {
+            std::unique_ptr<File> file = std::move(m_closingFiles.front());
+            m_closingFiles.pop_front();
+            lock.unlock();
+            file->close();
+            file.reset();
+            lock.lock();
+            continue;
+        }
+
+        /* stop */
+        if (!m_running)
+            break;
+
+        /* open next file */
+        if (!m_nextFile) {
+            const uint32_t fileNumber = m_nextFileNumber;
+            lock.unlock();
+            std::unique_ptr<File> file = openFile(fileNumber);
+            lock.lock();
+            if (file->is_open()) {
+                m_nextFile = std::move(file);
+                m_nextFileNumber++;
+                continue;
+            }
+
+            /* retry later */
+            m_condition.wait_for(lock, openRetryInterval);
+            continue;
+        }
+
+        m_condition.wait(lock, [this] {
+            return !m_closingFiles.empty() || !m_nextFile || !m_running;
+        });
+    }
+}
+
+}
+}
@@ -0,0 +1,165 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <Vector/BLF/File.h>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * Writer, which rotates files by size or time
+ *
+ * Files are named filenamePrefix + file number + ".blf", the file number
+ * has four digits and starts at 1.
+ *
+ * A background thread opens the next file in advance, and closes the
+ * previous file (restore points, FileStatistics). On rollover, write only
+ * switches to the next file, so it doesn't wait for files being opened or
+ * closed. If the next file is not open yet, the rollover is postponed and
+ * the objects continue to go into the current file. Every object is
+ * written into exactly one file.
+ */
+class VECTOR_BLF_EXPORT RotatingFile final {
+  public:
+    RotatingFile() = default;
+    virtual ~RotatingFile();
+    RotatingFile(const RotatingFile &) = delete;
+    RotatingFile & operator=(const RotatingFile &) = delete;
+
+    /** prefix of file names, e.g. "log_" for log_0001.blf */
+    std::string filenamePrefix {};
+
+    /** roll over, when this many bytes were written into the file, 0 to disable */
+    uint64_t maxFileSize {};
+
+    /** roll over, when the file is open for this time in ms, 0 to disable */
+    uint32_t maxFileTime {};
+
+    /**
+     * Template for the FileStatistics of the files
+     *
+     * Application and measurement start time are taken over.
+     */
+    FileStatistics fileStatistics {};
+
+    /** @see File::compressionLevel */
+    int compressionLevel {1};
+
+    /** @see File::writeRestorePoints */
+    bool writeRestorePoints {true};
+
+    /** @see File::defaultLogContainerSize */
+    uint32_t defaultLogContainerSize {0x20000};
+
+    /**
+     * Open first file.
+     */
+    virtual void open();
+
+    /**
+     * is file open?
+     *
+     * @return true if file is open
+     */
+    virtual bool is_open() const;
+
+    /**
+     * Write object to the current file.
+     *
+     * Ownership is taken over from the user to the library.
+     *
+     * @param[in] ohb write object
+     */
+    virtual void write(ObjectHeaderBase * ohb);
+
+    /**
+     * Close all files.
+     *
+     * The file, which was opened in advance, is removed.
+     */
+    virtual void close();
+
+    /**
+     * Get number of files written.
+     *
+     * @return file count
+     */
+    virtual uint32_t fileCount() const;
+
+    /**
+     * Get file name of a file number.
+     *
+     * @param[in] fileNumber file number
+     * @return file name
+     */
+    virtual std::string filename(const uint32_t fileNumber) const;
+
+  private:
+    /** current file, accessed by the producer only */
+    std::unique_ptr<File> m_currentFile {};
+
+    /** time the current file was started in ns */
+    uint64_t m_currentFileStart {};
+
+    /** number of files written */
+    std::atomic<uint32_t> m_fileCount {};
+
+    /** mutex for the data below */
+    mutable std::mutex m_mutex {};
+
+    /** work for the background thread */
+    std::condition_variable m_condition {};
+
+    /** next file, opened in advance */
+    std::unique_ptr<File> m_nextFile {};
+
+    /** file number of next file */
+    uint32_t m_nextFileNumber {};
+
+    /** files to close */
+    std::deque<std::unique_ptr<File>> m_closingFiles {};
+
+    /** thread still running */
+    bool m_running {};
+
+    /** thread opening and closing files */
+    std::thread m_thread {};
+
+    /**
+     * Create and open file.
+     *
+     * @param[in] fileNumber file number
+     * @return file, which is not open on error
+     */
+    std::unique_ptr<File> openFile(const uint32_t fileNumber) const;
+
+    /**
+     * Check if current file is full.
+     *
+     * @return true if rollover is due
+     */
+    bool rolloverDue() const;
+
+    /**
+     * Open next files and close previous files.
+     */
+    void fileThread();
+};
+
+}
+}
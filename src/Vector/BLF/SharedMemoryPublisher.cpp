@@ -0,0 +1,330 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/SharedMemoryPublisher.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <Vector/BLF/Exceptions.h>
+
+namespace Vector {
+namespace BLF {
+
+constexpr uint32_t SharedMemoryPublisher::signature;
+constexpr uint32_t SharedMemoryPublisher::version;
+constexpr uint32_t SharedMemoryPublisher::recordHeaderSize;
+
+namespace {
+
+/** interval in which the publisher polls the consumers, if the ring is full */
+const std::chrono::microseconds pollInterval(100);
+
+#if !defined(_WIN32)
+/** is the process running? */
+bool processAlive(uint32_t pid) {
+    /* EPERM: it exists, but belongs to another user */
+    return (::kill(static_cast<pid_t>(pid), 0) == 0) || (errno == EPERM);
+}
+
+/** is the existing shared memory left behind by a terminated publisher? */
+bool staleSegment(const char * name) {
+    const int fd = ::shm_open(name, O_RDWR, 0);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    void * memory = MAP_FAILED;
+    if ((::fstat(fd, &st) == 0) && (static_cast<uint64_t>(st.st_size) >= sizeof(SharedMemoryPublisher::Header)))
+        memory = ::mmap(nullptr, sizeof(SharedMemoryPublisher::Header), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED)
+        return false;
+
+    /* segments, which are not initialized or of another layout, are kept */
+    auto * header = static_cast<SharedMemoryPublisher::Header *>(memory);
+    const bool stale =
+        (header->signature.load(std::memory_order_acquire) == SharedMemoryPublisher::signature) &&
+        (header->version == SharedMemoryPublisher::version) &&
+        (header->closed.load() || !processAlive(header->publisherPid));
+    ::munmap(memory, sizeof(SharedMemoryPublisher::Header));
+    return stale;
+}
+#endif
+
+/** serializes an object into a buffer */
+class SerializeFile final : public AbstractFile {
+  public:
+    explicit SerializeFile(std::vector<char> & buffer) :
+        m_buffer(buffer) {
+        m_buffer.clear();
+    }
+
+    std::streamsize gcount() const override {
+        return 0;
+    }
+
+    void read(char * /*s*/, std::streamsize /*n*/) override {
+    }
+
+    std::streampos tellg() override {
+        return -1;
+    }
+
+    void seekg(std::streamoff /*off*/, const std::ios_base::seekdir /*way*/) override {
+    }
+
+    void write(const char * s, std::streamsize n) override {
+        m_buffer.insert(m_buffer.end(), s, s + n);
+    }
+
+    std::streampos tellp() override {
+        return static_cast<std::streamoff>(m_buffer.size());
+    }
+
+    bool good() const override {
+        return true;
+    }
+
+    bool eof() const override {
+        return false;
+    }
+
+  private:
+    /** buffer */
+    std::vector<char> & m_buffer;
+};
+
+}
+
+SharedMemoryPublisher::~SharedMemoryPublisher() {
+    close();
+}
+
+bool SharedMemoryPublisher::open(const char * name) {
+    if (is_open())
+        return false;
+
+#if defined(_WIN32)
+    (void) name;
+    return false;
+#else
+    /* atomics have to work across processes */
+    if (!std::atomic<uint32_t>().is_lock_free() || !std::atomic<uint64_t>().is_lock_free())
+        return false;
+
+    /* create shared memory */
+    const uint64_t ringSize = (capacity + 7) & ~UINT64_C(7);
+    const uint64_t size = ringOffset(maxConsumers) + ringSize;
+    int fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if ((fd < 0) && (errno == EEXIST) && staleSegment(name)) {
+        ::shm_unlink(name); // consumers of it keep their mapping
+        fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    }
+    if (fd < 0)
+        return false;
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        ::close(fd);
+        ::shm_unlink(name);
+        return false;
+    }
+    void * memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        ::shm_unlink(name);
+        return false;
+    }
+
+    /* layout */
+    m_name = name;
+    m_memory = memory;
+    m_size = size;
+    m_header = static_cast<Header *>(memory);
+    m_consumers = reinterpret_cast<Consumer *>(static_cast<char *>(memory) + consumersOffset());
+    m_ring = static_cast<char *>(memory) + ringOffset(maxConsumers);
+
+    /* initialize, the signature last, as readers check it */
+    m_header->version = version;
+    m_header->capacity = ringSize;
+    m_header->maxConsumers = maxConsumers;
+    m_header->closed.store(0);
+    m_header->writePosition.store(0);
+    m_header->publisherPid = static_cast<uint32_t>(::getpid());
+    for (uint32_t i = 0; i < maxConsumers; ++i) {
+        m_consumers[i].state.store(Free);
+        m_consumers[i].pid.store(0);
+        m_consumers[i].readPosition.store(0);
+    }
+    m_header->signature.store(signature, std::memory_order_release);
+    return true;
+#endif
+}
+
+bool SharedMemoryPublisher::open(const std::string & name) {
+    return open(name.c_str());
+}
+
+bool SharedMemoryPublisher::is_open() const {
+    return m_memory != nullptr;
+}
+
+bool SharedMemoryPublisher::waitForConsumers(uint32_t count, uint32_t timeout) {
+    if (!is_open())
+        return false;
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+    for (;;) {
+        detachStaleConsumers();
+        acceptConsumers();
+        if (consumers() >= count)
+            return true;
+        if (std::chrono::steady_clock::now() >= deadline)
+            return false;
+        std::this_thread::sleep_for(pollInterval);
+    }
+}
+
+uint32_t SharedMemoryPublisher::consumers() const {
+    if (!is_open())
+        return 0;
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < m_header->maxConsumers; ++i) {
+        if (m_consumers[i].state.load() == Attached)
+            count++;
+    }
+    return count;
+}
+
+void SharedMemoryPublisher::write(ObjectHeaderBase & ohb) {
+    if (!is_open())
+        return;
+
+    /* serialize */
+    SerializeFile serializeFile(m_buffer);
+    ohb.write(serializeFile);
+    const uint64_t objectSize = m_buffer.size();
+    const uint64_t recordSize = (recordHeaderSize + objectSize + 7) & ~UINT64_C(7);
+    const uint64_t capacity = m_header->capacity;
+    if (recordSize > capacity)
+        throw Exception("SharedMemoryPublisher::write(): Object is larger than the ring.");
+
+    /* records are contiguous, so wrap around if it doesn't fit at the end */
+    uint64_t writePosition = m_header->writePosition.load(std::memory_order_relaxed);
+    const uint64_t offset = writePosition % capacity;
+    const uint64_t wrapSize = (offset + recordSize > capacity) ? capacity - offset : 0;
+
+    /* wait for the slowest consumer, as long as it is alive */
+    for (;;) {
+        acceptConsumers();
+        if (freeSpace() >= wrapSize + recordSize)
+            break;
+        std::this_thread::sleep_for(pollInterval);
+        detachStaleConsumers();
+    }
+
+    /* wrap around */
+    if (wrapSize > 0) {
+        const uint32_t wrapMarker = 0;
+        std::memcpy(m_ring + offset, &wrapMarker, sizeof(wrapMarker));
+        writePosition += wrapSize;
+    }
+
+    /* copy record, and publish it */
+    const uint32_t size = static_cast<uint32_t>(objectSize);
+    char * record = m_ring + (writePosition % capacity);
+    std::memcpy(record, &size, sizeof(size));
+    std::memcpy(record + recordHeaderSize, m_buffer.data(), m_buffer.size());
+    m_header->writePosition.store(writePosition + recordSize, std::memory_order_release);
+}
+
+uint64_t SharedMemoryPublisher::publish(File & file) {
+    uint64_t count = 0;
+    while (ObjectHeaderBase * ohb = file.read()) {
+        write(*ohb);
+        delete ohb;
+        count++;
+    }
+    return count;
+}
+
+uint64_t SharedMemoryPublisher::consumersOffset() {
+    /* cache line aligned */
+    return (sizeof(Header) + 63) & ~UINT64_C(63);
+}
+
+uint64_t SharedMemoryPublisher::ringOffset(uint32_t maxConsumers) {
+    /* cache line aligned */
+    return (consumersOffset() + maxConsumers * sizeof(Consumer) + 63) & ~UINT64_C(63);
+}
+
+void SharedMemoryPublisher::close() {
+    if (!is_open())
+        return;
+
+#if !defined(_WIN32)
+    /* consumers keep their mapping, after the name is removed */
+    m_header->closed.store(1, std::memory_order_release);
+    ::munmap(m_memory, m_size);
+    ::shm_unlink(m_name.c_str());
+#endif
+    m_memory = nullptr;
+    m_header = nullptr;
+    m_consumers = nullptr;
+    m_ring = nullptr;
+}
+
+void SharedMemoryPublisher::acceptConsumers() {
+    const uint64_t writePosition = m_header->writePosition.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < m_header->maxConsumers; ++i) {
+        /* the consumer sets its pid after claiming the slot */
+        if ((m_consumers[i].state.load() == Attaching) && (m_consumers[i].pid.load() != 0)) {
+            /* the consumer gives up, if the publisher is too late */
+            m_consumers[i].readPosition.store(writePosition);
+            uint32_t expected = Attaching;
+            m_consumers[i].state.compare_exchange_strong(expected, Attached);
+        }
+    }
+}
+
+void SharedMemoryPublisher::detachStaleConsumers() {
+#if !defined(_WIN32)
+    for (uint32_t i = 0; i < m_header->maxConsumers; ++i) {
+        const uint32_t state = m_consumers[i].state.load();
+        const uint32_t pid = m_consumers[i].pid.load();
+        if ((state == Free) || (pid == 0) || processAlive(pid))
+            continue;
+
+        /* a terminated consumer can't free its slot, so nobody else changes it */
+        m_consumers[i].pid.store(0);
+        m_consumers[i].state.store(Free);
+    }
+#endif
+}
+
+uint64_t SharedMemoryPublisher::freeSpace() const {
+    /* the slowest consumer limits the space */
+    const uint64_t writePosition = m_header->writePosition.load(std::memory_order_relaxed);
+    uint64_t used = 0;
+    for (uint32_t i = 0; i < m_header->maxConsumers; ++i) {
+        if (m_consumers[i].state.load() == Attached) {
+            const uint64_t readPosition = m_consumers[i].readPosition.load(std::memory_order_acquire);
+            if (writePosition - readPosition > used)
+                used = writePosition - readPosition;
+        }
+    }
+    return m_header->capacity - used;
+}
+
+}
+}
@@ -0,0 +1,249 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <Vector/BLF/File.h>
+#include <Vector/BLF/ObjectHeaderBase.h>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * Publish objects into a shared memory ring
+ *
+ * A file is read, inflated and parsed once, and the serialized objects are
+ * published to several local processes, which attach with
+ * SharedMemoryReader. Each consumer has its own read position. The
+ * publisher waits for the slowest consumer, so that all consumers stay in
+ * lockstep and no object is lost. Consumers, whose process terminated
+ * without detaching, are detached by the publisher, when it waits for them.
+ *
+ * Objects are serialized as in the uncompressed file. A record in the ring
+ * is the object size (uint32_t), 4 reserved bytes and the object, padded to
+ * 8 bytes. A record size of 0 wraps around to the begin of the ring.
+ *
+ * Liveness is checked by process id, so publisher and consumers have to
+ * run in the same pid namespace.
+ *
+ * Uses POSIX shared memory (shm_open), so it's not available on Windows.
+ * This class is not thread-safe.
+ */
+class VECTOR_BLF_EXPORT SharedMemoryPublisher final {
+  public:
+    /** signature "BLFS" */
+    static constexpr uint32_t signature = 0x53464C42;
+
+    /** layout version */
+    static constexpr uint32_t version = 2;
+
+    /** record header: object size and reserved bytes */
+    static constexpr uint32_t recordHeaderSize = 8;
+
+    /** state of a consumer slot */
+    enum ConsumerState : uint32_t {
+        /** unused */
+        Free = 0,
+
+        /** consumer waits for the publisher to assign a read position */
+        Attaching = 1,
+
+        /** consumer reads */
+        Attached = 2
+    };
+
+    /** shared memory header */
+    struct Header {
+        /** signature "BLFS", set when initialized */
+        std::atomic<uint32_t> signature;
+
+        /** layout version */
+        uint32_t version;
+
+        /** ring size in bytes */
+        uint64_t capacity;
+
+        /** number of consumer slots */
+        uint32_t maxConsumers;
+
+        /** publisher closed, no more objects follow */
+        std::atomic<uint32_t> closed;
+
+        /** total bytes written into the ring */
+        std::atomic<uint64_t> writePosition;
+
+        /** process id of the publisher */
+        uint32_t publisherPid;
+    };
+
+    /** consumer slot, following the header */
+    struct Consumer {
+        /** state */
+        std::atomic<uint32_t> state;
+
+        /** process id of the consumer, 0 while it is claiming the slot */
+        std::atomic<uint32_t> pid;
+
+        /** total bytes read from the ring */
+        std::atomic<uint64_t> readPosition;
+    };
+
+    SharedMemoryPublisher() = default;
+    virtual ~SharedMemoryPublisher();
+    SharedMemoryPublisher(const SharedMemoryPublisher &) = delete;
+    SharedMemoryPublisher & operator=(const SharedMemoryPublisher &) = delete;
+    SharedMemoryPublisher(SharedMemoryPublisher &&) = delete;
+    SharedMemoryPublisher & operator=(SharedMemoryPublisher &&) = delete;
+
+    /**
+     * Ring size in bytes, read at open.
+     *
+     * It has to hold the largest object.
+     */
+    uint64_t capacity {0x4000000};
+
+    /**
+     * Maximum number of consumers, read at open.
+     */
+    uint32_t maxConsumers {8};
+
+    /**
+     * Create the shared memory.
+     *
+     * Fails, if the name is used by a running publisher, or by a segment
+     * of another layout. A segment left behind by a terminated publisher is
+     * replaced.
+     *
+     * @param[in] name shared memory name, e.g. "/vector_blf"
+     * @return true on success
+     */
+    virtual bool open(const char * name);
+
+    /**
+     * Create the shared memory.
+     *
+     * Fails, if the name is used by a running publisher, or by a segment
+     * of another layout. A segment left behind by a terminated publisher is
+     * replaced.
+     *
+     * @param[in] name shared memory name, e.g. "/vector_blf"
+     * @return true on success
+     */
+    virtual bool open(const std::string & name);
+
+    /**
+     * is shared memory open?
+     *
+     * @return true if open
+     */
+    virtual bool is_open() const;
+
+    /**
+     * Wait for consumers to attach.
+     *
+     * Consumers attach, when the publisher writes or waits here.
+     *
+     * @param[in] count number of consumers
+     * @param[in] timeout timeout in ms
+     * @return true if count consumers are attached
+     */
+    virtual bool waitForConsumers(uint32_t count, uint32_t timeout);
+
+    /**
+     * Number of attached consumers
+     *
+     * @return attached consumers
+     */
+    virtual uint32_t consumers() const;
+
+    /**
+     * Publish an object.
+     *
+     * Waits until all consumers have read enough to make space.
+     * Consumers of terminated processes are detached meanwhile.
+     *
+     * @param[in] ohb object
+     */
+    virtual void write(ObjectHeaderBase & ohb);
+
+    /**
+     * Publish all objects of a file.
+     *
+     * @param[in] file file opened for reading
+     * @return number of published objects
+     */
+    virtual uint64_t publish(File & file);
+
+    /**
+     * Offset of the consumer slots in the shared memory
+     *
+     * @return offset
+     */
+    static uint64_t consumersOffset();
+
+    /**
+     * Offset of the ring in the shared memory
+     *
+     * @param[in] maxConsumers number of consumer slots
+     * @return offset
+     */
+    static uint64_t ringOffset(uint32_t maxConsumers);
+
+    /**
+     * Mark the end, and remove the shared memory name.
+     *
+     * Attached consumers read the remaining objects.
+     */
+    virtual void close();
+
+  private:
+    /** shared memory name */
+    std::string m_name {};
+
+    /** mapped memory */
+    void * m_memory {};
+
+    /** mapped size */
+    uint64_t m_size {};
+
+    /** header */
+    Header * m_header {};
+
+    /** consumer slots */
+    Consumer * m_consumers {};
+
+    /** ring */
+    char * m_ring {};
+
+    /** serialization buffer */
+    std::vector<char> m_buffer {};
+
+    /**
+     * Assign the write position to attaching consumers.
+     */
+    void acceptConsumers();
+
+    /**
+     * Detach consumers, whose process terminated.
+     */
+    void detachStaleConsumers();
+
+    /**
+     * Free bytes, limited by the slowest consumer.
+     *
+     * @return free bytes
+     */
+    uint64_t freeSpace() const;
+};
+
+}
+}
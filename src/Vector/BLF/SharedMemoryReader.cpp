@@ -0,0 +1,295 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/SharedMemoryReader.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <Vector/BLF/Exceptions.h>
+#include <Vector/BLF/File.h>
+
+namespace Vector {
+namespace BLF {
+
+namespace {
+
+/** interval in which the reader polls the publisher, if there is no data */
+const std::chrono::microseconds pollInterval(100);
+
+/** reads an object from its data in the shared memory */
+class ViewFile final : public AbstractFile {
+  public:
+    /**
+     * @param[in] data object data
+     * @param[in] size object size
+     * @param[in] paddedSize size, up to which zeros are read after the data
+     */
+    ViewFile(const char * data, uint64_t size, uint64_t paddedSize) :
+        m_data(data),
+        m_size(size),
+        m_paddedSize(std::max(size, paddedSize)) {
+    }
+
+    std::streamsize gcount() const override {
+        return m_gcount;
+    }
+
+    void read(char * s, std::streamsize n) override {
+        /* handle read behind eof */
+        uint64_t count = static_cast<uint64_t>(n);
+        if (m_position + count > m_paddedSize) {
+            count = m_paddedSize - std::min(m_position, m_paddedSize);
+            m_rdstate = std::ios_base::eofbit | std::ios_base::failbit;
+        }
+
+        /* read data, and zeros behind it */
+        const uint64_t dataCount = (m_position < m_size) ? std::min(count, m_size - m_position) : 0;
+        if (dataCount > 0)
+            std::memcpy(s, m_data + m_position, static_cast<size_t>(dataCount));
+        std::memset(s + dataCount, 0, static_cast<size_t>(count - dataCount));
+        m_position += count;
+        m_gcount = static_cast<std::streamsize>(count);
+    }
+
+    std::streampos tellg() override {
+        return static_cast<std::streamoff>(m_position);
+    }
+
+    void seekg(std::streamoff off, const std::ios_base::seekdir way) override {
+        if (way == std::ios_base::beg)
+            m_position = static_cast<uint64_t>(off);
+        else if (way == std::ios_base::cur)
+            m_position = static_cast<uint64_t>(static_cast<std::streamoff>(m_position) + off);
+        else
+            m_position = static_cast<uint64_t>(static_cast<std::streamoff>(m_size) + off);
+    }
+
+    void write(const char * /*s*/, std::streamsize /*n*/) override {
+    }
+
+    std::streampos tellp() override {
+        return -1;
+    }
+
+    bool good() const override {
+        return m_rdstate == std::ios_base::goodbit;
+    }
+
+    bool eof() const override {
+        return m_rdstate & std::ios_base::eofbit;
+    }
+
+  private:
+    /** data */
+    const char * m_data;
+
+    /** size */
+    uint64_t m_size;
+
+    /** size including zeros */
+    uint64_t m_paddedSize;
+
+    /** position */
+    uint64_t m_position {};
+
+    /** last read size */
+    std::streamsize m_gcount {};
+
+    /** error state */
+    std::ios_base::iostate m_rdstate {std::ios_base::goodbit};
+};
+
+}
+
+SharedMemoryReader::~SharedMemoryReader() {
+    close();
+}
+
+bool SharedMemoryReader::open(const char * name, uint32_t timeout) {
+    if (is_open())
+        return false;
+
+#if defined(_WIN32)
+    (void) name;
+    (void) timeout;
+    return false;
+#else
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+
+    /* open shared memory, once the publisher has initialized it */
+    for (;;) {
+        const int fd = ::shm_open(name, O_RDWR, 0);
+        if (fd >= 0) {
+            struct stat st;
+            void * memory = MAP_FAILED;
+            if ((::fstat(fd, &st) == 0) && (static_cast<uint64_t>(st.st_size) >= sizeof(SharedMemoryPublisher::Header)))
+                memory = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (memory != MAP_FAILED) {
+                auto * header = static_cast<SharedMemoryPublisher::Header *>(memory);
+                if (header->signature.load(std::memory_order_acquire) == SharedMemoryPublisher::signature) {
+                    m_memory = memory;
+                    m_size = static_cast<uint64_t>(st.st_size);
+                    m_header = header;
+                    break;
+                }
+                ::munmap(memory, static_cast<size_t>(st.st_size));
+            }
+        }
+        if (std::chrono::steady_clock::now() >= deadline)
+            return false;
+        std::this_thread::sleep_for(pollInterval);
+    }
+    if ((m_header->version != SharedMemoryPublisher::version) ||
+            (SharedMemoryPublisher::ringOffset(m_header->maxConsumers) + m_header->capacity > m_size)) {
+        close();
+        return false;
+    }
+    m_ring = static_cast<const char *>(m_memory) + SharedMemoryPublisher::ringOffset(m_header->maxConsumers);
+
+    /* claim consumer slot */
+    auto * consumers = reinterpret_cast<SharedMemoryPublisher::Consumer *>(static_cast<char *>(m_memory) + SharedMemoryPublisher::consumersOffset());
+    for (uint32_t i = 0; i < m_header->maxConsumers; ++i) {
+        uint32_t expected = SharedMemoryPublisher::Free;
+        if (consumers[i].state.compare_exchange_strong(expected, SharedMemoryPublisher::Attaching)) {
+            m_consumer = &consumers[i];
+            m_consumer->pid.store(static_cast<uint32_t>(::getpid()));
+            break;
+        }
+    }
+    if (!m_consumer) {
+        close();
+        return false;
+    }
+
+    /* wait for the publisher to assign the read position */
+    while (m_consumer->state.load() != SharedMemoryPublisher::Attached) {
+        if ((std::chrono::steady_clock::now() >= deadline) || m_header->closed.load()) {
+            /* give up, unless the publisher was faster */
+            uint32_t expected = SharedMemoryPublisher::Attaching;
+            m_consumer->pid.store(0);
+            if (m_consumer->state.compare_exchange_strong(expected, SharedMemoryPublisher::Free)) {
+                m_consumer = nullptr;
+                close();
+                return false;
+            }
+            m_consumer->pid.store(static_cast<uint32_t>(::getpid()));
+            break;
+        }
+        std::this_thread::sleep_for(pollInterval);
+    }
+    m_readPosition = m_consumer->readPosition.load(std::memory_order_acquire);
+    m_eof = false;
+    return true;
+#endif
+}
+
+bool SharedMemoryReader::open(const std::string & name, uint32_t timeout) {
+    return open(name.c_str(), timeout);
+}
+
+bool SharedMemoryReader::is_open() const {
+    return m_consumer != nullptr;
+}
+
+const char * SharedMemoryReader::view(uint32_t & size, uint32_t timeout) {
+    if (!is_open() || m_eof)
+        return nullptr;
+
+    /* release the object viewed last */
+    m_consumer->readPosition.store(m_readPosition, std::memory_order_release);
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+    const uint64_t capacity = m_header->capacity;
+    for (;;) {
+        /* closed first, so that the write position is final then */
+        const bool closed = m_header->closed.load(std::memory_order_acquire);
+        const uint64_t writePosition = m_header->writePosition.load(std::memory_order_acquire);
+        while (m_readPosition < writePosition) {
+            const uint64_t offset = m_readPosition % capacity;
+            uint32_t recordSize;
+            std::memcpy(&recordSize, m_ring + offset, sizeof(recordSize));
+
+            /* wrap around */
+            if (recordSize == 0) {
+                m_readPosition += capacity - offset;
+                continue;
+            }
+
+            size = recordSize;
+            m_readPosition += (SharedMemoryPublisher::recordHeaderSize + recordSize + 7) & ~UINT64_C(7);
+            return m_ring + offset + SharedMemoryPublisher::recordHeaderSize;
+        }
+        if (closed) {
+            m_eof = true;
+            return nullptr;
+        }
+        if (std::chrono::steady_clock::now() >= deadline)
+            return nullptr;
+        std::this_thread::sleep_for(pollInterval);
+    }
+}
+
+ObjectHeaderBase * SharedMemoryReader::read(uint32_t timeout) {
+    for (;;) {
+        uint32_t size;
+        const char * data = view(size, timeout);
+        if (data == nullptr)
+            return nullptr;
+
+        /* identify type */
+        ObjectHeaderBase ohb(0, ObjectType::UNKNOWN);
+        ViewFile headerFile(data, size, size);
+        ohb.read(headerFile);
+        if (!headerFile.good())
+            throw Exception("SharedMemoryReader::read(): Object header is incomplete.");
+
+        /* create object, unknown types are skipped */
+        ObjectHeaderBase * obj = File::createObject(ohb.objectType);
+        if (obj == nullptr)
+            continue;
+
+        /* read object, some objects read up to their calculated size */
+        ViewFile objectFile(data, size, obj->calculateObjectSize());
+        obj->read(objectFile);
+        if (!objectFile.good()) {
+            delete obj;
+            throw Exception("SharedMemoryReader::read(): Read beyond end of object.");
+        }
+        return obj;
+    }
+}
+
+bool SharedMemoryReader::eof() const {
+    return m_eof;
+}
+
+void SharedMemoryReader::close() {
+#if !defined(_WIN32)
+    if (m_consumer) {
+        m_consumer->pid.store(0);
+        m_consumer->state.store(SharedMemoryPublisher::Free);
+        m_consumer = nullptr;
+    }
+    if (m_memory) {
+        ::munmap(m_memory, static_cast<size_t>(m_size));
+        m_memory = nullptr;
+    }
+#endif
+    m_header = nullptr;
+    m_ring = nullptr;
+}
+
+}
+}
@@ -0,0 +1,122 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <string>
+
+#include <Vector/BLF/ObjectHeaderBase.h>
+#include <Vector/BLF/SharedMemoryPublisher.h>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * Read objects published by SharedMemoryPublisher
+ *
+ * Each reader attaches as one consumer with its own read position.
+ * Objects can be viewed in the shared memory without copying, or read as
+ * objects like with File.
+ *
+ * This class is not thread-safe.
+ */
+class VECTOR_BLF_EXPORT SharedMemoryReader final {
+  public:
+    SharedMemoryReader() = default;
+    virtual ~SharedMemoryReader();
+    SharedMemoryReader(const SharedMemoryReader &) = delete;
+    SharedMemoryReader & operator=(const SharedMemoryReader &) = delete;
+    SharedMemoryReader(SharedMemoryReader &&) = delete;
+    SharedMemoryReader & operator=(SharedMemoryReader &&) = delete;
+
+    /**
+     * Attach to the shared memory.
+     *
+     * The publisher assigns the read position, while it writes or waits for
+     * consumers. The first object read is the next one published.
+     *
+     * @param[in] name shared memory name
+     * @param[in] timeout timeout in ms
+     * @return true if attached
+     */
+    virtual bool open(const char * name, uint32_t timeout = 1000);
+
+    /**
+     * Attach to the shared memory.
+     *
+     * @param[in] name shared memory name
+     * @param[in] timeout timeout in ms
+     * @return true if attached
+     */
+    virtual bool open(const std::string & name, uint32_t timeout = 1000);
+
+    /**
+     * is attached?
+     *
+     * @return true if attached
+     */
+    virtual bool is_open() const;
+
+    /**
+     * View the next object in the shared memory, without copying it.
+     *
+     * The data is serialized like in the uncompressed file, starting with
+     * the ObjectHeaderBase. It stays valid until the next call of view,
+     * read or close.
+     *
+     * @param[out] size object size in bytes
+     * @param[in] timeout timeout in ms
+     * @return object data, or nullptr on timeout or at end
+     */
+    virtual const char * view(uint32_t & size, uint32_t timeout = 1000);
+
+    /**
+     * Read the next object.
+     *
+     * @param[in] timeout timeout in ms
+     * @return object, or nullptr on timeout or at end
+     */
+    virtual ObjectHeaderBase * read(uint32_t timeout = 1000);
+
+    /**
+     * Publisher is closed and all objects are read.
+     *
+     * @return true at end
+     */
+    virtual bool eof() const;
+
+    /**
+     * Detach from the shared memory.
+     */
+    virtual void close();
+
+  private:
+    /** mapped memory */
+    void * m_memory {};
+
+    /** mapped size */
+    uint64_t m_size {};
+
+    /** header */
+    SharedMemoryPublisher::Header * m_header {};
+
+    /** consumer slot */
+    SharedMemoryPublisher::Consumer * m_consumer {};
+
+    /** ring */
+    const char * m_ring {};
+
+    /** position after the object viewed last */
+    uint64_t m_readPosition {};
+
+    /** end reached */
+    bool m_eof {};
+};
+
+}
+}
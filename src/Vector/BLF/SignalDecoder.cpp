@@ -0,0 +1,175 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/SignalDecoder.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <Vector/BLF/Exceptions.h>
+
+namespace Vector {
+namespace BLF {
+
+namespace {
+
+/** decode one signal over a batch of frames, with plan copied into locals */
+template<bool bigEndian, bool isSigned, typename Plan>
+void decodeLoop(const uint8_t * first, const std::size_t stride, const std::size_t count, const Plan & plan, double * values) {
+    const uint8_t byteCount = plan.byteCount;
+    const uint8_t shift = plan.shift;
+    const uint64_t mask = plan.mask;
+    const uint8_t signShift = plan.signShift;
+    const double factor = plan.factor;
+    const double offset = plan.offset;
+
+    for (std::size_t frame = 0; frame < count; ++frame) {
+        const uint8_t * bytes = first + frame * stride;
+        uint64_t value = 0;
+        for (uint8_t i = 0; i < byteCount; ++i) {
+            if (bigEndian)
+                value = (value << 8) | bytes[i];
+            else
+                value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+        }
+        value = (value >> shift) & mask;
+        if (isSigned)
+            values[frame] = static_cast<double>(static_cast<int64_t>(value << signShift) >> signShift) * factor + offset;
+        else
+            values[frame] = static_cast<double>(value) * factor + offset;
+    }
+}
+
+}
+
+SignalDecoder::SignalDecoder(const Dbc::Message & message) {
+    /* multiplexor */
+    int multiplexor = -1;
+    for (std::size_t i = 0; i < message.signals.size(); ++i)
+        if (message.signals[i].multiplex == Dbc::Signal::Multiplex::Multiplexor)
+            multiplexor = static_cast<int>(i);
+
+    for (const Dbc::Signal & signal : message.signals) {
+        Plan plan;
+        plan.name = signal.name;
+        plan.bigEndian = signal.bigEndian;
+        if (signal.bigEndian) {
+            /* Motorola: start bit is MSB, count bits from MSB of first byte */
+            uint16_t msb = (signal.startBit / 8) * 8 + (7 - signal.startBit % 8);
+            uint16_t lsb = msb + signal.length - 1;
+            plan.byteOffset = msb / 8;
+            plan.byteCount = static_cast<uint8_t>(lsb / 8 - plan.byteOffset + 1);
+            plan.shift = static_cast<uint8_t>(plan.byteCount * 8 - 1 - (lsb - plan.byteOffset * 8));
+        } else {
+            /* Intel: start bit is LSB */
+            plan.byteOffset = signal.startBit / 8;
+            plan.shift = signal.startBit % 8;
+            plan.byteCount = static_cast<uint8_t>((plan.shift + signal.length + 7) / 8);
+        }
+        if (plan.byteCount > 8)
+            throw Exception("SignalDecoder::SignalDecoder(): Signal spans more than 8 bytes.");
+        plan.mask = (signal.length == 64) ? ~0ULL : ((1ULL << signal.length) - 1);
+        plan.isSigned = signal.isSigned;
+        plan.signShift = static_cast<uint8_t>(64 - signal.length);
+        plan.factor = signal.factor;
+        plan.offset = signal.offset;
+        if (signal.multiplex == Dbc::Signal::Multiplex::Multiplexed) {
+            if (multiplexor < 0)
+                throw Exception("SignalDecoder::SignalDecoder(): Multiplexed signal without multiplexor.");
+            plan.multiplexor = multiplexor;
+            plan.multiplexValue = signal.multiplexValue;
+        }
+        m_size = std::max<std::size_t>(m_size, plan.byteOffset + plan.byteCount);
+        m_plans.push_back(plan);
+    }
+}
+
+std::size_t SignalDecoder::signalCount() const {
+    return m_plans.size();
+}
+
+const std::string & SignalDecoder::signalName(const std::size_t signal) const {
+    return m_plans.at(signal).name;
+}
+
+void SignalDecoder::decode(const uint8_t * data, const std::size_t size, double * values) const {
+    for (std::size_t i = 0; i < m_plans.size(); ++i) {
+        const Plan & plan = m_plans[i];
+        if (plan.byteOffset + plan.byteCount > size) {
+            values[i] = std::numeric_limits<double>::quiet_NaN();
+            continue;
+        }
+
+        /* the multiplexor has to be in the frame as well */
+        if (plan.multiplexor >= 0) {
+            const Plan & multiplexor = m_plans[plan.multiplexor];
+            if ((multiplexor.byteOffset + multiplexor.byteCount > size) ||
+                    (extract(multiplexor, data) != plan.multiplexValue)) {
+                values[i] = std::numeric_limits<double>::quiet_NaN();
+                continue;
+            }
+        }
+        uint64_t raw = extract(plan, data);
+        values[i] = (plan.isSigned ? static_cast<double>(static_cast<int64_t>(raw)) : static_cast<double>(raw)) * plan.factor + plan.offset;
+    }
+}
+
+void SignalDecoder::decode(const uint8_t * data, const std::size_t stride, const std::size_t count, const std::size_t signal, double * values) const {
+    if (signal >= m_plans.size())
+        throw Exception("SignalDecoder::decode(): Invalid signal index.");
+    decodeColumn(m_plans[signal], data, stride, count, values);
+}
+
+void SignalDecoder::decodeBatch(const uint8_t * data, const std::size_t stride, const std::size_t count, double * values) const {
+    for (const Plan & plan : m_plans) {
+        decodeColumn(plan, data, stride, count, values);
+        values += count;
+    }
+}
+
+uint64_t SignalDecoder::extract(const Plan & plan, const uint8_t * data) {
+    data += plan.byteOffset;
+    uint64_t value = 0;
+    if (plan.bigEndian) {
+        for (uint8_t i = 0; i < plan.byteCount; ++i)
+            value = (value << 8) | data[i];
+    } else {
+        for (uint8_t i = 0; i < plan.byteCount; ++i)
+            value |= static_cast<uint64_t>(data[i]) << (8 * i);
+    }
+    value = (value >> plan.shift) & plan.mask;
+    if (plan.isSigned)
+        value = static_cast<uint64_t>(static_cast<int64_t>(value << plan.signShift) >> plan.signShift);
+    return value;
+}
+
+void SignalDecoder::decodeColumn(const Plan & plan, const uint8_t * data, const std::size_t stride, const std::size_t count, double * values) const {
+    if ((count > 1) && (stride < m_size))
+        throw Exception("SignalDecoder::decode(): Stride is smaller than message size.");
+
+    /* the layout is constant within the loops, so only the byte order and sign select the loop */
+    const uint8_t * first = data + plan.byteOffset;
+    if (plan.bigEndian) {
+        if (plan.isSigned)
+            decodeLoop<true, true>(first, stride, count, plan, values);
+        else
+            decodeLoop<true, false>(first, stride, count, plan, values);
+    } else {
+        if (plan.isSigned)
+            decodeLoop<false, true>(first, stride, count, plan, values);
+        else
+            decodeLoop<false, false>(first, stride, count, plan, values);
+    }
+
+    /* multiplexing */
+    if (plan.multiplexor >= 0) {
+        const Plan & multiplexor = m_plans[plan.multiplexor];
+        for (std::size_t frame = 0; frame < count; ++frame)
+            if (extract(multiplexor, data + frame * stride) != plan.multiplexValue)
+                values[frame] = std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+}
+}
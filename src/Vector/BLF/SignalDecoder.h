@@ -0,0 +1,160 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <string>
+#include <vector>
+
+#include <Vector/BLF/Dbc.h>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * Signal decoder
+ *
+ * Compiles the signal layout of one DBC message into an extraction plan
+ * (byte offset, byte count, shift, mask, sign extension, factor/offset and
+ * multiplexor condition) and applies it to single frames or batches of
+ * frames with the same ID.
+ *
+ * The batch decoder works column by column: the inner loop runs over the
+ * frames with all signal parameters constant, so it doesn't branch on the
+ * signal layout per frame.
+ *
+ * Values of multiplexed signals, whose multiplexor doesn't match, and of
+ * signals outside the frame data are NaN.
+ */
+class VECTOR_BLF_EXPORT SignalDecoder final {
+  public:
+    /**
+     * constructor
+     *
+     * @param[in] message DBC message
+     */
+    explicit SignalDecoder(const Dbc::Message & message);
+    virtual ~SignalDecoder() = default;
+
+    /**
+     * Get number of signals.
+     *
+     * @return number of signals
+     */
+    virtual std::size_t signalCount() const;
+
+    /**
+     * Get signal name.
+     *
+     * @param[in] signal signal index
+     * @return signal name
+     */
+    virtual const std::string & signalName(const std::size_t signal) const;
+
+    /**
+     * Decode all signals of a frame.
+     *
+     * @param[in] data frame data
+     * @param[in] size frame data size
+     * @param[out] values physical values, one per signal
+     */
+    virtual void decode(const uint8_t * data, const std::size_t size, double * values) const;
+
+    /**
+     * Decode one signal over a batch of frames.
+     *
+     * Frames are stored with constant stride, e.g. an array of 8 or 64
+     * byte payloads. Frames must be at least as large as the message.
+     *
+     * @param[in] data data of first frame
+     * @param[in] stride distance between frames in bytes
+     * @param[in] count number of frames
+     * @param[in] signal signal index
+     * @param[out] values physical values, one per frame
+     */
+    virtual void decode(const uint8_t * data, const std::size_t stride, const std::size_t count, const std::size_t signal, double * values) const;
+
+    /**
+     * Decode all signals over a batch of frames.
+     *
+     * @param[in] data data of first frame
+     * @param[in] stride distance between frames in bytes
+     * @param[in] count number of frames
+     * @param[out] values physical values, signal by signal (values[signal * count + frame])
+     */
+    virtual void decodeBatch(const uint8_t * data, const std::size_t stride, const std::size_t count, double * values) const;
+
+  private:
+    /** extraction plan of a signal */
+    struct Plan {
+        /** name */
+        std::string name {};
+
+        /** first byte */
+        uint16_t byteOffset {};
+
+        /** number of bytes to load */
+        uint8_t byteCount {};
+
+        /** byte order */
+        bool bigEndian {};
+
+        /** right shift after load */
+        uint8_t shift {};
+
+        /** mask after shift */
+        uint64_t mask {};
+
+        /** value is signed */
+        bool isSigned {};
+
+        /** left shift for sign extension */
+        uint8_t signShift {};
+
+        /** factor */
+        double factor {};
+
+        /** offset */
+        double offset {};
+
+        /** index of multiplexor plan (-1 if not multiplexed) */
+        int multiplexor {-1};
+
+        /** multiplexor value */
+        uint64_t multiplexValue {};
+    };
+
+    /** plans */
+    std::vector<Plan> m_plans {};
+
+    /** minimum frame size */
+    std::size_t m_size {};
+
+    /**
+     * Extract raw value.
+     *
+     * @param[in] plan plan
+     * @param[in] data frame data
+     * @return raw value (sign extended)
+     */
+    static uint64_t extract(const Plan & plan, const uint8_t * data);
+
+    /**
+     * Decode one signal over a batch of frames into values.
+     *
+     * @param[in] plan plan
+     * @param[in] data data of first frame
+     * @param[in] stride distance between frames in bytes
+     * @param[in] count number of frames
+     * @param[out] values physical values
+     */
+    void decodeColumn(const Plan & plan, const uint8_t * data, const std::size_t stride, const std::size_t count, double * values) const;
+};
+
+}
+}
@@ -0,0 +1,211 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/Tracer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+
+#include <Vector/BLF/FileMetrics.h>
+
+namespace Vector {
+namespace BLF {
+
+namespace {
+
+/** next tracer id */
+std::atomic<uint64_t> nextTracerId {1};
+
+/** last used tracer and buffer of this thread */
+struct ThreadCache {
+    /** tracer id */
+    uint64_t tracerId;
+
+    /** buffer */
+    void * buffer;
+};
+thread_local ThreadCache threadCache {0, nullptr};
+
+/** append string with JSON escapes */
+void appendJsonString(std::string & json, const std::string & text) {
+    json += '"';
+    for (const char c : text) {
+        switch (c) {
+        case '"':
+            json += "\\\"";
+            break;
+        case '\\':
+            json += "\\\\";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) >= 0x20)
+                json += c;
+            break;
+        }
+    }
+    json += '"';
+}
+
+/** append time in us with ns resolution */
+void appendMicroseconds(std::string & json, const uint64_t ns) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%llu.%03llu",
+                  static_cast<unsigned long long>(ns / 1000),
+                  static_cast<unsigned long long>(ns % 1000));
+    json += buffer;
+}
+
+}
+
+Tracer::Scope::Scope(Tracer * tracer, const char * name, const uint64_t id) :
+    m_tracer(tracer),
+    m_name(name),
+    m_id(id),
+    m_begin(tracer ? FileMetrics::now() : 0) {
+}
+
+Tracer::Scope::~Scope() {
+    if (m_tracer)
+        m_tracer->record(m_name, m_id, m_begin, FileMetrics::now());
+}
+
+Tracer::Tracer(const std::size_t maxSpansPerThread) :
+    m_id(nextTracerId++),
+    m_maxSpansPerThread(maxSpansPerThread),
+    m_origin(FileMetrics::now()) {
+}
+
+void Tracer::record(const char * name, const uint64_t id, const uint64_t begin, const uint64_t end) {
+    ThreadBuffer & buffer = threadBuffer();
+    if (buffer.spans.size() >= m_maxSpansPerThread) {
+        buffer.droppedSpans++;
+        return;
+    }
+    buffer.spans.push_back(Span{name, id, begin, end});
+}
+
+void Tracer::setThreadName(const std::string & name) {
+    ThreadBuffer & buffer = threadBuffer();
+
+    /* mutex lock, as write may read the name */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    buffer.name = name;
+}
+
+std::size_t Tracer::spanCount() const {
+    /* mutex lock, only for m_threadBuffers, the buffers themselves are unsynchronized */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::size_t count = 0;
+    for (const auto & threadBuffer : m_threadBuffers)
+        count += threadBuffer.second->spans.size();
+    return count;
+}
+
+std::size_t Tracer::droppedSpanCount() const {
+    /* mutex lock, only for m_threadBuffers, the buffers themselves are unsynchronized */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::size_t count = 0;
+    for (const auto & threadBuffer : m_threadBuffers)
+        count += threadBuffer.second->droppedSpans;
+    return count;
+}
+
+void Tracer::clear() {
+    /* mutex lock, only for m_threadBuffers, the buffers themselves are unsynchronized */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto & threadBuffer : m_threadBuffers) {
+        threadBuffer.second->spans.clear();
+        threadBuffer.second->droppedSpans = 0;
+    }
+}
+
+bool Tracer::write(const std::string & filename) const {
+    std::ofstream os(filename, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    if (!os.is_open())
+        return false;
+
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::string json;
+    json.reserve(64 * 1024);
+    json += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto & threadBuffer : m_threadBuffers) {
+        const ThreadBuffer & buffer = *threadBuffer.second;
+        if (buffer.spans.empty())
+            continue;
+
+        /* thread name metadata */
+        if (!first)
+            json += ',';
+        first = false;
+        json += "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+        json += std::to_string(buffer.tid);
+        json += ",\"args\":{\"name\":";
+        appendJsonString(json, buffer.name.empty() ? "thread " + std::to_string(buffer.tid) : buffer.name);
+        json += "}}";
+
+        /* complete events */
+        for (const Span & span : buffer.spans) {
+            json += ",\n{\"name\":";
+            appendJsonString(json, span.name);
+            json += ",\"cat\":\"blf\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+            json += std::to_string(buffer.tid);
+            json += ",\"ts\":";
+            appendMicroseconds(json, span.begin >= m_origin ? span.begin - m_origin : 0);
+            json += ",\"dur\":";
+            appendMicroseconds(json, span.end >= span.begin ? span.end - span.begin : 0);
+            json += ",\"args\":{\"id\":";
+            json += std::to_string(span.id);
+            json += "}}";
+
+            /* flush in chunks */
+            if (json.size() >= 60 * 1024) {
+                os.write(json.data(), static_cast<std::streamsize>(json.size()));
+                json.clear();
+            }
+        }
+    }
+    json += "\n]}\n";
+    os.write(json.data(), static_cast<std::streamsize>(json.size()));
+    return os.good();
+}
+
+Tracer::ThreadBuffer & Tracer::threadBuffer() {
+    /* fast path without lock */
+    if (threadCache.tracerId == m_id)
+        return *static_cast<ThreadBuffer *>(threadCache.buffer);
+
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    /* find or create buffer of this thread */
+    const std::thread::id threadId = std::this_thread::get_id();
+    auto it = std::find_if(m_threadBuffers.begin(), m_threadBuffers.end(), [&threadId](const std::pair<std::thread::id, std::unique_ptr<ThreadBuffer>> & threadBuffer) {
+        return threadBuffer.first == threadId;
+    });
+    ThreadBuffer * buffer = nullptr;
+    if (it != m_threadBuffers.end())
+        buffer = it->second.get();
+    else {
+        std::unique_ptr<ThreadBuffer> newBuffer(new ThreadBuffer);
+        newBuffer->tid = static_cast<uint32_t>(m_threadBuffers.size() + 1);
+        newBuffer->spans.reserve(std::min<std::size_t>(m_maxSpansPerThread, 4096));
+        buffer = newBuffer.get();
+        m_threadBuffers.emplace_back(threadId, std::move(newBuffer));
+    }
+    threadCache.tracerId = m_id;
+    threadCache.buffer = buffer;
+    return *buffer;
+}
+
+}
+}
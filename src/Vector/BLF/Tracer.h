@@ -0,0 +1,200 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Vector/BLF/config.h>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * Timeline of pipeline activity
+ *
+ * Threads record begin/end spans into their own buffer. Only the first
+ * span of a thread takes a lock to register the buffer, further spans are
+ * appended without synchronization. Buffers must therefore only be written
+ * out when the recording threads are finished, e.g. on File::close.
+ *
+ * The spans are written in Chrome trace event format, which can be loaded
+ * into chrome://tracing or Perfetto.
+ *
+ * The File pipeline records spans with VECTOR_BLF_TRACE_SPAN, which
+ * compiles to nothing unless the library is built with OPTION_USE_TRACING.
+ */
+class VECTOR_BLF_EXPORT Tracer final {
+  public:
+    /**
+     * constructor
+     *
+     * @param[in] maxSpansPerThread spans per thread, further spans are dropped
+     */
+    explicit Tracer(const std::size_t maxSpansPerThread = 1000000);
+    virtual ~Tracer() = default;
+    Tracer(const Tracer &) = delete;
+    Tracer & operator=(const Tracer &) = delete;
+
+    /** span */
+    struct Span {
+        /** name, must be a string literal */
+        const char * name;
+
+        /** sequence number, e.g. log container number */
+        uint64_t id;
+
+        /** begin time in ns */
+        uint64_t begin;
+
+        /** end time in ns */
+        uint64_t end;
+    };
+
+    /** span recorded from construction to destruction */
+    class VECTOR_BLF_EXPORT Scope final {
+      public:
+        /**
+         * Begin span.
+         *
+         * @param[in] tracer tracer, or nullptr to record nothing
+         * @param[in] name name, must be a string literal
+         * @param[in] id sequence number
+         */
+        Scope(Tracer * tracer, const char * name, const uint64_t id = 0);
+
+        /** End span. */
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope & operator=(const Scope &) = delete;
+
+      private:
+        /** tracer */
+        Tracer * m_tracer;
+
+        /** name */
+        const char * m_name;
+
+        /** sequence number */
+        uint64_t m_id;
+
+        /** begin time */
+        uint64_t m_begin;
+    };
+
+    /**
+     * Record span of the current thread.
+     *
+     * @param[in] name name, must be a string literal
+     * @param[in] id sequence number
+     * @param[in] begin begin time in ns, see FileMetrics::now
+     * @param[in] end end time in ns
+     */
+    virtual void record(const char * name, const uint64_t id, const uint64_t begin, const uint64_t end);
+
+    /**
+     * Set name of the current thread in the trace.
+     *
+     * @param[in] name thread name
+     */
+    virtual void setThreadName(const std::string & name);
+
+    /**
+     * Get number of recorded spans.
+     *
+     * The spans are appended without synchronization, so this is only
+     * valid when the recording threads are finished, like write.
+     *
+     * @return span count
+     */
+    virtual std::size_t spanCount() const;
+
+    /**
+     * Get number of dropped spans.
+     *
+     * Only valid when the recording threads are finished, like write.
+     *
+     * @return span count
+     */
+    virtual std::size_t droppedSpanCount() const;
+
+    /**
+     * Remove all spans.
+     *
+     * Only allowed when the recording threads are finished, like write.
+     */
+    virtual void clear();
+
+    /**
+     * Write spans in Chrome trace event format.
+     *
+     * Only valid when the recording threads are finished.
+     *
+     * @param[in] filename file name
+     * @return true if the file was written
+     */
+    virtual bool write(const std::string & filename) const;
+
+  private:
+    /** buffer of one thread */
+    struct ThreadBuffer {
+        /** thread id in trace */
+        uint32_t tid {};
+
+        /** thread name */
+        std::string name {};
+
+        /** spans */
+        std::vector<Span> spans {};
+
+        /** dropped spans */
+        std::size_t droppedSpans {};
+    };
+
+    /** unique id, to identify the tracer in thread local caches */
+    uint64_t m_id;
+
+    /** spans per thread */
+    std::size_t m_maxSpansPerThread;
+
+    /** time of construction in ns, origin of the trace */
+    uint64_t m_origin;
+
+    /** mutex for m_threadBuffers */
+    mutable std::mutex m_mutex {};
+
+    /** thread buffers with their thread ids */
+    std::vector<std::pair<std::thread::id, std::unique_ptr<ThreadBuffer>>> m_threadBuffers {};
+
+    /**
+     * Get buffer of current thread, create it if it doesn't exist.
+     *
+     * @return thread buffer
+     */
+    ThreadBuffer & threadBuffer();
+};
+
+}
+}
+
+#ifdef OPTION_USE_TRACING
+#define VECTOR_BLF_TRACE_CONCAT2(a, b) a##b
+#define VECTOR_BLF_TRACE_CONCAT(a, b) VECTOR_BLF_TRACE_CONCAT2(a, b)
+/** record span until end of scope, tracer is a pointer */
+#define VECTOR_BLF_TRACE_SPAN(tracer, name, id) Vector::BLF::Tracer::Scope VECTOR_BLF_TRACE_CONCAT(traceSpan, __LINE__)((tracer), (name), (id))
+/** set name of current thread, tracer is a pointer */
+#define VECTOR_BLF_TRACE_THREAD_NAME(tracer, name) (tracer)->setThreadName(name)
+#else
+#define VECTOR_BLF_TRACE_SPAN(tracer, name, id)
+#define VECTOR_BLF_TRACE_THREAD_NAME(tracer, name)
+#endif
@@ -0,0 +1,308 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <Vector/BLF/TriggerRecorder.h>
+
+#include <chrono>
+#include <cstdio>
+
+#include <Vector/BLF/FileMetrics.h>
+
+namespace Vector {
+namespace BLF {
+
+namespace {
+
+/** interval in which the compression thread checks the post-trigger window */
+const std::chrono::milliseconds postTriggerCheckInterval(100);
+
+/** write-only AbstractFile appending to a block, to serialize objects */
+class BlockFile final : public AbstractFile {
+  public:
+    explicit BlockFile(std::vector<uint8_t> & data) :
+        m_data(data) {
+    }
+
+    std::streamsize gcount() const override {
+        return 0;
+    }
+
+    void read(char * /*s*/, std::streamsize /*n*/) override {
+    }
+
+    std::streampos tellg() override {
+        return 0;
+    }
+
+    void seekg(std::streamoff /*off*/, const std::ios_base::seekdir /*way*/) override {
+    }
+
+    void write(const char * s, std::streamsize n) override {
+        m_data.insert(m_data.end(), reinterpret_cast<const uint8_t *>(s), reinterpret_cast<const uint8_t *>(s) + n);
+    }
+
+    std::streampos tellp() override {
+        return static_cast<std::streamoff>(m_data.size());
+    }
+
+    bool good() const override {
+        return true;
+    }
+
+    bool eof() const override {
+        return false;
+    }
+
+  private:
+    /** data */
+    std::vector<uint8_t> & m_data;
+};
+
+}
+
+TriggerRecorder::~TriggerRecorder() {
+    close();
+}
+
+void TriggerRecorder::open() {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_running)
+        return;
+
+    /* reset */
+    m_block = Block();
+    m_block.data.reserve(defaultLogContainerSize);
+    m_pendingBlocks.clear();
+    m_triggerRequested = false;
+    m_ring.clear();
+    m_ringSize = 0;
+    m_triggerCount = 0;
+
+    /* start thread */
+    m_running = true;
+    m_thread = std::thread(&TriggerRecorder::compressionThread, this);
+}
+
+bool TriggerRecorder::is_open() const {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_running;
+}
+
+void TriggerRecorder::write(ObjectHeaderBase * ohb) {
+    if (ohb == nullptr)
+        return;
+    const bool isTrigger =
+        triggerOnObjects &&
+        ((ohb->objectType == ObjectType::TRIGGER_CONDITION) || (ohb->objectType == ObjectType::GLOBAL_MARKER));
+
+    {
+        /* mutex lock */
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_running) {
+            /* start new log container, if object doesn't fit anymore */
+            const uint32_t objectSize = ohb->calculateObjectSize();
+            if (!m_block.data.empty() && (m_block.data.size() + objectSize + objectSize % 4 > defaultLogContainerSize))
+                finishBlock();
+
+            /* serialize */
+            BlockFile blockFile(m_block.data);
+            ohb->write(blockFile);
+            m_block.objectCount++;
+
+            /* trigger */
+            if (isTrigger) {
+                m_triggerRequested = true;
+                m_condition.notify_one();
+            }
+        }
+    }
+
+    delete ohb;
+}
+
+void TriggerRecorder::trigger() {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!m_running)
+        return;
+    m_triggerRequested = true;
+    m_condition.notify_one();
+}
+
+void TriggerRecorder::close() {
+    {
+        /* mutex lock */
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (!m_running)
+            return;
+        finishBlock();
+        m_running = false;
+        m_condition.notify_one();
+    }
+
+    /* finalize thread */
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+uint32_t TriggerRecorder::triggerCount() const {
+    return m_triggerCount;
+}
+
+uint64_t TriggerRecorder::ringSize() const {
+    return m_ringSize;
+}
+
+void TriggerRecorder::finishBlock() {
+    if (m_block.data.empty())
+        return;
+    m_block.time = FileMetrics::now();
+    m_pendingBlocks.push_back(std::move(m_block));
+    m_block = Block();
+    m_block.data.reserve(defaultLogContainerSize);
+    m_condition.notify_one();
+}
+
+void TriggerRecorder::compressionThread() {
+    bool recording = false;
+
+    /* mutex lock */
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    for (;;) {
+        m_condition.wait_for(lock, postTriggerCheckInterval, [this] {
+            return !m_pendingBlocks.empty() || m_triggerRequested || !m_running;
+        });
+
+        /* the block of the producer completes a finished post-trigger window */
+        const bool postTriggerOver = recording && (FileMetrics::now() >= m_postTriggerEnd);
+        if (postTriggerOver)
+            finishBlock();
+
+        /* take over work */
+        std::deque<Block> blocks;
+        blocks.swap(m_pendingBlocks);
+        const bool triggerRequested = m_triggerRequested;
+        m_triggerRequested = false;
+        const bool running = m_running;
+        lock.unlock();
+
+        /* compress into ring or file */
+        for (Block & block : blocks) {
+            const Container container = compress(block);
+            if (recording)
+                writeFile(container);
+            else {
+                m_ring.push_back(container);
+                m_ringSize += container.logContainer->calculateObjectSize();
+            }
+        }
+        if (!recording)
+            trimRing();
+
+        /* trigger */
+        if (triggerRequested) {
+            if (!recording) {
+                openFile();
+                recording = m_file.is_open();
+            }
+            m_postTriggerEnd = FileMetrics::now() + postTriggerTime * UINT64_C(1000000);
+        }
+
+        /* post-trigger window finished */
+        if (recording && ((postTriggerOver && (FileMetrics::now() >= m_postTriggerEnd)) || !running)) {
+            closeFile();
+            recording = false;
+        }
+
+        lock.lock();
+        if (!running && m_pendingBlocks.empty())
+            break;
+    }
+
+    /* ring is not needed anymore */
+    m_ring.clear();
+    m_ringSize = 0;
+}
+
+TriggerRecorder::Container TriggerRecorder::compress(Block & block) const {
+    Container container;
+    container.logContainer = std::make_shared<LogContainer>();
+    container.logContainer->uncompressedFileSize = static_cast<uint32_t>(block.data.size());
+    container.logContainer->uncompressedFile = std::move(block.data);
+    container.logContainer->compress((compressionLevel == 0) ? 0 : 2, compressionLevel);
+
+    /* keep compressed data only */
+    container.logContainer->uncompressedFile.clear();
+    container.logContainer->uncompressedFile.shrink_to_fit();
+
+    container.objectCount = block.objectCount;
+    container.time = block.time;
+    return container;
+}
+
+void TriggerRecorder::trimRing() {
+    const uint64_t now = FileMetrics::now();
+    while (!m_ring.empty()) {
+        const bool sizeExceeded = (preTriggerSize > 0) && (m_ringSize > preTriggerSize);
+        const bool timeExceeded = (preTriggerTime > 0) && (now - m_ring.front().time > preTriggerTime * UINT64_C(1000000));
+        if (!sizeExceeded && !timeExceeded)
+            break;
+        m_ringSize -= m_ring.front().logContainer->calculateObjectSize();
+        m_ring.pop_front();
+    }
+}
+
+void TriggerRecorder::openFile() {
+    /* create file */
+    char number[16];
+    std::snprintf(number, sizeof(number), "%04u", static_cast<unsigned int>(m_triggerCount + 1));
+    const std::string filename = filenamePrefix + number + ".blf";
+    m_file.open(filename.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    if (!m_file.is_open())
+        return;
+    m_triggerCount++;
+
+    /* write file statistics, which are completed at close */
+    m_fileStatistics = fileStatistics;
+    m_fileStatistics.fileSize = 0;
+    m_fileStatistics.uncompressedFileSize = m_fileStatistics.statisticsSize;
+    m_fileStatistics.objectCount = 0;
+    m_fileStatistics.restorePointsOffset = 0;
+    m_fileStatistics.write(m_file);
+
+    /* pre-trigger data */
+    for (const Container & container : m_ring)
+        writeFile(container);
+    m_ring.clear();
+    m_ringSize = 0;
+}
+
+void TriggerRecorder::writeFile(const Container & container) {
+    /* log container passthrough */
+    container.logContainer->write(m_file);
+
+    /* statistics */
+    m_fileStatistics.uncompressedFileSize +=
+        container.logContainer->internalHeaderSize() +
+        container.logContainer->uncompressedFileSize;
+    m_fileStatistics.objectCount += container.objectCount;
+}
+
+void TriggerRecorder::closeFile() {
+    m_fileStatistics.fileSize = static_cast<uint64_t>(m_file.tellp());
+    m_file.seekp(0);
+    m_fileStatistics.write(m_file);
+    m_file.close();
+}
+
+}
+}
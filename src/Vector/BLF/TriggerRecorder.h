@@ -0,0 +1,245 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <Vector/BLF/platform.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Vector/BLF/CompressedFile.h>
+#include <Vector/BLF/FileStatistics.h>
+#include <Vector/BLF/LogContainer.h>
+#include <Vector/BLF/ObjectHeaderBase.h>
+
+#include <Vector/BLF/vector_blf_export.h>
+
+namespace Vector {
+namespace BLF {
+
+/**
+ * Pre/post-trigger recorder
+ *
+ * Objects are recorded continuously, but only the data around triggers is
+ * written into files. The objects are serialized into log containers, which
+ * are compressed by a background thread and kept in a memory ring. The ring
+ * is limited by preTriggerTime and/or preTriggerSize, so it holds compressed
+ * data only.
+ *
+ * On a trigger, either by calling trigger() or by writing a TriggerCondition
+ * or GlobalMarker object, a new file is created. It gets the log containers
+ * of the ring as they are, followed by the log containers of the
+ * postTriggerTime. A trigger within the post-trigger window extends it.
+ *
+ * Log containers always end at object boundaries, so the oldest log
+ * container can be dropped from the ring without breaking an object.
+ *
+ * The producer only serializes the object under a short lock and never
+ * waits for compression or file output.
+ */
+class VECTOR_BLF_EXPORT TriggerRecorder final {
+  public:
+    TriggerRecorder() = default;
+    virtual ~TriggerRecorder();
+    TriggerRecorder(const TriggerRecorder &) = delete;
+    TriggerRecorder & operator=(const TriggerRecorder &) = delete;
+
+    /**
+     * Template for the FileStatistics of the written files
+     *
+     * Application and measurement start time are taken over, sizes and
+     * counts are set by the recorder.
+     */
+    FileStatistics fileStatistics {};
+
+    /**
+     * Written files are named filenamePrefix + trigger number + ".blf"
+     *
+     * The trigger number has four digits and starts at 1.
+     */
+    std::string filenamePrefix {};
+
+    /** time in ms kept in the ring before a trigger, 0 for unlimited */
+    uint32_t preTriggerTime {10000};
+
+    /** compressed bytes kept in the ring before a trigger, 0 for unlimited */
+    uint64_t preTriggerSize {};
+
+    /** time in ms recorded after a trigger */
+    uint32_t postTriggerTime {10000};
+
+    /** trigger on TriggerCondition and GlobalMarker objects */
+    bool triggerOnObjects {true};
+
+    /** @see File::compressionLevel */
+    int compressionLevel {6};
+
+    /** uncompressed size of log containers */
+    uint32_t defaultLogContainerSize {0x20000};
+
+    /**
+     * Start recording.
+     */
+    virtual void open();
+
+    /**
+     * is recording?
+     *
+     * @return true if recording
+     */
+    virtual bool is_open() const;
+
+    /**
+     * Record object.
+     *
+     * Ownership is taken over from the user to the library.
+     *
+     * @param[in] ohb object
+     */
+    virtual void write(ObjectHeaderBase * ohb);
+
+    /**
+     * Trigger, so that the ring and the post-trigger window are written into a file.
+     */
+    virtual void trigger();
+
+    /**
+     * Stop recording.
+     *
+     * A running post-trigger window is cut short and its file is finished.
+     */
+    virtual void close();
+
+    /**
+     * Get number of files written or being written.
+     *
+     * @return trigger count
+     */
+    virtual uint32_t triggerCount() const;
+
+    /**
+     * Get compressed size of the ring.
+     *
+     * @return size in bytes
+     */
+    virtual uint64_t ringSize() const;
+
+  private:
+    /** serialized objects of a log container */
+    struct Block {
+        /** uncompressed data */
+        std::vector<uint8_t> data;
+
+        /** number of objects */
+        uint32_t objectCount;
+
+        /** time of the last object in ns */
+        uint64_t time;
+    };
+
+    /** compressed log container */
+    struct Container {
+        /** log container */
+        std::shared_ptr<LogContainer> logContainer;
+
+        /** number of objects */
+        uint32_t objectCount;
+
+        /** time of the last object in ns */
+        uint64_t time;
+    };
+
+    /** mutex for producer data */
+    mutable std::mutex m_mutex {};
+
+    /** blocks pending or trigger received */
+    std::condition_variable m_condition {};
+
+    /** log container being filled by the producer */
+    Block m_block {};
+
+    /** blocks to compress */
+    std::deque<Block> m_pendingBlocks {};
+
+    /** trigger received */
+    bool m_triggerRequested {};
+
+    /** thread still running */
+    bool m_running {};
+
+    /** thread compressing blocks and writing files */
+    std::thread m_thread {};
+
+    /** number of triggered files */
+    std::atomic<uint32_t> m_triggerCount {};
+
+    /* compression thread only */
+
+    /** ring of compressed log containers */
+    std::deque<Container> m_ring {};
+
+    /** compressed size of the ring */
+    std::atomic<uint64_t> m_ringSize {};
+
+    /** file being written */
+    CompressedFile m_file {};
+
+    /** statistics of file being written */
+    FileStatistics m_fileStatistics {};
+
+    /** end of post-trigger window in ns */
+    uint64_t m_postTriggerEnd {};
+
+    /**
+     * Move the block of the producer to the pending blocks.
+     *
+     * Mutex must be locked.
+     */
+    void finishBlock();
+
+    /**
+     * Compress blocks and write files.
+     */
+    void compressionThread();
+
+    /**
+     * Compress block into log container.
+     *
+     * @param[in] block block
+     * @return log container
+     */
+    Container compress(Block & block) const;
+
+    /**
+     * Drop log containers from the ring, which are out of the pre-trigger window.
+     */
+    void trimRing();
+
+    /**
+     * Create file and write the ring into it.
+     */
+    void openFile();
+
+    /**
+     * Write log container into file.
+     *
+     * @param[in] container log container
+     */
+    void writeFile(const Container & container);
+
+    /**
+     * Write file statistics and close file.
+     */
+    void closeFile();
+};
+
+}
+}
@@ -7,6 +7,7 @@
 #undef DEBUG_WRITE_LOG_CONTAINERS_TO_DISK
 
 #include <algorithm>
+#include <chrono>
 #include <cstring>
 #ifdef DEBUG_WRITE_LOG_CONTAINERS_TO_DISK
 #include <fstream>
@@ -33,12 +34,19 @@ void UncompressedFile::read(char * s, std::streamsize n) {
     std::unique_lock<std::mutex> lock(m_mutex);
 
     /* wait until there is sufficient data */
-    tellpChanged.wait(lock, [&] {
+    auto dataAvailable = [&] {
         return
         m_abort ||
         (n + m_tellg <= m_tellp) ||
         (n + m_tellg > m_fileSize);
-    });
+    };
+    if (!dataAvailable()) {
+        VECTOR_BLF_TRACE_SPAN(m_tracer, "wait data", static_cast<uint64_t>(m_tellg));
+        const uint64_t waitBegin = m_metrics ? FileMetrics::now() : 0;
+        tellpChanged.wait(lock, dataAvailable);
+        if (m_metrics)
+            FileMetrics::add(m_metrics->uncompressedFileReadWaitTime, FileMetrics::now() - waitBegin);
+    }
 
     /* handle read behind eof */
     if (n + m_tellg > m_fileSize) {
@@ -105,11 +113,18 @@ void UncompressedFile::write(const char * s, std::streamsize n) {
     std::unique_lock<std::mutex> lock(m_mutex);
 
     /* wait for free space */
-    tellgChanged.wait(lock, [&] {
+    auto spaceAvailable = [&] {
         return
         m_abort ||
         ((m_tellp - m_tellg) < m_bufferSize);
-    });
+    };
+    if (!spaceAvailable()) {
+        VECTOR_BLF_TRACE_SPAN(m_tracer, "wait space", static_cast<uint64_t>(m_tellp));
+        const uint64_t waitBegin = m_metrics ? FileMetrics::now() : 0;
+        tellgChanged.wait(lock, spaceAvailable);
+        if (m_metrics)
+            FileMetrics::add(m_metrics->uncompressedFileWriteWaitTime, FileMetrics::now() - waitBegin);
+    }
 
     /* write data */
     while (n > 0) {
@@ -128,6 +143,8 @@ void UncompressedFile::write(const char * s, std::streamsize n) {
                     m_data.back()->filePosition;
             }
             m_data.push_back(logContainer);
+            if (m_metrics)
+                FileMetrics::max(m_metrics->peakLogContainerCount, m_data.size());
         }
 
         /* offset to write */
@@ -198,14 +215,23 @@ void UncompressedFile::write(const std::shared_ptr<LogContainer> & logContainer)
     std::unique_lock<std::mutex> lock(m_mutex);
 
     /* wait for free space */
-    tellgChanged.wait(lock, [&] {
+    auto spaceAvailable = [&] {
         return
         m_abort ||
         static_cast<uint32_t>(m_tellp - m_tellg) < m_bufferSize;
-    });
+    };
+    if (!spaceAvailable()) {
+        VECTOR_BLF_TRACE_SPAN(m_tracer, "wait space", static_cast<uint64_t>(m_tellp));
+        const uint64_t waitBegin = m_metrics ? FileMetrics::now() : 0;
+        tellgChanged.wait(lock, spaceAvailable);
+        if (m_metrics)
+            FileMetrics::add(m_metrics->uncompressedFileWriteWaitTime, FileMetrics::now() - waitBegin);
+    }
 
     /* append logContainer */
     m_data.push_back(logContainer);
+    if (m_metrics)
+        FileMetrics::max(m_metrics->peakLogContainerCount, m_data.size());
     logContainer->filePosition = m_tellp;
 
 #ifdef DEBUG_WRITE_LOG_CONTAINERS_TO_DISK
@@ -225,18 +251,49 @@ void UncompressedFile::nextLogContainer() {
     /* mutex lock */
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    /* find starting log container */
-    std::shared_ptr<LogContainer> logContainer = logContainerContaining(m_tellp);
-    if (logContainer) {
-        /* offset to write */
-        std::streamoff offset = m_tellp - logContainer->filePosition;
+    closeLogContainer();
 
-        /* resize logContainer, if it's not already a newly created one */
-        if (offset > 0) {
-            logContainer->uncompressedFile.resize(offset);
-            logContainer->uncompressedFileSize = offset;
+    /* notify */
+    tellpChanged.notify_all();
+}
+
+std::streamsize UncompressedFile::waitLogContainer() {
+    /* mutex lock */
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    /* wait until the log container is complete */
+    auto logContainerComplete = [&] {
+        if (m_abort || (m_tellp >= m_fileSize))
+            return true;
+        std::shared_ptr<LogContainer> logContainer = logContainerContaining(m_tellg);
+        return
+        logContainer &&
+        (m_tellp >= logContainer->filePosition + static_cast<std::streamoff>(logContainer->uncompressedFileSize));
+    };
+    if (!logContainerComplete()) {
+        VECTOR_BLF_TRACE_SPAN(m_tracer, "wait log container", static_cast<uint64_t>(m_tellg));
+        const uint64_t waitBegin = m_metrics ? FileMetrics::now() : 0;
+        while (!logContainerComplete()) {
+            /* with data, wait for the log container to fill up within max latency */
+            if ((m_maxLatency > 0) && (m_tellp > m_tellg)) {
+                if (!tellpChanged.wait_for(lock, std::chrono::milliseconds(m_maxLatency), logContainerComplete))
+                    closeLogContainer();
+                break;
+            }
+            tellpChanged.wait(lock);
         }
+        if (m_metrics)
+            FileMetrics::add(m_metrics->uncompressedFileReadWaitTime, FileMetrics::now() - waitBegin);
     }
+
+    /* size up to the end of the log container, or beyond eof to hit it */
+    std::shared_ptr<LogContainer> logContainer = logContainerContaining(m_tellg);
+    if (logContainer) {
+        const std::streampos end = logContainer->filePosition + static_cast<std::streamoff>(logContainer->uncompressedFileSize);
+        if ((end <= m_tellp) && (end <= m_fileSize))
+            return end - m_tellg;
+    }
+    return m_defaultLogContainerSize;
 }
 
 std::streamsize UncompressedFile::fileSize() const {
@@ -302,6 +359,37 @@ void UncompressedFile::setDefaultLogContainerSize(uint32_t defaultLogContainerSi
     m_defaultLogContainerSize = defaultLogContainerSize;
 }
 
+uint32_t UncompressedFile::maxLatency() const {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_maxLatency;
+}
+
+void UncompressedFile::setMaxLatency(uint32_t maxLatency) {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_maxLatency = maxLatency;
+
+    /* notify */
+    tellpChanged.notify_all();
+}
+
+void UncompressedFile::setMetrics(FileMetrics * metrics) {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_metrics = metrics;
+}
+
+void UncompressedFile::setTracer(Tracer * tracer) {
+    /* mutex lock */
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_tracer = tracer;
+}
+
 std::shared_ptr<LogContainer> UncompressedFile::logContainerContaining(const std::streampos pos) const {
     /* find logContainer that contains file position */
     std::list<std::shared_ptr<LogContainer>>::const_iterator result = std::find_if(m_data.cbegin(), m_data.cend(), [&pos](std::shared_ptr<LogContainer> logContainer) {
@@ -319,5 +407,20 @@ std::shared_ptr<LogContainer> UncompressedFile::logContainerContaining(const std
     return nullptr;
 }
 
+void UncompressedFile::closeLogContainer() {
+    /* find starting log container */
+    std::shared_ptr<LogContainer> logContainer = logContainerContaining(m_tellp);
+    if (logContainer) {
+        /* offset to write */
+        std::streamoff offset = m_tellp - logContainer->filePosition;
+
+        /* resize logContainer, if it's not already a newly created one */
+        if (offset > 0) {
+            logContainer->uncompressedFile.resize(offset);
+            logContainer->uncompressedFileSize = offset;
+        }
+    }
+}
+
 }
 }
@@ -13,7 +13,9 @@
 #include <mutex>
 
 #include <Vector/BLF/AbstractFile.h>
+#include <Vector/BLF/FileMetrics.h>
 #include <Vector/BLF/LogContainer.h>
+#include <Vector/BLF/Tracer.h>
 
 #include <Vector/BLF/vector_blf_export.h>
 
@@ -64,6 +66,17 @@ class VECTOR_BLF_EXPORT UncompressedFile final : public AbstractFile {
      */
     virtual void nextLogContainer();
 
+    /**
+     * Wait until the log container at the get position is complete.
+     *
+     * A log container is complete, if it's filled up, closed by
+     * nextLogContainer, or end-of-file is reached. With a max latency, a
+     * log container holding data for longer than that is closed as well.
+     *
+     * @return size to read up to the end of the log container
+     */
+    virtual std::streamsize waitLogContainer();
+
     /**
      * Return current file size resp. end-of-file position.
      *
@@ -105,6 +118,35 @@ class VECTOR_BLF_EXPORT UncompressedFile final : public AbstractFile {
      */
     virtual void setDefaultLogContainerSize(uint32_t defaultLogContainerSize);
 
+    /**
+     * Get max latency.
+     *
+     * @return max latency in ms
+     */
+    virtual uint32_t maxLatency() const;
+
+    /**
+     * Set max latency, after which waitLogContainer closes a partially
+     * filled log container.
+     *
+     * @param[in] maxLatency max latency in ms, 0 to disable
+     */
+    virtual void setMaxLatency(uint32_t maxLatency);
+
+    /**
+     * Set metrics, which receive the wait times and the peak log container count.
+     *
+     * @param[in] metrics metrics or nullptr
+     */
+    virtual void setMetrics(FileMetrics * metrics);
+
+    /**
+     * Set tracer, which receives the wait spans.
+     *
+     * @param[in] tracer tracer or nullptr
+     */
+    virtual void setTracer(Tracer * tracer);
+
     /** tellg was changed (after read or seekg) */
     std::condition_variable tellgChanged;
 
@@ -142,6 +184,15 @@ class VECTOR_BLF_EXPORT UncompressedFile final : public AbstractFile {
     /** default log container size */
     uint32_t m_defaultLogContainerSize {0x20000};
 
+    /** max latency in ms */
+    uint32_t m_maxLatency {};
+
+    /** metrics */
+    FileMetrics * m_metrics {};
+
+    /** tracer */
+    Tracer * m_tracer {};
+
     /**
      * Returns the file container, which contains pos.
      *
@@ -153,6 +204,13 @@ class VECTOR_BLF_EXPORT UncompressedFile final : public AbstractFile {
      * @return log container or nullptr
      */
     std::shared_ptr<LogContainer> logContainerContaining(const std::streampos pos) const;
+
+    /**
+     * Close the current logContainer.
+     *
+     * Mutex must be locked.
+     */
+    void closeLogContainer();
 };
 
 }
@@ -0,0 +1,332 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+ * Crawl a directory tree and write a catalog of all BLF files.
+ *
+ * Each file is only probed (FileStatistics and leading AppText objects),
+ * no log containers besides the first one are inflated. The directory is
+ * crawled by one thread, while a pool of threads probes the files, so
+ * the catalog is written in order of completion.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#include <Vector/BLF.h>
+
+/** output format */
+enum class Format {
+    Csv,
+    Json
+};
+
+/** bounded queue of file names from crawler to probe threads */
+class PathQueue {
+  public:
+    /** enqueue, wait while the queue is full */
+    void push(std::string path) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this] {
+            return m_queue.size() < 4096;
+        });
+        m_queue.push(std::move(path));
+        m_notEmpty.notify_one();
+    }
+
+    /** dequeue, return false if queue is closed and empty */
+    bool pop(std::string & path) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this] {
+            return m_closed || !m_queue.empty();
+        });
+        if (m_queue.empty())
+            return false;
+        path = std::move(m_queue.front());
+        m_queue.pop();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    /** no further paths */
+    void close() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_notEmpty.notify_all();
+    }
+
+  private:
+    std::mutex m_mutex {};
+    std::condition_variable m_notEmpty {};
+    std::condition_variable m_notFull {};
+    std::queue<std::string> m_queue {};
+    bool m_closed {false};
+};
+
+/** file name ends with .blf (case insensitive) */
+bool isBlf(const std::string & name) {
+    if (name.size() < 4)
+        return false;
+    std::string extension = name.substr(name.size() - 4);
+    for (char & c : extension)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return extension == ".blf";
+}
+
+/** crawl directory tree recursively */
+void crawl(const std::string & directory, PathQueue & pathQueue) {
+#if defined(_WIN32)
+    WIN32_FIND_DATAA findData;
+    HANDLE handle = FindFirstFileA((directory + "\\*").c_str(), &findData);
+    if (handle == INVALID_HANDLE_VALUE)
+        return;
+    do {
+        const std::string name = findData.cFileName;
+        if ((name == ".") || (name == ".."))
+            continue;
+        const std::string path = directory + "\\" + name;
+        if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+            crawl(path, pathQueue);
+        else if (isBlf(name))
+            pathQueue.push(path);
+    } while (FindNextFileA(handle, &findData));
+    FindClose(handle);
+#else
+    DIR * dir = opendir(directory.c_str());
+    if (dir == nullptr)
+        return;
+    while (struct dirent * entry = readdir(dir)) {
+        const std::string name = entry->d_name;
+        if ((name == ".") || (name == ".."))
+            continue;
+        const std::string path = directory + "/" + name;
+        bool isDirectory = false;
+        bool isRegular = false;
+#if defined(_DIRENT_HAVE_D_TYPE)
+        isDirectory = (entry->d_type == DT_DIR);
+        isRegular = (entry->d_type == DT_REG);
+        if (entry->d_type == DT_UNKNOWN)
+#endif
+        {
+            struct stat st;
+            if (lstat(path.c_str(), &st) == 0) {
+                isDirectory = S_ISDIR(st.st_mode);
+                isRegular = S_ISREG(st.st_mode);
+            }
+        }
+        if (isDirectory)
+            crawl(path, pathQueue);
+        else if (isRegular && isBlf(name))
+            pathQueue.push(path);
+    }
+    closedir(dir);
+#endif
+}
+
+/** format system time as ISO 8601 */
+std::string isoTime(const Vector::BLF::SYSTEMTIME & time) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%04u-%02u-%02uT%02u:%02u:%02u.%03u",
+                  time.year, time.month, time.day,
+                  time.hour, time.minute, time.second, time.milliseconds);
+    return buffer;
+}
+
+/** quote CSV field */
+std::string csv(const std::string & text) {
+    std::string result = "\"";
+    for (const char c : text) {
+        if (c == '"')
+            result += '"';
+        result += c;
+    }
+    return result + '"';
+}
+
+/** quote JSON string */
+std::string json(const std::string & text) {
+    std::string result = "\"";
+    for (const char c : text) {
+        switch (c) {
+        case '"':
+            result += "\\\"";
+            break;
+        case '\\':
+            result += "\\\\";
+            break;
+        case '\n':
+            result += "\\n";
+            break;
+        case '\r':
+            result += "\\r";
+            break;
+        case '\t':
+            result += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned int>(c));
+                result += buffer;
+            } else
+                result += c;
+            break;
+        }
+    }
+    return result + '"';
+}
+
+/** catalog line of a file */
+std::string catalogLine(const std::string & path, const Format format, const bool withMetaData) {
+    Vector::BLF::FileStatistics fileStatistics;
+    std::vector<Vector::BLF::AppText> appTexts;
+    const bool valid = Vector::BLF::File::probe(path, fileStatistics, withMetaData ? &appTexts : nullptr);
+
+    /* collect metadata */
+    std::string dbChannelInfo;
+    std::string metaData;
+    for (const Vector::BLF::AppText & appText : appTexts) {
+        if (appText.source == Vector::BLF::AppText::Source::DbChannelInfo) {
+            if (!dbChannelInfo.empty())
+                dbChannelInfo += '|';
+            dbChannelInfo += std::to_string((appText.reservedAppText1 >> 8) & 0xff) + ":" + appText.text;
+        } else if (appText.source == Vector::BLF::AppText::Source::MetaData)
+            metaData += appText.text;
+    }
+
+    const std::string application =
+        std::to_string(fileStatistics.applicationMajor) + "." +
+        std::to_string(fileStatistics.applicationMinor) + "." +
+        std::to_string(fileStatistics.applicationBuild);
+    std::ostringstream os;
+    if (format == Format::Csv) {
+        os << csv(path) << ',' << (valid ? 1 : 0);
+        if (valid) {
+            os << ',' << static_cast<uint16_t>(fileStatistics.applicationId)
+               << ',' << application
+               << ',' << fileStatistics.fileSize
+               << ',' << fileStatistics.uncompressedFileSize
+               << ',' << fileStatistics.objectCount
+               << ',' << isoTime(fileStatistics.measurementStartTime)
+               << ',' << isoTime(fileStatistics.lastObjectTime);
+            if (withMetaData)
+                os << ',' << csv(dbChannelInfo) << ',' << csv(metaData);
+        }
+    } else {
+        os << "{\"path\":" << json(path) << ",\"valid\":" << (valid ? "true" : "false");
+        if (valid) {
+            os << ",\"applicationId\":" << static_cast<uint16_t>(fileStatistics.applicationId)
+               << ",\"application\":" << json(application)
+               << ",\"fileSize\":" << fileStatistics.fileSize
+               << ",\"uncompressedFileSize\":" << fileStatistics.uncompressedFileSize
+               << ",\"objectCount\":" << fileStatistics.objectCount
+               << ",\"measurementStartTime\":" << json(isoTime(fileStatistics.measurementStartTime))
+               << ",\"lastObjectTime\":" << json(isoTime(fileStatistics.lastObjectTime));
+            if (withMetaData)
+                os << ",\"dbChannelInfo\":" << json(dbChannelInfo) << ",\"metaData\":" << json(metaData);
+        }
+        os << '}';
+    }
+    os << '\n';
+    return os.str();
+}
+
+void usage() {
+    std::cout << "Usage: vector-blf-catalog [-j threads] [-f csv|json] [-m] <directory> [<catalog file>]" << std::endl;
+    std::cout << "  -j  number of probe threads (default: hardware concurrency)" << std::endl;
+    std::cout << "  -f  output format, CSV or JSON lines (default: csv)" << std::endl;
+    std::cout << "  -m  include DbChannelInfo and MetaData of the first log container" << std::endl;
+}
+
+int main(int argc, char * argv[]) {
+    /* arguments */
+    unsigned int threadCount = std::max(std::thread::hardware_concurrency(), 1U);
+    Format format = Format::Csv;
+    bool withMetaData = false;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if ((arg == "-j") && (i + 1 < argc))
+            threadCount = std::max(static_cast<unsigned int>(std::stoul(argv[++i])), 1U);
+        else if ((arg == "-f") && (i + 1 < argc)) {
+            const std::string value = argv[++i];
+            if (value == "csv")
+                format = Format::Csv;
+            else if (value == "json")
+                format = Format::Json;
+            else {
+                usage();
+                return 1;
+            }
+        } else if (arg == "-m")
+            withMetaData = true;
+        else
+            positional.push_back(arg);
+    }
+    if ((positional.size() < 1) || (positional.size() > 2)) {
+        usage();
+        return 1;
+    }
+
+    /* output */
+    std::ofstream ofs;
+    if (positional.size() == 2) {
+        ofs.open(positional[1], std::ios_base::out | std::ios_base::trunc);
+        if (!ofs.is_open()) {
+            std::cerr << "Unable to open " << positional[1] << std::endl;
+            return 1;
+        }
+    }
+    std::ostream & os = ofs.is_open() ? ofs : std::cout;
+    if (format == Format::Csv) {
+        os << "path,valid,applicationId,application,fileSize,uncompressedFileSize,objectCount,measurementStartTime,lastObjectTime";
+        if (withMetaData)
+            os << ",dbChannelInfo,metaData";
+        os << '\n';
+    }
+
+    /* probe threads */
+    PathQueue pathQueue;
+    std::mutex outputMutex;
+    std::atomic<uint64_t> fileCount {0};
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < threadCount; ++i) {
+        threads.emplace_back([&]() {
+            std::string path;
+            while (pathQueue.pop(path)) {
+                const std::string line = catalogLine(path, format, withMetaData);
+                std::lock_guard<std::mutex> lock(outputMutex);
+                os << line;
+                fileCount++;
+            }
+        });
+    }
+
+    /* crawl */
+    crawl(positional[0], pathQueue);
+    pathQueue.close();
+    for (std::thread & thread : threads)
+        thread.join();
+
+    std::cerr << fileCount << " files cataloged" << std::endl;
+    return 0;
+}
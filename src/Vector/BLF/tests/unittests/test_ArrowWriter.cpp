@@ -0,0 +1,391 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE ArrowWriter
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include <Vector/BLF.h>
+
+/** read whole file */
+std::vector<char> readFile(const std::string & filename) {
+    std::ifstream is(filename, std::ios_base::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+}
+
+/** check Arrow file framing */
+void checkArrowFile(const std::string & filename) {
+    std::vector<char> data = readFile(filename);
+    BOOST_REQUIRE_GT(data.size(), 8 + 6 + 4);
+    BOOST_CHECK(std::string(data.begin(), data.begin() + 6) == "ARROW1");
+    BOOST_CHECK(std::string(data.end() - 6, data.end()) == "ARROW1");
+    int32_t footerSize;
+    std::memcpy(&footerSize, data.data() + data.size() - 10, sizeof(footerSize));
+    BOOST_CHECK_GT(footerSize, 0);
+    BOOST_CHECK_EQUAL(footerSize % 8, 0);
+    BOOST_CHECK_LT(static_cast<std::size_t>(footerSize), data.size());
+
+    /* end of stream marker directly in front of footer */
+    const char * eos = data.data() + data.size() - 10 - footerSize - 8;
+    uint32_t marker[2];
+    std::memcpy(marker, eos, sizeof(marker));
+    BOOST_CHECK_EQUAL(marker[0], 0xffffffff);
+    BOOST_CHECK_EQUAL(marker[1], 0);
+}
+
+/** minimal flatbuffer reader */
+class FlatBuffer final {
+  public:
+    FlatBuffer(const char * data, const std::size_t size) :
+        m_data(data),
+        m_size(size) {
+    }
+
+    /** scalar at position */
+    template<typename T>
+    T scalar(const std::size_t position) const {
+        BOOST_REQUIRE_LE(position + sizeof(T), m_size);
+        T value;
+        std::memcpy(&value, m_data + position, sizeof(T));
+        return value;
+    }
+
+    /** root table */
+    std::size_t root() const {
+        return scalar<uint32_t>(0);
+    }
+
+    /** position of a table field (0 if absent) */
+    std::size_t field(const std::size_t table, const uint16_t id) const {
+        const std::size_t vtable = static_cast<std::size_t>(static_cast<int64_t>(table) - scalar<int32_t>(table));
+        if (4U + 2U * id >= scalar<uint16_t>(vtable))
+            return 0;
+        const uint16_t offset = scalar<uint16_t>(vtable + 4 + 2 * id);
+        return (offset == 0) ? 0 : table + offset;
+    }
+
+    /** scalar table field */
+    template<typename T>
+    T get(const std::size_t table, const uint16_t id, const T defaultValue) const {
+        const std::size_t position = field(table, id);
+        return (position == 0) ? defaultValue : scalar<T>(position);
+    }
+
+    /** referenced table, vector or string */
+    std::size_t offset(const std::size_t table, const uint16_t id) const {
+        const std::size_t position = field(table, id);
+        BOOST_REQUIRE_NE(position, 0);
+        return position + scalar<uint32_t>(position);
+    }
+
+    /** table in vector of tables */
+    std::size_t element(const std::size_t vector, const std::size_t index) const {
+        const std::size_t position = vector + 4 + 4 * index;
+        return position + scalar<uint32_t>(position);
+    }
+
+    /** string field */
+    std::string string(const std::size_t table, const uint16_t id) const {
+        const std::size_t position = offset(table, id);
+        const uint32_t length = scalar<uint32_t>(position);
+        BOOST_REQUIRE_LE(position + 4 + length, m_size);
+        return std::string(m_data + position + 4, length);
+    }
+
+  private:
+    /** data */
+    const char * m_data;
+
+    /** size */
+    std::size_t m_size;
+};
+
+/** decoded Arrow file, values are kept as raw bytes */
+struct ArrowTable {
+    /** field names */
+    std::vector<std::string> names {};
+
+    /** field type ids */
+    std::vector<uint8_t> types {};
+
+    /** dictionary ids (-1 if not dictionary encoded) */
+    std::vector<int64_t> dictionaryIds {};
+
+    /** values per column */
+    std::vector<std::vector<std::string>> columns {};
+
+    /** values per dictionary */
+    std::map<int64_t, std::vector<std::string>> dictionaries {};
+
+    /** delta flags of the dictionary batches */
+    std::vector<bool> dictionaryDeltas {};
+
+    /** record batch lengths */
+    std::vector<int64_t> batchLengths {};
+
+    /** value of a fixed width cell */
+    template<typename T>
+    static T value(const std::string & cell) {
+        BOOST_REQUIRE_EQUAL(cell.size(), sizeof(T));
+        T value;
+        std::memcpy(&value, cell.data(), sizeof(T));
+        return value;
+    }
+
+    /** dictionary value of a cell */
+    const std::string & dictionaryValue(const std::size_t column, const std::size_t row) const {
+        const std::vector<std::string> & dictionary = dictionaries.at(dictionaryIds[column]);
+        const int32_t index = value<int32_t>(columns[column][row]);
+        BOOST_REQUIRE_LT(static_cast<std::size_t>(index), dictionary.size());
+        return dictionary[static_cast<std::size_t>(index)];
+    }
+};
+
+/** value layout: variable size (0) or fixed width in bytes */
+std::size_t valueWidth(const FlatBuffer & fb, const uint8_t type, const std::size_t typeTable) {
+    switch (type) {
+    case 2: // Int
+        return static_cast<std::size_t>(fb.get<int32_t>(typeTable, 0, 0) / 8);
+    case 3: // FloatingPoint
+        BOOST_REQUIRE_EQUAL(fb.get<int16_t>(typeTable, 0, 0), 2); // DOUBLE
+        return 8;
+    case 10: // Timestamp
+        return 8;
+    default: // Binary, Utf8
+        return 0;
+    }
+}
+
+/** decode the columns of a record batch */
+int64_t decodeRecordBatch(const FlatBuffer & fb, const std::size_t recordBatch, const char * body, const std::vector<std::size_t> & widths, std::vector<std::vector<std::string>> & columns) {
+    const int64_t length = fb.get<int64_t>(recordBatch, 0, 0);
+    const std::size_t nodes = fb.offset(recordBatch, 1);
+    const std::size_t buffers = fb.offset(recordBatch, 2);
+    BOOST_REQUIRE_EQUAL(fb.scalar<uint32_t>(nodes), widths.size());
+    std::size_t buffer = 0;
+    auto nextBuffer = [&fb, &buffers, &buffer, body](std::size_t & size) {
+        const std::size_t position = buffers + 4 + 16 * buffer++;
+        size = static_cast<std::size_t>(fb.scalar<int64_t>(position + 8));
+        return body + fb.scalar<int64_t>(position);
+    };
+    for (std::size_t column = 0; column < widths.size(); ++column) {
+        BOOST_REQUIRE_EQUAL(fb.scalar<int64_t>(nodes + 4 + 16 * column), length);
+        BOOST_CHECK_EQUAL(fb.scalar<int64_t>(nodes + 4 + 16 * column + 8), 0); // null count
+        std::size_t size;
+        nextBuffer(size); // validity
+        if (widths[column] == 0) {
+            const char * offsets = nextBuffer(size);
+            BOOST_REQUIRE_EQUAL(size, (length + 1) * sizeof(int32_t));
+            const char * values = nextBuffer(size);
+            for (int64_t row = 0; row < length; ++row) {
+                int32_t range[2];
+                std::memcpy(range, offsets + row * sizeof(int32_t), sizeof(range));
+                BOOST_REQUIRE_LE(static_cast<std::size_t>(range[1]), size);
+                columns[column].push_back(std::string(values + range[0], static_cast<std::size_t>(range[1] - range[0])));
+            }
+        } else {
+            const char * values = nextBuffer(size);
+            BOOST_REQUIRE_EQUAL(size, length * widths[column]);
+            for (int64_t row = 0; row < length; ++row)
+                columns[column].push_back(std::string(values + row * widths[column], widths[column]));
+        }
+    }
+    return length;
+}
+
+/** decode an Arrow file */
+ArrowTable readArrowFile(const std::string & filename) {
+    checkArrowFile(filename);
+    std::vector<char> data = readFile(filename);
+    ArrowTable table;
+    std::vector<std::size_t> widths;
+    std::map<int64_t, std::size_t> dictionaryWidths;
+
+    /* messages */
+    std::size_t position = 8;
+    for (;;) {
+        BOOST_REQUIRE_LE(position + 8, data.size());
+        int32_t prefix[2];
+        std::memcpy(prefix, data.data() + position, sizeof(prefix));
+        BOOST_REQUIRE_EQUAL(prefix[0], -1);
+        if (prefix[1] == 0)
+            break;
+        const FlatBuffer fb(data.data() + position + 8, static_cast<std::size_t>(prefix[1]));
+        const char * body = data.data() + position + 8 + prefix[1];
+        const std::size_t message = fb.root();
+        BOOST_REQUIRE_EQUAL(fb.get<int16_t>(message, 0, 0), 4); // V5
+        const uint8_t headerType = fb.get<uint8_t>(message, 1, 0);
+        const std::size_t header = fb.offset(message, 2);
+        const int64_t bodyLength = fb.get<int64_t>(message, 3, 0);
+        BOOST_REQUIRE_LE(position + 8 + prefix[1] + bodyLength, data.size());
+
+        switch (headerType) {
+        case 1: { // Schema
+            BOOST_REQUIRE(table.names.empty());
+            const std::size_t fields = fb.offset(header, 1);
+            for (uint32_t i = 0; i < fb.scalar<uint32_t>(fields); ++i) {
+                const std::size_t field = fb.element(fields, i);
+                const uint8_t type = fb.get<uint8_t>(field, 2, 0);
+                const std::size_t width = valueWidth(fb, type, fb.offset(field, 3));
+                table.names.push_back(fb.string(field, 0));
+                table.types.push_back(type);
+                if (fb.field(field, 4)) {
+                    const std::size_t dictionary = fb.offset(field, 4);
+                    const std::size_t indexType = fb.offset(dictionary, 1);
+                    BOOST_CHECK_EQUAL(fb.get<int32_t>(indexType, 0, 0), 32);
+                    table.dictionaryIds.push_back(fb.get<int64_t>(dictionary, 0, 0));
+                    dictionaryWidths[table.dictionaryIds.back()] = width;
+                    widths.push_back(4);
+                } else {
+                    table.dictionaryIds.push_back(-1);
+                    widths.push_back(width);
+                }
+            }
+            table.columns.resize(table.names.size());
+        }
+        break;
+        case 2: { // DictionaryBatch
+            const int64_t id = fb.get<int64_t>(header, 0, 0);
+            BOOST_REQUIRE(dictionaryWidths.count(id));
+            std::vector<std::vector<std::string>> values(1);
+            decodeRecordBatch(fb, fb.offset(header, 1), body, { dictionaryWidths[id] }, values);
+            std::vector<std::string> & dictionary = table.dictionaries[id];
+            table.dictionaryDeltas.push_back(fb.get<uint8_t>(header, 2, 0) != 0);
+            BOOST_CHECK_EQUAL(table.dictionaryDeltas.back(), !dictionary.empty());
+            dictionary.insert(dictionary.end(), values[0].begin(), values[0].end());
+        }
+        break;
+        case 3: // RecordBatch
+            table.batchLengths.push_back(decodeRecordBatch(fb, header, body, widths, table.columns));
+            break;
+        default:
+            BOOST_FAIL("unexpected message type");
+        }
+        position += 8 + static_cast<std::size_t>(prefix[1]) + static_cast<std::size_t>(bodyLength);
+    }
+
+    /* footer references all batches */
+    int32_t footerSize;
+    std::memcpy(&footerSize, data.data() + data.size() - 10, sizeof(footerSize));
+    const FlatBuffer fb(data.data() + data.size() - 10 - footerSize, static_cast<std::size_t>(footerSize));
+    const std::size_t footer = fb.root();
+    BOOST_CHECK_EQUAL(fb.scalar<uint32_t>(fb.offset(footer, 2)), table.dictionaryDeltas.size());
+    BOOST_CHECK_EQUAL(fb.scalar<uint32_t>(fb.offset(footer, 3)), table.batchLengths.size());
+    BOOST_CHECK_EQUAL(fb.scalar<uint32_t>(fb.offset(fb.offset(footer, 1), 1)), table.names.size());
+    return table;
+}
+
+/** write frames, system variables and signals into separate files */
+BOOST_AUTO_TEST_CASE(WriteTables) {
+    const std::string prefix = CMAKE_CURRENT_BINARY_DIR "/test_ArrowWriter";
+    boost::filesystem::remove(prefix + "_can.arrow");
+    boost::filesystem::remove(prefix + "_canfd.arrow");
+    boost::filesystem::remove(prefix + "_sysvar.arrow");
+    boost::filesystem::remove(prefix + "_signals.arrow");
+    boost::filesystem::remove(prefix + "_lin.arrow");
+
+    std::istringstream is(
+        "BO_ 256 Engine: 8 Node\n"
+        " SG_ Speed : 0|16@1+ (0.25,0) [0|0] \"rpm\" Node\n"
+        " SG_ Temp : 16|8@1+ (1,-40) [0|0] \"degC\" Node\n");
+    Vector::BLF::Dbc dbc;
+    dbc.parse(is);
+
+    {
+        Vector::BLF::ArrowWriter arrowWriter(prefix, 2);
+        arrowWriter.addDbc(dbc);
+
+        /* 5 CAN messages on 2 channels, so there are 3 batches and a dictionary delta */
+        for (uint16_t i = 0; i < 5; ++i) {
+            Vector::BLF::CanMessage2 canMessage2;
+            canMessage2.channel = (i < 3) ? 1 : 2;
+            canMessage2.id = 0x100;
+            canMessage2.dlc = 8;
+            canMessage2.data = { 0x10, 0x27, 0x5A, 0, 0, 0, 0, 0 };
+            canMessage2.objectTimeStamp = i * 1000;
+            arrowWriter.write(&canMessage2);
+        }
+
+        Vector::BLF::CanFdMessage64 canFdMessage64;
+        canFdMessage64.channel = 3;
+        canFdMessage64.id = 0x200;
+        canFdMessage64.flags = 0x1000;
+        canFdMessage64.data.resize(12, 0x55);
+        canFdMessage64.validDataBytes = 12;
+        arrowWriter.write(&canFdMessage64);
+
+        Vector::BLF::SystemVariable systemVariable;
+        systemVariable.name = "Namespace::Variable";
+        systemVariable.type = Vector::BLF::SystemVariable::Type::Long;
+        systemVariable.data = { 42, 0, 0, 0 };
+        arrowWriter.write(&systemVariable);
+
+        /* other objects are ignored */
+        Vector::BLF::AppText appText;
+        arrowWriter.write(&appText);
+    }
+
+    const std::string frameData("\x10\x27\x5A\0\0\0\0\0", 8);
+
+    /* CAN: 3 batches, channel 2 is a dictionary delta in front of the second one */
+    ArrowTable can = readArrowFile(prefix + "_can.arrow");
+    BOOST_CHECK(can.names == std::vector<std::string>({ "timestamp", "channel", "id", "dir", "rtr", "dlc", "data" }));
+    BOOST_CHECK(can.types == std::vector<uint8_t>({ 10, 2, 2, 2, 2, 2, 4 }));
+    BOOST_CHECK(can.dictionaryIds == std::vector<int64_t>({ -1, 0, -1, -1, -1, -1, -1 }));
+    BOOST_CHECK(can.batchLengths == std::vector<int64_t>({ 2, 2, 1 }));
+    BOOST_CHECK(can.dictionaryDeltas == std::vector<bool>({ false, true }));
+    BOOST_REQUIRE_EQUAL(can.dictionaries[0].size(), 2);
+    BOOST_CHECK_EQUAL(ArrowTable::value<uint16_t>(can.dictionaries[0][0]), 1);
+    BOOST_CHECK_EQUAL(ArrowTable::value<uint16_t>(can.dictionaries[0][1]), 2);
+    for (std::size_t row = 0; row < 5; ++row) {
+        BOOST_CHECK_EQUAL(ArrowTable::value<uint64_t>(can.columns[0][row]), row * 1000);
+        BOOST_CHECK_EQUAL(ArrowTable::value<uint16_t>(can.dictionaryValue(1, row)), (row < 3) ? 1 : 2);
+        BOOST_CHECK_EQUAL(ArrowTable::value<uint32_t>(can.columns[2][row]), 0x100);
+        BOOST_CHECK_EQUAL(ArrowTable::value<uint8_t>(can.columns[5][row]), 8);
+        BOOST_CHECK(can.columns[6][row] == frameData);
+    }
+
+    /* CAN FD */
+    ArrowTable canFd = readArrowFile(prefix + "_canfd.arrow");
+    BOOST_CHECK(canFd.names == std::vector<std::string>({ "timestamp", "channel", "id", "dir", "edl", "brs", "dlc", "data" }));
+    BOOST_REQUIRE(canFd.batchLengths == std::vector<int64_t>({ 1 }));
+    BOOST_CHECK_EQUAL(ArrowTable::value<uint16_t>(canFd.dictionaryValue(1, 0)), 3);
+    BOOST_CHECK_EQUAL(ArrowTable::value<uint32_t>(canFd.columns[2][0]), 0x200);
+    BOOST_CHECK_EQUAL(ArrowTable::value<uint8_t>(canFd.columns[4][0]), 1);
+    BOOST_CHECK_EQUAL(ArrowTable::value<uint8_t>(canFd.columns[5][0]), 0);
+    BOOST_CHECK(canFd.columns[7][0] == std::string(12, '\x55'));
+
+    /* system variables */
+    ArrowTable sysVar = readArrowFile(prefix + "_sysvar.arrow");
+    BOOST_CHECK(sysVar.names == std::vector<std::string>({ "timestamp", "name", "type", "value", "data" }));
+    BOOST_CHECK(sysVar.types == std::vector<uint8_t>({ 10, 5, 2, 3, 4 }));
+    BOOST_REQUIRE(sysVar.batchLengths == std::vector<int64_t>({ 1 }));
+    BOOST_CHECK_EQUAL(sysVar.dictionaryValue(1, 0), "Namespace::Variable");
+    BOOST_CHECK_EQUAL(ArrowTable::value<uint32_t>(sysVar.columns[2][0]), Vector::BLF::SystemVariable::Type::Long);
+    BOOST_CHECK_EQUAL(ArrowTable::value<double>(sysVar.columns[3][0]), 42);
+    BOOST_CHECK(sysVar.columns[4][0] == std::string("\x2A\0\0\0", 4));
+
+    /* signals: Speed = 0x2710 * 0.25, Temp = 0x5A - 40 */
+    ArrowTable signals = readArrowFile(prefix + "_signals.arrow");
+    BOOST_CHECK(signals.names == std::vector<std::string>({ "timestamp", "channel", "id", "name", "value" }));
+    BOOST_CHECK(signals.dictionaryIds == std::vector<int64_t>({ -1, 0, -1, 1, -1 }));
+    BOOST_CHECK(signals.dictionaries[1] == std::vector<std::string>({ "Speed", "Temp" }));
+    BOOST_REQUIRE_EQUAL(signals.columns[0].size(), 10);
+    for (std::size_t row = 0; row < 10; ++row) {
+        BOOST_CHECK_EQUAL(ArrowTable::value<uint64_t>(signals.columns[0][row]), row / 2 * 1000);
+        BOOST_CHECK_EQUAL(ArrowTable::value<uint32_t>(signals.columns[2][row]), 0x100);
+        BOOST_CHECK_EQUAL(signals.dictionaryValue(3, row), (row % 2) ? "Temp" : "Speed");
+        BOOST_CHECK_EQUAL(ArrowTable::value<double>(signals.columns[4][row]), (row % 2) ? 50 : 2500);
+    }
+
+    BOOST_CHECK(!boost::filesystem::exists(prefix + "_lin.arrow"));
+}
@@ -0,0 +1,182 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE AscReader
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+#include <Vector/BLF.h>
+
+/** read next object of expected type */
+template<typename T>
+std::unique_ptr<T> readObject(Vector::BLF::AscReader & ascReader, Vector::BLF::ObjectType objectType) {
+    Vector::BLF::ObjectHeaderBase * ohb = ascReader.read();
+    BOOST_REQUIRE(ohb != nullptr);
+    BOOST_REQUIRE(ohb->objectType == objectType);
+    return std::unique_ptr<T>(static_cast<T *>(ohb));
+}
+
+/** read all supported line types */
+BOOST_AUTO_TEST_CASE(ReadLines) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_AscReader.asc";
+    {
+        std::ofstream os(filename, std::ios_base::binary);
+        os << "date Sat Jan 2 03:04:05.678 pm 2021\r\n"
+           "base hex  timestamps absolute\r\n"
+           "internal events logged\r\n"
+           "// version 13.0.0\r\n"
+           "Begin Triggerblock Sat Jan 2 03:04:05.678 pm 2021\r\n"
+           "   0.000000 Start of measurement\r\n"
+           "   0.001000 1  123             Rx   d 8 01 02 03 04 05 06 07 08  Length = 235016 BitCount = 122 ID = 291\r\n"
+           "   0.002000 2  18FEF100x       Tx   d 3 AA BB CC\r\n"
+           "   0.003000 1  7FF             Rx   r 4\r\n"
+           "   0.004000 1  ErrorFrame\r\n"
+           "   0.005000 CANFD   3 Rx      1AB                                   1 0 9 12 00 01 02 03 04 05 06 07 08 09 0A 0B   102000  180     3000        1234  0  0  0  0  0  0\r\n"
+           "   0.006000 CANFD   3 Tx      1AB  Symbol                           0 1 8  8 00 01 02 03 04 05 06 07\r\n"
+           "   0.007000 Li1  12 Tx 2 01 02 checksum = 35 header time = 40, full time = 80\r\n"
+           "   0.008000 SV: 2 0 1 ::Namespace::Long = -42\r\n"
+           "   0.009000 SV: 1 0 1 ::Namespace::Double = 1.5\r\n"
+           "   0.010000 SV: 3 0 1 ::Namespace::String = hello world\r\n"
+           "   0.011000 EnvInt := 5\r\n"
+           "   0.012000 EnvData := 01 02 03\r\n"
+           "   0.013000 EnvString := some text\r\n"
+           "   0.014000 1  123             Rx   d 8 01 02\r\n" // malformed
+           "End TriggerBlock\r\n";
+    }
+
+    Vector::BLF::AscReader ascReader(filename, 256); // small buffer to force refills
+    Vector::BLF::SYSTEMTIME startTime = ascReader.startTime();
+    BOOST_CHECK_EQUAL(startTime.year, 2021);
+    BOOST_CHECK_EQUAL(startTime.month, 1);
+    BOOST_CHECK_EQUAL(startTime.dayOfWeek, 6);
+    BOOST_CHECK_EQUAL(startTime.day, 2);
+    BOOST_CHECK_EQUAL(startTime.hour, 15);
+    BOOST_CHECK_EQUAL(startTime.minute, 4);
+    BOOST_CHECK_EQUAL(startTime.second, 5);
+    BOOST_CHECK_EQUAL(startTime.milliseconds, 678);
+
+    auto canMessage2 = readObject<Vector::BLF::CanMessage2>(ascReader, Vector::BLF::ObjectType::CAN_MESSAGE2);
+    BOOST_CHECK_EQUAL(canMessage2->objectFlags, Vector::BLF::ObjectHeader::ObjectFlags::TimeOneNans);
+    BOOST_CHECK_EQUAL(canMessage2->objectTimeStamp, 1000000);
+    BOOST_CHECK_EQUAL(canMessage2->channel, 1);
+    BOOST_CHECK_EQUAL(canMessage2->id, 0x123);
+    BOOST_CHECK_EQUAL(canMessage2->flags, 0);
+    BOOST_CHECK_EQUAL(canMessage2->dlc, 8);
+    BOOST_REQUIRE_EQUAL(canMessage2->data.size(), 8);
+    BOOST_CHECK_EQUAL(canMessage2->data[7], 0x08);
+    BOOST_CHECK_EQUAL(canMessage2->frameLength, 235016);
+    BOOST_CHECK_EQUAL(canMessage2->bitCount, 122);
+
+    canMessage2 = readObject<Vector::BLF::CanMessage2>(ascReader, Vector::BLF::ObjectType::CAN_MESSAGE2);
+    BOOST_CHECK_EQUAL(canMessage2->channel, 2);
+    BOOST_CHECK_EQUAL(canMessage2->id, 0x98FEF100);
+    BOOST_CHECK_EQUAL(canMessage2->flags, 0x01);
+    BOOST_REQUIRE_EQUAL(canMessage2->data.size(), 3);
+    BOOST_CHECK_EQUAL(canMessage2->data[2], 0xCC);
+
+    canMessage2 = readObject<Vector::BLF::CanMessage2>(ascReader, Vector::BLF::ObjectType::CAN_MESSAGE2);
+    BOOST_CHECK_EQUAL(canMessage2->flags, 0x80);
+    BOOST_CHECK_EQUAL(canMessage2->dlc, 4);
+    BOOST_CHECK(canMessage2->data.empty());
+
+    auto canErrorFrame = readObject<Vector::BLF::CanErrorFrame>(ascReader, Vector::BLF::ObjectType::CAN_ERROR);
+    BOOST_CHECK_EQUAL(canErrorFrame->channel, 1);
+    BOOST_CHECK_EQUAL(canErrorFrame->objectTimeStamp, 4000000);
+
+    auto canFdMessage64 = readObject<Vector::BLF::CanFdMessage64>(ascReader, Vector::BLF::ObjectType::CAN_FD_MESSAGE_64);
+    BOOST_CHECK_EQUAL(canFdMessage64->channel, 3);
+    BOOST_CHECK_EQUAL(canFdMessage64->dir, 0);
+    BOOST_CHECK_EQUAL(canFdMessage64->id, 0x1AB);
+    BOOST_CHECK_EQUAL(canFdMessage64->dlc, 9);
+    BOOST_CHECK_EQUAL(canFdMessage64->validDataBytes, 12);
+    BOOST_REQUIRE_EQUAL(canFdMessage64->data.size(), 12);
+    BOOST_CHECK_EQUAL(canFdMessage64->data[11], 0x0B);
+    BOOST_CHECK_EQUAL(canFdMessage64->frameLength, 102000);
+    BOOST_CHECK_EQUAL(canFdMessage64->bitCount, 180);
+    BOOST_CHECK_EQUAL(canFdMessage64->flags, 0x3000);
+    BOOST_CHECK_EQUAL(canFdMessage64->crc, 0x1234);
+
+    canFdMessage64 = readObject<Vector::BLF::CanFdMessage64>(ascReader, Vector::BLF::ObjectType::CAN_FD_MESSAGE_64);
+    BOOST_CHECK_EQUAL(canFdMessage64->dir, 1);
+    BOOST_CHECK_EQUAL(canFdMessage64->flags, 0x5000);
+    BOOST_CHECK_EQUAL(canFdMessage64->data.size(), 8);
+
+    auto linMessage = readObject<Vector::BLF::LinMessage>(ascReader, Vector::BLF::ObjectType::LIN_MESSAGE);
+    BOOST_CHECK_EQUAL(linMessage->channel, 1);
+    BOOST_CHECK_EQUAL(linMessage->id, 0x12);
+    BOOST_CHECK_EQUAL(linMessage->dir, 1);
+    BOOST_CHECK_EQUAL(linMessage->dlc, 2);
+    BOOST_CHECK_EQUAL(linMessage->data[1], 0x02);
+    BOOST_CHECK_EQUAL(linMessage->crc, 0x35);
+    BOOST_CHECK_EQUAL(linMessage->headerTime, 40);
+    BOOST_CHECK_EQUAL(linMessage->fullTime, 80);
+
+    auto systemVariable = readObject<Vector::BLF::SystemVariable>(ascReader, Vector::BLF::ObjectType::SYS_VARIABLE);
+    BOOST_CHECK_EQUAL(systemVariable->name, "Namespace::Long");
+    BOOST_CHECK_EQUAL(systemVariable->type, Vector::BLF::SystemVariable::Type::Long);
+    int32_t longValue;
+    BOOST_REQUIRE_EQUAL(systemVariable->data.size(), sizeof(longValue));
+    std::memcpy(&longValue, systemVariable->data.data(), sizeof(longValue));
+    BOOST_CHECK_EQUAL(longValue, -42);
+
+    systemVariable = readObject<Vector::BLF::SystemVariable>(ascReader, Vector::BLF::ObjectType::SYS_VARIABLE);
+    double doubleValue;
+    BOOST_REQUIRE_EQUAL(systemVariable->data.size(), sizeof(doubleValue));
+    std::memcpy(&doubleValue, systemVariable->data.data(), sizeof(doubleValue));
+    BOOST_CHECK_EQUAL(doubleValue, 1.5);
+
+    systemVariable = readObject<Vector::BLF::SystemVariable>(ascReader, Vector::BLF::ObjectType::SYS_VARIABLE);
+    BOOST_CHECK(std::string(systemVariable->data.begin(), systemVariable->data.end()) == "hello world");
+
+    auto environmentVariable = readObject<Vector::BLF::EnvironmentVariable>(ascReader, Vector::BLF::ObjectType::ENV_INTEGER);
+    BOOST_CHECK_EQUAL(environmentVariable->name, "EnvInt");
+    BOOST_CHECK_EQUAL(environmentVariable->data.size(), 4);
+    BOOST_CHECK_EQUAL(environmentVariable->data[0], 5);
+
+    environmentVariable = readObject<Vector::BLF::EnvironmentVariable>(ascReader, Vector::BLF::ObjectType::ENV_DATA);
+    BOOST_CHECK(environmentVariable->data == std::vector<uint8_t>({ 1, 2, 3 }));
+
+    environmentVariable = readObject<Vector::BLF::EnvironmentVariable>(ascReader, Vector::BLF::ObjectType::ENV_STRING);
+    BOOST_CHECK(std::string(environmentVariable->data.begin(), environmentVariable->data.end()) == "some text");
+
+    BOOST_CHECK(ascReader.read() == nullptr);
+
+    /* Start of measurement and the malformed line */
+    BOOST_CHECK_EQUAL(ascReader.skippedLineCount(), 2);
+}
+
+/** read decimal numbers and relative timestamps */
+BOOST_AUTO_TEST_CASE(ReadDecimalRelative) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_AscReader_dec.asc";
+    {
+        std::ofstream os(filename, std::ios_base::binary);
+        os << "date Sat Jan 2 12:00:00.000 am 2021\n"
+           "base dec  timestamps relative\n"
+           "Begin Triggerblock\n"
+           "   0.500000 1  291             Rx   d 2 255 16\n"
+           "   0.250000 1  291x            Rx   d 1 1";
+    }
+
+    Vector::BLF::AscReader ascReader(filename);
+    BOOST_CHECK_EQUAL(ascReader.startTime().hour, 0);
+
+    auto canMessage2 = readObject<Vector::BLF::CanMessage2>(ascReader, Vector::BLF::ObjectType::CAN_MESSAGE2);
+    BOOST_CHECK_EQUAL(canMessage2->objectTimeStamp, 500000000);
+    BOOST_CHECK_EQUAL(canMessage2->id, 0x123);
+    BOOST_CHECK(canMessage2->data == std::vector<uint8_t>({ 0xFF, 0x10 }));
+
+    /* last line without line end */
+    canMessage2 = readObject<Vector::BLF::CanMessage2>(ascReader, Vector::BLF::ObjectType::CAN_MESSAGE2);
+    BOOST_CHECK_EQUAL(canMessage2->objectTimeStamp, 750000000);
+    BOOST_CHECK_EQUAL(canMessage2->id, 0x80000123);
+
+    BOOST_CHECK(ascReader.read() == nullptr);
+}
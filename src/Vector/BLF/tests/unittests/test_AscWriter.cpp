@@ -0,0 +1,221 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE AscWriter
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <clocale>
+#include <cstring>
+#include <fstream>
+#include <locale>
+#include <memory>
+#include <sstream>
+
+#include <Vector/BLF.h>
+
+/** write objects and check the lines */
+BOOST_AUTO_TEST_CASE(WriteLines) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_AscWriter.asc";
+    {
+        Vector::BLF::AscWriter ascWriter(filename);
+
+        Vector::BLF::SYSTEMTIME startTime {};
+        startTime.year = 2021;
+        startTime.month = 1;
+        startTime.dayOfWeek = 6;
+        startTime.day = 2;
+        startTime.hour = 15;
+        startTime.minute = 4;
+        startTime.second = 5;
+        startTime.milliseconds = 678;
+        ascWriter.setStartTime(startTime);
+
+        Vector::BLF::CanMessage canMessage;
+        canMessage.channel = 1;
+        canMessage.id = 0x123;
+        canMessage.dlc = 2;
+        canMessage.data[0] = 0x0A;
+        canMessage.data[1] = 0xB0;
+        canMessage.objectTimeStamp = 1000000;
+        ascWriter.write(&canMessage);
+
+        Vector::BLF::CanErrorFrame canErrorFrame;
+        canErrorFrame.channel = 2;
+        canErrorFrame.objectTimeStamp = 12345678901;
+        ascWriter.write(&canErrorFrame);
+
+        Vector::BLF::EnvironmentVariable environmentVariable;
+        environmentVariable.objectType = Vector::BLF::ObjectType::ENV_DATA;
+        environmentVariable.name = "EnvData";
+        environmentVariable.data = { 0x01, 0xFF };
+        ascWriter.write(&environmentVariable);
+
+        /* other objects are ignored */
+        Vector::BLF::AppText appText;
+        ascWriter.write(&appText);
+    }
+
+    std::ifstream is(filename);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(is, line))
+        lines.push_back(line);
+    BOOST_REQUIRE_EQUAL(lines.size(), 10);
+    BOOST_CHECK_EQUAL(lines[0], "date Sat Jan 2 03:04:05.678 pm 2021");
+    BOOST_CHECK_EQUAL(lines[1], "base hex  timestamps absolute");
+    BOOST_CHECK_EQUAL(lines[6], "   0.001000 1  123             Rx     d 2 0A B0");
+    BOOST_CHECK_EQUAL(lines[7], "  12.345678 2  ErrorFrame");
+    BOOST_CHECK_EQUAL(lines[8], "   0.000000 EnvData := 01 FF");
+    BOOST_CHECK_EQUAL(lines[9], "End TriggerBlock");
+}
+
+/** write objects and read them back */
+BOOST_AUTO_TEST_CASE(RoundTrip) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_AscWriter_roundtrip.asc";
+    {
+        Vector::BLF::AscWriter ascWriter(filename, 16); // small buffer to force flushes
+
+        Vector::BLF::CanMessage2 canMessage2;
+        canMessage2.channel = 1;
+        canMessage2.id = 0x98FEF100;
+        canMessage2.flags = 0x01;
+        canMessage2.dlc = 3;
+        canMessage2.data = { 1, 2, 3 };
+        canMessage2.frameLength = 1000;
+        canMessage2.bitCount = 80;
+        canMessage2.objectTimeStamp = 1000;
+        ascWriter.write(&canMessage2);
+
+        Vector::BLF::CanFdMessage64 canFdMessage64;
+        canFdMessage64.channel = 2;
+        canFdMessage64.id = 0x100;
+        canFdMessage64.dlc = 9;
+        canFdMessage64.data.resize(12, 0x77);
+        canFdMessage64.validDataBytes = 12;
+        canFdMessage64.flags = 0x3000;
+        canFdMessage64.crc = 0xABCDE;
+        canFdMessage64.objectTimeStamp = 2000;
+        ascWriter.write(&canFdMessage64);
+
+        Vector::BLF::LinMessage linMessage;
+        linMessage.channel = 1;
+        linMessage.id = 0x3C;
+        linMessage.dlc = 8;
+        linMessage.data.fill(0x11);
+        linMessage.crc = 0x99;
+        linMessage.dir = 1;
+        ascWriter.write(&linMessage);
+
+        Vector::BLF::SystemVariable systemVariable;
+        systemVariable.name = "Namespace::Array";
+        systemVariable.type = Vector::BLF::SystemVariable::Type::LongArray;
+        const int32_t values[2] = { -1, 7 };
+        systemVariable.data.resize(sizeof(values));
+        std::memcpy(systemVariable.data.data(), values, sizeof(values));
+        ascWriter.write(&systemVariable);
+
+        Vector::BLF::EnvironmentVariable environmentVariable;
+        environmentVariable.objectType = Vector::BLF::ObjectType::ENV_DOUBLE;
+        environmentVariable.name = "EnvDouble";
+        const double value = 0.1;
+        environmentVariable.data.resize(sizeof(value));
+        std::memcpy(environmentVariable.data.data(), &value, sizeof(value));
+        ascWriter.write(&environmentVariable);
+    }
+
+    Vector::BLF::AscReader ascReader(filename);
+    std::unique_ptr<Vector::BLF::ObjectHeaderBase> ohb(ascReader.read());
+    BOOST_REQUIRE(ohb && (ohb->objectType == Vector::BLF::ObjectType::CAN_MESSAGE2));
+    auto * canMessage2 = static_cast<Vector::BLF::CanMessage2 *>(ohb.get());
+    BOOST_CHECK_EQUAL(canMessage2->id, 0x98FEF100);
+    BOOST_CHECK_EQUAL(canMessage2->flags, 0x01);
+    BOOST_CHECK(canMessage2->data == std::vector<uint8_t>({ 1, 2, 3 }));
+    BOOST_CHECK_EQUAL(canMessage2->frameLength, 1000);
+    BOOST_CHECK_EQUAL(canMessage2->bitCount, 80);
+
+    ohb.reset(ascReader.read());
+    BOOST_REQUIRE(ohb && (ohb->objectType == Vector::BLF::ObjectType::CAN_FD_MESSAGE_64));
+    auto * canFdMessage64 = static_cast<Vector::BLF::CanFdMessage64 *>(ohb.get());
+    BOOST_CHECK_EQUAL(canFdMessage64->objectTimeStamp, 2000);
+    BOOST_CHECK_EQUAL(canFdMessage64->channel, 2);
+    BOOST_CHECK_EQUAL(canFdMessage64->dlc, 9);
+    BOOST_CHECK_EQUAL(canFdMessage64->data.size(), 12);
+    BOOST_CHECK_EQUAL(canFdMessage64->flags, 0x3000);
+    BOOST_CHECK_EQUAL(canFdMessage64->crc, 0xABCDE);
+
+    ohb.reset(ascReader.read());
+    BOOST_REQUIRE(ohb && (ohb->objectType == Vector::BLF::ObjectType::LIN_MESSAGE));
+    auto * linMessage = static_cast<Vector::BLF::LinMessage *>(ohb.get());
+    BOOST_CHECK_EQUAL(linMessage->id, 0x3C);
+    BOOST_CHECK_EQUAL(linMessage->dlc, 8);
+    BOOST_CHECK_EQUAL(linMessage->data[7], 0x11);
+    BOOST_CHECK_EQUAL(linMessage->crc, 0x99);
+    BOOST_CHECK_EQUAL(linMessage->dir, 1);
+
+    ohb.reset(ascReader.read());
+    BOOST_REQUIRE(ohb && (ohb->objectType == Vector::BLF::ObjectType::SYS_VARIABLE));
+    auto * systemVariable = static_cast<Vector::BLF::SystemVariable *>(ohb.get());
+    BOOST_CHECK_EQUAL(systemVariable->name, "Namespace::Array");
+    int32_t values[2];
+    BOOST_REQUIRE_EQUAL(systemVariable->data.size(), sizeof(values));
+    std::memcpy(values, systemVariable->data.data(), sizeof(values));
+    BOOST_CHECK_EQUAL(values[0], -1);
+    BOOST_CHECK_EQUAL(values[1], 7);
+
+    ohb.reset(ascReader.read());
+    BOOST_REQUIRE(ohb && (ohb->objectType == Vector::BLF::ObjectType::ENV_DOUBLE));
+    auto * environmentVariable = static_cast<Vector::BLF::EnvironmentVariable *>(ohb.get());
+    double value;
+    BOOST_REQUIRE_EQUAL(environmentVariable->data.size(), sizeof(value));
+    std::memcpy(&value, environmentVariable->data.data(), sizeof(value));
+    BOOST_CHECK_EQUAL(value, 0.1);
+
+    BOOST_CHECK(ascReader.read() == nullptr);
+}
+
+/** numbers with ',' as decimal point */
+struct CommaNumpunct : std::numpunct<char> {
+    char do_decimal_point() const override {
+        return ',';
+    }
+};
+
+/** doubles are written and read with '.', whatever the global locale is */
+BOOST_AUTO_TEST_CASE(GlobalLocale) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_AscWriter_locale.asc";
+    const std::locale previousLocale = std::locale::global(std::locale(std::locale::classic(), new CommaNumpunct));
+    const std::string previousCLocale = std::setlocale(LC_ALL, nullptr);
+    std::setlocale(LC_ALL, "de_DE.UTF-8"); // if available
+    {
+        Vector::BLF::AscWriter ascWriter(filename);
+        Vector::BLF::EnvironmentVariable environmentVariable;
+        environmentVariable.objectType = Vector::BLF::ObjectType::ENV_DOUBLE;
+        environmentVariable.name = "EnvDouble";
+        const double value = 1.5;
+        environmentVariable.data.resize(sizeof(value));
+        std::memcpy(environmentVariable.data.data(), &value, sizeof(value));
+        ascWriter.write(&environmentVariable);
+    }
+
+    std::ifstream ifs(filename);
+    std::stringstream text;
+    text << ifs.rdbuf();
+    BOOST_CHECK(text.str().find("EnvDouble := 1.5") != std::string::npos);
+
+    Vector::BLF::AscReader ascReader(filename);
+    std::unique_ptr<Vector::BLF::ObjectHeaderBase> ohb(ascReader.read());
+    BOOST_REQUIRE(ohb && (ohb->objectType == Vector::BLF::ObjectType::ENV_DOUBLE));
+    auto * environmentVariable = static_cast<Vector::BLF::EnvironmentVariable *>(ohb.get());
+    double value;
+    BOOST_REQUIRE_EQUAL(environmentVariable->data.size(), sizeof(value));
+    std::memcpy(&value, environmentVariable->data.data(), sizeof(value));
+    BOOST_CHECK_EQUAL(value, 1.5);
+
+    std::setlocale(LC_ALL, previousCLocale.c_str());
+    std::locale::global(previousLocale);
+}
@@ -0,0 +1,142 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE CanBusLoad
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <Vector/BLF.h>
+
+/** bit counts of classic CAN frames */
+BOOST_AUTO_TEST_CASE(CanFrameBitCount) {
+    std::array<uint8_t, 8> data;
+
+    /* 0x555 with alternating data has no stuff bits in id and data */
+    data.fill(0x55);
+    uint16_t bits = Vector::BLF::CanBusLoad::canFrameBitCount(0x555, false, data.data(), 8);
+    BOOST_CHECK_GE(bits, 47 + 64);
+    BOOST_CHECK_LE(bits, 47 + 64 + 3); // only CRC can produce stuff bits
+
+    /* all zero data produces lots of stuff bits */
+    data.fill(0x00);
+    bits = Vector::BLF::CanBusLoad::canFrameBitCount(0x000, false, data.data(), 8);
+    BOOST_CHECK_GT(bits, 47 + 64 + 12);
+    BOOST_CHECK_LE(bits, 47 + 64 + (34 + 64 - 1) / 4);
+
+    /* remote frames don't carry data */
+    bits = Vector::BLF::CanBusLoad::canFrameBitCount(0x555, true, data.data(), 8);
+    BOOST_CHECK_LE(bits, 47 + 3);
+
+    /* extended frames have 20 more bits */
+    data.fill(0x55);
+    uint16_t extendedBits = Vector::BLF::CanBusLoad::canFrameBitCount(0x80000000 | 0x15555555, false, data.data(), 8);
+    BOOST_CHECK_GE(extendedBits, 67 + 64);
+}
+
+/** bit counts of CAN FD frames */
+BOOST_AUTO_TEST_CASE(CanFdFrameBitCount) {
+    std::array<uint8_t, 64> data;
+    data.fill(0x55);
+    uint16_t arbitrationBitCount;
+    uint16_t dataBitCount;
+
+    /* 8 bytes: CRC17 with 6 fixed stuff bits */
+    Vector::BLF::CanBusLoad::canFdFrameBitCount(0x555, data.data(), 8, arbitrationBitCount, dataBitCount);
+    BOOST_CHECK_GE(arbitrationBitCount, 17 + 13);
+    BOOST_CHECK_GE(dataBitCount, 5 + 64 + 21 + 6);
+    BOOST_CHECK_LE(dataBitCount, 5 + 64 + 21 + 6 + 2);
+
+    /* 64 bytes: CRC21 with 7 fixed stuff bits */
+    Vector::BLF::CanBusLoad::canFdFrameBitCount(0x555, data.data(), 64, arbitrationBitCount, dataBitCount);
+    BOOST_CHECK_GE(dataBitCount, 5 + 512 + 25 + 7);
+}
+
+/** windows are filled according to frame durations */
+BOOST_AUTO_TEST_CASE(Batch) {
+    Vector::BLF::CanBusLoad canBusLoad(1000000); // 1 ms
+    BOOST_CHECK_EQUAL(canBusLoad.resolution(), 1000000);
+
+    /* frame in window 10, frame crossing windows 11/12, long frame over 13-15 */
+    std::array<uint64_t, 3> timeStamps { { 10500000, 12100000, 15500000 } };
+    std::array<uint32_t, 3> durations { { 250000, 200000, 2700000 } };
+    canBusLoad.process(1, timeStamps.data(), durations.data(), timeStamps.size());
+
+    BOOST_REQUIRE_EQUAL(canBusLoad.channels().size(), 1);
+    BOOST_CHECK_EQUAL(canBusLoad.channels()[0], 1);
+    BOOST_CHECK_EQUAL(canBusLoad.startTime(1), 10000000);
+
+    std::vector<uint64_t> busyTime = canBusLoad.busyTime(1);
+    BOOST_REQUIRE_EQUAL(busyTime.size(), 6);
+    BOOST_CHECK_EQUAL(busyTime[0], 250000);
+    BOOST_CHECK_EQUAL(busyTime[1], 100000);
+    BOOST_CHECK_EQUAL(busyTime[2], 100000 + 200000);
+    BOOST_CHECK_EQUAL(busyTime[3], 1000000);
+    BOOST_CHECK_EQUAL(busyTime[4], 1000000);
+    BOOST_CHECK_EQUAL(busyTime[5], 500000);
+
+    std::vector<double> utilization = canBusLoad.utilization(1);
+    BOOST_REQUIRE_EQUAL(utilization.size(), 6);
+    BOOST_CHECK_CLOSE(utilization[0], 0.25, 0.001);
+    BOOST_CHECK_CLOSE(utilization[3], 1.0, 0.001);
+
+    /* earlier frame extends windows to the front */
+    canBusLoad.process(1, timeStamps.data(), durations.data(), 0);
+    uint64_t timeStamp = 8500000;
+    uint32_t duration = 100000;
+    canBusLoad.process(1, &timeStamp, &duration, 1);
+    BOOST_CHECK_EQUAL(canBusLoad.startTime(1), 8000000);
+    BOOST_CHECK_EQUAL(canBusLoad.busyTime(1).size(), 8);
+    BOOST_CHECK_EQUAL(canBusLoad.busyTime(1)[0], 100000);
+
+    /* unknown channel */
+    BOOST_CHECK(canBusLoad.utilization(2).empty());
+}
+
+/** frame duration is taken from objects */
+BOOST_AUTO_TEST_CASE(Objects) {
+    Vector::BLF::CanBusLoad canBusLoad(1000000); // 1 ms
+    canBusLoad.setBitRate(1, 500000);
+    canBusLoad.setBitRate(2, 500000, 2000000);
+
+    /* frameLength given, interframe space is added */
+    Vector::BLF::CanMessage2 canMessage2;
+    canMessage2.channel = 1;
+    canMessage2.objectTimeStamp = 1500000;
+    canMessage2.frameLength = 200000;
+    canBusLoad.process(&canMessage2);
+    BOOST_CHECK_EQUAL(canBusLoad.busyTime(1)[0], 200000 + 6000);
+
+    /* 10 us timestamps */
+    Vector::BLF::CanMessage canMessage;
+    canMessage.channel = 1;
+    canMessage.objectFlags = Vector::BLF::ObjectHeader::ObjectFlags::TimeTenMics;
+    canMessage.objectTimeStamp = 180;
+    canMessage.id = 0x555;
+    canMessage.dlc = 0;
+    canBusLoad.process(&canMessage);
+    std::vector<uint64_t> busyTime = canBusLoad.busyTime(1);
+    BOOST_CHECK_EQUAL(busyTime[0], 200000 + 6000 + Vector::BLF::CanBusLoad::canFrameBitCount(0x555, false, canMessage.data.data(), 0) * 2000);
+
+    /* CAN FD with bit rate switch */
+    Vector::BLF::CanFdMessage64 canFdMessage64;
+    canFdMessage64.channel = 2;
+    canFdMessage64.objectTimeStamp = 5000000;
+    canFdMessage64.flags = 0x1000 | 0x2000; // EDL, BRS
+    canFdMessage64.id = 0x123;
+    canFdMessage64.data.resize(64);
+    canFdMessage64.validDataBytes = 64;
+    canBusLoad.process(&canFdMessage64);
+    uint16_t arbitrationBitCount;
+    uint16_t dataBitCount;
+    Vector::BLF::CanBusLoad::canFdFrameBitCount(0x123, canFdMessage64.data.data(), 64, arbitrationBitCount, dataBitCount);
+    BOOST_CHECK_EQUAL(canBusLoad.busyTime(2)[0], arbitrationBitCount * 2000 + dataBitCount * 500);
+
+    /* other objects are ignored */
+    Vector::BLF::LinMessage linMessage;
+    canBusLoad.process(&linMessage);
+    BOOST_CHECK_EQUAL(canBusLoad.channels().size(), 2);
+}
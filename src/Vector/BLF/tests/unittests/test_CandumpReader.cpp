@@ -0,0 +1,132 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE CandumpReader
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <memory>
+
+#include <Vector/BLF.h>
+
+/** read next object of expected type */
+template<typename T>
+std::unique_ptr<T> readObject(Vector::BLF::CandumpReader & candumpReader, Vector::BLF::ObjectType objectType) {
+    Vector::BLF::ObjectHeaderBase * ohb = candumpReader.read();
+    BOOST_REQUIRE(ohb != nullptr);
+    BOOST_REQUIRE(ohb->objectType == objectType);
+    return std::unique_ptr<T>(static_cast<T *>(ohb));
+}
+
+/** read CAN, CAN FD and error frames */
+BOOST_AUTO_TEST_CASE(ReadFrames) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_CandumpReader.log";
+    {
+        std::ofstream os(filename, std::ios_base::binary);
+        os << "(1609556400.000100) can0 123#DEADBEEF\n"
+           "(1609556400.000200) vcan1 12345678#\n"
+           "(1609556400.000300) can0 7FF#R3 T\n"
+           "(1609556400.000400) can0 1AB##3000102030405060708090A0B\n"
+           "(1609556400.000500) can0 20000088#0000040000000000\n"
+           "(1609556400.000600) can2 123#1122334455667788_C\n"
+           "\n"
+           "(1609556400.000700) can0 12#00\n" // malformed id
+           "(1609556400.000800) vcan1 456#01";
+    }
+
+    Vector::BLF::CandumpReader candumpReader(filename, 256); // small buffer to force refills
+    candumpReader.setChannel("can2", 5);
+
+    auto canMessage2 = readObject<Vector::BLF::CanMessage2>(candumpReader, Vector::BLF::ObjectType::CAN_MESSAGE2);
+    BOOST_CHECK_EQUAL(candumpReader.startTime(), 1609556400000100000ULL);
+    BOOST_CHECK_EQUAL(canMessage2->objectFlags, Vector::BLF::ObjectHeader::ObjectFlags::TimeOneNans);
+    BOOST_CHECK_EQUAL(canMessage2->objectTimeStamp, 0);
+    BOOST_CHECK_EQUAL(canMessage2->channel, 6);
+    BOOST_CHECK_EQUAL(canMessage2->id, 0x123);
+    BOOST_CHECK_EQUAL(canMessage2->flags, 0);
+    BOOST_CHECK_EQUAL(canMessage2->dlc, 4);
+    BOOST_CHECK(canMessage2->data == std::vector<uint8_t>({ 0xDE, 0xAD, 0xBE, 0xEF }));
+
+    canMessage2 = readObject<Vector::BLF::CanMessage2>(candumpReader, Vector::BLF::ObjectType::CAN_MESSAGE2);
+    BOOST_CHECK_EQUAL(canMessage2->objectTimeStamp, 100000);
+    BOOST_CHECK_EQUAL(canMessage2->channel, 7);
+    BOOST_CHECK_EQUAL(canMessage2->id, 0x92345678);
+    BOOST_CHECK_EQUAL(canMessage2->dlc, 0);
+
+    canMessage2 = readObject<Vector::BLF::CanMessage2>(candumpReader, Vector::BLF::ObjectType::CAN_MESSAGE2);
+    BOOST_CHECK_EQUAL(canMessage2->channel, 6);
+    BOOST_CHECK_EQUAL(canMessage2->flags, 0x81);
+    BOOST_CHECK_EQUAL(canMessage2->dlc, 3);
+    BOOST_CHECK(canMessage2->data.empty());
+
+    auto canFdMessage64 = readObject<Vector::BLF::CanFdMessage64>(candumpReader, Vector::BLF::ObjectType::CAN_FD_MESSAGE_64);
+    BOOST_CHECK_EQUAL(canFdMessage64->channel, 6);
+    BOOST_CHECK_EQUAL(canFdMessage64->id, 0x1AB);
+    BOOST_CHECK_EQUAL(canFdMessage64->flags, 0x7000);
+    BOOST_CHECK_EQUAL(canFdMessage64->dlc, 9);
+    BOOST_CHECK_EQUAL(canFdMessage64->validDataBytes, 12);
+    BOOST_REQUIRE_EQUAL(canFdMessage64->data.size(), 12);
+    BOOST_CHECK_EQUAL(canFdMessage64->data[11], 0x0B);
+
+    auto canErrorFrameExt = readObject<Vector::BLF::CanErrorFrameExt>(candumpReader, Vector::BLF::ObjectType::CAN_ERROR_EXT);
+    BOOST_CHECK_EQUAL(canErrorFrameExt->channel, 6);
+    BOOST_CHECK_EQUAL(canErrorFrameExt->dlc, 8);
+    BOOST_CHECK_EQUAL(canErrorFrameExt->flags, 2);
+    BOOST_CHECK_EQUAL(canErrorFrameExt->flagsExt, (2 << 6) | (2 << 12)); // stuff error, Rx
+
+    canMessage2 = readObject<Vector::BLF::CanMessage2>(candumpReader, Vector::BLF::ObjectType::CAN_MESSAGE2);
+    BOOST_CHECK_EQUAL(canMessage2->channel, 5);
+    BOOST_CHECK_EQUAL(canMessage2->dlc, 12);
+    BOOST_CHECK_EQUAL(canMessage2->data.size(), 8);
+
+    /* last line without line end */
+    canMessage2 = readObject<Vector::BLF::CanMessage2>(candumpReader, Vector::BLF::ObjectType::CAN_MESSAGE2);
+    BOOST_CHECK_EQUAL(canMessage2->channel, 7);
+    BOOST_CHECK_EQUAL(canMessage2->objectTimeStamp, 700000);
+
+    BOOST_CHECK(candumpReader.read() == nullptr);
+    BOOST_CHECK_EQUAL(candumpReader.skippedLineCount(), 2);
+    BOOST_CHECK_EQUAL(candumpReader.channels().size(), 3);
+}
+
+/** copy candump log into a BLF file */
+BOOST_AUTO_TEST_CASE(CopyToBlf) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_CandumpReader_copy.log";
+    const std::string blfFilename = CMAKE_CURRENT_BINARY_DIR "/test_CandumpReader.blf";
+    {
+        std::ofstream os(filename, std::ios_base::binary);
+        for (int i = 0; i < 1000; ++i)
+            os << "(1609556400." << (100000 + i) << ") can0 100#0102030405060708\n";
+    }
+
+    {
+        Vector::BLF::CandumpReader candumpReader(filename);
+        Vector::BLF::File file;
+        file.open(blfFilename, std::ios_base::out);
+        BOOST_REQUIRE(file.is_open());
+        BOOST_CHECK_EQUAL(candumpReader.copyTo(file), 1000);
+        file.close();
+    }
+
+    Vector::BLF::File file;
+    file.open(blfFilename);
+    BOOST_REQUIRE(file.is_open());
+    BOOST_CHECK_EQUAL(file.fileStatistics.measurementStartTime.year, 2021);
+    BOOST_CHECK_EQUAL(file.fileStatistics.objectCount, 1000);
+    uint64_t count = 0;
+    uint64_t lastTimeStamp = 0;
+    while (Vector::BLF::ObjectHeaderBase * ohb = file.read()) {
+        BOOST_REQUIRE(ohb->objectType == Vector::BLF::ObjectType::CAN_MESSAGE2);
+        lastTimeStamp = static_cast<Vector::BLF::CanMessage2 *>(ohb)->objectTimeStamp;
+        delete ohb;
+        count++;
+    }
+    BOOST_CHECK_EQUAL(count, 1000);
+    BOOST_CHECK_EQUAL(lastTimeStamp, 999000);
+    file.close();
+}
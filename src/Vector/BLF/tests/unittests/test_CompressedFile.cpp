@@ -9,6 +9,14 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/filesystem.hpp>
 
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#endif
+
 #include <Vector/BLF.h>
 
 /** Test read operations on a blf file. */
@@ -44,3 +52,92 @@ BOOST_AUTO_TEST_CASE(ReadTest) {
     compressedFile.close();
     BOOST_CHECK(!compressedFile.is_open());
 }
+
+/** Read with read ahead and dropping of the data already read. */
+BOOST_AUTO_TEST_CASE(ReadPolicy) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_CompressedFile_readPolicy.bin";
+
+    /* data spanning several drop chunks */
+    std::vector<char> data(0x300000 + 17);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<char>(i * 3);
+    {
+        std::ofstream ofs(filename, std::ios_base::binary);
+        ofs.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    for (const bool ioUring : { false, true }) {
+        Vector::BLF::CompressedFile compressedFile;
+        compressedFile.setReadPolicy(0x80000, true);
+        compressedFile.open(filename.c_str(), std::ios_base::in | std::ios_base::binary, ioUring);
+        BOOST_REQUIRE(compressedFile.is_open());
+
+        /* sequential */
+        std::vector<char> content(data.size());
+        for (size_t i = 0; i < content.size(); i += 0x1000) {
+            const std::streamsize n = static_cast<std::streamsize>(std::min<size_t>(0x1000, content.size() - i));
+            compressedFile.read(content.data() + i, n);
+            BOOST_REQUIRE_EQUAL(compressedFile.gcount(), n);
+        }
+        BOOST_CHECK(content == data);
+
+        /* backward seek into dropped data */
+        char c;
+        compressedFile.seekg(5, std::ios_base::beg);
+        compressedFile.read(&c, 1);
+        BOOST_CHECK_EQUAL(c, data[5]);
+        compressedFile.seekg(0x200000, std::ios_base::cur);
+        compressedFile.read(&c, 1);
+        BOOST_CHECK_EQUAL(c, data[0x200006]);
+        compressedFile.close();
+    }
+}
+
+#if !defined(_WIN32)
+/** Seek in a pipe, within the lookback buffer and forward. */
+BOOST_AUTO_TEST_CASE(Pipe) {
+    const std::string pipename = CMAKE_CURRENT_BINARY_DIR "/test_CompressedFilePipe.fifo";
+    boost::filesystem::remove(pipename);
+    BOOST_REQUIRE(::mkfifo(pipename.c_str(), 0600) == 0);
+
+    /* write bytes 0..255 repeatedly */
+    std::thread writer([&pipename]() {
+        std::ofstream out(pipename, std::ios_base::binary);
+        for (int i = 0; i < 0x1000; ++i)
+            out.put(static_cast<char>(i & 0xff));
+    });
+
+    Vector::BLF::CompressedFile compressedFile;
+    compressedFile.open(pipename.c_str(), std::ios_base::in);
+    BOOST_REQUIRE(compressedFile.is_open());
+
+    /* read */
+    std::vector<char> data(0x10);
+    compressedFile.read(data.data(), 0x10);
+    BOOST_CHECK_EQUAL(compressedFile.gcount(), 0x10);
+    BOOST_CHECK_EQUAL(compressedFile.tellg(), 0x10);
+
+    /* seek back, and read again */
+    compressedFile.seekg(-4, std::ios_base::cur);
+    BOOST_CHECK_EQUAL(compressedFile.tellg(), 0x0c);
+    compressedFile.read(data.data(), 8);
+    BOOST_CHECK_EQUAL(compressedFile.gcount(), 8);
+    BOOST_CHECK_EQUAL(data[0], 0x0c);
+    BOOST_CHECK_EQUAL(data[7], 0x13);
+
+    /* seek forward */
+    compressedFile.seekg(0x801, std::ios_base::beg);
+    BOOST_CHECK_EQUAL(compressedFile.tellg(), 0x801);
+    compressedFile.read(data.data(), 1);
+    BOOST_CHECK_EQUAL(data[0], 0x01);
+    BOOST_CHECK(compressedFile.good());
+
+    /* seek back beyond the lookback buffer fails */
+    compressedFile.seekg(0, std::ios_base::beg);
+    BOOST_CHECK(!compressedFile.good());
+
+    compressedFile.close();
+    writer.join();
+    boost::filesystem::remove(pipename);
+}
+#endif
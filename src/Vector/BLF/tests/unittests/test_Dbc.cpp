@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE Dbc
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <sstream>
+
+#include <Vector/BLF.h>
+
+/** parse messages and signals */
+BOOST_AUTO_TEST_CASE(Parse) {
+    std::istringstream is(
+        "VERSION \"\"\n"
+        "\n"
+        "BU_: Engine Gateway\n"
+        "\n"
+        "BO_ 100 EngineData: 8 Engine\n"
+        " SG_ EngineSpeed : 0|16@1+ (0.25,0) [0|16383.75] \"rpm\" Gateway\n"
+        " SG_ EngineTemp : 23|8@0- (1,-40) [-40|215] \"degC\" Gateway,Engine\n"
+        "\n"
+        "BO_ 2147484672 MuxMessage: 64 Gateway\r\n"
+        " SG_ Mux M : 0|4@1+ (1,0) [0|15] \"\" Engine\r\n"
+        " SG_ Value1 m1 : 8|8@1+ (1,0) [0|255] \"\" Engine\r\n"
+        "\n"
+        "CM_ BO_ 100 \"multi line\n"
+        "BO_ 200 NotAMessage: 8 Engine\n"
+        "comment\";\n");
+    Vector::BLF::Dbc dbc;
+    dbc.parse(is);
+
+    BOOST_REQUIRE_EQUAL(dbc.messages().size(), 2);
+    const Vector::BLF::Dbc::Message * message = dbc.message(100);
+    BOOST_REQUIRE(message != nullptr);
+    BOOST_CHECK_EQUAL(message->name, "EngineData");
+    BOOST_CHECK_EQUAL(message->size, 8);
+    BOOST_CHECK_EQUAL(message->transmitter, "Engine");
+    BOOST_REQUIRE_EQUAL(message->signals.size(), 2);
+    BOOST_CHECK_EQUAL(message->signals[0].name, "EngineSpeed");
+    BOOST_CHECK_EQUAL(message->signals[0].startBit, 0);
+    BOOST_CHECK_EQUAL(message->signals[0].length, 16);
+    BOOST_CHECK(!message->signals[0].bigEndian);
+    BOOST_CHECK(!message->signals[0].isSigned);
+    BOOST_CHECK_EQUAL(message->signals[0].factor, 0.25);
+    BOOST_CHECK_EQUAL(message->signals[0].maximum, 16383.75);
+    BOOST_CHECK_EQUAL(message->signals[0].unit, "rpm");
+    BOOST_CHECK(message->signals[1].bigEndian);
+    BOOST_CHECK(message->signals[1].isSigned);
+    BOOST_CHECK_EQUAL(message->signals[1].offset, -40);
+
+    /* extended id and multiplexing */
+    message = dbc.message(0x80000400);
+    BOOST_REQUIRE(message != nullptr);
+    BOOST_CHECK_EQUAL(message->size, 64);
+    BOOST_REQUIRE_EQUAL(message->signals.size(), 2);
+    BOOST_CHECK(message->signals[0].multiplex == Vector::BLF::Dbc::Signal::Multiplex::Multiplexor);
+    BOOST_CHECK(message->signals[1].multiplex == Vector::BLF::Dbc::Signal::Multiplex::Multiplexed);
+    BOOST_CHECK_EQUAL(message->signals[1].multiplexValue, 1);
+
+    /* lines within strings are skipped */
+    BOOST_CHECK(dbc.message(200) == nullptr);
+}
+
+/** errors */
+BOOST_AUTO_TEST_CASE(Errors) {
+    Vector::BLF::Dbc dbc;
+    BOOST_CHECK_THROW(dbc.load("does_not_exist.dbc"), Vector::BLF::Exception);
+
+    std::istringstream is1(" SG_ Orphan : 0|8@1+ (1,0) [0|255] \"\" Engine\n");
+    BOOST_CHECK_THROW(dbc.parse(is1), Vector::BLF::Exception);
+
+    std::istringstream is2(
+        "BO_ 100 EngineData: 8 Engine\n"
+        " SG_ Broken : 0|8@1+ (1,0)\n");
+    BOOST_CHECK_THROW(dbc.parse(is2), Vector::BLF::Exception);
+}
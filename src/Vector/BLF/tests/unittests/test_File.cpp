@@ -9,6 +9,15 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/filesystem.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#endif
+
 #include <Vector/BLF.h>
 
 /** check error conditions in open */
@@ -165,3 +174,346 @@ BOOST_AUTO_TEST_CASE(OpenCloseCycles) {
     logfile.open(CMAKE_CURRENT_BINARY_DIR "test.blf", std::ios_base::out);
     logfile.close();
 }
+
+/** probe file statistics and leading AppText objects without opening the file */
+BOOST_AUTO_TEST_CASE(Probe) {
+    Vector::BLF::FileStatistics fileStatistics;
+    std::vector<Vector::BLF::AppText> appTexts;
+
+    /* unexisting file */
+    BOOST_CHECK(!Vector::BLF::File::probe(CMAKE_CURRENT_SOURCE_DIR "/events_from_binlog/FileNotExists.blf", fileStatistics));
+
+    /* no BLF file */
+    BOOST_CHECK(!Vector::BLF::File::probe(CMAKE_CURRENT_SOURCE_DIR "/CMakeLists.txt", fileStatistics));
+
+    /* file statistics only */
+    BOOST_REQUIRE(Vector::BLF::File::probe(CMAKE_CURRENT_SOURCE_DIR "/events_from_binlog/test_AppText.blf", fileStatistics));
+    BOOST_CHECK_EQUAL(fileStatistics.signature, Vector::BLF::FileSignature);
+    BOOST_CHECK_EQUAL(fileStatistics.objectCount, 2);
+
+    /* with AppText objects */
+    BOOST_REQUIRE(Vector::BLF::File::probe(CMAKE_CURRENT_SOURCE_DIR "/events_from_binlog/test_AppText.blf", fileStatistics, &appTexts));
+    BOOST_REQUIRE_EQUAL(appTexts.size(), 2);
+    BOOST_CHECK_EQUAL(appTexts[0].source, Vector::BLF::AppText::Source::MetaData);
+    BOOST_CHECK_EQUAL(appTexts[0].text, "xyz");
+
+    /* no leading AppText objects */
+    appTexts.clear();
+    BOOST_REQUIRE(Vector::BLF::File::probe(CMAKE_CURRENT_SOURCE_DIR "/events_from_binlog/test_CanMessage.blf", fileStatistics, &appTexts));
+    BOOST_CHECK(appTexts.empty());
+}
+
+/** checkpoints rewrite the file statistics while the file is written */
+BOOST_AUTO_TEST_CASE(Checkpoints) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_Checkpoints.blf";
+
+    /* write objects into several log containers */
+    Vector::BLF::File file;
+    file.setDefaultLogContainerSize(0x1000);
+    file.checkpointSize = 1;
+    file.open(filename, std::ios_base::out);
+    BOOST_REQUIRE(file.is_open());
+    for (int i = 0; i < 2000; ++i) {
+        auto * canMessage2 = new Vector::BLF::CanMessage2;
+        canMessage2->data.assign(8, static_cast<uint8_t>(i));
+        file.write(canMessage2);
+    }
+
+    /* wait until all complete log containers are checkpointed */
+    uint64_t checkpoints = 0;
+    for (int i = 0; i < 100; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        if ((file.metrics.checkpoints > 0) &&
+                (file.metrics.checkpoints == file.metrics.logContainersDeflated) &&
+                (file.metrics.checkpoints == checkpoints))
+            break;
+        checkpoints = file.metrics.checkpoints;
+    }
+    BOOST_REQUIRE_GT(file.metrics.checkpoints, 0);
+
+    /* file statistics describe the file as is, like after a power loss */
+    Vector::BLF::FileStatistics fileStatistics;
+    BOOST_REQUIRE(Vector::BLF::File::probe(filename, fileStatistics));
+    BOOST_CHECK_EQUAL(fileStatistics.fileSize, boost::filesystem::file_size(filename));
+    BOOST_CHECK_GT(fileStatistics.objectCount, 0);
+    BOOST_CHECK_LT(fileStatistics.objectCount, 2000);
+    BOOST_CHECK_GT(fileStatistics.uncompressedFileSize, fileStatistics.statisticsSize);
+
+    /* uncompressed size up to the counted objects, with the headers of their log containers */
+    Vector::BLF::CanMessage2 canMessage2;
+    canMessage2.data.resize(8);
+    const uint64_t objectsSize = fileStatistics.objectCount * canMessage2.calculateObjectSize();
+    const uint64_t logContainers = (objectsSize + 0xfff) / 0x1000;
+    BOOST_CHECK_EQUAL(fileStatistics.uncompressedFileSize,
+                      fileStatistics.statisticsSize + objectsSize + logContainers * Vector::BLF::LogContainer().internalHeaderSize());
+
+    /* readable up to the checkpoint */
+    {
+        Vector::BLF::File checkpointFile;
+        checkpointFile.open(filename, std::ios_base::in);
+        BOOST_REQUIRE(checkpointFile.is_open());
+        uint32_t count = 0;
+        while (Vector::BLF::ObjectHeaderBase * ohb = checkpointFile.read()) {
+            delete ohb;
+            count++;
+        }
+        BOOST_CHECK_GE(count, fileStatistics.objectCount);
+        checkpointFile.close();
+    }
+
+    /* final statistics at close */
+    file.close();
+    BOOST_REQUIRE(Vector::BLF::File::probe(filename, fileStatistics));
+    BOOST_CHECK_EQUAL(fileStatistics.objectCount, 2000);
+    BOOST_CHECK_EQUAL(fileStatistics.fileSize, boost::filesystem::file_size(filename));
+}
+
+/** Flush and max latency write partially filled log containers. */
+BOOST_AUTO_TEST_CASE(Flush) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_Flush.blf";
+
+    /* objects, which reached the file */
+    const auto countObjects = [&filename]() {
+        Vector::BLF::File readFile;
+        readFile.open(filename, std::ios_base::in);
+        uint32_t count = 0;
+        while (Vector::BLF::ObjectHeaderBase * ohb = readFile.read()) {
+            delete ohb;
+            count++;
+        }
+        return count;
+    };
+
+    Vector::BLF::File file;
+    file.open(filename, std::ios_base::out);
+    BOOST_REQUIRE(file.is_open());
+    BOOST_CHECK_EQUAL(file.maxLatency(), 0);
+
+    /* explicit flush */
+    for (int i = 0; i < 10; ++i)
+        file.write(new Vector::BLF::CanMessage2);
+    file.flush();
+    BOOST_CHECK_EQUAL(file.metrics.logContainersDeflated, 1);
+    BOOST_CHECK_EQUAL(countObjects(), 10);
+
+    /* flush without new objects */
+    file.flush();
+    BOOST_CHECK_EQUAL(file.metrics.logContainersDeflated, 1);
+
+    /* nullptr is ignored, and doesn't flush */
+    file.write(new Vector::BLF::CanMessage2);
+    file.write(nullptr);
+    Vector::BLF::ObjectHeaderBase * objs[2] = { nullptr, new Vector::BLF::CanMessage2 };
+    file.write(objs, 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    BOOST_CHECK_EQUAL(file.metrics.logContainersDeflated, 1);
+    file.flush();
+    BOOST_CHECK_EQUAL(file.metrics.logContainersDeflated, 2);
+    BOOST_CHECK_EQUAL(countObjects(), 12);
+
+    /* max latency */
+    file.setMaxLatency(20);
+    BOOST_CHECK_EQUAL(file.maxLatency(), 20);
+    for (int i = 0; i < 5; ++i)
+        file.write(new Vector::BLF::CanMessage2);
+    for (int i = 0; (i < 100) && (file.metrics.logContainersDeflated < 3); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    BOOST_CHECK_EQUAL(file.metrics.logContainersDeflated, 3);
+    BOOST_CHECK_EQUAL(countObjects(), 17);
+
+    /* all objects at close */
+    file.close();
+    BOOST_CHECK_EQUAL(countObjects(), 17);
+}
+
+/** Dropped objects are counted and marked with DataLostBegin/DataLostEnd. */
+BOOST_AUTO_TEST_CASE(TryWrite) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_TryWrite.blf";
+    const uint32_t objectCount = 20000;
+
+    Vector::BLF::File file;
+    file.setReadWriteQueueSize(2);
+    BOOST_CHECK_EQUAL(file.readWriteQueueSize(), 2);
+    file.highWatermark = 2;
+    file.lowWatermark = 0;
+    std::atomic<uint32_t> highWatermarks {};
+    file.watermarkCallback = [&highWatermarks](bool high) {
+        if (high)
+            highWatermarks++;
+    };
+    file.open(filename, std::ios_base::out);
+    BOOST_REQUIRE(file.is_open());
+
+    /* write faster than the pipeline compresses */
+    uint32_t written = 0;
+    for (uint32_t i = 0; i < objectCount; ++i) {
+        auto * canMessage = new Vector::BLF::CanMessage;
+        canMessage->objectTimeStamp = i;
+        if (file.tryWrite(canMessage))
+            written++;
+    }
+    BOOST_CHECK_EQUAL(written + file.metrics.objectsDropped, objectCount);
+    BOOST_CHECK_GT(highWatermarks, 0);
+    file.close();
+
+    /* read back */
+    Vector::BLF::File readFile;
+    readFile.open(filename, std::ios_base::in);
+    BOOST_REQUIRE(readFile.is_open());
+    uint32_t canMessages = 0;
+    uint32_t dataLostBegins = 0;
+    uint32_t lostEvents = 0;
+    for (;;) {
+        Vector::BLF::ObjectHeaderBase * ohb = readFile.read(1000);
+        if (ohb == nullptr) {
+            BOOST_CHECK(readFile.eof());
+            break;
+        }
+        if (ohb->objectType == Vector::BLF::ObjectType::CAN_MESSAGE)
+            canMessages++;
+        if (ohb->objectType == Vector::BLF::ObjectType::DATA_LOST_BEGIN)
+            dataLostBegins++;
+        if (auto * dataLostEnd = dynamic_cast<Vector::BLF::DataLostEnd *>(ohb)) {
+            BOOST_CHECK_LE(dataLostEnd->firstObjectLostTimeStamp, dataLostEnd->objectTimeStamp);
+            lostEvents += dataLostEnd->numberOfLostEvents;
+        }
+        delete ohb;
+    }
+    BOOST_CHECK_EQUAL(canMessages, written);
+    BOOST_CHECK_EQUAL(lostEvents, objectCount - written);
+    BOOST_CHECK_EQUAL(dataLostBegins > 0, written < objectCount);
+}
+
+/** read count CanMessages with consecutive timestamps from a followed file */
+static void readFollowed(Vector::BLF::File & file, uint32_t & timeStamp, const uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) {
+        Vector::BLF::ObjectHeaderBase * ohb = file.read(5000);
+        BOOST_REQUIRE(ohb);
+        auto * canMessage = dynamic_cast<Vector::BLF::CanMessage *>(ohb);
+        BOOST_REQUIRE(canMessage);
+        BOOST_CHECK_EQUAL(canMessage->objectTimeStamp, timeStamp);
+        timeStamp++;
+        delete ohb;
+    }
+}
+
+/** Follow a file, which is still being written. */
+BOOST_AUTO_TEST_CASE(Follow) {
+    for (const bool ioUring : { false, true }) {
+        const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_Follow.blf";
+
+        /* write and flush a first part */
+        Vector::BLF::File file;
+        file.open(filename, std::ios_base::out);
+        BOOST_REQUIRE(file.is_open());
+        uint32_t writeTimeStamp = 0;
+        auto writeObjects = [&file, &writeTimeStamp](const uint32_t count) {
+            for (uint32_t i = 0; i < count; ++i) {
+                auto * canMessage = new Vector::BLF::CanMessage;
+                canMessage->objectTimeStamp = writeTimeStamp++;
+                file.write(canMessage);
+            }
+        };
+        writeObjects(100);
+        file.flush();
+
+        /* follow it */
+        Vector::BLF::File readFile;
+        readFile.follow = true;
+        readFile.useIoUring = ioUring;
+        readFile.open(filename, std::ios_base::in);
+        BOOST_REQUIRE(readFile.is_open());
+        uint32_t readTimeStamp = 0;
+        readFollowed(readFile, readTimeStamp, 100);
+        BOOST_CHECK(readFile.tryRead() == nullptr);
+        BOOST_CHECK(!readFile.eof());
+
+        /* larger parts span several log containers */
+        writeObjects(20000);
+        file.flush();
+        readFollowed(readFile, readTimeStamp, 20000);
+
+        /* end of writing, with restore points and finalized statistics */
+        writeObjects(50);
+        file.close();
+        readFollowed(readFile, readTimeStamp, 50);
+        BOOST_CHECK(readFile.read(50) == nullptr);
+
+        /* close while waiting for growth */
+        readFile.close();
+        BOOST_CHECK(!readFile.is_open());
+
+        /* an object, which is not a log container, ends reading instead of waiting */
+        {
+            std::ofstream os(filename, std::ios_base::out | std::ios_base::binary | std::ios_base::app);
+            const uint32_t objectHeaderBase[4] = { Vector::BLF::ObjectSignature, 0x00010010, 16, static_cast<uint32_t>(Vector::BLF::ObjectType::CAN_MESSAGE) };
+            os.write(reinterpret_cast<const char *>(objectHeaderBase), sizeof(objectHeaderBase));
+        }
+        Vector::BLF::File corruptFile;
+        corruptFile.follow = true;
+        corruptFile.useIoUring = ioUring;
+        corruptFile.open(filename, std::ios_base::in);
+        BOOST_REQUIRE(corruptFile.is_open());
+        readTimeStamp = 0;
+        readFollowed(corruptFile, readTimeStamp, 20150);
+        BOOST_CHECK(corruptFile.read(5000) == nullptr);
+        BOOST_CHECK(corruptFile.eof());
+        corruptFile.close();
+    }
+}
+
+#if !defined(_WIN32)
+/** Read a file from a pipe, which can't seek. */
+BOOST_AUTO_TEST_CASE(Pipe) {
+    for (const bool ioUring : { false, true }) {
+        const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_Pipe.blf";
+        const std::string pipename = CMAKE_CURRENT_BINARY_DIR "/test_Pipe.fifo";
+
+        /* write objects, texts with odd sizes are padded in the log containers */
+        Vector::BLF::File file;
+        file.open(filename, std::ios_base::out);
+        BOOST_REQUIRE(file.is_open());
+        const uint32_t objectCount = 20000;
+        for (uint32_t i = 0; i < objectCount; ++i) {
+            if (i % 2) {
+                auto * appText = new Vector::BLF::AppText;
+                appText->objectTimeStamp = i;
+                appText->text = std::string(i % 7, 'x');
+                file.write(appText);
+            } else {
+                auto * canMessage = new Vector::BLF::CanMessage;
+                canMessage->objectTimeStamp = i;
+                file.write(canMessage);
+            }
+        }
+        file.close();
+
+        /* copy it into a pipe */
+        boost::filesystem::remove(pipename);
+        BOOST_REQUIRE(::mkfifo(pipename.c_str(), 0600) == 0);
+        std::thread writer([&filename, &pipename]() {
+            std::ifstream in(filename, std::ios_base::binary);
+            std::ofstream out(pipename, std::ios_base::binary);
+            out << in.rdbuf();
+        });
+
+        /* read from the pipe */
+        Vector::BLF::File readFile;
+        readFile.useIoUring = ioUring;
+        readFile.open(pipename, std::ios_base::in);
+        BOOST_REQUIRE(readFile.is_open());
+        uint32_t readCount = 0;
+        while (Vector::BLF::ObjectHeaderBase * ohb = readFile.read()) {
+            BOOST_CHECK(ohb->objectType == ((readCount % 2) ? Vector::BLF::ObjectType::APP_TEXT : Vector::BLF::ObjectType::CAN_MESSAGE));
+            if (auto * appText = dynamic_cast<Vector::BLF::AppText *>(ohb))
+                BOOST_CHECK_EQUAL(appText->text, std::string(readCount % 7, 'x'));
+            readCount++;
+            delete ohb;
+        }
+        BOOST_CHECK_EQUAL(readCount, objectCount);
+        readFile.close();
+        writer.join();
+        boost::filesystem::remove(pipename);
+    }
+}
+#endif
@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE FileMetrics
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <Vector/BLF.h>
+
+/** metrics of write and read pipeline */
+BOOST_AUTO_TEST_CASE(WriteRead) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_FileMetrics.blf";
+
+    /* write */
+    {
+        Vector::BLF::File file;
+        file.compressionLevel = 6;
+        file.setDefaultLogContainerSize(0x1000);
+        file.open(filename, std::ios_base::out);
+        BOOST_REQUIRE(file.is_open());
+        for (int i = 0; i < 2000; ++i) {
+            auto * canMessage2 = new Vector::BLF::CanMessage2;
+            canMessage2->data.assign(8, static_cast<uint8_t>(i));
+            file.write(canMessage2);
+        }
+        auto * appText = new Vector::BLF::AppText;
+        appText->text = "metrics";
+        file.write(appText);
+        file.close();
+
+        BOOST_CHECK_EQUAL(file.metrics.objects(Vector::BLF::ObjectType::CAN_MESSAGE2), 2000);
+        BOOST_CHECK_EQUAL(file.metrics.objects(Vector::BLF::ObjectType::APP_TEXT), 1);
+        BOOST_CHECK_EQUAL(file.metrics.objects(Vector::BLF::ObjectType::CAN_MESSAGE), 0);
+        BOOST_CHECK_GT(file.metrics.logContainersDeflated, 1);
+        BOOST_CHECK_EQUAL(file.metrics.logContainersInflated, 0);
+        BOOST_CHECK_EQUAL(file.metrics.compressedBytesRead, 0);
+
+        /* statistics at the start are written twice, so it's at least the file size */
+        BOOST_CHECK_GE(file.metrics.compressedBytesWritten, boost::filesystem::file_size(filename));
+    }
+
+    /* read */
+    Vector::BLF::File file;
+    file.open(filename, std::ios_base::in);
+    BOOST_REQUIRE(file.is_open());
+    uint64_t count = 0;
+    while (Vector::BLF::ObjectHeaderBase * ohb = file.read()) {
+        delete ohb;
+        count++;
+
+        /* readable while threads are running */
+        BOOST_CHECK_LE(file.metrics.objects(Vector::BLF::ObjectType::CAN_MESSAGE2) + file.metrics.objects(Vector::BLF::ObjectType::APP_TEXT), 2001);
+    }
+    BOOST_CHECK_EQUAL(count, 2001);
+    BOOST_CHECK_EQUAL(file.metrics.objects(Vector::BLF::ObjectType::CAN_MESSAGE2), 2000);
+    BOOST_CHECK_GT(file.metrics.logContainersInflated, 1);
+    BOOST_CHECK_EQUAL(file.metrics.logContainersDeflated, 0);
+    BOOST_CHECK_GE(file.metrics.peakLogContainerCount, 1);
+    BOOST_CHECK_GT(file.metrics.compressedBytesRead, 0);
+    BOOST_CHECK_EQUAL(file.metrics.compressedBytesWritten, 0);
+    file.close();
+
+    /* reset */
+    file.metrics.reset();
+    BOOST_CHECK_EQUAL(file.metrics.objects(Vector::BLF::ObjectType::CAN_MESSAGE2), 0);
+    BOOST_CHECK_EQUAL(file.metrics.logContainersInflated, 0);
+    BOOST_CHECK_EQUAL(file.metrics.peakLogContainerCount, 0);
+}
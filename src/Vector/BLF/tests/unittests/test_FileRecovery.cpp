@@ -0,0 +1,135 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE FileRecovery
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <vector>
+
+#include <Vector/BLF.h>
+
+/** count objects of a file */
+static uint32_t countObjects(const std::string & filename) {
+    Vector::BLF::File file;
+    file.open(filename, std::ios_base::in);
+    BOOST_REQUIRE(file.is_open());
+    uint32_t count = 0;
+    while (Vector::BLF::ObjectHeaderBase * ohb = file.read()) {
+        delete ohb;
+        count++;
+    }
+    file.close();
+    return count;
+}
+
+/** recover the files of the error test set */
+BOOST_AUTO_TEST_CASE(ErrorFiles) {
+    Vector::BLF::FileRecovery fileRecovery;
+    Vector::BLF::FileStatistics fileStatistics;
+
+    /* unexisting file */
+    BOOST_CHECK(!fileRecovery.recover(CMAKE_CURRENT_SOURCE_DIR "/errors/FileNotExists.blf", CMAKE_CURRENT_BINARY_DIR "/test_FileRecovery.blf"));
+
+    /* objects outside of log containers */
+    BOOST_REQUIRE(fileRecovery.recover(CMAKE_CURRENT_SOURCE_DIR "/errors/FileWithoutLogContainers.blf", CMAKE_CURRENT_BINARY_DIR "/test_FileRecovery.blf"));
+    BOOST_CHECK_EQUAL(fileRecovery.objects, 2);
+    BOOST_CHECK_EQUAL(fileRecovery.logContainers, 0);
+    BOOST_CHECK_EQUAL(countObjects(CMAKE_CURRENT_BINARY_DIR "/test_FileRecovery.blf"), 2);
+
+    /* truncated zlib stream */
+    BOOST_REQUIRE(fileRecovery.recover(CMAKE_CURRENT_SOURCE_DIR "/errors/FileWithTruncatedCompressedLogContainer.blf", CMAKE_CURRENT_BINARY_DIR "/test_FileRecovery.blf"));
+    BOOST_CHECK_EQUAL(fileRecovery.damagedLogContainers, 1);
+    BOOST_CHECK_GE(fileRecovery.objects, 1);
+    BOOST_CHECK_EQUAL(countObjects(CMAKE_CURRENT_BINARY_DIR "/test_FileRecovery.blf"), fileRecovery.objects);
+
+    /* truncated uncompressed log container */
+    BOOST_REQUIRE(fileRecovery.recover(CMAKE_CURRENT_SOURCE_DIR "/errors/FileWithTruncatedUncompressedLogContainer.blf", CMAKE_CURRENT_BINARY_DIR "/test_FileRecovery.blf"));
+    BOOST_CHECK_EQUAL(fileRecovery.damagedLogContainers, 1);
+    BOOST_CHECK_EQUAL(fileRecovery.objects, 1);
+    BOOST_CHECK_EQUAL(fileRecovery.damagedObjects, 1);
+    BOOST_CHECK_EQUAL(countObjects(CMAKE_CURRENT_BINARY_DIR "/test_FileRecovery.blf"), 1);
+
+    /* truncated object */
+    BOOST_REQUIRE(fileRecovery.recover(CMAKE_CURRENT_SOURCE_DIR "/errors/FileWithTruncatedCanMessage.blf", CMAKE_CURRENT_BINARY_DIR "/test_FileRecovery.blf"));
+    BOOST_CHECK_EQUAL(fileRecovery.objects, 1);
+    BOOST_CHECK_EQUAL(fileRecovery.damagedObjects, 1);
+    BOOST_REQUIRE(Vector::BLF::File::probe(CMAKE_CURRENT_BINARY_DIR "/test_FileRecovery.blf", fileStatistics));
+    BOOST_CHECK_EQUAL(fileStatistics.objectCount, 1);
+
+    /* unknown object type */
+    BOOST_REQUIRE(fileRecovery.recover(CMAKE_CURRENT_SOURCE_DIR "/errors/FileWithUnknownObjectType.blf", CMAKE_CURRENT_BINARY_DIR "/test_FileRecovery.blf"));
+    BOOST_CHECK_EQUAL(fileRecovery.objects, 1);
+    BOOST_CHECK_EQUAL(fileRecovery.unknownObjects, 1);
+}
+
+/** recover a file with a corrupted log container in the middle and a truncated end */
+BOOST_AUTO_TEST_CASE(CorruptedFile) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_FileRecoveryCorrupted.blf";
+    const std::string recoveredFilename = CMAKE_CURRENT_BINARY_DIR "/test_FileRecoveryRecovered.blf";
+
+    /* write file with several log containers */
+    {
+        Vector::BLF::File file;
+        file.compressionLevel = 6;
+        file.setDefaultLogContainerSize(0x1000);
+        file.open(filename, std::ios_base::out);
+        BOOST_REQUIRE(file.is_open());
+        for (int i = 0; i < 2000; ++i) {
+            auto * canMessage2 = new Vector::BLF::CanMessage2;
+            canMessage2->id = static_cast<uint32_t>(i);
+            canMessage2->data.assign(8, static_cast<uint8_t>(i));
+            file.write(canMessage2);
+        }
+        file.close();
+    }
+
+    /* corrupt data in the middle and truncate the end */
+    std::vector<char> data;
+    {
+        std::ifstream ifs(filename, std::ios_base::in | std::ios_base::binary);
+        data.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+    BOOST_REQUIRE_GT(data.size(), 4096);
+    for (std::size_t i = data.size() / 2; i < data.size() / 2 + 64; ++i)
+        data[i] = static_cast<char>(0xA5);
+    data.resize(data.size() - 100);
+    {
+        std::ofstream ofs(filename, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        ofs.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    /* recover */
+    Vector::BLF::FileRecovery fileRecovery;
+    BOOST_REQUIRE(fileRecovery.recover(filename, recoveredFilename));
+    BOOST_CHECK_GT(fileRecovery.logContainers, 1);
+    BOOST_CHECK_GE(fileRecovery.damagedLogContainers, 1);
+    BOOST_CHECK_GT(fileRecovery.objects, 1000);
+    BOOST_CHECK_LT(fileRecovery.objects, 2000);
+
+    /* recovered file is consistent */
+    Vector::BLF::FileStatistics fileStatistics;
+    BOOST_REQUIRE(Vector::BLF::File::probe(recoveredFilename, fileStatistics));
+    BOOST_CHECK_EQUAL(fileStatistics.objectCount, fileRecovery.objects);
+    BOOST_CHECK_EQUAL(fileStatistics.fileSize, boost::filesystem::file_size(recoveredFilename));
+    BOOST_CHECK_EQUAL(countObjects(recoveredFilename), fileRecovery.objects);
+
+    /* objects before the corruption are intact */
+    Vector::BLF::File file;
+    file.open(recoveredFilename, std::ios_base::in);
+    BOOST_REQUIRE(file.is_open());
+    for (uint32_t i = 0; i < 500; ++i) {
+        Vector::BLF::ObjectHeaderBase * ohb = file.read();
+        auto * canMessage2 = dynamic_cast<Vector::BLF::CanMessage2 *>(ohb);
+        BOOST_REQUIRE(canMessage2);
+        BOOST_CHECK_EQUAL(canMessage2->id, i);
+        BOOST_CHECK(canMessage2->data == std::vector<uint8_t>(8, static_cast<uint8_t>(i)));
+        delete ohb;
+    }
+    file.close();
+}
@@ -0,0 +1,153 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE IoUringFile
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include <Vector/BLF.h>
+#include <Vector/BLF/IoUringFile.h>
+
+/** Write with seek, read back with std::ifstream. */
+BOOST_AUTO_TEST_CASE(Write) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_IoUringFile_write.bin";
+
+    /* data spanning several buffers */
+    std::vector<char> data(0x100000 + 123);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<char>(i * 7);
+
+    Vector::BLF::IoUringFile ioUringFile;
+    if (!ioUringFile.open(filename.c_str(), std::ios_base::out)) {
+        BOOST_TEST_MESSAGE("io_uring not available");
+        return;
+    }
+    BOOST_CHECK(ioUringFile.is_open());
+    for (size_t i = 0; i < data.size(); i += 1000)
+        ioUringFile.write(data.data() + i, static_cast<std::streamsize>(std::min<size_t>(1000, data.size() - i)));
+    BOOST_CHECK_EQUAL(ioUringFile.tellp(), static_cast<std::streamoff>(data.size()));
+
+    /* overwrite the beginning, like FileStatistics */
+    ioUringFile.seekp(0);
+    ioUringFile.write("header", 6);
+    BOOST_CHECK(ioUringFile.sync());
+    ioUringFile.close();
+    BOOST_CHECK(!ioUringFile.is_open());
+    data[0] = 'h';
+    data[1] = 'e';
+    data[2] = 'a';
+    data[3] = 'd';
+    data[4] = 'e';
+    data[5] = 'r';
+
+    /* compare */
+    std::ifstream ifs(filename, std::ios_base::binary);
+    std::vector<char> content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    BOOST_CHECK(content == data);
+}
+
+/** Read ahead with seeks and end of file. */
+BOOST_AUTO_TEST_CASE(Read) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_IoUringFile_read.bin";
+
+    std::vector<char> data(0x180000 + 45);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<char>(i * 13);
+    {
+        std::ofstream ofs(filename, std::ios_base::binary);
+        ofs.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    Vector::BLF::IoUringFile ioUringFile;
+    if (!ioUringFile.open(filename.c_str(), std::ios_base::in)) {
+        BOOST_TEST_MESSAGE("io_uring not available");
+        return;
+    }
+
+    /* sequential */
+    std::vector<char> content(data.size());
+    for (size_t i = 0; i < content.size(); i += 5000) {
+        const std::streamsize n = static_cast<std::streamsize>(std::min<size_t>(5000, content.size() - i));
+        ioUringFile.read(content.data() + i, n);
+        BOOST_REQUIRE_EQUAL(ioUringFile.gcount(), n);
+    }
+    BOOST_CHECK(content == data);
+    BOOST_CHECK(ioUringFile.good());
+
+    /* backward and forward seeks */
+    char c;
+    ioUringFile.seekg(10, std::ios_base::beg);
+    ioUringFile.read(&c, 1);
+    BOOST_CHECK_EQUAL(c, data[10]);
+    ioUringFile.seekg(0x100000, std::ios_base::cur);
+    BOOST_CHECK_EQUAL(ioUringFile.tellg(), 0x100000 + 11);
+    ioUringFile.read(&c, 1);
+    BOOST_CHECK_EQUAL(c, data[0x100000 + 11]);
+
+    /* end of file */
+    std::vector<char> rest(100);
+    ioUringFile.seekg(-10, std::ios_base::end);
+    ioUringFile.read(rest.data(), 100);
+    BOOST_CHECK_EQUAL(ioUringFile.gcount(), 10);
+    BOOST_CHECK(ioUringFile.eof());
+    BOOST_CHECK(!ioUringFile.good());
+    ioUringFile.close();
+}
+
+/** File roundtrip using io_uring. */
+BOOST_AUTO_TEST_CASE(File) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_IoUringFile.blf";
+    const uint32_t objectCount = 50000;
+
+    /* write */
+    Vector::BLF::File file;
+    file.useIoUring = true;
+    file.open(filename, std::ios_base::out);
+    BOOST_REQUIRE(file.is_open());
+    for (uint32_t i = 0; i < objectCount; ++i) {
+        auto * canMessage = new Vector::BLF::CanMessage;
+        canMessage->channel = 1;
+        canMessage->id = i & 0x7ff;
+        canMessage->objectTimeStamp = i;
+        file.write(canMessage);
+    }
+    file.close();
+
+    /* read */
+    Vector::BLF::File readFile;
+    readFile.useIoUring = true;
+    readFile.open(filename, std::ios_base::in);
+    BOOST_REQUIRE(readFile.is_open());
+    BOOST_CHECK_EQUAL(readFile.fileStatistics.objectCount, objectCount);
+    uint32_t count = 0;
+    while (Vector::BLF::ObjectHeaderBase * ohb = readFile.read()) {
+        auto * canMessage = dynamic_cast<Vector::BLF::CanMessage *>(ohb);
+        BOOST_REQUIRE(canMessage);
+        BOOST_CHECK_EQUAL(canMessage->objectTimeStamp, count);
+        delete ohb;
+        count++;
+    }
+    BOOST_CHECK_EQUAL(count, objectCount);
+    readFile.close();
+}
+
+/** Pipes are not opened, and opening them doesn't wait for a writer. */
+BOOST_AUTO_TEST_CASE(Pipe) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_IoUringFile.fifo";
+    boost::filesystem::remove(filename);
+    BOOST_REQUIRE_EQUAL(::mkfifo(filename.c_str(), 0600), 0);
+
+    Vector::BLF::IoUringFile ioUringFile;
+    BOOST_CHECK(!ioUringFile.open(filename.c_str(), std::ios_base::in));
+    BOOST_CHECK(!ioUringFile.is_open());
+    boost::filesystem::remove(filename);
+}
@@ -0,0 +1,170 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE IsoTpReassembler
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <Vector/BLF.h>
+
+/** received PDUs */
+struct Pdus {
+    std::vector<Vector::BLF::IsoTpReassembler::Pdu> pdus;
+    std::vector<std::vector<uint8_t>> data;
+
+    void operator()(const Vector::BLF::IsoTpReassembler::Pdu & pdu) {
+        pdus.push_back(pdu);
+        data.push_back(std::vector<uint8_t>(pdu.data, pdu.data + pdu.size));
+    }
+};
+
+/** create a CanMessage2 */
+Vector::BLF::CanMessage2 * canMessage2(uint32_t id, std::vector<uint8_t> data, uint64_t timeStamp) {
+    auto * obj = new Vector::BLF::CanMessage2;
+    obj->channel = 1;
+    obj->id = id;
+    obj->dlc = static_cast<uint8_t>(data.size());
+    obj->data = data;
+    obj->objectTimeStamp = timeStamp;
+    return obj;
+}
+
+/** single frame and multi frame reassembly with normal addressing */
+BOOST_AUTO_TEST_CASE(NormalAddressing) {
+    Pdus pdus;
+    Vector::BLF::IsoTpReassembler reassembler(std::ref(pdus));
+    reassembler.addConnection(1, 0x7E0, 0x7E8);
+    reassembler.addConnection(1, 0x7E8, 0x7E0);
+
+    /* single frame request */
+    std::unique_ptr<Vector::BLF::CanMessage2> obj(canMessage2(0x7E0, { 0x02, 0x10, 0x03, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA }, 1000));
+    reassembler.process(obj.get());
+    BOOST_REQUIRE_EQUAL(pdus.pdus.size(), 1);
+    BOOST_CHECK_EQUAL(pdus.pdus[0].txId, 0x7E0);
+    BOOST_CHECK_EQUAL(pdus.pdus[0].startTimeStamp, 1000);
+    BOOST_CHECK_EQUAL(pdus.pdus[0].endTimeStamp, 1000);
+    BOOST_CHECK(pdus.data[0] == std::vector<uint8_t>({ 0x10, 0x03 }));
+
+    /* multi frame response with 20 bytes */
+    obj.reset(canMessage2(0x7E8, { 0x10, 0x14, 0x62, 0xF1, 0x90, 0x01, 0x02, 0x03 }, 2000));
+    reassembler.process(obj.get());
+    obj.reset(canMessage2(0x7E0, { 0x30, 0x00, 0x00, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA }, 2500)); // flow control
+    reassembler.process(obj.get());
+    obj.reset(canMessage2(0x7E8, { 0x21, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A }, 3000));
+    reassembler.process(obj.get());
+    BOOST_CHECK_EQUAL(pdus.pdus.size(), 1);
+    obj.reset(canMessage2(0x7E8, { 0x22, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11 }, 4000));
+    reassembler.process(obj.get());
+    BOOST_REQUIRE_EQUAL(pdus.pdus.size(), 2);
+    BOOST_CHECK_EQUAL(pdus.pdus[1].txId, 0x7E8);
+    BOOST_CHECK_EQUAL(pdus.pdus[1].rxId, 0x7E0);
+    BOOST_CHECK_EQUAL(pdus.pdus[1].startTimeStamp, 2000);
+    BOOST_CHECK_EQUAL(pdus.pdus[1].endTimeStamp, 4000);
+    BOOST_REQUIRE_EQUAL(pdus.data[1].size(), 20);
+    BOOST_CHECK_EQUAL(pdus.data[1][0], 0x62);
+    BOOST_CHECK_EQUAL(pdus.data[1][19], 0x11);
+    BOOST_CHECK_EQUAL(reassembler.errorCount(), 0);
+
+    /* sequence error */
+    obj.reset(canMessage2(0x7E8, { 0x10, 0x14, 0x62, 0xF1, 0x90, 0x01, 0x02, 0x03 }, 5000));
+    reassembler.process(obj.get());
+    obj.reset(canMessage2(0x7E8, { 0x22, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A }, 6000));
+    reassembler.process(obj.get());
+    BOOST_CHECK_EQUAL(reassembler.errorCount(), 1);
+
+    /* unexpected consecutive frame */
+    obj.reset(canMessage2(0x7E8, { 0x23, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A }, 7000));
+    reassembler.process(obj.get());
+    BOOST_CHECK_EQUAL(reassembler.errorCount(), 2);
+    BOOST_CHECK_EQUAL(pdus.pdus.size(), 2);
+
+    /* unknown ids are ignored */
+    obj.reset(canMessage2(0x123, { 0x02, 0x10, 0x03 }, 8000));
+    reassembler.process(obj.get());
+    BOOST_CHECK_EQUAL(pdus.pdus.size(), 2);
+}
+
+/** extended addressing and too large PDUs */
+BOOST_AUTO_TEST_CASE(ExtendedAddressing) {
+    Pdus pdus;
+    Vector::BLF::IsoTpReassembler reassembler(std::ref(pdus));
+    reassembler.addConnection(1, 0x600, 0x601, Vector::BLF::IsoTpReassembler::AddressingMode::Extended, 0x55, 10);
+
+    /* single frame to other target address is ignored */
+    std::unique_ptr<Vector::BLF::CanMessage2> obj(canMessage2(0x600, { 0x66, 0x02, 0x10, 0x03 }, 1000));
+    reassembler.process(obj.get());
+    BOOST_CHECK_EQUAL(pdus.pdus.size(), 0);
+
+    /* multi frame */
+    obj.reset(canMessage2(0x600, { 0x55, 0x10, 0x08, 0x01, 0x02, 0x03, 0x04, 0x05 }, 2000));
+    reassembler.process(obj.get());
+    obj.reset(canMessage2(0x600, { 0x55, 0x21, 0x06, 0x07, 0x08, 0xCC, 0xCC, 0xCC }, 3000));
+    reassembler.process(obj.get());
+    BOOST_REQUIRE_EQUAL(pdus.pdus.size(), 1);
+    BOOST_CHECK_EQUAL(pdus.pdus[0].address, 0x55);
+    BOOST_CHECK(pdus.data[0] == std::vector<uint8_t>({ 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 }));
+
+    /* PDU larger than maxPduSize */
+    obj.reset(canMessage2(0x600, { 0x55, 0x10, 0x20, 0x01, 0x02, 0x03, 0x04, 0x05 }, 4000));
+    reassembler.process(obj.get());
+    BOOST_CHECK_EQUAL(reassembler.errorCount(), 1);
+
+    /* flow control overflow aborts reception */
+    obj.reset(canMessage2(0x600, { 0x55, 0x10, 0x08, 0x01, 0x02, 0x03, 0x04, 0x05 }, 5000));
+    reassembler.process(obj.get());
+    obj.reset(canMessage2(0x601, { 0xF1, 0x32, 0x00, 0x00 }, 5500));
+    reassembler.process(obj.get());
+    BOOST_CHECK_EQUAL(reassembler.errorCount(), 2);
+    obj.reset(canMessage2(0x600, { 0x55, 0x21, 0x06, 0x07, 0x08, 0xCC, 0xCC, 0xCC }, 6000));
+    reassembler.process(obj.get());
+    BOOST_CHECK_EQUAL(pdus.pdus.size(), 1);
+}
+
+/** CAN FD escape sequences */
+BOOST_AUTO_TEST_CASE(CanFd) {
+    Pdus pdus;
+    Vector::BLF::IsoTpReassembler reassembler(std::ref(pdus));
+    reassembler.addConnection(2, 0x80000700, 0x80000708, Vector::BLF::IsoTpReassembler::AddressingMode::Normal, 0, 8000);
+
+    /* single frame with escape sequence */
+    Vector::BLF::CanFdMessage64 canFdMessage64;
+    canFdMessage64.channel = 2;
+    canFdMessage64.id = 0x80000700;
+    canFdMessage64.flags = 0x1000; // EDL
+    canFdMessage64.data.resize(64, 0xCC);
+    canFdMessage64.validDataBytes = 64;
+    canFdMessage64.data[0] = 0x00;
+    canFdMessage64.data[1] = 62;
+    canFdMessage64.objectTimeStamp = 1000;
+    reassembler.process(&canFdMessage64);
+    BOOST_REQUIRE_EQUAL(pdus.pdus.size(), 1);
+    BOOST_CHECK_EQUAL(pdus.pdus[0].size, 62);
+
+    /* first frame with escape sequence (5000 bytes) */
+    canFdMessage64.data[0] = 0x10;
+    canFdMessage64.data[1] = 0x00;
+    canFdMessage64.data[2] = 0x00;
+    canFdMessage64.data[3] = 0x00;
+    canFdMessage64.data[4] = 0x13;
+    canFdMessage64.data[5] = 0x88;
+    canFdMessage64.objectTimeStamp = 2000;
+    reassembler.process(&canFdMessage64);
+    uint32_t received = 58;
+    uint8_t sequenceNumber = 1;
+    while (received < 5000) {
+        canFdMessage64.data[0] = 0x20 | sequenceNumber;
+        canFdMessage64.objectTimeStamp += 100;
+        reassembler.process(&canFdMessage64);
+        sequenceNumber = (sequenceNumber + 1) & 0x0f;
+        received += 63;
+    }
+    BOOST_REQUIRE_EQUAL(pdus.pdus.size(), 2);
+    BOOST_CHECK_EQUAL(pdus.pdus[1].size, 5000);
+    BOOST_CHECK_EQUAL(pdus.pdus[1].startTimeStamp, 2000);
+    BOOST_CHECK_EQUAL(pdus.pdus[1].endTimeStamp, canFdMessage64.objectTimeStamp);
+    BOOST_CHECK_EQUAL(reassembler.errorCount(), 0);
+}
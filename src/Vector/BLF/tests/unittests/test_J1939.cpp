@@ -0,0 +1,176 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE J1939
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <Vector/BLF.h>
+
+/** received messages */
+struct Messages {
+    std::vector<Vector::BLF::J1939::Message> messages;
+    std::vector<std::vector<uint8_t>> data;
+
+    void operator()(const Vector::BLF::J1939::Message & message) {
+        messages.push_back(message);
+        data.push_back(std::vector<uint8_t>(message.data, message.data + message.size));
+    }
+};
+
+/** received J1708 frames */
+struct J1708Frames {
+    std::vector<Vector::BLF::J1939::J1708Frame> frames;
+
+    void operator()(const Vector::BLF::J1939::J1708Frame & frame) {
+        frames.push_back(frame);
+    }
+};
+
+/** send a frame */
+void send(Vector::BLF::J1939 & j1939, uint32_t id, std::vector<uint8_t> data, uint64_t timeStamp) {
+    Vector::BLF::CanMessage2 canMessage2;
+    canMessage2.channel = 1;
+    canMessage2.id = 0x80000000 | id;
+    canMessage2.dlc = static_cast<uint8_t>(data.size());
+    canMessage2.data = data;
+    canMessage2.objectTimeStamp = timeStamp;
+    j1939.process(&canMessage2);
+}
+
+/** ID parsing */
+BOOST_AUTO_TEST_CASE(ParseId) {
+    uint8_t priority;
+    uint32_t pgn;
+    uint8_t sourceAddress;
+    uint8_t destinationAddress;
+
+    /* EEC1 (PDU2) */
+    Vector::BLF::J1939::parseId(0x0CF00400, priority, pgn, sourceAddress, destinationAddress);
+    BOOST_CHECK_EQUAL(priority, 3);
+    BOOST_CHECK_EQUAL(pgn, 0xF004);
+    BOOST_CHECK_EQUAL(sourceAddress, 0x00);
+    BOOST_CHECK_EQUAL(destinationAddress, 0xFF);
+
+    /* request (PDU1) */
+    Vector::BLF::J1939::parseId(0x18EA00F9, priority, pgn, sourceAddress, destinationAddress);
+    BOOST_CHECK_EQUAL(priority, 6);
+    BOOST_CHECK_EQUAL(pgn, 0xEA00);
+    BOOST_CHECK_EQUAL(sourceAddress, 0xF9);
+    BOOST_CHECK_EQUAL(destinationAddress, 0x00);
+
+    /* data page */
+    Vector::BLF::J1939::parseId(0x19FEF100, priority, pgn, sourceAddress, destinationAddress);
+    BOOST_CHECK_EQUAL(pgn, 0x1FEF1);
+}
+
+/** broadcast announce message */
+BOOST_AUTO_TEST_CASE(Bam) {
+    Messages messages;
+    Vector::BLF::J1939 j1939(std::ref(messages));
+
+    /* single frame */
+    send(j1939, 0x0CF00400, { 0xF0, 0xFF, 0x7D, 0x40, 0x1F, 0x00, 0xFF, 0xFF }, 1000);
+    BOOST_REQUIRE_EQUAL(messages.messages.size(), 1);
+    BOOST_CHECK_EQUAL(messages.messages[0].pgn, 0xF004);
+
+    /* DM1 with 10 bytes */
+    send(j1939, 0x18ECFF00, { 0x20, 0x0A, 0x00, 0x02, 0xFF, 0xCA, 0xFE, 0x00 }, 2000);
+    send(j1939, 0x18EBFF00, { 0x01, 0x00, 0xFF, 0x01, 0x02, 0x03, 0x04, 0x05 }, 3000);
+    BOOST_CHECK_EQUAL(messages.messages.size(), 1);
+    send(j1939, 0x18EBFF00, { 0x02, 0x06, 0x07, 0x08, 0xFF, 0xFF, 0xFF, 0xFF }, 4000);
+    BOOST_REQUIRE_EQUAL(messages.messages.size(), 2);
+    BOOST_CHECK_EQUAL(messages.messages[1].pgn, 0xFECA);
+    BOOST_CHECK_EQUAL(messages.messages[1].sourceAddress, 0x00);
+    BOOST_CHECK_EQUAL(messages.messages[1].destinationAddress, 0xFF);
+    BOOST_CHECK_EQUAL(messages.messages[1].startTimeStamp, 2000);
+    BOOST_CHECK_EQUAL(messages.messages[1].endTimeStamp, 4000);
+    BOOST_CHECK(messages.data[1] == std::vector<uint8_t>({ 0x00, 0xFF, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 }));
+    BOOST_CHECK_EQUAL(j1939.errorCount(), 0);
+
+    /* sequence error */
+    send(j1939, 0x18ECFF00, { 0x20, 0x0A, 0x00, 0x02, 0xFF, 0xCA, 0xFE, 0x00 }, 5000);
+    send(j1939, 0x18EBFF00, { 0x02, 0x06, 0x07, 0x08, 0xFF, 0xFF, 0xFF, 0xFF }, 6000);
+    BOOST_CHECK_EQUAL(j1939.errorCount(), 1);
+    BOOST_CHECK_EQUAL(messages.messages.size(), 2);
+
+    /* index */
+    std::map<uint32_t, Vector::BLF::J1939::IndexEntry> pgnIndex = j1939.pgnIndex(1);
+    BOOST_REQUIRE_EQUAL(pgnIndex.size(), 2);
+    BOOST_CHECK_EQUAL(pgnIndex[0xF004].count, 1);
+    BOOST_CHECK_EQUAL(pgnIndex[0xFECA].count, 1);
+    BOOST_CHECK_EQUAL(pgnIndex[0xFECA].firstTimeStamp, 4000);
+    BOOST_CHECK(j1939.pgnIndex(2).empty());
+}
+
+/** connection mode data transfer */
+BOOST_AUTO_TEST_CASE(RtsCts) {
+    Messages messages;
+    Vector::BLF::J1939 j1939(std::ref(messages));
+    j1939.setPgnFilter({ 0xFEE5 });
+
+    /* filtered single frame */
+    send(j1939, 0x0CF00400, { 0xF0, 0xFF, 0x7D, 0x40, 0x1F, 0x00, 0xFF, 0xFF }, 1000);
+    BOOST_CHECK_EQUAL(messages.messages.size(), 0);
+
+    /* 16 bytes from 0x00 to 0xF9, 2 packets per CTS, with retransmission */
+    send(j1939, 0x1CECF900, { 0x10, 0x10, 0x00, 0x03, 0x02, 0xE5, 0xFE, 0x00 }, 2000);
+    send(j1939, 0x1CEC00F9, { 0x11, 0x02, 0x01, 0xFF, 0xFF, 0xE5, 0xFE, 0x00 }, 2100);
+    send(j1939, 0x1CEBF900, { 0x01, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 }, 2200);
+    send(j1939, 0x1CEC00F9, { 0x11, 0x02, 0x01, 0xFF, 0xFF, 0xE5, 0xFE, 0x00 }, 2300);
+    send(j1939, 0x1CEBF900, { 0x01, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 }, 2400);
+    send(j1939, 0x1CEBF900, { 0x02, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E }, 2500);
+    send(j1939, 0x1CEC00F9, { 0x11, 0x01, 0x03, 0xFF, 0xFF, 0xE5, 0xFE, 0x00 }, 2600);
+    send(j1939, 0x1CEBF900, { 0x03, 0x0F, 0x10, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF }, 2700);
+    BOOST_REQUIRE_EQUAL(messages.messages.size(), 1);
+    BOOST_CHECK_EQUAL(messages.messages[0].pgn, 0xFEE5);
+    BOOST_CHECK_EQUAL(messages.messages[0].destinationAddress, 0xF9);
+    BOOST_REQUIRE_EQUAL(messages.data[0].size(), 16);
+    BOOST_CHECK_EQUAL(messages.data[0][15], 0x10);
+    BOOST_CHECK_EQUAL(j1939.errorCount(), 0);
+
+    /* abort by receiver */
+    send(j1939, 0x1CECF900, { 0x10, 0x10, 0x00, 0x03, 0x02, 0xE5, 0xFE, 0x00 }, 3000);
+    send(j1939, 0x1CEC00F9, { 0xFF, 0x01, 0xFF, 0xFF, 0xFF, 0xE5, 0xFE, 0x00 }, 3100);
+    BOOST_CHECK_EQUAL(j1939.errorCount(), 1);
+    send(j1939, 0x1CEBF900, { 0x01, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 }, 3200);
+    BOOST_CHECK_EQUAL(j1939.errorCount(), 2);
+}
+
+/** J1708 in the same pass */
+BOOST_AUTO_TEST_CASE(J1708) {
+    Messages messages;
+    J1708Frames frames;
+    Vector::BLF::J1939 j1939(std::ref(messages), std::ref(frames));
+
+    Vector::BLF::J1708Message j1708Message;
+    j1708Message.channel = 3;
+    j1708Message.objectTimeStamp = 1000;
+    j1708Message.data[0] = 0x80; // MID 128
+    j1708Message.data[1] = 0x54; // PID 84
+    j1708Message.data[2] = 0x64;
+    j1708Message.data[3] = static_cast<uint8_t>(-(0x80 + 0x54 + 0x64));
+    j1708Message.size = 4;
+    j1939.process(&j1708Message);
+
+    BOOST_REQUIRE_EQUAL(frames.frames.size(), 1);
+    BOOST_CHECK_EQUAL(frames.frames[0].channel, 3);
+    BOOST_CHECK_EQUAL(frames.frames[0].mid, 0x80);
+    BOOST_CHECK(frames.frames[0].checksumValid);
+    BOOST_CHECK_EQUAL(frames.frames[0].size, 2);
+    BOOST_CHECK_EQUAL(frames.frames[0].data[0], 0x54);
+
+    /* invalid checksum */
+    j1708Message.data[3] = 0;
+    j1939.process(&j1708Message);
+    BOOST_REQUIRE_EQUAL(frames.frames.size(), 2);
+    BOOST_CHECK(!frames.frames[1].checksumValid);
+    BOOST_CHECK_EQUAL(frames.frames[1].size, 3);
+
+    BOOST_CHECK_EQUAL(j1939.midIndex(3)[0x80].count, 2);
+    BOOST_CHECK_EQUAL(messages.messages.size(), 0);
+}
@@ -0,0 +1,153 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE Mdf4Writer
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+
+#include <Vector/BLF.h>
+
+/** read value from file content */
+template<typename T>
+T get(const std::vector<char> & content, const uint64_t position) {
+    BOOST_REQUIRE(position + sizeof(T) <= content.size());
+    T value;
+    std::memcpy(&value, content.data() + position, sizeof(T));
+    return value;
+}
+
+/** check block id and get link */
+uint64_t link(const std::vector<char> & content, const uint64_t block, const char * id, const uint64_t index) {
+    BOOST_REQUIRE(std::string(content.data() + block, 4) == std::string("##") + id);
+    BOOST_REQUIRE(index < get<uint64_t>(content, block + 16));
+    return get<uint64_t>(content, block + 24 + 8 * index);
+}
+
+/** get text of a TX block */
+std::string text(const std::vector<char> & content, const uint64_t block) {
+    BOOST_REQUIRE(std::string(content.data() + block, 4) == "##TX");
+    return std::string(content.data() + block + 24);
+}
+
+/** write a few bus objects, return cycle counts by group name */
+std::map<std::string, uint64_t> writeAndCheck(const std::string & filename, const int compressionLevel) {
+    {
+        Vector::BLF::Mdf4Writer mdf4Writer(filename, compressionLevel, 1024);
+        mdf4Writer.setStartTime(1609556400000000000ULL);
+
+        /* enough CAN frames to fill several data blocks */
+        for (int i = 0; i < 100; ++i) {
+            auto * canMessage2 = new Vector::BLF::CanMessage2;
+            canMessage2->objectTimeStamp = 1000000 * i;
+            canMessage2->channel = 1;
+            canMessage2->id = 0x80000123;
+            canMessage2->dlc = 8;
+            canMessage2->data.assign(8, 0x55);
+            mdf4Writer.write(canMessage2);
+            delete canMessage2;
+        }
+
+        /* remote frame is not written */
+        auto * canMessage = new Vector::BLF::CanMessage;
+        canMessage->flags = 0x80;
+        mdf4Writer.write(canMessage);
+        delete canMessage;
+
+        auto * canFdMessage64 = new Vector::BLF::CanFdMessage64;
+        canFdMessage64->channel = 2;
+        canFdMessage64->flags = 0x3000;
+        canFdMessage64->dlc = 15;
+        canFdMessage64->validDataBytes = 64;
+        canFdMessage64->data.assign(64, 0xAA);
+        mdf4Writer.write(canFdMessage64);
+        delete canFdMessage64;
+
+        auto * linMessage = new Vector::BLF::LinMessage;
+        linMessage->channel = 1;
+        linMessage->id = 0x11;
+        linMessage->dlc = 2;
+        mdf4Writer.write(linMessage);
+        delete linMessage;
+
+        auto * flexRayVFrReceiveMsg = new Vector::BLF::FlexRayVFrReceiveMsg;
+        flexRayVFrReceiveMsg->channel = 1;
+        flexRayVFrReceiveMsg->frameId = 5;
+        flexRayVFrReceiveMsg->dataCount = 16;
+        mdf4Writer.write(flexRayVFrReceiveMsg);
+        delete flexRayVFrReceiveMsg;
+
+        for (int i = 0; i < 3; ++i) {
+            auto * ethernetFrameEx = new Vector::BLF::EthernetFrameEx;
+            ethernetFrameEx->channel = 1;
+            ethernetFrameEx->frameData.assign(600, static_cast<uint8_t>(i));
+            mdf4Writer.write(ethernetFrameEx);
+            delete ethernetFrameEx;
+        }
+
+        /* unsupported objects are ignored */
+        auto * appText = new Vector::BLF::AppText;
+        mdf4Writer.write(appText);
+        delete appText;
+    }
+
+    std::ifstream is(filename, std::ios_base::binary);
+    const std::vector<char> content((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+
+    /* IDBLOCK */
+    BOOST_REQUIRE(content.size() > 64);
+    BOOST_CHECK(std::string(content.data(), 8) == "MDF     ");
+    BOOST_CHECK(std::string(content.data() + 8, 8) == "4.10    ");
+    BOOST_CHECK_EQUAL(get<uint16_t>(content, 28), 410);
+
+    /* HDBLOCK */
+    const uint64_t header = 64;
+    BOOST_CHECK_NE(link(content, header, "HD", 1), 0);
+    BOOST_CHECK_EQUAL(get<uint64_t>(content, header + 24 + 6 * 8), 1609556400000000000ULL);
+
+    /* walk data groups */
+    std::map<std::string, uint64_t> cycleCounts;
+    for (uint64_t dataGroup = link(content, header, "HD", 0); dataGroup != 0; dataGroup = link(content, dataGroup, "DG", 0)) {
+        const uint64_t channelGroup = link(content, dataGroup, "DG", 1);
+        const uint64_t data = link(content, dataGroup, "DG", 2);
+        BOOST_CHECK_NE(data, 0);
+        BOOST_CHECK_EQUAL(get<uint32_t>(content, data) & 0xFFFF, 0x2323);
+        const std::string name = text(content, link(content, channelGroup, "CG", 2));
+        const uint64_t timeStamp = link(content, channelGroup, "CG", 1);
+        BOOST_CHECK_EQUAL(text(content, link(content, timeStamp, "CN", 2)), "Timestamp");
+        const uint64_t structure = link(content, timeStamp, "CN", 0);
+        BOOST_CHECK_NE(link(content, structure, "CN", 1), 0);
+        cycleCounts[name] = get<uint64_t>(content, channelGroup + 24 + 6 * 8 + 8);
+    }
+    return cycleCounts;
+}
+
+/** write uncompressed data blocks */
+BOOST_AUTO_TEST_CASE(WriteUncompressed) {
+    const std::map<std::string, uint64_t> cycleCounts = writeAndCheck(CMAKE_CURRENT_BINARY_DIR "/test_Mdf4Writer.mf4", 0);
+    BOOST_REQUIRE_EQUAL(cycleCounts.size(), 4);
+    BOOST_CHECK_EQUAL(cycleCounts.at("CAN"), 101);
+    BOOST_CHECK_EQUAL(cycleCounts.at("LIN"), 1);
+    BOOST_CHECK_EQUAL(cycleCounts.at("FlexRay"), 1);
+    BOOST_CHECK_EQUAL(cycleCounts.at("Ethernet"), 3);
+}
+
+/** write compressed data blocks */
+BOOST_AUTO_TEST_CASE(WriteCompressed) {
+    const std::string compressedFilename = CMAKE_CURRENT_BINARY_DIR "/test_Mdf4Writer_dz.mf4";
+    const std::map<std::string, uint64_t> cycleCounts = writeAndCheck(compressedFilename, 6);
+    BOOST_REQUIRE_EQUAL(cycleCounts.size(), 4);
+    BOOST_CHECK_EQUAL(cycleCounts.at("CAN"), 101);
+    BOOST_CHECK_EQUAL(cycleCounts.at("Ethernet"), 3);
+
+    /* repetitive data compresses well */
+    BOOST_CHECK_LT(boost::filesystem::file_size(compressedFilename), boost::filesystem::file_size(CMAKE_CURRENT_BINARY_DIR "/test_Mdf4Writer.mf4"));
+}
@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE MultiProducerWriter
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <Vector/BLF.h>
+
+/** create CanMessage2 with channel and timestamp */
+static Vector::BLF::CanMessage2 * canMessage2(const uint16_t channel, const uint64_t timeStamp) {
+    auto * canMessage2 = new Vector::BLF::CanMessage2;
+    canMessage2->channel = channel;
+    canMessage2->objectTimeStamp = timeStamp;
+    return canMessage2;
+}
+
+/** read file and check that the objects are complete and in order */
+static void checkFile(const std::string & filename, const uint32_t objectCount) {
+    Vector::BLF::File file;
+    file.open(filename, std::ios_base::in);
+    BOOST_REQUIRE(file.is_open());
+    uint32_t count = 0;
+    uint64_t timeStamp = 0;
+    while (Vector::BLF::ObjectHeaderBase * ohb = file.read()) {
+        auto * canMessage2 = dynamic_cast<Vector::BLF::CanMessage2 *>(ohb);
+        BOOST_REQUIRE(canMessage2);
+        BOOST_CHECK_GE(canMessage2->objectTimeStamp, timeStamp);
+        timeStamp = canMessage2->objectTimeStamp;
+        delete ohb;
+        count++;
+    }
+    BOOST_CHECK_EQUAL(count, objectCount);
+    file.close();
+}
+
+/** Objects of several producers are merged by timestamp. */
+BOOST_AUTO_TEST_CASE(MergeProducers) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_MultiProducerWriter.blf";
+    const uint16_t producerCount = 4;
+    const uint32_t objectsPerProducer = 5000;
+
+    Vector::BLF::File file;
+    file.open(filename, std::ios_base::out);
+    BOOST_REQUIRE(file.is_open());
+
+    Vector::BLF::MultiProducerWriter writer(file);
+    writer.reorderWindow = 1000;
+    writer.open();
+    BOOST_CHECK(writer.is_open());
+
+    /* interleaved timestamps, each producer writes 8 objects late after 2 newer ones */
+    std::vector<std::thread> threads;
+    for (uint16_t channel = 0; channel < producerCount; ++channel) {
+        Vector::BLF::MultiProducerWriter::Producer * producer = writer.producer();
+        threads.emplace_back([producer, channel, producerCount, objectsPerProducer] {
+            for (uint32_t i = 0; i < objectsPerProducer; i += 10) {
+                for (uint32_t j = 0; j < 10; ++j) {
+                    const uint32_t k = (j < 2) ? j + 8 : j - 2;
+                    producer->write(canMessage2(channel, (uint64_t(i + k) * producerCount + channel) * 1000));
+                }
+            }
+        });
+    }
+    for (std::thread & thread : threads)
+        thread.join();
+
+    writer.close();
+    BOOST_CHECK(!writer.is_open());
+    BOOST_CHECK_EQUAL(writer.lateObjects(), 0);
+    file.close();
+
+    checkFile(filename, producerCount * objectsPerProducer);
+}
+
+/** Objects older than the reorder window are written anyway. */
+BOOST_AUTO_TEST_CASE(LateObjects) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_MultiProducerWriter_late.blf";
+
+    Vector::BLF::File file;
+    file.open(filename, std::ios_base::out);
+    BOOST_REQUIRE(file.is_open());
+
+    Vector::BLF::MultiProducerWriter writer(file);
+    writer.reorderWindow = 1;
+    writer.open();
+    Vector::BLF::MultiProducerWriter::Producer * producer = writer.producer();
+
+    /* newer object pushes the first one out of the reorder window */
+    producer->write(canMessage2(0, 1000));
+    producer->write(canMessage2(0, 10000000));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    producer->write(canMessage2(0, 2000));
+    writer.close();
+    BOOST_CHECK_EQUAL(writer.lateObjects(), 1);
+    file.close();
+
+    /* all objects are written */
+    Vector::BLF::File readFile;
+    readFile.open(filename, std::ios_base::in);
+    uint32_t count = 0;
+    while (Vector::BLF::ObjectHeaderBase * ohb = readFile.read()) {
+        delete ohb;
+        count++;
+    }
+    BOOST_CHECK_EQUAL(count, 3);
+}
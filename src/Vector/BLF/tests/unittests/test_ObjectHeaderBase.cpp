@@ -25,3 +25,30 @@ BOOST_AUTO_TEST_CASE(WrongSignature) {
     Vector::BLF::ObjectHeaderBase ohb2(1, Vector::BLF::ObjectType::UNKNOWN);
     BOOST_CHECK_THROW(ohb2.read(file), Vector::BLF::Exception);
 }
+
+/** timestamps in ns for both object header versions */
+BOOST_AUTO_TEST_CASE(ObjectTimeStampNs) {
+    /* ObjectHeader */
+    Vector::BLF::CanMessage canMessage;
+    BOOST_REQUIRE(dynamic_cast<Vector::BLF::ObjectHeader *>(&canMessage));
+    canMessage.objectFlags = Vector::BLF::ObjectHeader::ObjectFlags::TimeTenMics;
+    canMessage.objectTimeStamp = 5;
+    BOOST_CHECK_EQUAL(Vector::BLF::objectTimeStampNs(canMessage), 50000);
+    canMessage.objectFlags = Vector::BLF::ObjectHeader::ObjectFlags::TimeOneNans;
+    BOOST_CHECK_EQUAL(Vector::BLF::objectTimeStampNs(canMessage), 5);
+
+    /* ObjectHeader2, the original timestamp is not used */
+    Vector::BLF::Most150Message most150Message;
+    BOOST_REQUIRE(dynamic_cast<Vector::BLF::ObjectHeader2 *>(&most150Message));
+    most150Message.objectFlags = Vector::BLF::ObjectHeader2::ObjectFlags::TimeTenMics;
+    most150Message.objectTimeStamp = 7;
+    most150Message.timeStampStatus = Vector::BLF::ObjectHeader2::TimeStampStatus::Orig;
+    most150Message.originalTimeStamp = 3;
+    BOOST_CHECK_EQUAL(Vector::BLF::objectTimeStampNs(most150Message), 70000);
+    most150Message.objectFlags = Vector::BLF::ObjectHeader2::ObjectFlags::TimeOneNans;
+    BOOST_CHECK_EQUAL(Vector::BLF::objectTimeStampNs(most150Message), 7);
+
+    /* no timestamp */
+    Vector::BLF::ObjectHeaderBase ohb(0, Vector::BLF::ObjectType::UNKNOWN);
+    BOOST_CHECK_EQUAL(Vector::BLF::objectTimeStampNs(ohb), 0);
+}
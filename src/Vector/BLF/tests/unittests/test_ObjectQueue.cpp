@@ -9,6 +9,10 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/filesystem.hpp>
 
+#include <chrono>
+#include <thread>
+#include <vector>
+
 #include <Vector/BLF.h>
 
 /** insert and remove some elements and check state of queue */
@@ -70,3 +74,81 @@ BOOST_AUTO_TEST_CASE(SimpleTest) {
     objectQueue.write(new Vector::BLF::LinMessage);
     objectQueue.write(new Vector::BLF::J1708Message);
 }
+
+/** write and read with timeouts, and watermarks */
+BOOST_AUTO_TEST_CASE(TimeoutsAndWatermarks) {
+    Vector::BLF::ObjectQueue<Vector::BLF::ObjectHeaderBase> objectQueue;
+    objectQueue.setBufferSize(3);
+    BOOST_CHECK_EQUAL(objectQueue.bufferSize(), 3);
+    std::vector<bool> watermarks;
+    objectQueue.setWatermarks(1, 3, [&watermarks](bool high) {
+        watermarks.push_back(high);
+    });
+
+    /* read from empty queue */
+    BOOST_CHECK(objectQueue.read(std::chrono::milliseconds(10)) == nullptr);
+    BOOST_CHECK(objectQueue.good());
+    BOOST_CHECK(!objectQueue.eof());
+
+    /* fill up to the high watermark */
+    Vector::BLF::ObjectHeaderBase * objs[2] = { new Vector::BLF::CanMessage, new Vector::BLF::CanMessage };
+    BOOST_CHECK(objectQueue.write(objs, 2, std::chrono::milliseconds(0)));
+    BOOST_CHECK(watermarks.empty());
+    Vector::BLF::ObjectHeaderBase * obj = new Vector::BLF::CanMessage;
+    BOOST_CHECK(objectQueue.write(&obj, 1, std::chrono::milliseconds(0)));
+    BOOST_REQUIRE_EQUAL(watermarks.size(), 1);
+    BOOST_CHECK(watermarks[0]);
+
+    /* full queue */
+    obj = new Vector::BLF::CanMessage;
+    BOOST_CHECK(!objectQueue.write(&obj, 1, std::chrono::milliseconds(10)));
+    BOOST_CHECK_EQUAL(objectQueue.tellp(), 3);
+
+    /* drain down to the low watermark */
+    delete objectQueue.read(std::chrono::milliseconds(0));
+    BOOST_CHECK_EQUAL(watermarks.size(), 1);
+    delete objectQueue.read(std::chrono::milliseconds(0));
+    BOOST_REQUIRE_EQUAL(watermarks.size(), 2);
+    BOOST_CHECK(!watermarks[1]);
+
+    /* space again */
+    BOOST_CHECK(objectQueue.write(&obj, 1, std::chrono::milliseconds(0)));
+    BOOST_CHECK_EQUAL(watermarks.size(), 2);
+
+    /* eof */
+    objectQueue.setFileSize(objectQueue.tellp());
+    delete objectQueue.read(std::chrono::milliseconds(0));
+    delete objectQueue.read(std::chrono::milliseconds(0));
+    BOOST_CHECK(objectQueue.read(std::chrono::milliseconds(10)) == nullptr);
+    BOOST_CHECK(objectQueue.eof());
+}
+
+/** Blocking batch writes wait until there is space for all objects. */
+BOOST_AUTO_TEST_CASE(BatchWrite) {
+    Vector::BLF::ObjectQueue<Vector::BLF::ObjectHeaderBase> objectQueue;
+    objectQueue.setBufferSize(3);
+
+    /* an empty queue takes any count */
+    Vector::BLF::ObjectHeaderBase * objs[4] = { new Vector::BLF::CanMessage, new Vector::BLF::CanMessage, new Vector::BLF::CanMessage, new Vector::BLF::CanMessage };
+    objectQueue.write(objs, 4);
+    BOOST_CHECK_EQUAL(objectQueue.tellp(), 4);
+
+    /* the next batch waits, until the reader made space for all */
+    std::thread reader([&objectQueue]() {
+        for (int i = 0; i < 3; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            delete objectQueue.read(std::chrono::milliseconds(1000));
+        }
+    });
+    Vector::BLF::ObjectHeaderBase * batch[2] = { new Vector::BLF::CanMessage, new Vector::BLF::CanMessage };
+    objectQueue.write(batch, 2);
+    BOOST_CHECK_GE(objectQueue.tellg(), 3);
+    BOOST_CHECK_EQUAL(objectQueue.tellp(), 6);
+    reader.join();
+
+    /* drain */
+    objectQueue.setFileSize(objectQueue.tellp());
+    while (Vector::BLF::ObjectHeaderBase * ohb = objectQueue.read(std::chrono::milliseconds(0)))
+        delete ohb;
+    BOOST_CHECK(objectQueue.eof());
+}
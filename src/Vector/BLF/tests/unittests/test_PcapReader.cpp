@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE PcapReader
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <memory>
+
+#include <Vector/BLF.h>
+
+/** write 32-bit value in big or little endian */
+void write32(std::ofstream & os, uint32_t value, bool bigEndian) {
+    for (int i = 0; i < 4; ++i) {
+        const int shift = bigEndian ? (24 - 8 * i) : (8 * i);
+        os.put(static_cast<char>(value >> shift));
+    }
+}
+
+/** write PCAP file with two Ethernet packets */
+void writePcap(const std::string & filename, bool bigEndian, bool nanoseconds) {
+    std::ofstream os(filename, std::ios_base::binary);
+    write32(os, nanoseconds ? 0xA1B23C4D : 0xA1B2C3D4, bigEndian);
+    write32(os, bigEndian ? 0x00020004 : 0x00040002, bigEndian); // version 2.4 as two 16-bit values
+    write32(os, 0, bigEndian); // thiszone
+    write32(os, 0, bigEndian); // sigfigs
+    write32(os, 65535, bigEndian); // snaplen
+    write32(os, 1, bigEndian); // Ethernet
+    for (uint32_t i = 0; i < 2; ++i) {
+        write32(os, 1609556400 + i, bigEndian);
+        write32(os, nanoseconds ? 500 : 5, bigEndian);
+        write32(os, 60, bigEndian); // captured length
+        write32(os, 1514, bigEndian); // original length
+        for (int j = 0; j < 60; ++j)
+            os.put(static_cast<char>(j));
+    }
+}
+
+/** read PCAP files in both byte orders and resolutions */
+BOOST_AUTO_TEST_CASE(ReadPcap) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_PcapReader.pcap";
+    for (int variant = 0; variant < 4; ++variant) {
+        const bool bigEndian = (variant & 1) != 0;
+        const bool nanoseconds = (variant & 2) != 0;
+        writePcap(filename, bigEndian, nanoseconds);
+
+        Vector::BLF::PcapReader pcapReader(filename, 64); // small buffer to force refills
+        std::unique_ptr<Vector::BLF::EthernetFrameEx> first(pcapReader.read());
+        BOOST_REQUIRE(first);
+        BOOST_CHECK_EQUAL(pcapReader.startTime(), 1609556400000000000ULL + (nanoseconds ? 500 : 5000));
+        BOOST_CHECK_EQUAL(first->objectFlags, Vector::BLF::ObjectHeader::ObjectFlags::TimeOneNans);
+        BOOST_CHECK_EQUAL(first->objectTimeStamp, 0);
+        BOOST_CHECK_EQUAL(first->channel, 1);
+        BOOST_CHECK_EQUAL(first->dir, 0);
+        BOOST_CHECK_EQUAL(first->frameLength, 60);
+        BOOST_REQUIRE_EQUAL(first->frameData.size(), 60);
+        BOOST_CHECK_EQUAL(first->frameData[59], 59);
+
+        std::unique_ptr<Vector::BLF::EthernetFrameEx> second(pcapReader.read());
+        BOOST_REQUIRE(second);
+        BOOST_CHECK_EQUAL(second->objectTimeStamp, 1000000000);
+
+        BOOST_CHECK(pcapReader.read() == nullptr);
+        BOOST_CHECK_EQUAL(pcapReader.packetCount(), 2);
+
+        Vector::BLF::SYSTEMTIME startTime = pcapReader.startSystemTime();
+        BOOST_CHECK_EQUAL(startTime.year, 2021);
+        BOOST_CHECK_EQUAL(startTime.month, 1);
+        BOOST_CHECK_EQUAL(startTime.day, 2);
+        BOOST_CHECK_EQUAL(startTime.dayOfWeek, 6);
+        BOOST_CHECK_EQUAL(startTime.hour, 3);
+    }
+}
+
+/** read PCAPNG file and copy it into a BLF file */
+BOOST_AUTO_TEST_CASE(CopyPcapngToBlf) {
+    const std::string pcapngFilename = CMAKE_CURRENT_BINARY_DIR "/test_PcapReader.pcapng";
+    const std::string blfFilename = CMAKE_CURRENT_BINARY_DIR "/test_PcapReader.blf";
+    {
+        Vector::BLF::PcapngWriter pcapngWriter(pcapngFilename);
+        pcapngWriter.setStartTime(1609556400000000000ULL);
+        const std::vector<uint8_t> frame(61, 0x5A);
+        pcapngWriter.writePacket(Vector::BLF::PcapngWriter::Ethernet, 1, 1000, 0, frame.data(), static_cast<uint32_t>(frame.size()));
+        pcapngWriter.writePacket(Vector::BLF::PcapngWriter::Ieee80211, 1, 1500, 0, frame.data(), 30); // skipped
+        pcapngWriter.writePacket(Vector::BLF::PcapngWriter::Ethernet, 2, 2000, 1, frame.data(), 17);
+    }
+
+    {
+        Vector::BLF::PcapReader pcapReader(pcapngFilename);
+        Vector::BLF::File file;
+        file.open(blfFilename, std::ios_base::out);
+        BOOST_REQUIRE(file.is_open());
+        BOOST_CHECK_EQUAL(pcapReader.copyTo(file), 2);
+        BOOST_CHECK_EQUAL(pcapReader.startTime(), 1609556400000001000ULL);
+        file.close();
+    }
+
+    Vector::BLF::File file;
+    file.open(blfFilename);
+    BOOST_REQUIRE(file.is_open());
+    BOOST_CHECK_EQUAL(file.fileStatistics.measurementStartTime.year, 2021);
+    BOOST_CHECK_EQUAL(file.fileStatistics.measurementStartTime.hour, 3);
+
+    std::unique_ptr<Vector::BLF::ObjectHeaderBase> ohb(file.read());
+    BOOST_REQUIRE(ohb);
+    BOOST_REQUIRE(ohb->objectType == Vector::BLF::ObjectType::ETHERNET_FRAME_EX);
+    auto * ethernetFrameEx = static_cast<Vector::BLF::EthernetFrameEx *>(ohb.get());
+    BOOST_CHECK_EQUAL(ethernetFrameEx->channel, 1);
+    BOOST_CHECK_EQUAL(ethernetFrameEx->dir, 0);
+    BOOST_CHECK_EQUAL(ethernetFrameEx->objectTimeStamp, 0);
+    BOOST_CHECK_EQUAL(ethernetFrameEx->frameLength, 61);
+    BOOST_CHECK_EQUAL(ethernetFrameEx->frameData.size(), 61);
+
+    /* interface 1 is the WLAN interface, so the second Ethernet channel is interface 2 */
+    ohb.reset(file.read());
+    BOOST_REQUIRE(ohb);
+    BOOST_REQUIRE(ohb->objectType == Vector::BLF::ObjectType::ETHERNET_FRAME_EX);
+    ethernetFrameEx = static_cast<Vector::BLF::EthernetFrameEx *>(ohb.get());
+    BOOST_CHECK_EQUAL(ethernetFrameEx->channel, 3);
+    BOOST_CHECK_EQUAL(ethernetFrameEx->dir, 1);
+    BOOST_CHECK_EQUAL(ethernetFrameEx->objectTimeStamp, 1000);
+    BOOST_CHECK_EQUAL(ethernetFrameEx->frameLength, 17);
+
+    file.close();
+}
@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE PcapngWriter
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+
+#include <Vector/BLF.h>
+
+/** read 32-bit value */
+uint32_t read32(const std::vector<char> & data, std::size_t offset) {
+    uint32_t value;
+    std::memcpy(&value, data.data() + offset, sizeof(value));
+    return value;
+}
+
+/** write Ethernet and WLAN frames and check the block structure */
+BOOST_AUTO_TEST_CASE(WriteFrames) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_PcapngWriter.pcapng";
+    {
+        Vector::BLF::PcapngWriter pcapngWriter(filename, 64); // small buffer to force flushes
+
+        Vector::BLF::SYSTEMTIME startTime {};
+        startTime.year = 2021;
+        startTime.month = 1;
+        startTime.day = 2;
+        startTime.hour = 3;
+        pcapngWriter.setStartTime(startTime);
+
+        /* EthernetFrame with VLAN tag is reconstructed */
+        Vector::BLF::EthernetFrame ethernetFrame;
+        ethernetFrame.channel = 1;
+        ethernetFrame.destinationAddress = { { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff } };
+        ethernetFrame.sourceAddress = { { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 } };
+        ethernetFrame.tpid = 0x8100;
+        ethernetFrame.tci = 0x0005;
+        ethernetFrame.type = 0x0800;
+        ethernetFrame.payLoad.resize(47, 0xAB);
+        ethernetFrame.objectTimeStamp = 1000;
+        pcapngWriter.write(&ethernetFrame);
+
+        /* EthernetFrameEx on same channel, transmitted */
+        Vector::BLF::EthernetFrameEx ethernetFrameEx;
+        ethernetFrameEx.channel = 1;
+        ethernetFrameEx.dir = 1;
+        ethernetFrameEx.frameData.resize(100, 0xCD);
+        ethernetFrameEx.objectTimeStamp = 2000;
+        pcapngWriter.write(&ethernetFrameEx);
+
+        /* WLAN frame on channel 1 gets its own interface */
+        Vector::BLF::WlanFrame wlanFrame;
+        wlanFrame.channel = 1;
+        wlanFrame.frameData.resize(30, 0xEF);
+        pcapngWriter.write(&wlanFrame);
+
+        /* other objects are ignored */
+        Vector::BLF::CanMessage canMessage;
+        pcapngWriter.write(&canMessage);
+
+        BOOST_CHECK_EQUAL(pcapngWriter.packetCount(), 3);
+    }
+
+    std::ifstream is(filename, std::ios_base::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+
+    /* walk blocks */
+    std::vector<uint32_t> blockTypes;
+    std::size_t offset = 0;
+    while (offset + 12 <= data.size()) {
+        uint32_t blockType = read32(data, offset);
+        uint32_t blockLength = read32(data, offset + 4);
+        BOOST_REQUIRE_EQUAL(blockLength % 4, 0);
+        BOOST_REQUIRE_LE(offset + blockLength, data.size());
+        BOOST_CHECK_EQUAL(read32(data, offset + blockLength - 4), blockLength);
+        blockTypes.push_back(blockType);
+
+        if (blockType == 0x0A0D0D0A)
+            BOOST_CHECK_EQUAL(read32(data, offset + 8), 0x1A2B3C4D);
+
+        /* first packet: VLAN tagged frame with absolute timestamp */
+        if ((blockType == 6) && (blockTypes.size() == 3)) {
+            BOOST_CHECK_EQUAL(read32(data, offset + 8), 0);
+            uint64_t timeStamp = (static_cast<uint64_t>(read32(data, offset + 12)) << 32) | read32(data, offset + 16);
+            BOOST_CHECK_EQUAL(timeStamp, 1609556400000000000ULL + 1000);
+            BOOST_CHECK_EQUAL(read32(data, offset + 20), 6 + 6 + 4 + 2 + 47);
+            BOOST_CHECK_EQUAL(static_cast<uint8_t>(data[offset + 28 + 12]), 0x81);
+        }
+
+        offset += blockLength;
+    }
+    BOOST_CHECK_EQUAL(offset, data.size());
+
+    /* SHB, IDB (ETH 1), EPB, EPB, IDB (WLAN 1), EPB */
+    BOOST_CHECK(blockTypes == std::vector<uint32_t>({ 0x0A0D0D0A, 1, 6, 6, 1, 6 }));
+}
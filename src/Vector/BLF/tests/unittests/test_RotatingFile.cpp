@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE RotatingFile
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <thread>
+
+#include <Vector/BLF.h>
+
+/** read all files and check that the objects are complete and in order */
+static void checkFiles(const Vector::BLF::RotatingFile & rotatingFile, const uint32_t objectCount) {
+    uint32_t id = 0;
+    for (uint32_t fileNumber = 1; fileNumber <= rotatingFile.fileCount(); ++fileNumber) {
+        Vector::BLF::File file;
+        file.open(rotatingFile.filename(fileNumber), std::ios_base::in);
+        BOOST_REQUIRE(file.is_open());
+        BOOST_CHECK_GT(file.fileStatistics.objectCount, 0);
+        BOOST_CHECK_EQUAL(file.fileStatistics.fileSize, boost::filesystem::file_size(rotatingFile.filename(fileNumber)));
+        uint32_t count = 0;
+        while (Vector::BLF::ObjectHeaderBase * ohb = file.read()) {
+            auto * canMessage2 = dynamic_cast<Vector::BLF::CanMessage2 *>(ohb);
+            BOOST_REQUIRE(canMessage2);
+            BOOST_CHECK_EQUAL(canMessage2->id, id);
+            delete ohb;
+            id++;
+            count++;
+        }
+        BOOST_CHECK_EQUAL(count, file.fileStatistics.objectCount);
+        file.close();
+    }
+    BOOST_CHECK_EQUAL(id, objectCount);
+
+    /* file opened in advance is removed */
+    BOOST_CHECK(!boost::filesystem::exists(rotatingFile.filename(rotatingFile.fileCount() + 1)));
+}
+
+/** rollover by size */
+BOOST_AUTO_TEST_CASE(RolloverBySize) {
+    Vector::BLF::RotatingFile rotatingFile;
+    rotatingFile.filenamePrefix = CMAKE_CURRENT_BINARY_DIR "/test_RotatingFileSize_";
+    rotatingFile.maxFileSize = 0x4000;
+    rotatingFile.defaultLogContainerSize = 0x1000;
+    rotatingFile.open();
+    BOOST_REQUIRE(rotatingFile.is_open());
+    for (uint32_t i = 0; i < 20000; ++i) {
+        auto * canMessage2 = new Vector::BLF::CanMessage2;
+        canMessage2->id = i;
+        canMessage2->data.assign(8, static_cast<uint8_t>(i));
+        rotatingFile.write(canMessage2);
+    }
+    rotatingFile.close();
+    BOOST_CHECK(!rotatingFile.is_open());
+
+    BOOST_CHECK_GT(rotatingFile.fileCount(), 1);
+    checkFiles(rotatingFile, 20000);
+}
+
+/** rollover by time */
+BOOST_AUTO_TEST_CASE(RolloverByTime) {
+    Vector::BLF::RotatingFile rotatingFile;
+    rotatingFile.filenamePrefix = CMAKE_CURRENT_BINARY_DIR "/test_RotatingFileTime_";
+    rotatingFile.maxFileTime = 50;
+    rotatingFile.open();
+    BOOST_REQUIRE(rotatingFile.is_open());
+    for (uint32_t i = 0; i < 30; ++i) {
+        auto * canMessage2 = new Vector::BLF::CanMessage2;
+        canMessage2->id = i;
+        canMessage2->data.assign(8, static_cast<uint8_t>(i));
+        rotatingFile.write(canMessage2);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    rotatingFile.close();
+
+    BOOST_CHECK_GT(rotatingFile.fileCount(), 1);
+    checkFiles(rotatingFile, 30);
+}
@@ -0,0 +1,157 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE SharedMemoryPublisher
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <Vector/BLF.h>
+
+/** A file is published to several consumers, which read all objects in order. */
+BOOST_AUTO_TEST_CASE(PublishFile) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_SharedMemoryPublisher.blf";
+    const std::string name = "/vector_blf_test_SharedMemoryPublisher";
+    const uint32_t objectCount = 10000;
+    const uint32_t consumerCount = 3;
+
+    /* write file */
+    {
+        Vector::BLF::File file;
+        file.open(filename, std::ios_base::out);
+        BOOST_REQUIRE(file.is_open());
+        for (uint32_t i = 0; i < objectCount; ++i) {
+            auto * canMessage = new Vector::BLF::CanMessage;
+            canMessage->objectTimeStamp = i;
+            file.write(canMessage);
+        }
+        file.close();
+    }
+
+    /* small ring, so that it wraps around and the publisher waits for the consumers */
+    Vector::BLF::SharedMemoryPublisher publisher;
+    publisher.capacity = 0x1000;
+    publisher.maxConsumers = 4;
+    BOOST_REQUIRE(publisher.open(name));
+    BOOST_CHECK(publisher.is_open());
+    BOOST_CHECK_EQUAL(publisher.consumers(), 0);
+
+    /* consumers */
+    std::vector<uint32_t> counts(consumerCount);
+    std::vector<bool> ordered(consumerCount);
+    std::vector<std::thread> threads;
+    for (uint32_t c = 0; c < consumerCount; ++c) {
+        threads.emplace_back([&name, &counts, &ordered, c] {
+            Vector::BLF::SharedMemoryReader reader;
+            if (!reader.open(name, 5000))
+                return;
+            uint32_t count = 0;
+            bool inOrder = true;
+            while (Vector::BLF::ObjectHeaderBase * ohb = reader.read(5000)) {
+                auto * canMessage = dynamic_cast<Vector::BLF::CanMessage *>(ohb);
+                if (!canMessage || (canMessage->objectTimeStamp != count))
+                    inOrder = false;
+                delete ohb;
+                count++;
+            }
+            counts[c] = reader.eof() ? count : 0;
+            ordered[c] = inOrder;
+        });
+    }
+    BOOST_REQUIRE(publisher.waitForConsumers(consumerCount, 5000));
+    BOOST_CHECK_EQUAL(publisher.consumers(), consumerCount);
+
+    /* publish */
+    Vector::BLF::File file;
+    file.open(filename, std::ios_base::in);
+    BOOST_REQUIRE(file.is_open());
+    BOOST_CHECK_EQUAL(publisher.publish(file), objectCount);
+    file.close();
+    publisher.close();
+    BOOST_CHECK(!publisher.is_open());
+
+    for (std::thread & thread : threads)
+        thread.join();
+    for (uint32_t c = 0; c < consumerCount; ++c) {
+        BOOST_CHECK_EQUAL(counts[c], objectCount);
+        BOOST_CHECK(ordered[c]);
+    }
+}
+
+/** Objects larger than the ring are rejected. */
+BOOST_AUTO_TEST_CASE(ObjectTooLarge) {
+    Vector::BLF::SharedMemoryPublisher publisher;
+    publisher.capacity = 0x100;
+    BOOST_REQUIRE(publisher.open("/vector_blf_test_SharedMemoryPublisher_large"));
+    Vector::BLF::AppText appText;
+    appText.text = std::string(0x200, 'x');
+    BOOST_CHECK_THROW(publisher.write(appText), Vector::BLF::Exception);
+    publisher.close();
+}
+
+#if !defined(_WIN32)
+/** The name of a running publisher is not taken over, the one of a terminated publisher is. */
+BOOST_AUTO_TEST_CASE(NameInUse) {
+    const std::string name = "/vector_blf_test_SharedMemoryPublisher_inUse";
+
+    /* running publisher */
+    Vector::BLF::SharedMemoryPublisher publisher1;
+    BOOST_REQUIRE(publisher1.open(name));
+    Vector::BLF::SharedMemoryPublisher publisher2;
+    BOOST_CHECK(!publisher2.open(name));
+    publisher1.close();
+
+    /* terminated publisher, which didn't close */
+    const pid_t pid = ::fork();
+    BOOST_REQUIRE(pid >= 0);
+    if (pid == 0) {
+        Vector::BLF::SharedMemoryPublisher publisher;
+        ::_exit(publisher.open(name) ? 0 : 1);
+    }
+    int status = 0;
+    BOOST_REQUIRE_EQUAL(::waitpid(pid, &status, 0), pid);
+    BOOST_REQUIRE(WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+    BOOST_CHECK(publisher2.open(name));
+    publisher2.close();
+}
+
+/** A consumer, which terminated without detaching, doesn't block the publisher. */
+BOOST_AUTO_TEST_CASE(StaleConsumer) {
+    const std::string name = "/vector_blf_test_SharedMemoryPublisher_stale";
+
+    Vector::BLF::SharedMemoryPublisher publisher;
+    publisher.capacity = 0x1000;
+    BOOST_REQUIRE(publisher.open(name));
+
+    /* consumer attaches, and terminates without reading */
+    const pid_t pid = ::fork();
+    BOOST_REQUIRE(pid >= 0);
+    if (pid == 0) {
+        Vector::BLF::SharedMemoryReader reader;
+        ::_exit(reader.open(name, 5000) ? 0 : 1);
+    }
+    BOOST_REQUIRE(publisher.waitForConsumers(1, 5000));
+    int status = 0;
+    BOOST_REQUIRE_EQUAL(::waitpid(pid, &status, 0), pid);
+    BOOST_REQUIRE(WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+    BOOST_CHECK_EQUAL(publisher.consumers(), 1);
+
+    /* more than the ring holds */
+    Vector::BLF::CanMessage canMessage;
+    for (int i = 0; i < 1000; ++i)
+        publisher.write(canMessage);
+    BOOST_CHECK_EQUAL(publisher.consumers(), 0);
+    publisher.close();
+}
+#endif
@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE SharedMemoryReader
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <cstring>
+#include <thread>
+
+#include <Vector/BLF.h>
+
+/** Objects are viewed without copying, and read as objects. */
+BOOST_AUTO_TEST_CASE(ViewAndRead) {
+    const std::string name = "/vector_blf_test_SharedMemoryReader";
+
+    Vector::BLF::SharedMemoryPublisher publisher;
+    BOOST_REQUIRE(publisher.open(name));
+
+    /* attach, while the publisher waits */
+    Vector::BLF::SharedMemoryReader reader;
+    BOOST_CHECK(!reader.is_open());
+    std::thread thread([&publisher] {
+        publisher.waitForConsumers(1, 5000);
+    });
+    BOOST_REQUIRE(reader.open(name, 5000));
+    thread.join();
+    BOOST_CHECK(reader.is_open());
+    BOOST_CHECK_EQUAL(publisher.consumers(), 1);
+
+    /* nothing published yet */
+    uint32_t size = 0;
+    BOOST_CHECK(reader.view(size, 0) == nullptr);
+    BOOST_CHECK(!reader.eof());
+
+    /* publish */
+    Vector::BLF::CanMessage canMessage;
+    canMessage.channel = 2;
+    canMessage.id = 0x123;
+    canMessage.objectTimeStamp = 42;
+    publisher.write(canMessage);
+    Vector::BLF::AppText appText;
+    appText.text = "text";
+    publisher.write(appText);
+    publisher.close();
+
+    /* view, data is serialized like in the file */
+    const char * data = reader.view(size);
+    BOOST_REQUIRE(data);
+    BOOST_CHECK_EQUAL(size, canMessage.calculateObjectSize());
+    BOOST_CHECK_EQUAL(std::memcmp(data, "LOBJ", 4), 0);
+    uint32_t objectType;
+    std::memcpy(&objectType, data + 12, sizeof(objectType));
+    BOOST_CHECK_EQUAL(objectType, static_cast<uint32_t>(Vector::BLF::ObjectType::CAN_MESSAGE));
+
+    /* read */
+    Vector::BLF::ObjectHeaderBase * ohb = reader.read();
+    auto * readAppText = dynamic_cast<Vector::BLF::AppText *>(ohb);
+    BOOST_REQUIRE(readAppText);
+    BOOST_CHECK_EQUAL(readAppText->text, "text");
+    delete ohb;
+
+    /* end */
+    BOOST_CHECK(reader.read() == nullptr);
+    BOOST_CHECK(reader.eof());
+    reader.close();
+    BOOST_CHECK(!reader.is_open());
+}
+
+/** Attaching fails without publisher. */
+BOOST_AUTO_TEST_CASE(NoPublisher) {
+    Vector::BLF::SharedMemoryReader reader;
+    BOOST_CHECK(!reader.open("/vector_blf_test_SharedMemoryReader_none", 10));
+    BOOST_CHECK(!reader.is_open());
+}
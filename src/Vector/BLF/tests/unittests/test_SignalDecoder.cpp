@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE SignalDecoder
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <cmath>
+#include <sstream>
+
+#include <Vector/BLF.h>
+
+/** load a DBC from string */
+Vector::BLF::Dbc dbc(const char * text) {
+    std::istringstream is(text);
+    Vector::BLF::Dbc dbc;
+    dbc.parse(is);
+    return dbc;
+}
+
+/** byte orders, signs and scaling */
+BOOST_AUTO_TEST_CASE(Layout) {
+    Vector::BLF::Dbc database = dbc(
+                                    "BO_ 100 Test: 8 Node\n"
+                                    " SG_ Intel12 : 4|12@1+ (1,0) [0|0] \"\" Node\n"
+                                    " SG_ Motorola12 : 19|12@0+ (1,0) [0|0] \"\" Node\n"
+                                    " SG_ Signed8 : 32|8@1- (0.5,10) [0|0] \"\" Node\n"
+                                    " SG_ Bit : 47|1@1+ (1,0) [0|0] \"\" Node\n"
+                                    " SG_ Motorola16 : 55|16@0- (1,0) [0|0] \"\" Node\n");
+    Vector::BLF::SignalDecoder decoder(database.messages()[0]);
+    BOOST_REQUIRE_EQUAL(decoder.signalCount(), 5);
+    BOOST_CHECK_EQUAL(decoder.signalName(1), "Motorola12");
+
+    /*
+     * Intel12 = 0xABC at bits 4..15
+     * Motorola12 = 0x123 with MSB at bit 19 (byte 2 bits 3..0, byte 3)
+     * Signed8 = -2
+     * Bit = 1
+     * Motorola16 = -2 in bytes 6, 7
+     */
+    std::array<uint8_t, 8> data { { 0xC0, 0xAB, 0x01, 0x23, 0xFE, 0x80, 0xFF, 0xFE } };
+    std::array<double, 5> values;
+    decoder.decode(data.data(), data.size(), values.data());
+    BOOST_CHECK_EQUAL(values[0], 0xABC);
+    BOOST_CHECK_EQUAL(values[1], 0x123);
+    BOOST_CHECK_EQUAL(values[2], -2 * 0.5 + 10);
+    BOOST_CHECK_EQUAL(values[3], 1);
+    BOOST_CHECK_EQUAL(values[4], -2);
+
+    /* short frame */
+    decoder.decode(data.data(), 4, values.data());
+    BOOST_CHECK_EQUAL(values[1], 0x123);
+    BOOST_CHECK(std::isnan(values[2]));
+
+    /* batch decoding matches single frame decoding */
+    std::vector<uint8_t> frames(8 * 100);
+    for (std::size_t i = 0; i < frames.size(); ++i)
+        frames[i] = static_cast<uint8_t>(i * 37 + 11);
+    std::vector<double> batch(5 * 100);
+    decoder.decodeBatch(frames.data(), 8, 100, batch.data());
+    for (std::size_t frame = 0; frame < 100; ++frame) {
+        decoder.decode(frames.data() + frame * 8, 8, values.data());
+        for (std::size_t signal = 0; signal < 5; ++signal)
+            BOOST_CHECK_EQUAL(batch[signal * 100 + frame], values[signal]);
+    }
+
+    /* one column */
+    std::vector<double> column(100);
+    decoder.decode(frames.data(), 8, 100, 4, column.data());
+    BOOST_CHECK(std::equal(column.begin(), column.end(), batch.begin() + 400));
+    BOOST_CHECK_THROW(decoder.decode(frames.data(), 8, 100, 5, column.data()), Vector::BLF::Exception);
+    BOOST_CHECK_THROW(decoder.decode(frames.data(), 4, 100, 0, column.data()), Vector::BLF::Exception);
+}
+
+/** multiplexed signals */
+BOOST_AUTO_TEST_CASE(Multiplexing) {
+    Vector::BLF::Dbc database = dbc(
+                                    "BO_ 200 Mux: 8 Node\n"
+                                    " SG_ Mux M : 0|8@1+ (1,0) [0|0] \"\" Node\n"
+                                    " SG_ A m1 : 8|8@1+ (1,0) [0|0] \"\" Node\n"
+                                    " SG_ B m2 : 8|16@1+ (1,0) [0|0] \"\" Node\n");
+    Vector::BLF::SignalDecoder decoder(database.messages()[0]);
+
+    std::array<uint8_t, 16> frames { {
+            0x01, 0x34, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x02, 0x34, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00
+        }
+    };
+    std::array<double, 6> values;
+    decoder.decodeBatch(frames.data(), 8, 2, values.data());
+    BOOST_CHECK_EQUAL(values[0], 1);
+    BOOST_CHECK_EQUAL(values[1], 2);
+    BOOST_CHECK_EQUAL(values[2], 0x34);
+    BOOST_CHECK(std::isnan(values[3]));
+    BOOST_CHECK(std::isnan(values[4]));
+    BOOST_CHECK_EQUAL(values[5], 0x1234);
+
+    /* frame shorter than the multiplexor behind the signal */
+    Vector::BLF::Dbc shortDatabase = dbc(
+                                         "BO_ 201 Mux: 8 Node\n"
+                                         " SG_ Mux M : 56|8@1+ (1,0) [0|0] \"\" Node\n"
+                                         " SG_ A m1 : 0|8@1+ (1,0) [0|0] \"\" Node\n");
+    Vector::BLF::SignalDecoder shortDecoder(shortDatabase.messages()[0]);
+    const std::array<uint8_t, 2> shortFrame { { 0x34, 0x01 } };
+    std::array<double, 2> shortValues;
+    shortDecoder.decode(shortFrame.data(), shortFrame.size(), shortValues.data());
+    BOOST_CHECK(std::isnan(shortValues[0]));
+    BOOST_CHECK(std::isnan(shortValues[1]));
+
+    /* multiplexed signal without multiplexor */
+    Vector::BLF::Dbc::Message message = database.messages()[0];
+    message.signals.erase(message.signals.begin());
+    BOOST_CHECK_THROW(Vector::BLF::SignalDecoder decoder2(message), Vector::BLF::Exception);
+}
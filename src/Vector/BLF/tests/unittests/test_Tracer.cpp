@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE Tracer
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+#include <Vector/BLF.h>
+
+/** read file into string */
+std::string readFile(const std::string & filename) {
+    std::ifstream is(filename, std::ios_base::binary);
+    return std::string((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+}
+
+/** record spans from several threads */
+BOOST_AUTO_TEST_CASE(RecordSpans) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_Tracer.json";
+    Vector::BLF::Tracer tracer(3);
+
+    tracer.setThreadName("main \"thread\"");
+    {
+        Vector::BLF::Tracer::Scope scope(&tracer, "outer", 1);
+        Vector::BLF::Tracer::Scope nullScope(nullptr, "ignored", 2);
+    }
+    std::thread thread([&tracer]() {
+        tracer.setThreadName("worker");
+        for (uint64_t i = 0; i < 5; ++i)
+            tracer.record("inflate log container", i, 1000 * i, 1000 * i + 500);
+    });
+    thread.join();
+
+    /* spans beyond the maximum per thread are dropped */
+    BOOST_CHECK_EQUAL(tracer.spanCount(), 4);
+    BOOST_CHECK_EQUAL(tracer.droppedSpanCount(), 2);
+
+    BOOST_REQUIRE(tracer.write(filename));
+    const std::string json = readFile(filename);
+    BOOST_CHECK_EQUAL(json.compare(0, 14, "{\"displayTimeU"), 0);
+    BOOST_CHECK(json.find("\"name\":\"outer\"") != std::string::npos);
+    BOOST_CHECK(json.find("\"ignored\"") == std::string::npos);
+    BOOST_CHECK(json.find("\"name\":\"main \\\"thread\\\"\"") != std::string::npos);
+    BOOST_CHECK(json.find("\"name\":\"worker\"") != std::string::npos);
+    BOOST_CHECK(json.find("\"dur\":0.500,\"args\":{\"id\":2}") != std::string::npos);
+    BOOST_CHECK(json.find("\"id\":3") == std::string::npos);
+    BOOST_CHECK_EQUAL(json.substr(json.size() - 4), "\n]}\n");
+
+    /* clear */
+    tracer.clear();
+    BOOST_CHECK_EQUAL(tracer.spanCount(), 0);
+    BOOST_CHECK_EQUAL(tracer.droppedSpanCount(), 0);
+}
+
+/** trace of the File pipeline */
+BOOST_AUTO_TEST_CASE(FileTrace) {
+    const std::string filename = CMAKE_CURRENT_BINARY_DIR "/test_Tracer.blf";
+    const std::string traceFilename = CMAKE_CURRENT_BINARY_DIR "/test_Tracer_file.json";
+    boost::filesystem::remove(traceFilename);
+
+    Vector::BLF::File file;
+    file.traceFilename = traceFilename;
+    file.setDefaultLogContainerSize(0x1000);
+    file.open(filename, std::ios_base::out);
+    BOOST_REQUIRE(file.is_open());
+    for (int i = 0; i < 1000; ++i)
+        file.write(new Vector::BLF::CanMessage2);
+    file.close();
+
+#ifdef OPTION_USE_TRACING
+    const std::string json = readFile(traceFilename);
+    BOOST_CHECK(json.find("\"name\":\"compressedFileWriteThread\"") != std::string::npos);
+    BOOST_CHECK(json.find("\"name\":\"deflate log container\"") != std::string::npos);
+    BOOST_CHECK(json.find("\"name\":\"serialize objects\"") != std::string::npos);
+    BOOST_CHECK(json.find("\"name\":\"write\"") != std::string::npos);
+#else
+    /* compiled without tracing */
+    BOOST_CHECK(!boost::filesystem::exists(traceFilename));
+#endif
+}
@@ -0,0 +1,133 @@
+// SPDX-FileCopyrightText: 2013-2021 Tobias Lorenz <tobias.lorenz@gmx.net>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#define BOOST_TEST_MODULE TriggerRecorder
+#if !defined(WIN32)
+#define BOOST_TEST_DYN_LINK
+#endif
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <thread>
+
+#include <Vector/BLF.h>
+
+/** trigger by API with size limited ring */
+BOOST_AUTO_TEST_CASE(PreTriggerSize) {
+    const std::string filenamePrefix = CMAKE_CURRENT_BINARY_DIR "/test_TriggerRecorderSize_";
+    boost::filesystem::remove(filenamePrefix + "0001.blf");
+
+    Vector::BLF::TriggerRecorder triggerRecorder;
+    triggerRecorder.filenamePrefix = filenamePrefix;
+    triggerRecorder.defaultLogContainerSize = 0x1000;
+    triggerRecorder.preTriggerTime = 0;
+    triggerRecorder.preTriggerSize = 0x1000;
+    triggerRecorder.postTriggerTime = 60000;
+    triggerRecorder.open();
+    BOOST_REQUIRE(triggerRecorder.is_open());
+    for (uint32_t i = 0; i < 5000; ++i) {
+        auto * canMessage2 = new Vector::BLF::CanMessage2;
+        canMessage2->id = i;
+        canMessage2->data.assign(8, static_cast<uint8_t>(i));
+        triggerRecorder.write(canMessage2);
+    }
+
+    /* ring is compressed and limited */
+    for (int i = 0; (i < 100) && (triggerRecorder.ringSize() == 0); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    BOOST_CHECK_GT(triggerRecorder.ringSize(), 0);
+    BOOST_CHECK_LE(triggerRecorder.ringSize(), 0x1000);
+
+    /* trigger, close cuts the post-trigger window */
+    triggerRecorder.trigger();
+    for (int i = 0; (i < 100) && (triggerRecorder.triggerCount() == 0); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    BOOST_CHECK_EQUAL(triggerRecorder.triggerCount(), 1);
+    triggerRecorder.close();
+    BOOST_CHECK(!triggerRecorder.is_open());
+
+    /* file has the last objects up to the trigger */
+    Vector::BLF::File file;
+    file.open(filenamePrefix + "0001.blf", std::ios_base::in);
+    BOOST_REQUIRE(file.is_open());
+    BOOST_CHECK_GT(file.fileStatistics.objectCount, 0);
+    BOOST_CHECK_LT(file.fileStatistics.objectCount, 5000);
+    BOOST_CHECK_EQUAL(file.fileStatistics.fileSize, boost::filesystem::file_size(filenamePrefix + "0001.blf"));
+    uint32_t count = 0;
+    uint32_t id = 5000 - file.fileStatistics.objectCount;
+    while (Vector::BLF::ObjectHeaderBase * ohb = file.read()) {
+        auto * canMessage2 = dynamic_cast<Vector::BLF::CanMessage2 *>(ohb);
+        BOOST_REQUIRE(canMessage2);
+        BOOST_CHECK_EQUAL(canMessage2->id, id);
+        BOOST_CHECK_EQUAL(canMessage2->data[7], static_cast<uint8_t>(id));
+        delete ohb;
+        id++;
+        count++;
+    }
+    BOOST_CHECK_EQUAL(count, file.fileStatistics.objectCount);
+    file.close();
+}
+
+/** trigger by GlobalMarker with post-trigger window */
+BOOST_AUTO_TEST_CASE(PostTriggerTime) {
+    const std::string filenamePrefix = CMAKE_CURRENT_BINARY_DIR "/test_TriggerRecorderTime_";
+    boost::filesystem::remove(filenamePrefix + "0001.blf");
+    boost::filesystem::remove(filenamePrefix + "0002.blf");
+
+    Vector::BLF::TriggerRecorder triggerRecorder;
+    triggerRecorder.filenamePrefix = filenamePrefix;
+    triggerRecorder.postTriggerTime = 100;
+    triggerRecorder.open();
+
+    /* pre-trigger, trigger and post-trigger objects */
+    for (uint32_t i = 0; i < 100; ++i) {
+        auto * canMessage2 = new Vector::BLF::CanMessage2;
+        canMessage2->id = i;
+        canMessage2->data.assign(8, static_cast<uint8_t>(i));
+        triggerRecorder.write(canMessage2);
+    }
+    triggerRecorder.write(new Vector::BLF::GlobalMarker);
+    for (uint32_t i = 100; i < 200; ++i) {
+        auto * canMessage2 = new Vector::BLF::CanMessage2;
+        canMessage2->id = i;
+        canMessage2->data.assign(8, static_cast<uint8_t>(i));
+        triggerRecorder.write(canMessage2);
+    }
+
+    /* objects after the post-trigger window are only in the ring */
+    for (int i = 0; (i < 100) && !boost::filesystem::exists(filenamePrefix + "0001.blf"); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    for (uint32_t i = 200; i < 300; ++i) {
+        auto * canMessage2 = new Vector::BLF::CanMessage2;
+        canMessage2->id = i;
+        canMessage2->data.assign(8, static_cast<uint8_t>(i));
+        triggerRecorder.write(canMessage2);
+    }
+    triggerRecorder.close();
+    BOOST_CHECK_EQUAL(triggerRecorder.triggerCount(), 1);
+    BOOST_CHECK(!boost::filesystem::exists(filenamePrefix + "0002.blf"));
+
+    /* file */
+    Vector::BLF::FileStatistics fileStatistics;
+    BOOST_REQUIRE(Vector::BLF::File::probe(filenamePrefix + "0001.blf", fileStatistics));
+    BOOST_CHECK_EQUAL(fileStatistics.objectCount, 201);
+    Vector::BLF::File file;
+    file.open(filenamePrefix + "0001.blf", std::ios_base::in);
+    BOOST_REQUIRE(file.is_open());
+    uint32_t globalMarkers = 0;
+    uint32_t canMessages = 0;
+    while (Vector::BLF::ObjectHeaderBase * ohb = file.read()) {
+        if (ohb->objectType == Vector::BLF::ObjectType::GLOBAL_MARKER)
+            globalMarkers++;
+        if (ohb->objectType == Vector::BLF::ObjectType::CAN_MESSAGE2)
+            canMessages++;
+        delete ohb;
+    }
+    BOOST_CHECK_EQUAL(globalMarkers, 1);
+    BOOST_CHECK_EQUAL(canMessages, 200);
+    file.close();
+}